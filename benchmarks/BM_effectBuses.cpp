@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "Synth.h"
+#include "Resources.h"
+#include "SynthConfig.h"
+#include "AudioBuffer.h"
+#include <benchmark/benchmark.h>
+#include <ghc/fs_std.hpp>
+
+constexpr int blockSize { 256 };
+constexpr int blocksPerNote { 64 };
+
+// Heavy effects on 4 buses, each fed by its own voice
+static const char* effectMix = R"(
+<region> key=60 sample=*saw effect1=100
+<region> key=61 sample=*square effect2=100
+<region> key=62 sample=*triangle effect3=100
+<region> key=63 sample=*saw effect4=100
+<effect> bus=fx1 type=fverb reverb_type=large_hall reverb_wet=100
+<effect> bus=fx2 type=strings strings_number=88 strings_wet=100
+<effect> bus=fx3 type=comp comp_threshold=-20 comp_ratio=4
+<effect> bus=fx3 type=fverb reverb_type=chamber reverb_wet=50
+<effect> bus=fx4 type=strings strings_number=44 strings_wet=100
+)";
+
+class EffectBusFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State& state)
+    {
+        synth.setSamplesPerBlock(blockSize);
+        synth.setNumRenderThreads(static_cast<int>(state.range(0)));
+        synth.getResources().getSynthConfig().parallelEffectBuses = state.range(1) != 0;
+        synth.loadSfzString((fs::current_path() / "effectBuses.sfz").string(), effectMix);
+        buffer = sfz::AudioBuffer<float>(2, blockSize);
+    }
+
+    void TearDown(const ::benchmark::State& /* state */)
+    {
+    }
+
+    sfz::Synth synth;
+    sfz::AudioBuffer<float> buffer;
+};
+
+BENCHMARK_DEFINE_F(EffectBusFixture, Render)(benchmark::State& state)
+{
+    int block = 0;
+    for (auto _ : state) {
+        if (block++ % blocksPerNote == 0) {
+            state.PauseTiming();
+            for (int key = 60; key <= 63; ++key)
+                synth.noteOn(0, key, 100);
+            state.ResumeTiming();
+        }
+        synth.renderBlock(buffer);
+    }
+
+    state.counters["Blocks"] = benchmark::Counter(
+        static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+// The number of render threads, and whether the buses run in parallel
+BENCHMARK_REGISTER_F(EffectBusFixture, Render)
+    ->Args({ 1, 0 })->Args({ 4, 0 })->Args({ 4, 1 })->UseRealTime();
+BENCHMARK_MAIN();
@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "FilterBank.h"
+#include "SfzFilter.h"
+#include "SIMDHelpers.h"
+#include "ScopedFTZ.h"
+#include <benchmark/benchmark.h>
+#include <absl/memory/memory.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+constexpr int blockSize { 256 };
+constexpr float sampleRate { 48000.0f };
+
+// Voices each running a 2-pole low-pass filter, with their cutoffs moving
+class FilterBankFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State& state) {
+        numVoices = static_cast<unsigned>(state.range(0));
+        std::uniform_real_distribution<float> noise { -0.5f, 0.5f };
+        std::uniform_real_distribution<float> cutoff { 200.0f, 8000.0f };
+
+        inputs.assign(numVoices, std::vector<float>(blockSize));
+        outputs.assign(numVoices, std::vector<float>(blockSize));
+        cutoffs.assign(numVoices, std::vector<float>(blockSize));
+        resonances.assign(numVoices, std::vector<float>(blockSize, 3.0f));
+        gains.assign(blockSize, 0.0f);
+        for (unsigned v = 0; v < numVoices; ++v) {
+            std::generate(inputs[v].begin(), inputs[v].end(), [&]() { return noise(gen); });
+            sfz::linearRamp<float>(absl::MakeSpan(cutoffs[v]), cutoff(gen), 1.0f);
+        }
+    }
+
+    void TearDown(const ::benchmark::State& /* state */) {
+    }
+
+    std::mt19937 gen { 42 };
+    unsigned numVoices { 0 };
+    std::vector<std::vector<float>> inputs;
+    std::vector<std::vector<float>> outputs;
+    std::vector<std::vector<float>> cutoffs;
+    std::vector<std::vector<float>> resonances;
+    std::vector<float> gains;
+};
+
+BENCHMARK_DEFINE_F(FilterBankFixture, PerVoice_Faust)(benchmark::State& state) {
+    ScopedFTZ ftz;
+    std::vector<std::unique_ptr<sfz::Filter>> filters;
+    for (unsigned v = 0; v < numVoices; ++v) {
+        filters.push_back(absl::make_unique<sfz::Filter>());
+        filters[v]->init(sampleRate);
+        filters[v]->setType(sfz::FilterType::kFilterLpf2p);
+        filters[v]->setChannels(1);
+    }
+
+    for (auto _ : state) {
+        for (unsigned v = 0; v < numVoices; ++v) {
+            const float* input[1] { inputs[v].data() };
+            float* output[1] { outputs[v].data() };
+            filters[v]->processModulated(input, output, cutoffs[v].data(),
+                resonances[v].data(), gains.data(), blockSize);
+        }
+        benchmark::DoNotOptimize(outputs);
+    }
+    state.counters["Voices"] = numVoices;
+}
+
+static void processBank(FilterBankFixture& fixture, benchmark::State& state)
+{
+    ScopedFTZ ftz;
+    const unsigned numVoices = fixture.numVoices;
+    sfz::FilterBank bank { numVoices };
+    bank.setSampleRate(sampleRate);
+    std::vector<sfz::FilterBank::Channel> channels(numVoices);
+    for (auto& channel : channels)
+        sfz::FilterBank::setupChannel(channel, sfz::FilterType::kFilterLpf2p);
+
+    for (auto _ : state) {
+        bank.clear();
+        for (unsigned v = 0; v < numVoices; ++v) {
+            bank.add(channels[v], fixture.inputs[v].data(), fixture.outputs[v].data(),
+                fixture.cutoffs[v].data(), fixture.resonances[v].data());
+        }
+        bank.process(blockSize);
+        benchmark::DoNotOptimize(fixture.outputs);
+    }
+    state.counters["Voices"] = numVoices;
+}
+
+BENCHMARK_DEFINE_F(FilterBankFixture, Bank_Scalar)(benchmark::State& state) {
+    sfz::setSIMDOpStatus<float>(sfz::SIMDOps::biquadVoiceBatch, false);
+    processBank(*this, state);
+    sfz::resetSIMDOpStatus<float>();
+}
+
+BENCHMARK_DEFINE_F(FilterBankFixture, Bank_SIMD)(benchmark::State& state) {
+    sfz::setSIMDOpStatus<float>(sfz::SIMDOps::biquadVoiceBatch, true);
+    processBank(*this, state);
+    sfz::resetSIMDOpStatus<float>();
+}
+
+BENCHMARK_REGISTER_F(FilterBankFixture, PerVoice_Faust)->Arg(64)->Arg(128)->Arg(256);
+BENCHMARK_REGISTER_F(FilterBankFixture, Bank_Scalar)->Arg(64)->Arg(128)->Arg(256);
+BENCHMARK_REGISTER_F(FilterBankFixture, Bank_SIMD)->Arg(64)->Arg(128)->Arg(256);
+BENCHMARK_MAIN();
@@ -32,6 +32,10 @@ public:
         sfz::linearRamp<float>(absl::MakeSpan(q), 0.0f, 0.001f);
         sfz::linearRamp<float>(absl::MakeSpan(pksh), 0.0f, 0.001f);
         std::generate(input.begin(), input.end(), [&]() { return dist(gen); });
+        constantCutoff = std::vector<float>(blockSize, 500.0f);
+        constantQ = std::vector<float>(blockSize, 0.0f);
+        constantPksh = std::vector<float>(blockSize, 0.0f);
+        tables.setSampleRate(sampleRate);
     }
 
     void TearDown(const ::benchmark::State& /* state */) {
@@ -43,10 +47,37 @@ public:
     std::vector<float> cutoff;
     std::vector<float> q;
     std::vector<float> pksh;
+    std::vector<float> constantCutoff;
+    std::vector<float> constantQ;
+    std::vector<float> constantPksh;
     std::vector<float> input;
     std::vector<float> output;
+    sfz::FilterTables tables;
 };
 
+template <class F, class T>
+static void processModulated(benchmark::State& state, T type, const sfz::FilterTables* tables,
+    const std::vector<float>& input, std::vector<float>& output,
+    const std::vector<float>& cutoff, const std::vector<float>& q, const std::vector<float>& pksh)
+{
+    ScopedFTZ ftz;
+    F filter;
+    filter.init(sampleRate);
+    filter.setType(type);
+    filter.setCoefficientTables(tables);
+    for (auto _ : state)
+    {
+        const auto step = static_cast<size_t>(state.range(0));
+        for (size_t frame = 0; frame < blockSize; frame += step)
+        {
+            const float* inputPtr = input.data() + frame;
+            float* outputPtr = output.data() + frame;
+            filter.processModulated(&inputPtr, &outputPtr, cutoff.data() + frame,
+                q.data() + frame, pksh.data() + frame, step);
+        }
+    }
+}
+
 BENCHMARK_DEFINE_F(FilterFixture, OnePole_VA)(benchmark::State& state) {
     ScopedFTZ ftz;
     sfz::OnePoleFilter<float> filter;
@@ -141,9 +172,49 @@ BENCHMARK_DEFINE_F(FilterFixture, TwoPoleShelf_Faust)(benchmark::State& state) {
     }
 }
 
+BENCHMARK_DEFINE_F(FilterFixture, TwoPoleModulated_Faust)(benchmark::State& state) {
+    processModulated<sfz::Filter>(state, sfz::kFilterLpf2p, nullptr, input, output, cutoff, q, pksh);
+}
+
+BENCHMARK_DEFINE_F(FilterFixture, TwoPoleModulated_Tables)(benchmark::State& state) {
+    processModulated<sfz::Filter>(state, sfz::kFilterLpf2p, &tables, input, output, cutoff, q, pksh);
+}
+
+BENCHMARK_DEFINE_F(FilterFixture, TwoPoleShelfModulated_Faust)(benchmark::State& state) {
+    processModulated<sfz::Filter>(state, sfz::kFilterLsh, nullptr, input, output, cutoff, q, pksh);
+}
+
+BENCHMARK_DEFINE_F(FilterFixture, TwoPoleShelfModulated_Tables)(benchmark::State& state) {
+    processModulated<sfz::Filter>(state, sfz::kFilterLsh, &tables, input, output, cutoff, q, pksh);
+}
+
+BENCHMARK_DEFINE_F(FilterFixture, EqPeakModulated_Faust)(benchmark::State& state) {
+    processModulated<sfz::FilterEq>(state, sfz::kEqPeak, nullptr, input, output, cutoff, constantQ, pksh);
+}
+
+BENCHMARK_DEFINE_F(FilterFixture, EqPeakModulated_Tables)(benchmark::State& state) {
+    processModulated<sfz::FilterEq>(state, sfz::kEqPeak, &tables, input, output, cutoff, constantQ, pksh);
+}
+
+BENCHMARK_DEFINE_F(FilterFixture, TwoPoleConstant_Faust)(benchmark::State& state) {
+    processModulated<sfz::Filter>(state, sfz::kFilterLpf2p, nullptr, input, output, constantCutoff, constantQ, constantPksh);
+}
+
+BENCHMARK_DEFINE_F(FilterFixture, TwoPoleConstant_Tables)(benchmark::State& state) {
+    processModulated<sfz::Filter>(state, sfz::kFilterLpf2p, &tables, input, output, constantCutoff, constantQ, constantPksh);
+}
+
 BENCHMARK_REGISTER_F(FilterFixture, OnePole_VA)->RangeMultiplier(2)->Range(1, 1 << 8);
 BENCHMARK_REGISTER_F(FilterFixture, OnePole_Faust)->RangeMultiplier(2)->Range(1, 1 << 8);
 BENCHMARK_REGISTER_F(FilterFixture, TwoPole_Faust)->RangeMultiplier(2)->Range(1, 1 << 8);
 BENCHMARK_REGISTER_F(FilterFixture, TwoPoleShelf_Faust)->RangeMultiplier(2)->Range(1, 1 << 8);
+BENCHMARK_REGISTER_F(FilterFixture, TwoPoleModulated_Faust)->RangeMultiplier(4)->Range(16, 1 << 8);
+BENCHMARK_REGISTER_F(FilterFixture, TwoPoleModulated_Tables)->RangeMultiplier(4)->Range(16, 1 << 8);
+BENCHMARK_REGISTER_F(FilterFixture, TwoPoleShelfModulated_Faust)->RangeMultiplier(4)->Range(16, 1 << 8);
+BENCHMARK_REGISTER_F(FilterFixture, TwoPoleShelfModulated_Tables)->RangeMultiplier(4)->Range(16, 1 << 8);
+BENCHMARK_REGISTER_F(FilterFixture, EqPeakModulated_Faust)->RangeMultiplier(4)->Range(16, 1 << 8);
+BENCHMARK_REGISTER_F(FilterFixture, EqPeakModulated_Tables)->RangeMultiplier(4)->Range(16, 1 << 8);
+BENCHMARK_REGISTER_F(FilterFixture, TwoPoleConstant_Faust)->RangeMultiplier(4)->Range(16, 1 << 8);
+BENCHMARK_REGISTER_F(FilterFixture, TwoPoleConstant_Tables)->RangeMultiplier(4)->Range(16, 1 << 8);
 BENCHMARK_MAIN();
 
@@ -6,6 +6,7 @@
 
 #include "Config.h"
 #include "Interpolators.h"
+#include "SIMDHelpers.h"
 #include "ScopedFTZ.h"
 #include "absl/types/span.h"
 #include <benchmark/benchmark.h>
@@ -16,6 +17,7 @@ public:
     Interpolators()
     {
         sfz::initializeInterpolators();
+        sfz::initializeSIMDDispatchers();
     }
 
     void SetUp(const ::benchmark::State& state)
@@ -34,6 +36,20 @@ public:
         input = absl::MakeSpan(inputBuffer).subspan(sfz::config::excessFileFrames, numFramesIn);
         output = std::vector<float>(numFramesOut);
         std::generate(input.begin(), input.end(), [&]() { return dist(gen); });
+
+        rightInputBuffer = inputBuffer;
+        rightInput = absl::MakeSpan(rightInputBuffer).subspan(sfz::config::excessFileFrames, numFramesIn);
+        std::generate(rightInput.begin(), rightInput.end(), [&]() { return dist(gen); });
+        rightOutput = std::vector<float>(numFramesOut);
+
+        const float kOutToIn = static_cast<float>(numFramesIn) / numFramesOut;
+        indices = std::vector<int>(numFramesOut);
+        coeffs = std::vector<float>(numFramesOut);
+        for (size_t iOut = 0; iOut < numFramesOut; ++iOut) {
+            float posIn = iOut * kOutToIn;
+            indices[iOut] = static_cast<int>(posIn);
+            coeffs[iOut] = posIn - indices[iOut];
+        }
     }
 
     void TearDown(const ::benchmark::State& /* state */)
@@ -43,6 +59,11 @@ public:
     std::vector<float> inputBuffer;
     absl::Span<float> input;
     std::vector<float> output;
+    std::vector<float> rightInputBuffer;
+    absl::Span<float> rightInput;
+    std::vector<float> rightOutput;
+    std::vector<int> indices;
+    std::vector<float> coeffs;
 
     enum { excessFrames = 8 };
 };
@@ -60,6 +81,25 @@ static void doInterpolation(absl::Span<const float> input, absl::Span<float> out
     }
 }
 
+// Stereo interpolation of a block, which uses the SIMD windowed-sinc
+// kernels for the sinc models and the per-frame interpolators otherwise
+template <sfz::InterpolatorModel M>
+static void doStereoBlockInterpolation(
+    absl::Span<const float> inputLeft, absl::Span<const float> inputRight,
+    absl::Span<float> outputLeft, absl::Span<float> outputRight,
+    absl::Span<const int> indices, absl::Span<const float> coeffs)
+{
+    const unsigned size = static_cast<unsigned>(outputLeft.size());
+    if (sfz::interpolateSincBlock<M>(inputLeft.data(), inputRight.data(),
+            outputLeft.data(), outputRight.data(), indices.data(), coeffs.data(), nullptr, size))
+        return;
+
+    for (unsigned iOut = 0; iOut < size; ++iOut) {
+        outputLeft[iOut] = sfz::interpolate<M>(&inputLeft[indices[iOut]], coeffs[iOut]);
+        outputRight[iOut] = sfz::interpolate<M>(&inputRight[indices[iOut]], coeffs[iOut]);
+    }
+}
+
 #define ADD_INTERPOLATOR_BENCHMARK(Type)                                \
     BENCHMARK_DEFINE_F(Interpolators, Type)(benchmark::State& state)    \
     {                                                                   \
@@ -84,3 +124,41 @@ ADD_INTERPOLATOR_BENCHMARK(Sinc36)
 ADD_INTERPOLATOR_BENCHMARK(Sinc48)
 ADD_INTERPOLATOR_BENCHMARK(Sinc60)
 ADD_INTERPOLATOR_BENCHMARK(Sinc72)
+
+#define ADD_STEREO_INTERPOLATOR_BENCHMARK(Type)                                 \
+    BENCHMARK_DEFINE_F(Interpolators, Stereo##Type##_Scalar)(benchmark::State& state) \
+    {                                                                           \
+        ScopedFTZ ftz;                                                          \
+        sfz::setSIMDOpStatus<float>(sfz::SIMDOps::sincInterpolation, false);    \
+        for (auto _ : state) {                                                  \
+            doStereoBlockInterpolation<sfz::kInterpolator##Type>(               \
+                input, rightInput, absl::MakeSpan(output),                      \
+                absl::MakeSpan(rightOutput), indices, coeffs);                  \
+        }                                                                       \
+    }                                                                           \
+    BENCHMARK_DEFINE_F(Interpolators, Stereo##Type##_SIMD)(benchmark::State& state) \
+    {                                                                           \
+        ScopedFTZ ftz;                                                          \
+        sfz::setSIMDOpStatus<float>(sfz::SIMDOps::sincInterpolation, true);     \
+        for (auto _ : state) {                                                  \
+            doStereoBlockInterpolation<sfz::kInterpolator##Type>(               \
+                input, rightInput, absl::MakeSpan(output),                      \
+                absl::MakeSpan(rightOutput), indices, coeffs);                  \
+        }                                                                       \
+    }                                                                           \
+    BENCHMARK_REGISTER_F(Interpolators, Stereo##Type##_Scalar)                  \
+        ->RangeMultiplier(4)->Range(1 << 4, 1 << 12);                           \
+    BENCHMARK_REGISTER_F(Interpolators, Stereo##Type##_SIMD)                    \
+        ->RangeMultiplier(4)->Range(1 << 4, 1 << 12);
+
+ADD_STEREO_INTERPOLATOR_BENCHMARK(Nearest)
+ADD_STEREO_INTERPOLATOR_BENCHMARK(Linear)
+ADD_STEREO_INTERPOLATOR_BENCHMARK(Hermite3)
+ADD_STEREO_INTERPOLATOR_BENCHMARK(Sinc8)
+ADD_STEREO_INTERPOLATOR_BENCHMARK(Sinc12)
+ADD_STEREO_INTERPOLATOR_BENCHMARK(Sinc16)
+ADD_STEREO_INTERPOLATOR_BENCHMARK(Sinc24)
+ADD_STEREO_INTERPOLATOR_BENCHMARK(Sinc36)
+ADD_STEREO_INTERPOLATOR_BENCHMARK(Sinc48)
+ADD_STEREO_INTERPOLATOR_BENCHMARK(Sinc60)
+ADD_STEREO_INTERPOLATOR_BENCHMARK(Sinc72)
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "Synth.h"
+#include "Resources.h"
+#include "Voice.h"
+#include "Region.h"
+#include "modulations/ModMatrix.h"
+#include "modulations/ModKey.h"
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+constexpr int blockSize { 256 };
+
+// A single region with 32 connections: 16 controllers and 4 LFOs going to
+// 4 targets each
+static std::string makeRegion()
+{
+    static const char* targets[] = { "pitch", "volume", "amplitude", "pan" };
+    std::ostringstream sfz;
+    sfz << "<region> key=60 sample=*sine";
+    for (int i = 0; i < 16; ++i)
+        sfz << " " << targets[i / 4] << "_oncc" << (i + 1) << "=" << (i + 1);
+    for (int lfo = 1; lfo <= 4; ++lfo) {
+        sfz << " lfo" << lfo << "_freq=" << lfo;
+        for (const char* target : targets)
+            sfz << " lfo" << lfo << "_" << target << "=" << 10 * lfo;
+    }
+    sfz << "\n";
+    return sfz.str();
+}
+
+class ModMatrixFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State& /* state */)
+    {
+        synth.setSamplesPerBlock(blockSize);
+        synth.loadSfzString("modMatrix.sfz", makeRegion());
+        synth.noteOn(0, 60, 100);
+
+        for (int i = 0; i < synth.getNumVoices(); ++i) {
+            const sfz::Voice* voice = synth.getVoiceView(i);
+            if (!voice->isFree()) {
+                voiceId = voice->getId();
+                regionId = voice->getRegion()->getId();
+            }
+        }
+
+        struct TargetCollector : sfz::ModMatrix::KeyVisitor {
+            explicit TargetCollector(sfz::ModMatrix& mm) : mm(mm) {}
+            bool visit(const sfz::ModKey& key) override
+            {
+                ids.push_back(mm.findTarget(key));
+                return true;
+            }
+            sfz::ModMatrix& mm;
+            std::vector<sfz::ModMatrix::TargetId> ids;
+        };
+
+        sfz::ModMatrix& mm = synth.getResources().getModMatrix();
+        TargetCollector collector { mm };
+        mm.visitTargets(collector);
+        targets = std::move(collector.ids);
+    }
+
+    void TearDown(const ::benchmark::State& /* state */)
+    {
+    }
+
+    sfz::Synth synth;
+    NumericId<sfz::Voice> voiceId;
+    NumericId<sfz::Region> regionId;
+    std::vector<sfz::ModMatrix::TargetId> targets;
+};
+
+BENCHMARK_DEFINE_F(ModMatrixFixture, Region32)(benchmark::State& state)
+{
+    sfz::ModMatrix& mm = synth.getResources().getModMatrix();
+    for (auto _ : state) {
+        mm.beginCycle(blockSize);
+        mm.beginVoice(voiceId, regionId, 1.0f);
+        for (sfz::ModMatrix::TargetId id : targets)
+            benchmark::DoNotOptimize(mm.getModulation(id));
+        mm.endVoice();
+        mm.endCycle();
+    }
+
+    state.counters["Targets"] = static_cast<double>(targets.size());
+    state.counters["Blocks"] = benchmark::Counter(
+        static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(ModMatrixFixture, Region32);
+BENCHMARK_MAIN();
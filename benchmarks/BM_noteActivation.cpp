@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "Synth.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A synthetic drum kit: each key has velocity layers, each of them with
+// random round-robins, for about 10k regions in total.
+constexpr int firstKey { 36 };
+constexpr int numKeys { 40 };
+constexpr int numRoundRobins { 16 };
+
+static std::string makeKit(int numVelocityLayers)
+{
+    std::ostringstream sfz;
+    sfz << "<control> set_cc20=127\n";
+    for (int key = firstKey; key < firstKey + numKeys; ++key) {
+        sfz << "<group> key=" << key << " locc20=64 sample=*silence\n";
+        for (int layer = 0; layer < numVelocityLayers; ++layer) {
+            const int loVel = 1 + layer * 127 / numVelocityLayers;
+            const int hiVel = (layer + 1) * 127 / numVelocityLayers;
+            for (int rr = 0; rr < numRoundRobins; ++rr) {
+                sfz << "<region> lovel=" << loVel << " hivel=" << hiVel
+                    << " lorand=" << static_cast<float>(rr) / numRoundRobins
+                    << " hirand=" << static_cast<float>(rr + 1) / numRoundRobins << "\n";
+            }
+        }
+    }
+    return sfz.str();
+}
+
+class NoteOnFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State& state)
+    {
+        synth.loadSfzString("kit.sfz", makeKit(static_cast<int>(state.range(0))));
+        std::uniform_int_distribution<int> keyDist { firstKey, firstKey + numKeys - 1 };
+        std::uniform_int_distribution<int> velocityDist { 1, 127 };
+        notes.resize(1024);
+        for (auto& note : notes)
+            note = { keyDist(generator), velocityDist(generator) };
+    }
+
+    void TearDown(const ::benchmark::State& /* state */)
+    {
+    }
+
+    sfz::Synth synth;
+    std::minstd_rand generator { 42 };
+    std::vector<std::pair<int, int>> notes;
+};
+
+BENCHMARK_DEFINE_F(NoteOnFixture, Dispatch)(benchmark::State& state)
+{
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& note = notes[i++ % notes.size()];
+        synth.noteOn(0, note.first, note.second);
+        synth.noteOff(1, note.first, note.second);
+        if (i % 32 == 0) {
+            state.PauseTiming();
+            synth.allSoundOff();
+            state.ResumeTiming();
+        }
+    }
+
+    state.counters["Regions"] = static_cast<double>(synth.getNumRegions());
+    state.counters["Notes"] = benchmark::Counter(
+        static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+// 16 velocity layers is 10240 regions
+BENCHMARK_REGISTER_F(NoteOnFixture, Dispatch)->RangeMultiplier(2)->Range(1, 16);
+BENCHMARK_MAIN();
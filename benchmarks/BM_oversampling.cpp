@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "Synth.h"
+#include "AudioBuffer.h"
+#include <benchmark/benchmark.h>
+#include <ghc/fs_std.hpp>
+
+constexpr int blockSize { 256 };
+constexpr int numNotes { 16 };
+constexpr int blocksPerNote { 64 };
+
+// Samples pitched up by up to an octave, with a cheap interpolation
+static const char* pitchedUp = R"(
+<global> ampeg_release=1 sample_quality=1 lokey=60 hikey=72 pitch_keycenter=60
+<region> sample=sample1.wav lovel=1 hivel=63
+<region> sample=sample2.wav lovel=64 hivel=127
+)";
+
+class OversamplingFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State& state)
+    {
+        synth.setSamplesPerBlock(blockSize);
+        synth.setOversamplingFactor(static_cast<sfz::Oversampling>(state.range(0)));
+        synth.loadSfzString((fs::current_path() / "oversampling.sfz").string(), pitchedUp);
+        buffer = sfz::AudioBuffer<float>(2, blockSize);
+    }
+
+    void TearDown(const ::benchmark::State& /* state */)
+    {
+    }
+
+    void playNotes()
+    {
+        synth.allSoundOff();
+        for (int i = 0; i < numNotes; ++i)
+            synth.noteOn(0, 60 + i % 13, i % 2 ? 40 : 100);
+    }
+
+    sfz::Synth synth;
+    sfz::AudioBuffer<float> buffer;
+};
+
+BENCHMARK_DEFINE_F(OversamplingFixture, Render)(benchmark::State& state)
+{
+    int block = 0;
+    for (auto _ : state) {
+        if (block++ % blocksPerNote == 0) {
+            state.PauseTiming();
+            playNotes();
+            state.ResumeTiming();
+        }
+        synth.renderBlock(buffer);
+    }
+
+    state.counters["PreloadedMB"] = static_cast<double>(synth.getPreloadedMemory()) / (1024 * 1024);
+    state.counters["Blocks"] = benchmark::Counter(
+        static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+// The argument is the oversampling factor
+BENCHMARK_REGISTER_F(OversamplingFixture, Render)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+BENCHMARK_MAIN();
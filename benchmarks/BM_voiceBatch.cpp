@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "Synth.h"
+#include "Resources.h"
+#include "SynthConfig.h"
+#include "AudioBuffer.h"
+#include <benchmark/benchmark.h>
+#include <ghc/fs_std.hpp>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+
+constexpr int blockSize { 256 };
+constexpr int numNotes { 256 };
+constexpr int blocksPerNote { 64 };
+constexpr int sampleRate { 48000 };
+constexpr int sampleFrames { 2 * sampleRate };
+
+// A plain mono piano-like region spanning the keyboard, which is simple
+// enough for its voices to be rendered in batches
+static const char* piano = R"(
+<region> lokey=21 hikey=108 pitch_keycenter=60 sample=voiceBatch.wav
+    loop_mode=no_loop sample_quality=1 ampeg_release=1
+)";
+
+// Write a decaying tone with a few partials as a 16-bit mono wave file
+static void writePianoSample(const fs::path& path)
+{
+    std::ofstream file(path.string(), std::ios::binary);
+    const auto write32 = [&file](uint32_t x) {
+        const char bytes[4] { char(x), char(x >> 8), char(x >> 16), char(x >> 24) };
+        file.write(bytes, 4);
+    };
+    const auto write16 = [&file](uint16_t x) {
+        const char bytes[2] { char(x), char(x >> 8) };
+        file.write(bytes, 2);
+    };
+
+    const uint32_t dataSize = sampleFrames * 2;
+    file.write("RIFF", 4);
+    write32(36 + dataSize);
+    file.write("WAVEfmt ", 8);
+    write32(16);
+    write16(1); // PCM
+    write16(1); // mono
+    write32(sampleRate);
+    write32(sampleRate * 2);
+    write16(2);
+    write16(16);
+    file.write("data", 4);
+    write32(dataSize);
+
+    const double frequency = 261.63;
+    for (int i = 0; i < sampleFrames; ++i) {
+        const double t = static_cast<double>(i) / sampleRate;
+        double value = 0.0;
+        for (int partial = 1; partial <= 4; ++partial)
+            value += std::sin(2 * M_PI * frequency * partial * t) / (partial * partial);
+        value *= 0.5 * std::exp(-3.0 * t);
+        write16(static_cast<uint16_t>(static_cast<int16_t>(value * 32767.0)));
+    }
+}
+
+class VoiceBatchFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State& state)
+    {
+        const fs::path directory = fs::temp_directory_path();
+        writePianoSample(directory / "voiceBatch.wav");
+
+        synth.setSamplesPerBlock(blockSize);
+        synth.setNumVoices(numNotes);
+        synth.getResources().getSynthConfig().batchedVoiceRendering = state.range(0) != 0;
+        synth.loadSfzString((directory / "voiceBatch.sfz").string(), piano);
+        buffer = sfz::AudioBuffer<float>(2, blockSize);
+    }
+
+    void TearDown(const ::benchmark::State& /* state */)
+    {
+        std::error_code ec;
+        fs::remove(fs::temp_directory_path() / "voiceBatch.wav", ec);
+    }
+
+    void playNotes()
+    {
+        synth.allSoundOff();
+        for (int i = 0; i < numNotes; ++i)
+            synth.noteOn(0, 21 + i % 88, 100);
+    }
+
+    sfz::Synth synth;
+    sfz::AudioBuffer<float> buffer;
+};
+
+BENCHMARK_DEFINE_F(VoiceBatchFixture, Render)(benchmark::State& state)
+{
+    int block = 0;
+    for (auto _ : state) {
+        if (block++ % blocksPerNote == 0) {
+            state.PauseTiming();
+            playNotes();
+            state.ResumeTiming();
+        }
+        synth.renderBlock(buffer);
+    }
+
+    state.counters["Voices"] = static_cast<double>(synth.getNumActiveVoices());
+    state.counters["Blocks"] = benchmark::Counter(
+        static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+// 0 renders each voice on its own, 1 renders the voices in batches
+BENCHMARK_REGISTER_F(VoiceBatchFixture, Render)->Arg(0)->Arg(1);
+BENCHMARK_MAIN();
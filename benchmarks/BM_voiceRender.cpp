@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "Synth.h"
+#include "Resources.h"
+#include "SynthConfig.h"
+#include "AudioBuffer.h"
+#include <benchmark/benchmark.h>
+#include <ghc/fs_std.hpp>
+
+constexpr int blockSize { 256 };
+constexpr int numNotes { 32 };
+constexpr int blocksPerNote { 64 };
+
+// A realistic mix of regions: plain samples, samples with a filter or with
+// crossfades, and plain or filtered oscillators
+static const char* voiceMix = R"(
+<global> ampeg_release=1
+<region> key=60 sample=sample1.wav
+<region> key=61 sample=sample2.wav
+<region> key=62 sample=sample3.wav cutoff=2000 fil_type=lpf_2p
+<region> key=63 sample=sample1.wav xfin_locc1=0 xfin_hicc1=127
+<region> key=64 sample=*sine
+<region> key=65 sample=*saw cutoff=1000 fil_type=lpf_2p
+<region> key=66 sample=*triangle eq1_freq=500 eq1_gain=6
+<region> key=67 sample=sample2.wav
+)";
+
+class VoiceRenderFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State& state)
+    {
+        synth.setSamplesPerBlock(blockSize);
+        synth.getResources().getSynthConfig().specializedRenderPipelines = state.range(0) != 0;
+        synth.loadSfzString((fs::current_path() / "voiceRender.sfz").string(), voiceMix);
+        buffer = sfz::AudioBuffer<float>(2, blockSize);
+    }
+
+    void TearDown(const ::benchmark::State& /* state */)
+    {
+    }
+
+    void playNotes()
+    {
+        synth.allSoundOff();
+        for (int i = 0; i < numNotes; ++i)
+            synth.noteOn(0, 60 + i % 8, 100);
+    }
+
+    sfz::Synth synth;
+    sfz::AudioBuffer<float> buffer;
+};
+
+BENCHMARK_DEFINE_F(VoiceRenderFixture, Render)(benchmark::State& state)
+{
+    int block = 0;
+    for (auto _ : state) {
+        if (block++ % blocksPerNote == 0) {
+            state.PauseTiming();
+            playNotes();
+            state.ResumeTiming();
+        }
+        synth.renderBlock(buffer);
+    }
+
+    state.counters["Voices"] = static_cast<double>(synth.getNumActiveVoices());
+    state.counters["Blocks"] = benchmark::Counter(
+        static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+// 0 is the generic render pipeline, 1 are the specialized ones
+BENCHMARK_REGISTER_F(VoiceRenderFixture, Render)->Arg(0)->Arg(1);
+BENCHMARK_MAIN();
@@ -7,7 +7,16 @@
 #include <st_audiofile_libs.h>
 #include <cxxopts.hpp>
 #include <fmidi/fmidi.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #define LOG_ERROR(ostream) std::cerr  << ostream << '\n'
 #define LOG_INFO(ostream) if (verbose) { std::cout << ostream << '\n'; }
@@ -56,105 +65,89 @@ void finishedCallback(void * cbdata)
     data->finished = true;
 }
 
-int main(int argc, char** argv)
-{
-    cxxopts::Options options("sfizz-render", "Render a midi file through an SFZ file using the sfizz library.");
-
+struct RenderSettings {
     unsigned blockSize { 1024 };
     int sampleRate { 48000 };
-    bool verbose { false };
-    bool help { false };
-    bool useEOT { false };
     int quality { 2 };
+    bool useEOT { false };
+    bool sharedPreloading { false };
+    std::string logPrefix;
+};
 
-    options.add_options()
-        ("sfz", "SFZ file", cxxopts::value<std::string>())
-        ("midi", "Input midi file", cxxopts::value<std::string>())
-        ("wav", "Output wav file", cxxopts::value<std::string>())
-        ("b,blocksize", "Block size for the sfizz callbacks", cxxopts::value(blockSize))
-        ("s,samplerate", "Output sample rate", cxxopts::value(sampleRate))
-        ("q,quality", "Resampling quality", cxxopts::value(quality))
-        ("v,verbose", "Verbose output", cxxopts::value(verbose))
-        ("log", "Produce logs", cxxopts::value<std::string>())
-        ("use-eot", "End the rendering at the last End of Track Midi message", cxxopts::value(useEOT))
-        ("h,help", "Show help", cxxopts::value(help))
-    ;
-    auto params = [&]() {
-        try { return options.parse(argc, argv); }
-        catch (std::exception& e) {
-            LOG_ERROR(e.what());
-            std::exit(-1);
-        }
-    }();
-
-    if (help) {
-        std::cout << options.help();
-        std::exit(0);
-    }
-
-    ERROR_IF(params.count("sfz") != 1, "Please specify a single SFZ file using --sfz");
-    ERROR_IF(params.count("wav") != 1, "Please specify a single WAV file using --wav");
-    ERROR_IF(params.count("midi") != 1, "Please specify a single MIDI file using --midi");
-
-    fs::path sfzPath  = fs::current_path() / params["sfz"].as<std::string>();
-    fs::path outputPath  = fs::current_path() / params["wav"].as<std::string>();
-    fs::path midiPath  = fs::current_path() / params["midi"].as<std::string>();
+struct RenderJob {
+    fs::path sfzPath;
+    fs::path midiPath;
+    fs::path outputPath;
+};
 
-    ERROR_IF(!fs::exists(sfzPath) || !fs::is_regular_file(sfzPath),
-                    "SFZ file " << sfzPath.string() << " does not exist or is not a regular file");
-    ERROR_IF(!fs::exists(midiPath) || !fs::is_regular_file(midiPath),
-            "MIDI file " << midiPath.string() << " does not exist or is not a regular file");
+struct RenderResult {
+    bool success { false };
+    std::string error;
+    size_t numRegions { 0 };
+    uint64_t numFramesWritten { 0 };
+    double renderTime { 0.0 };
 
-    if (fs::exists(outputPath)) {
-        LOG_INFO("Output file " << outputPath.string() << " already exists and will be erased.");
+    /**
+     * @brief The rendered duration over the time it took to render it.
+     */
+    double realtimeFactor(int sampleRate) const
+    {
+        if (renderTime <= 0.0)
+            return 0.0;
+        return static_cast<double>(numFramesWritten) / sampleRate / renderTime;
     }
+};
+
+RenderResult renderJob(const RenderJob& job, const RenderSettings& settings)
+{
+    RenderResult result;
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto fail = [&result](std::string error) {
+        result.error = std::move(error);
+        return result;
+    };
 
-    LOG_INFO("SFZ file:    " << sfzPath.string());
-    LOG_INFO("MIDI file:   " << midiPath.string());
-    LOG_INFO("Output file: " << outputPath.string());
-    LOG_INFO("Block size: " << blockSize);
-    LOG_INFO("Sample rate: " << sampleRate);
+    if (!fs::exists(job.sfzPath) || !fs::is_regular_file(job.sfzPath))
+        return fail("SFZ file " + job.sfzPath.string() + " does not exist or is not a regular file");
+    if (!fs::exists(job.midiPath) || !fs::is_regular_file(job.midiPath))
+        return fail("MIDI file " + job.midiPath.string() + " does not exist or is not a regular file");
 
+    const unsigned blockSize = settings.blockSize;
     sfz::Synth synth;
+    synth.setSharedPreloading(settings.sharedPreloading);
     synth.setSamplesPerBlock(blockSize);
-    synth.setSampleRate(sampleRate);
-    synth.setSampleQuality(sfz::Synth::ProcessMode::ProcessFreewheeling, quality);
+    synth.setSampleRate(settings.sampleRate);
+    synth.setSampleQuality(sfz::Synth::ProcessMode::ProcessFreewheeling, settings.quality);
     synth.enableFreeWheeling();
 
-    if (params.count("log") > 0)
-        synth.enableLogging(params["log"].as<std::string>());
-
-    ERROR_IF(!synth.loadSfzFile(sfzPath), "There was an error loading the SFZ file.");
-    LOG_INFO(synth.getNumRegions() << " regions in the SFZ.");
-
-    fmidi_smf_u midiFile { fmidi_smf_file_read(midiPath.u8string().c_str()) };
-    ERROR_IF(!midiFile, "Can't read " << midiPath);
+    if (!settings.logPrefix.empty())
+        synth.enableLogging(settings.logPrefix);
 
-    const auto* midiInfo = fmidi_smf_get_info(midiFile.get());
-    ERROR_IF(!midiInfo, "Can't get info on the midi file");
+    if (!synth.loadSfzFile(job.sfzPath))
+        return fail("There was an error loading the SFZ file " + job.sfzPath.string());
+    result.numRegions = static_cast<size_t>(synth.getNumRegions());
 
-    LOG_INFO( midiInfo->track_count << " tracks in the SMF.");
-
-    if (useEOT) {
-        LOG_INFO("-- Cutting the rendering at the last MIDI End of Track message");
-    }
+    fmidi_smf_u midiFile { fmidi_smf_file_read(job.midiPath.u8string().c_str()) };
+    if (!midiFile)
+        return fail("Can't read " + job.midiPath.string());
 
     drwav outputFile;
     drwav_data_format outputFormat {};
     outputFormat.container = drwav_container_riff;
     outputFormat.format = DR_WAVE_FORMAT_PCM;
     outputFormat.channels = 2;
-    outputFormat.sampleRate = sampleRate;
+    outputFormat.sampleRate = settings.sampleRate;
     outputFormat.bitsPerSample = 16;
 
 #if !defined(_WIN32)
-    drwav_bool32 outputFileOk = drwav_init_file_write(&outputFile, outputPath.c_str(), &outputFormat, nullptr);
+    drwav_bool32 outputFileOk = drwav_init_file_write(&outputFile, job.outputPath.c_str(), &outputFormat, nullptr);
 #else
-    drwav_bool32 outputFileOk = drwav_init_file_write_w(&outputFile, outputPath.c_str(), &outputFormat, nullptr);
+    drwav_bool32 outputFileOk = drwav_init_file_write_w(&outputFile, job.outputPath.c_str(), &outputFormat, nullptr);
 #endif
-    ERROR_IF(!outputFileOk, "Error opening the wav file for writing");
+    if (!outputFileOk)
+        return fail("Error opening the wav file " + job.outputPath.string() + " for writing");
 
-    auto sampleRateDouble = static_cast<double>(sampleRate);
+    auto sampleRateDouble = static_cast<double>(settings.sampleRate);
     const double increment { 1.0 / sampleRateDouble };
     uint64_t numFramesWritten { 0 };
     sfz::AudioBuffer<float> audioBuffer { 2, blockSize };
@@ -176,7 +169,7 @@ int main(int argc, char** argv)
         numFramesWritten += drwav_write_pcm_frames(&outputFile, blockSize, interleavedPcm.data());
     }
 
-    if (!useEOT) {
+    if (!settings.useEOT) {
         auto averagePower = sfz::meanSquared<float>(interleavedBuffer);
         while (averagePower > 1e-12f) {
             synth.renderBlock(audioBuffer);
@@ -188,7 +181,169 @@ int main(int argc, char** argv)
     }
 
     drwav_uninit(&outputFile);
-    LOG_INFO("Wrote " << numFramesWritten << " frames of sound data in" << outputPath.string());
+
+    const std::chrono::duration<double> renderTime = std::chrono::steady_clock::now() - startTime;
+    result.success = true;
+    result.numFramesWritten = numFramesWritten;
+    result.renderTime = renderTime.count();
+    return result;
+}
+
+/**
+ * @brief Read the jobs of a batch manifest. Each line holds the SFZ, MIDI and
+ * output WAV files of a job, separated by spaces, relative to the directory of
+ * the manifest. Empty lines and lines starting with '#' are ignored.
+ */
+bool readManifest(const fs::path& manifestPath, std::vector<RenderJob>& jobs)
+{
+    std::ifstream manifest { manifestPath.string() };
+    if (!manifest)
+        return false;
+
+    const fs::path directory = manifestPath.parent_path();
+    std::string line;
+    unsigned lineNumber = 0;
+    while (std::getline(manifest, line)) {
+        ++lineNumber;
+        std::istringstream fields { line };
+        std::string sfz, midi, wav, extra;
+        if (!(fields >> sfz) || sfz[0] == '#')
+            continue;
+
+        if (!(fields >> midi >> wav) || (fields >> extra)) {
+            LOG_ERROR("Line " << lineNumber << " of the manifest should hold an SFZ, a MIDI and a WAV file");
+            return false;
+        }
+
+        jobs.push_back({ directory / sfz, directory / midi, directory / wav });
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    cxxopts::Options options("sfizz-render", "Render a midi file through an SFZ file using the sfizz library.");
+
+    RenderSettings settings;
+    bool verbose { false };
+    bool help { false };
+    unsigned numJobs { std::max(1u, std::thread::hardware_concurrency()) };
+
+    options.add_options()
+        ("sfz", "SFZ file", cxxopts::value<std::string>())
+        ("midi", "Input midi file", cxxopts::value<std::string>())
+        ("wav", "Output wav file", cxxopts::value<std::string>())
+        ("batch", "Render the jobs of a manifest, with an SFZ, a MIDI and a WAV file per line", cxxopts::value<std::string>())
+        ("j,jobs", "Number of jobs rendered concurrently in batch mode", cxxopts::value(numJobs))
+        ("b,blocksize", "Block size for the sfizz callbacks", cxxopts::value(settings.blockSize))
+        ("s,samplerate", "Output sample rate", cxxopts::value(settings.sampleRate))
+        ("q,quality", "Resampling quality", cxxopts::value(settings.quality))
+        ("v,verbose", "Verbose output", cxxopts::value(verbose))
+        ("log", "Produce logs", cxxopts::value<std::string>())
+        ("use-eot", "End the rendering at the last End of Track Midi message", cxxopts::value(settings.useEOT))
+        ("h,help", "Show help", cxxopts::value(help))
+    ;
+    auto params = [&]() {
+        try { return options.parse(argc, argv); }
+        catch (std::exception& e) {
+            LOG_ERROR(e.what());
+            std::exit(-1);
+        }
+    }();
+
+    if (help) {
+        std::cout << options.help();
+        std::exit(0);
+    }
+
+    if (params.count("log") > 0)
+        settings.logPrefix = params["log"].as<std::string>();
+
+    LOG_INFO("Block size: " << settings.blockSize);
+    LOG_INFO("Sample rate: " << settings.sampleRate);
+    if (settings.useEOT) {
+        LOG_INFO("-- Cutting the rendering at the last MIDI End of Track message");
+    }
+
+    if (params.count("batch") > 0) {
+        ERROR_IF(params.count("sfz") + params.count("midi") + params.count("wav") > 0,
+            "The --sfz, --midi and --wav options are not used in batch mode");
+        ERROR_IF(numJobs == 0, "Please specify at least one job using --jobs");
+
+        const fs::path manifestPath = fs::current_path() / params["batch"].as<std::string>();
+        std::vector<RenderJob> jobs;
+        ERROR_IF(!readManifest(manifestPath, jobs), "Can't read the manifest " << manifestPath.string());
+        LOG_INFO(jobs.size() << " jobs in the manifest, rendering " << numJobs << " at a time.");
+
+        // The synths which render the same instrument share its preloaded data
+        settings.sharedPreloading = true;
+        const std::string logPrefix = settings.logPrefix;
+
+        std::atomic<size_t> nextJob { 0 };
+        std::atomic<size_t> numFailed { 0 };
+        std::mutex outputMutex;
+        const auto batchStartTime = std::chrono::steady_clock::now();
+
+        const auto worker = [&]() {
+            for (size_t index = nextJob++; index < jobs.size(); index = nextJob++) {
+                RenderSettings jobSettings = settings;
+                if (!logPrefix.empty())
+                    jobSettings.logPrefix = logPrefix + "_" + std::to_string(index);
+
+                const RenderJob& job = jobs[index];
+                const RenderResult result = renderJob(job, jobSettings);
+
+                std::lock_guard<std::mutex> lock { outputMutex };
+                if (!result.success) {
+                    ++numFailed;
+                    LOG_ERROR("[" << index << "] " << result.error);
+                    continue;
+                }
+
+                std::cout << "[" << index << "] " << job.outputPath.string()
+                          << ": " << result.numFramesWritten << " frames in " << result.renderTime
+                          << " s, realtime factor " << result.realtimeFactor(settings.sampleRate) << '\n';
+            }
+        };
+
+        std::vector<std::thread> workers;
+        const unsigned numWorkers = std::min<unsigned>(numJobs, static_cast<unsigned>(jobs.size()));
+        for (unsigned i = 1; i < numWorkers; ++i)
+            workers.emplace_back(worker);
+        worker();
+        for (auto& thread : workers)
+            thread.join();
+
+        const std::chrono::duration<double> batchTime = std::chrono::steady_clock::now() - batchStartTime;
+        LOG_INFO("Rendered " << jobs.size() - numFailed << " of " << jobs.size() << " jobs in " << batchTime.count() << " s");
+
+        return numFailed > 0 ? -1 : 0;
+    }
+
+    ERROR_IF(params.count("sfz") != 1, "Please specify a single SFZ file using --sfz");
+    ERROR_IF(params.count("wav") != 1, "Please specify a single WAV file using --wav");
+    ERROR_IF(params.count("midi") != 1, "Please specify a single MIDI file using --midi");
+
+    RenderJob job;
+    job.sfzPath  = fs::current_path() / params["sfz"].as<std::string>();
+    job.outputPath  = fs::current_path() / params["wav"].as<std::string>();
+    job.midiPath  = fs::current_path() / params["midi"].as<std::string>();
+
+    if (fs::exists(job.outputPath)) {
+        LOG_INFO("Output file " << job.outputPath.string() << " already exists and will be erased.");
+    }
+
+    LOG_INFO("SFZ file:    " << job.sfzPath.string());
+    LOG_INFO("MIDI file:   " << job.midiPath.string());
+    LOG_INFO("Output file: " << job.outputPath.string());
+
+    const RenderResult result = renderJob(job, settings);
+    ERROR_IF(!result.success, result.error);
+
+    LOG_INFO(result.numRegions << " regions in the SFZ.");
+    LOG_INFO("Wrote " << result.numFramesWritten << " frames of sound data in " << job.outputPath.string());
+    LOG_INFO("Realtime factor: " << result.realtimeFactor(settings.sampleRate));
 
     return 0;
 }
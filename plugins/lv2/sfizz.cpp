@@ -1238,10 +1238,14 @@ sfizz_lv2_load_file(sfizz_plugin_t *self, const char *file_path)
         file_path = buf;
     }
 
-    ///
-    bool status = sfizz_load_or_import_file(self->synth, file_path, nullptr);
+    // The current instrument keeps playing while the new one loads, so the
+    // synth mutex is only held to update the information of the plugin; the
+    // reloads after a modification only read the samples which changed
+    bool status = sfizz_load_or_import_file_in_background(self->synth, file_path, nullptr);
+    spin_mutex_lock(self->synth_mutex);
     sfizz_lv2_update_sfz_info(self);
     sfizz_lv2_update_file_info(self, file_path);
+    spin_mutex_unlock(self->synth_mutex);
     return status;
 }
 
@@ -1370,12 +1374,12 @@ restore(LV2_Handle instance,
     }
 
     // Sync the parameters to the synth
+    self->check_modification = false;
+    const bool loaded = sfizz_lv2_load_file(self, self->sfz_file_path);
+
     spin_mutex_lock(self->synth_mutex);
 
-    // Load an empty file to remove the default sine, and then the new file.
-    sfizz_load_string(self->synth, "empty.sfz", "");
-    self->check_modification = false;
-    if (sfizz_lv2_load_file(self, self->sfz_file_path))
+    if (loaded)
     {
         lv2_log_note(&self->logger,
             "[sfizz] Restoring the file %s\n", self->sfz_file_path);
@@ -1385,6 +1389,9 @@ restore(LV2_Handle instance,
     {
         lv2_log_error(&self->logger,
             "[sfizz] Error while restoring the file %s\n", self->sfz_file_path);
+        // Load an empty file to remove the previous instrument
+        sfizz_load_string(self->synth, "empty.sfz", "");
+        sfizz_lv2_update_sfz_info(self);
     }
 
     if (sfizz_lv2_load_scala_file(self, self->scala_file_path))
@@ -1561,9 +1568,7 @@ work(LV2_Handle instance,
     {
         const char *sfz_file_path = (const char *)LV2_ATOM_BODY_CONST(atom);
 
-        spin_mutex_lock(self->synth_mutex);
         bool success = sfizz_lv2_load_file(self, sfz_file_path);
-        spin_mutex_unlock(self->synth_mutex);
 
         if (!success) {
             lv2_log_error(&self->logger,
@@ -1646,9 +1651,7 @@ work(LV2_Handle instance,
                         "[sfizz] File %s seems to have been updated, reloading\n",
                         self->sfz_file_path);
 
-            spin_mutex_lock(self->synth_mutex);
             bool success = sfizz_lv2_load_file(self, self->sfz_file_path);
-            spin_mutex_unlock(self->synth_mutex);
 
             if (!success) {
                 lv2_log_error(&self->logger,
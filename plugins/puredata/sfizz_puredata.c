@@ -59,13 +59,15 @@ static void sfizz_tilde_set_file(t_sfizz_tilde* self, const char* file)
     self->filepath = filepath;
 }
 
-static bool sfizz_tilde_do_load(t_sfizz_tilde* self)
+static bool sfizz_tilde_do_load(t_sfizz_tilde* self, bool reload)
 {
     bool loaded;
-    if (self->filepath[0] != '\0')
-        loaded = sfizz_load_or_import_file(self->synth, self->filepath, NULL);
-    else
+    if (self->filepath[0] == '\0')
         loaded = sfizz_load_string(self->synth, "default.sfz", "<region>sample=*sine");
+    else if (reload)
+        loaded = sfizz_reload_or_import_file(self->synth, self->filepath, NULL);
+    else
+        loaded = sfizz_load_or_import_file(self->synth, self->filepath, NULL);
     return loaded;
 }
 
@@ -101,7 +103,7 @@ static void* sfizz_tilde_new(t_symbol* sym, int argc, t_atom argv[])
     sfizz_set_samples_per_block(synth, sys_getblksize());
 
     sfizz_tilde_set_file(self, file);
-    if (!sfizz_tilde_do_load(self)) {
+    if (!sfizz_tilde_do_load(self, false)) {
         pd_free((t_pd*)self);
         return NULL;
     }
@@ -226,13 +228,13 @@ static void sfizz_tilde_midiin(t_sfizz_tilde* self, t_float f)
 static void sfizz_tilde_load(t_sfizz_tilde* self, t_symbol* sym)
 {
     sfizz_tilde_set_file(self, sym->s_name);
-    sfizz_tilde_do_load(self);
+    sfizz_tilde_do_load(self, false);
 }
 
 static void sfizz_tilde_reload(t_sfizz_tilde* self, t_float value)
 {
     (void)value;
-    sfizz_tilde_do_load(self);
+    sfizz_tilde_do_load(self, true);
 }
 
 static void sfizz_tilde_hdcc(t_sfizz_tilde* self, t_float f1, t_float f2)
@@ -194,11 +194,12 @@ tresult PLUGIN_API SfizzVstProcessor::setState(IBStream* stream)
     }
 
     //
-    std::lock_guard<SpinMutex> lock(_processMutex);
+    std::unique_lock<SpinMutex> lock(_processMutex);
     _state = s;
 
     // allocate needed space to track CC values
     _state.controllers.resize(sfz::config::numCCs);
+    lock.unlock();
 
     syncStateToSynth();
 
@@ -218,7 +219,13 @@ void SfizzVstProcessor::syncStateToSynth()
     if (!synth)
         return;
 
-    loadSfzFileOrDefault(_state.sfzFile, true);
+    std::unique_lock<SpinMutex> lock(_processMutex);
+    const std::string sfzFile = _state.sfzFile;
+    lock.unlock();
+
+    loadSfzFileOrDefault(sfzFile, true);
+
+    lock.lock();
     synth->setVolume(_state.volume);
     synth->setNumVoices(_state.numVoices);
     synth->setOversamplingFactor(1 << _state.oversamplingLog2);
@@ -570,8 +577,10 @@ tresult PLUGIN_API SfizzVstProcessor::notify(Vst::IMessage* message)
 
         std::unique_lock<SpinMutex> lock(_processMutex);
         _state.sfzFile.assign(static_cast<const char *>(data), size);
-        loadSfzFileOrDefault(_state.sfzFile, false);
+        const std::string sfzFile = _state.sfzFile;
         lock.unlock();
+
+        loadSfzFileOrDefault(sfzFile, false);
     }
     else if (!std::strcmp(id, "LoadScala")) {
         const void* data = nullptr;
@@ -681,13 +690,15 @@ void SfizzVstProcessor::loadSfzFileOrDefault(const std::string& filePath, bool i
 {
     sfz::Sfizz& synth = *_synth;
 
+    // the current instrument keeps playing while the new one loads
     if (!filePath.empty()) {
-        sfizz_load_or_import_file(synth.handle(), filePath.c_str(), nullptr);
+        sfizz_load_or_import_file_in_background(synth.handle(), filePath.c_str(), nullptr);
     }
     else {
-        synth.loadSfzString("default.sfz", defaultSfzText);
+        synth.loadSfzStringInBackground("default.sfz", defaultSfzText);
     }
 
+    std::lock_guard<SpinMutex> lock(_processMutex);
     const std::string descBlob = getDescriptionBlob(synth.handle());
 
     {
@@ -804,8 +815,12 @@ void SfizzVstProcessor::doBackgroundIdle(size_t idleCounter)
     if (idleCounter % 25 == 0) {
         if (_synth->shouldReloadFile()) {
             fprintf(stderr, "[Sfizz] sfz file has changed, reloading\n");
-            std::lock_guard<SpinMutex> lock(_processMutex);
-            loadSfzFileOrDefault(_state.sfzFile, false);
+            std::unique_lock<SpinMutex> lock(_processMutex);
+            const std::string sfzFile = _state.sfzFile;
+            lock.unlock();
+            // Loading in the background keeps the preloaded samples which
+            // are unchanged on disk, so only the edited ones are read again
+            loadSfzFileOrDefault(sfzFile, false);
         }
         if (_synth->shouldReloadScala()) {
             fprintf(stderr, "[Sfizz] scala file has changed, reloading\n");
@@ -84,6 +84,7 @@ private:
     void receiveOSC(int delay, const char* path, const char* sig, const sfizz_arg_t* args);
 
     // misc
+    // loads in the background, call it without holding the process mutex
     void loadSfzFileOrDefault(const std::string& filePath, bool initParametersFromState);
 
     // note event tracking
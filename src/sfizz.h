@@ -147,6 +147,132 @@ SFIZZ_EXPORTED_API bool sfizz_load_file(sfizz_synth_t* synth, const char* path);
  */
 SFIZZ_EXPORTED_API bool sfizz_load_string(sfizz_synth_t* synth, const char* path, const char* text);
 
+/**
+ * @brief Reloads an SFZ file, keeping the preloaded samples which are still
+ * in use and unchanged on disk.
+ *
+ * This is similar to sfizz_load_file() in functionality, but only the new
+ * or modified samples are read again, which makes reloading a large
+ * instrument after a small edit much faster.
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ * @param path   A null-terminated string representing a path to an SFZ file.
+ *
+ * @return @true when file loading went OK,
+ *         @false if some error occured while loading.
+ *
+ * @par Thread-safety constraints
+ * - @b CT: the function must be invoked from the Control thread
+ * - @b OFF: the function cannot be invoked while a thread is calling @b RT functions
+ */
+SFIZZ_EXPORTED_API bool sfizz_reload_file(sfizz_synth_t* synth, const char* path);
+
+/**
+ * @brief Reloads an SFZ file from textual data, keeping the preloaded
+ * samples which are still in use and unchanged on disk.
+ *
+ * This is similar to sfizz_reload_file() in functionality, and accepts a
+ * virtual path like sfizz_load_string().
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ * @param path   The virtual path of the SFZ file.
+ * @param text   The contents of the virtual SFZ file.
+ *
+ * @return @true when file loading went OK,
+ *         @false if some error occured while loading.
+ *
+ * @par Thread-safety constraints
+ * - @b CT: the function must be invoked from the Control thread
+ * - @b OFF: the function cannot be invoked while a thread is calling @b RT functions
+ */
+SFIZZ_EXPORTED_API bool sfizz_reload_string(sfizz_synth_t* synth, const char* path, const char* text);
+
+/**
+ * @brief Function which is told the progress of the sample preloading while
+ * an SFZ is loaded.
+ * @since 1.1.0
+ *
+ * @param data        The opaque data pointer given with the function.
+ * @param num_loaded  The number of sample files preloaded.
+ * @param num_total   The total number of sample files to preload.
+ *
+ * @return @false to cancel the load, @true to continue.
+ */
+typedef bool (sfizz_load_progress_t)(void* data, unsigned int num_loaded, unsigned int num_total);
+
+/**
+ * @brief Set the function which is told the progress of the loads.
+ *
+ * The samples are preloaded in parallel, and the function is called on the
+ * loading thread each time a sample file is done. When the function cancels
+ * a load, the synth is left empty and the load function returns @false.
+ * @since 1.1.0
+ *
+ * @param synth     The synth.
+ * @param callback  The progress function, or NULL to remove it.
+ * @param data      The opaque data pointer which is passed to the function.
+ *
+ * @par Thread-safety constraints
+ * - @b CT: the function must be invoked from the Control thread
+ */
+SFIZZ_EXPORTED_API void sfizz_set_load_progress_callback(sfizz_synth_t* synth, sfizz_load_progress_t* callback, void* data);
+
+/**
+ * @brief Loads an SFZ file in the background, while the current instrument
+ * keeps playing.
+ *
+ * The new instrument is built apart with the settings of the synth, and
+ * the settings changed during the load are applied to it again. It
+ * shares the preloaded samples of the current instrument which are
+ * unchanged on disk. It replaces the current one when the load returns, and
+ * the replaced instrument rings out for a short while from the next call to
+ * a render function.
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ * @param path   A null-terminated string representing a path to an SFZ file.
+ *
+ * @return @true when file loading went OK,
+ *         @false if some error occured while loading, in which case the
+ *         current instrument is kept.
+ *
+ * @par Thread-safety constraints
+ * - @b CT: the function must be invoked from the Control thread
+ */
+SFIZZ_EXPORTED_API bool sfizz_load_file_in_background(sfizz_synth_t* synth, const char* path);
+
+/**
+ * @brief Loads an SFZ file from textual data in the background, while the
+ * current instrument keeps playing.
+ *
+ * This is similar to sfizz_load_file_in_background() in functionality, and
+ * accepts a virtual path like sfizz_load_string().
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ * @param path   The virtual path of the SFZ file.
+ * @param text   The contents of the virtual SFZ file.
+ *
+ * @return @true when file loading went OK,
+ *         @false if some error occured while loading, in which case the
+ *         current instrument is kept.
+ *
+ * @par Thread-safety constraints
+ * - @b CT: the function must be invoked from the Control thread
+ */
+SFIZZ_EXPORTED_API bool sfizz_load_string_in_background(sfizz_synth_t* synth, const char* path, const char* text);
+
+/**
+ * @brief Check whether an instrument replaced by a background load waits
+ * for the audio thread to take it over and make it ring out.
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ */
+SFIZZ_EXPORTED_API bool sfizz_is_instrument_swap_pending(sfizz_synth_t* synth);
+
 /**
  * @brief Sets the tuning from a Scala file loaded from the file system.
  * @since 0.4.0
@@ -288,6 +414,27 @@ SFIZZ_EXPORTED_API char* sfizz_export_midnam(sfizz_synth_t* synth, const char* m
  */
 SFIZZ_EXPORTED_API size_t sfizz_get_num_preloaded_samples(sfizz_synth_t* synth);
 
+/**
+ * @brief Return the number of preloaded samples which the last load reused
+ * from the previous instrument.
+ *
+ * The reloads and the background loads reuse the preloaded samples which
+ * are unchanged on disk.
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ */
+SFIZZ_EXPORTED_API size_t sfizz_get_num_reused_preloaded_samples(sfizz_synth_t* synth);
+
+/**
+ * @brief Return the number of preloaded samples which the last load read
+ * from disk.
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ */
+SFIZZ_EXPORTED_API size_t sfizz_get_num_read_preloaded_samples(sfizz_synth_t* synth);
+
 /**
  * @brief Return the number of active voices.
  *
@@ -737,9 +884,81 @@ SFIZZ_EXPORTED_API unsigned int sfizz_get_preload_size(sfizz_synth_t* synth);
 SFIZZ_EXPORTED_API void sfizz_set_preload_size(sfizz_synth_t* synth, unsigned int preload_size);
 
 /**
- * @brief Get the internal oversampling rate.
+ * @brief Get the size of the streaming rings in frames, 0 if disabled.
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ */
+SFIZZ_EXPORTED_API unsigned int sfizz_get_stream_ring_size(sfizz_synth_t* synth);
+
+/**
+ * @brief Set the size of the streaming rings in frames.
+ *
+ * The frames of a sample past its preloaded part are streamed from the disk
+ * into a ring of this size per voice, so the memory used does not depend on
+ * the length of the samples. Larger rings are more tolerant of slow disks.
+ * This applies to the voices started after the call. The rings are disabled
+ * by default with a size of 0, which loads the whole sample file in memory
+ * instead; a size of 32768 frames suits most disks.
+ * @since 1.1.0
+ *
+ * @param      synth       The synth.
+ * @param[in]  num_frames  The ring size.
+ *
+ * @par Thread-safety constraints
+ * - @b CT: the function must be invoked from the Control thread
+ */
+SFIZZ_EXPORTED_API void sfizz_set_stream_ring_size(sfizz_synth_t* synth, unsigned int num_frames);
+
+/**
+ * @brief Get the number of streaming underruns.
  *
- * As of 1.0, This is an inactive stub for future work on oversampling in the engine.
+ * This counts the times a voice needed streamed frames which were not
+ * available yet, and rendered silence instead.
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ */
+SFIZZ_EXPORTED_API size_t sfizz_get_num_stream_underruns(sfizz_synth_t* synth);
+
+/**
+ * @brief Set the directory of the persistent preload cache.
+ *
+ * The preloaded data of the samples is saved in this directory, and reused
+ * by the next loads as long as the sample files are unchanged, which avoids
+ * decoding them again. The directory is created if needed. This applies to
+ * the instruments loaded after the call.
+ * @since 1.1.0
+ *
+ * @param      synth  The synth.
+ * @param[in]  path   The cache directory; NULL or empty disables the cache.
+ *
+ * @return @true if the cache directory is usable, @false otherwise.
+ *
+ * @par Thread-safety constraints
+ * - @b CT: the function must be invoked from the Control thread
+ */
+SFIZZ_EXPORTED_API bool sfizz_set_preload_cache_directory(sfizz_synth_t* synth, const char* path);
+
+/**
+ * @brief Get the number of sample preloads served by the persistent cache.
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ */
+SFIZZ_EXPORTED_API size_t sfizz_get_num_preload_cache_hits(sfizz_synth_t* synth);
+
+/**
+ * @brief Get the number of sample preloads which missed the persistent cache,
+ * and were read from the sample files.
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ */
+SFIZZ_EXPORTED_API size_t sfizz_get_num_preload_cache_misses(sfizz_synth_t* synth);
+
+/**
+ * @brief Get the internal oversampling rate.
  *
  * @since 0.2.0
  *
@@ -750,7 +969,11 @@ SFIZZ_EXPORTED_API sfizz_oversampling_factor_t sfizz_get_oversampling_factor(sfi
 /**
  * @brief Set the internal oversampling rate.
  *
- * As of 1.0, This is an inactive stub for future work on oversampling in the engine.
+ * The sample data is upsampled by this factor when it is loaded, which
+ * reduces the aliasing of pitched-up samples at a given sample quality, at
+ * the expense of memory. This reloads the preloaded data and stops all the
+ * voices.
+ *
  * @since 0.2.0
  *
  * @param      synth         The synth.
@@ -764,6 +987,17 @@ SFIZZ_EXPORTED_API sfizz_oversampling_factor_t sfizz_get_oversampling_factor(sfi
  */
 SFIZZ_EXPORTED_API bool sfizz_set_oversampling_factor(sfizz_synth_t* synth, sfizz_oversampling_factor_t oversampling);
 
+/**
+ * @brief Get the memory used by the preloaded sample data, in bytes.
+ *
+ * This grows with the oversampling factor.
+ *
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ */
+SFIZZ_EXPORTED_API size_t sfizz_get_preloaded_memory(sfizz_synth_t* synth);
+
 /**
  * @brief Get the default resampling quality.
  *
@@ -874,6 +1108,46 @@ SFIZZ_EXPORTED_API void sfizz_set_num_voices(sfizz_synth_t* synth, int num_voice
  */
 SFIZZ_EXPORTED_API int sfizz_get_num_voices(sfizz_synth_t* synth);
 
+/**
+ * @brief Set the number of threads used to render the voices.
+ *
+ * This counts the thread which calls @ref sfizz_render_block, so the default
+ * value of 1 renders all the voices serially. Higher values spawn worker
+ * threads which render the active voices in parallel with the audio thread.
+ * The value is clamped between 1 and 16. If the threads cannot be spawned,
+ * the voices are rendered serially.
+ *
+ * @since 1.1.0
+ *
+ * @param synth        The synth.
+ * @param num_threads  The number of render threads.
+ *
+ * @par Thread-safety constraints
+ * - @b CT: the function must be invoked from the Control thread
+ * - @b OFF: the function cannot be invoked while a thread is calling @b RT functions
+ */
+SFIZZ_EXPORTED_API void sfizz_set_num_render_threads(sfizz_synth_t* synth, int num_threads);
+
+/**
+ * @brief Return the number of threads used to render the voices.
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ */
+SFIZZ_EXPORTED_API int sfizz_get_num_render_threads(sfizz_synth_t* synth);
+
+/**
+ * @brief Return whether the render threads run with a realtime priority.
+ *
+ * The system may refuse it, e.g. without the permission to use a realtime
+ * scheduling policy; the threads then run at normal priority.
+ *
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ */
+SFIZZ_EXPORTED_API bool sfizz_has_realtime_render_threads(sfizz_synth_t* synth);
+
 /**
  * @brief Return the number of allocated buffers from the synth.
  * @since 0.2.0
@@ -893,6 +1167,28 @@ SFIZZ_EXPORTED_API int sfizz_get_num_buffers(sfizz_synth_t* synth);
  */
 SFIZZ_EXPORTED_API int sfizz_get_num_bytes(sfizz_synth_t* synth);
 
+/**
+ * @brief Get the number of bytes of the memory-mapped sample files.
+ *
+ * This is counted over all the synth instances of the process.
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ */
+SFIZZ_EXPORTED_API size_t sfizz_get_num_mapped_bytes(sfizz_synth_t* synth);
+
+/**
+ * @brief Get the number of bytes of the memory-mapped sample files which are
+ * currently resident in memory.
+ *
+ * This is counted over all the synth instances of the process. This function
+ * queries the operating system, do not call on the audio thread.
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ */
+SFIZZ_EXPORTED_API size_t sfizz_get_num_resident_mapped_bytes(sfizz_synth_t* synth);
+
 /**
  * @brief Enable freewheeling on the synth.
  * @since 0.2.0
@@ -915,6 +1211,36 @@ SFIZZ_EXPORTED_API void sfizz_enable_freewheeling(sfizz_synth_t* synth);
  */
 SFIZZ_EXPORTED_API void sfizz_disable_freewheeling(sfizz_synth_t* synth);
 
+/**
+ * @brief Enable the memory mapping of streamed sample files.
+ *
+ * The files whose frames can be used as-is, which are 32-bit float WAV files
+ * with one or two interleaved channels, are then read from the page cache past
+ * their preloaded part instead of being decoded in memory. Other files keep
+ * being decoded, as well as the oversampled and reversed samples. The mono
+ * files are read in place on POSIX systems; the stereo files, and all files
+ * on Windows, are deinterleaved block per block.
+ * This affects the files which are streamed after the call.
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ *
+ * @par Thread-safety constraints
+ * - @b CT: the function must be invoked from the Control thread
+ */
+SFIZZ_EXPORTED_API void sfizz_enable_mapped_streaming(sfizz_synth_t* synth);
+
+/**
+ * @brief Disable the memory mapping of streamed sample files.
+ * @since 1.1.0
+ *
+ * @param synth  The synth.
+ *
+ * @par Thread-safety constraints
+ * - @b CT: the function must be invoked from the Control thread
+ */
+SFIZZ_EXPORTED_API void sfizz_disable_mapped_streaming(sfizz_synth_t* synth);
+
 /**
  * @brief Return a comma separated list of unknown opcodes.
  *
@@ -996,6 +1322,72 @@ SFIZZ_EXPORTED_API void sfizz_disable_logging(sfizz_synth_t* synth);
  */
 SFIZZ_EXPORTED_API SFIZZ_DEPRECATED_API void sfizz_set_logging_prefix(sfizz_synth_t* synth, const char* prefix);
 
+/**
+ * @brief Snapshot of the synth telemetry.
+ * @since 1.1.0
+ *
+ * The counters accumulate since the synth creation or the last call to
+ * sfizz_reset_telemetry(). Times are in seconds; the percentiles are
+ * upper bounds with a relative precision of about 6%.
+ */
+typedef struct {
+    uint64_t num_blocks;              /**< Number of rendered blocks */
+    uint64_t num_frames;              /**< Number of rendered frames */
+    double dispatch_time;             /**< Time spent dispatching the events */
+    double render_time;               /**< Time spent rendering */
+    double data_time;                 /**< Time spent reading or generating the voice data */
+    double amplitude_time;            /**< Time spent on the voice amplitudes */
+    double filter_time;               /**< Time spent in the voice filters and equalizers */
+    double panning_time;              /**< Time spent on the voice panning */
+    double effects_time;              /**< Time spent in the effects */
+    int active_voices;                /**< Active voices at the end of the last block */
+    int max_active_voices;            /**< Highest number of active voices */
+    uint64_t stolen_voices;           /**< Voices released by the polyphony limits */
+    size_t file_queue_depth;          /**< Files waiting to be loaded at the end of the last block */
+    size_t max_file_queue_depth;      /**< Highest number of files waiting to be loaded */
+    uint64_t buffer_pool_exhaustions; /**< Scratch buffer requests which could not be served */
+    uint64_t stream_underruns;        /**< Streamed frames which were not available in time */
+    uint64_t effect_bus_blocks;       /**< Blocks processed by the effect buses */
+    uint64_t skipped_effect_bus_blocks; /**< Blocks skipped by the idle effect buses */
+    double callback_time_mean;        /**< Mean time of the audio callback */
+    double callback_time_p50;         /**< Median time of the audio callback */
+    double callback_time_p99;         /**< 99th percentile of the audio callback time */
+    double callback_time_p999;        /**< 99.9th percentile of the audio callback time */
+    double callback_time_max;         /**< Longest audio callback */
+    double file_wait_time_p50;        /**< Median time files wait before loading */
+    double file_wait_time_p99;        /**< 99th percentile of the time files wait before loading */
+    double file_wait_time_max;        /**< Longest time a file waited before loading */
+    double file_load_time_p50;        /**< Median file loading time */
+    double file_load_time_p99;        /**< 99th percentile of the file loading time */
+    double file_load_time_max;        /**< Longest file loading time */
+} sfizz_telemetry_t;
+
+/**
+ * @brief Read the telemetry of the synth.
+ * @since 1.1.0
+ *
+ * The telemetry is collected by the audio thread without locks, and is
+ * always available, whether logging is enabled or not.
+ *
+ * @param synth     The synth.
+ * @param telemetry The structure to fill.
+ *
+ * @par Thread-safety constraints
+ * - @b CT or @b RT: the function can be invoked from any thread, while rendering
+ */
+SFIZZ_EXPORTED_API void sfizz_get_telemetry(sfizz_synth_t* synth, sfizz_telemetry_t* telemetry);
+
+/**
+ * @brief Reset the counters and histograms of the telemetry.
+ * @since 1.1.0
+ *
+ * @param synth The synth.
+ *
+ * @par Thread-safety constraints
+ * - @b CT or @b RT: the function can be invoked from any thread, while rendering
+ */
+SFIZZ_EXPORTED_API void sfizz_reset_telemetry(sfizz_synth_t* synth);
+
 /**
  * @brief Shuts down the current processing, clear buffers and reset the voices.
  * @since 0.3.2
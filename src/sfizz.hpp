@@ -11,6 +11,7 @@
 
 #pragma once
 #include "sfizz_message.h"
+#include <functional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -141,6 +142,125 @@ public:
      */
     bool loadSfzString(const std::string& path, const std::string& text);
 
+    /**
+     * @brief Reload an SFZ file, keeping the preloaded samples which are
+     * still in use and unchanged on disk.
+     *
+     * This is similar to loadSfzFile() in functionality, but only the new or
+     * modified samples are read again, which makes reloading a large
+     * instrument after a small edit much faster.
+     *
+     * @since 1.1.0
+     *
+     * @param path The path to the file to load, as string.
+     *
+     * @return @false if the file was not found or no regions were loaded,
+     *         @true otherwise.
+     *
+     * @par Thread-safety constraints
+     * - @b CT: the function must be invoked from the Control thread
+     * - @b OFF: the function cannot be invoked while a thread is calling @b RT functions
+     */
+    bool reloadSfzFile(const std::string& path);
+
+    /**
+     * @brief Reload an SFZ document from memory, keeping the preloaded
+     * samples which are still in use and unchanged on disk.
+     *
+     * This is similar to reloadSfzFile() in functionality, and accepts a
+     * virtual path like loadSfzString().
+     *
+     * @since 1.1.0
+     *
+     * @param path The virtual path of the SFZ file, as string.
+     * @param text The contents of the virtual SFZ file.
+     *
+     * @return @false if no regions were loaded,
+     *         @true otherwise.
+     *
+     * @par Thread-safety constraints
+     * - @b CT: the function must be invoked from the Control thread
+     * - @b OFF: the function cannot be invoked while a thread is calling @b RT functions
+     */
+    bool reloadSfzString(const std::string& path, const std::string& text);
+
+    /**
+     * @brief Function which is told the progress of the sample preloading
+     * while an SFZ is loaded, with the number of sample files preloaded and
+     * the total number of sample files. Returning @false cancels the load.
+     *
+     * @since 1.1.0
+     */
+    using LoadProgressCallback = std::function<bool(size_t numLoaded, size_t numTotal)>;
+
+    /**
+     * @brief Set the function which is told the progress of the loads.
+     *
+     * The samples are preloaded in parallel, and the function is called on
+     * the loading thread each time a sample file is done. When the function
+     * cancels a load, the synth is left empty and the load function returns
+     * @false.
+     *
+     * @since 1.1.0
+     *
+     * @param callback The progress function, which may be empty.
+     *
+     * @par Thread-safety constraints
+     * - @b CT: the function must be invoked from the Control thread
+     */
+    void setLoadProgressCallback(LoadProgressCallback callback);
+
+    /**
+     * @brief Load a new SFZ file in the background, while the current
+     * instrument keeps playing.
+     *
+     * The new instrument is built apart with the settings of the synth, and
+     * the settings changed during the load are applied to it again. It
+     * shares the preloaded samples of the current instrument which are
+     * unchanged on disk. It replaces the current one when the load returns,
+     * and the replaced instrument rings out for a short while from the next
+     * call to renderBlock().
+     *
+     * @since 1.1.0
+     *
+     * @param path The path to the file to load, as string.
+     *
+     * @return @false if the file was not found or no regions were loaded,
+     *         in which case the current instrument is kept.
+     *
+     * @par Thread-safety constraints
+     * - @b CT: the function must be invoked from the Control thread
+     */
+    bool loadSfzFileInBackground(const std::string& path);
+
+    /**
+     * @brief Load a new SFZ document from memory in the background, while
+     * the current instrument keeps playing.
+     *
+     * This is similar to loadSfzFileInBackground() in functionality, and
+     * accepts a virtual path like loadSfzString().
+     *
+     * @since 1.1.0
+     *
+     * @param path The virtual path of the SFZ file, as string.
+     * @param text The contents of the virtual SFZ file.
+     *
+     * @return @false if no regions were loaded, in which case the current
+     *         instrument is kept.
+     *
+     * @par Thread-safety constraints
+     * - @b CT: the function must be invoked from the Control thread
+     */
+    bool loadSfzStringInBackground(const std::string& path, const std::string& text);
+
+    /**
+     * @brief Check whether an instrument replaced by a background load waits
+     * for the audio thread to take it over and make it ring out.
+     *
+     * @since 1.1.0
+     */
+    bool isInstrumentSwapPending() const noexcept;
+
     /**
      * @brief Sets the tuning from a Scala file loaded from the file system.
      *
@@ -263,6 +383,24 @@ public:
      */
     size_t getNumPreloadedSamples() const noexcept;
 
+    /**
+     * @brief Return the number of preloaded samples which the last load
+     * reused from the previous instrument.
+     *
+     * The reloads and the background loads reuse the preloaded samples which
+     * are unchanged on disk.
+     *
+     * @since 1.1.0
+     */
+    size_t getNumReusedPreloadedSamples() const noexcept;
+
+    /**
+     * @brief Return the number of preloaded samples which the last load read
+     * from disk.
+     * @since 1.1.0
+     */
+    size_t getNumReadPreloadedSamples() const noexcept;
+
     /**
      * @brief Set the maximum size of the blocks for the callback.
      *
@@ -772,16 +910,53 @@ public:
     void setNumVoices(int numVoices) noexcept;
 
     /**
-     * @brief Set the oversampling factor to a new value.
+     * @brief Return the number of threads used to render the voices.
+     * @since 1.1.0
+     */
+    int getNumRenderThreads() const noexcept;
+
+    /**
+     * @brief Change the number of threads used to render the voices.
+     *
+     * This counts the thread which calls renderBlock, so the default value
+     * of 1 renders all the voices serially. Higher values spawn worker
+     * threads which render the active voices in parallel with the audio
+     * thread. The value is clamped between 1 and 16. If the threads cannot
+     * be spawned, the voices are rendered serially.
+     *
+     * @since 1.1.0
+     *
+     * @param numThreads The number of render threads.
      *
-     * As of 1.0, This is an inactive stub for future work on oversampling in the engine.
+     * @par Thread-safety constraints
+     * - @b CT: the function must be invoked from the Control thread
+     * - @b OFF: the function cannot be invoked while a thread is calling @b RT functions
+     */
+    void setNumRenderThreads(int numThreads) noexcept;
+
+    /**
+     * @brief Return whether the render threads run with a realtime priority.
+     *
+     * The system may refuse it, e.g. without the permission to use a
+     * realtime scheduling policy; the threads then run at normal priority.
+     *
+     * @since 1.1.0
+     */
+    bool hasRealtimeRenderThreads() const noexcept;
+
+    /**
+     * @brief Set the oversampling factor to a new value.
      *
+     * The sample data is upsampled by this factor when it is loaded, which
+     * reduces the aliasing of pitched-up samples at a given sample quality,
+     * at the expense of memory. This reloads the preloaded data and stops
+     * all the voices.
      *
      * @since 0.2.0
      *
      * @param factor The oversampling factor.
      *
-     * @return @true if the factor did indeed change, @false otherwise.
+     * @return @true if the factor is valid, @false otherwise.
      *
      * @par Thread-safety constraints
      * - @b CT: the function must be invoked from the Control thread
@@ -792,12 +967,16 @@ public:
     /**
      * @brief Return the current oversampling factor.
      * @since 0.2.0
-     *
-     * As of 1.0, This is an inactive stub for future work on oversampling in the engine.
-     *
      */
     int getOversamplingFactor() const noexcept;
 
+    /**
+     * @brief Get the memory used by the preloaded sample data, in bytes.
+     * This grows with the oversampling factor.
+     * @since 1.1.0
+     */
+    size_t getPreloadedMemory() const noexcept;
+
     /**
      * @brief Set the preloaded file size.
      *
@@ -817,6 +996,72 @@ public:
      */
     uint32_t getPreloadSize() const noexcept;
 
+    /**
+     * @brief Set the size of the streaming rings in frames.
+     *
+     * The frames of a sample past its preloaded part are streamed from the
+     * disk into a ring of this size per voice, so the memory used does not
+     * depend on the length of the samples. Larger rings are more tolerant of
+     * slow disks. This applies to the voices started after the call.
+     * The rings are disabled by default with a size of 0, which loads the
+     * whole sample file in memory instead; a size of 32768 frames suits
+     * most disks.
+     *
+     * @since 1.1.0
+     *
+     * @param numFrames  The ring size.
+     *
+     * @par Thread-safety constraints
+     * - @b CT: the function must be invoked from the Control thread
+     */
+    void setStreamRingSize(uint32_t numFrames) noexcept;
+
+    /**
+     * @brief Return the size of the streaming rings in frames.
+     * @since 1.1.0
+     */
+    uint32_t getStreamRingSize() const noexcept;
+
+    /**
+     * @brief Return the number of times a voice needed streamed frames which
+     * were not available yet, and rendered silence instead.
+     * @since 1.1.0
+     */
+    size_t getNumStreamUnderruns() const noexcept;
+
+    /**
+     * @brief Set the directory of the persistent preload cache.
+     *
+     * The preloaded data of the samples is saved in this directory, and
+     * reused by the next loads as long as the sample files are unchanged,
+     * which avoids decoding them again. The directory is created if needed.
+     * This applies to the instruments loaded after the call.
+     * An empty path disables the cache.
+     *
+     * @since 1.1.0
+     *
+     * @param directory  The cache directory.
+     *
+     * @return @true if the cache directory is usable, @false otherwise.
+     *
+     * @par Thread-safety constraints
+     * - @b CT: the function must be invoked from the Control thread
+     */
+    bool setPreloadCacheDirectory(const std::string& directory) noexcept;
+
+    /**
+     * @brief Return the number of sample preloads served by the persistent cache.
+     * @since 1.1.0
+     */
+    size_t getNumPreloadCacheHits() const noexcept;
+
+    /**
+     * @brief Return the number of sample preloads which missed the persistent
+     * cache, and were read from the sample files.
+     * @since 1.1.0
+     */
+    size_t getNumPreloadCacheMisses() const noexcept;
+
     /**
      * @brief Return the number of allocated buffers.
      * @since 0.2.0
@@ -829,6 +1074,22 @@ public:
      */
     int getAllocatedBytes() const noexcept;
 
+    /**
+     * @brief Return the number of bytes of the memory-mapped sample files.
+     * This is counted over all the synth instances of the process.
+     * @since 1.1.0
+     */
+    size_t getMappedBytes() const noexcept;
+
+    /**
+     * @brief Return the number of bytes of the memory-mapped sample files
+     * which are currently resident in memory.
+     * This is counted over all the synth instances of the process.
+     * It queries the operating system, do not call on the audio thread.
+     * @since 1.1.0
+     */
+    size_t getResidentMappedBytes() const noexcept;
+
     /**
      * @brief Enable freewheeling on the synth.
      *
@@ -855,6 +1116,34 @@ public:
      */
     void disableFreeWheeling() noexcept;
 
+    /**
+     * @brief Enable the memory mapping of streamed sample files.
+     *
+     * The files whose frames can be used as-is, which are 32-bit float WAV
+     * files with one or two interleaved channels, are then read from the page
+     * cache past their preloaded part instead of being decoded in memory.
+     * Other files keep being decoded, as well as the oversampled and reversed
+     * samples. The mono files are read in place on POSIX systems; the stereo
+     * files, and all files on Windows, are deinterleaved block per block.
+     * This affects the files which are streamed after the call.
+     *
+     * @since 1.1.0
+     *
+     * @par Thread-safety constraints
+     * - @b CT: the function must be invoked from the Control thread
+     */
+    void enableMappedStreaming() noexcept;
+
+    /**
+     * @brief Disable the memory mapping of streamed sample files.
+     *
+     * @since 1.1.0
+     *
+     * @par Thread-safety constraints
+     * - @b CT: the function must be invoked from the Control thread
+     */
+    void disableMappedStreaming() noexcept;
+
     /**
      * @brief Check if the SFZ should be reloaded.
      *
@@ -933,6 +1222,70 @@ public:
      */
     void disableLogging() noexcept;
 
+    /**
+     * @brief Snapshot of the synth telemetry.
+     *
+     * @since 1.1.0
+     *
+     * The counters accumulate since the synth creation or the last call to
+     * resetTelemetry(). Times are in seconds; the percentiles are upper
+     * bounds with a relative precision of about 6%.
+     */
+    struct Telemetry {
+        uint64_t numBlocks { 0 };
+        uint64_t numFrames { 0 };
+        double dispatchTime { 0.0 };
+        double renderTime { 0.0 };
+        double dataTime { 0.0 };
+        double amplitudeTime { 0.0 };
+        double filterTime { 0.0 };
+        double panningTime { 0.0 };
+        double effectsTime { 0.0 };
+        int activeVoices { 0 };
+        int maxActiveVoices { 0 };
+        uint64_t stolenVoices { 0 };
+        size_t fileQueueDepth { 0 };
+        size_t maxFileQueueDepth { 0 };
+        uint64_t bufferPoolExhaustions { 0 };
+        uint64_t streamUnderruns { 0 };
+        uint64_t effectBusBlocks { 0 };
+        uint64_t skippedEffectBusBlocks { 0 };
+        double callbackTimeMean { 0.0 };
+        double callbackTimeP50 { 0.0 };
+        double callbackTimeP99 { 0.0 };
+        double callbackTimeP999 { 0.0 };
+        double callbackTimeMax { 0.0 };
+        double fileWaitTimeP50 { 0.0 };
+        double fileWaitTimeP99 { 0.0 };
+        double fileWaitTimeMax { 0.0 };
+        double fileLoadTimeP50 { 0.0 };
+        double fileLoadTimeP99 { 0.0 };
+        double fileLoadTimeMax { 0.0 };
+    };
+
+    /**
+     * @brief Read the telemetry of the synth.
+     *
+     * @since 1.1.0
+     *
+     * The telemetry is collected by the audio thread without locks, and is
+     * always available, whether logging is enabled or not.
+     *
+     * @par Thread-safety constraints
+     * - @b CT or @b RT: the function can be invoked from any thread, while rendering
+     */
+    Telemetry getTelemetry() const noexcept;
+
+    /**
+     * @brief Reset the counters and histograms of the telemetry.
+     *
+     * @since 1.1.0
+     *
+     * @par Thread-safety constraints
+     * - @b CT or @b RT: the function can be invoked from any thread, while rendering
+     */
+    void resetTelemetry() noexcept;
+
     /**
      * @brief Shuts down the current processing, clear buffers and reset the voices.
      *
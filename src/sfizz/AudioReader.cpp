@@ -72,6 +72,7 @@ public:
     explicit ForwardReader(ST_AudioFile handle);
     AudioReaderType type() const override;
     size_t readNextBlock(float* buffer, size_t frames) override;
+    bool seek(uint64_t frame) override;
 };
 
 ForwardReader::ForwardReader(ST_AudioFile handle)
@@ -93,6 +94,11 @@ size_t ForwardReader::readNextBlock(float* buffer, size_t frames)
     return readFrames;
 }
 
+bool ForwardReader::seek(uint64_t frame)
+{
+    return handle_.seek(frame);
+}
+
 //------------------------------------------------------------------------------
 
 template <size_t N, class T = float>
@@ -141,6 +147,7 @@ public:
     explicit ReverseReader(ST_AudioFile handle);
     AudioReaderType type() const override;
     size_t readNextBlock(float* buffer, size_t frames) override;
+    bool seek(uint64_t frame) override;
 
 private:
     uint64_t position_ {};
@@ -176,6 +183,17 @@ size_t ReverseReader::readNextBlock(float* buffer, size_t frames)
     return readFrames;
 }
 
+bool ReverseReader::seek(uint64_t frame)
+{
+    // The file is seeked on the next read
+    const uint64_t numFrames = handle_.get_frame_count();
+    if (frame > numFrames)
+        return false;
+
+    position_ = numFrames - frame;
+    return true;
+}
+
 //------------------------------------------------------------------------------
 
 /**
@@ -186,12 +204,14 @@ public:
     explicit NoSeekReverseReader(ST_AudioFile handle);
     AudioReaderType type() const override;
     size_t readNextBlock(float* buffer, size_t frames) override;
+    bool seek(uint64_t frame) override;
 
 private:
     void readWholeFile();
 
 private:
     std::unique_ptr<float[]> fileBuffer_;
+    uint64_t fileFrames_ { 0 };
     uint64_t fileFramesLeft_ { 0 };
 };
 
@@ -228,13 +248,27 @@ size_t NoSeekReverseReader::readNextBlock(float* buffer, size_t frames)
     return readFrames;
 }
 
+bool NoSeekReverseReader::seek(uint64_t frame)
+{
+    // The whole file is in memory, seeking is moving in the buffer
+    if (!fileBuffer_)
+        readWholeFile();
+
+    if (frame > fileFrames_)
+        return false;
+
+    fileFramesLeft_ = fileFrames_ - frame;
+    return true;
+}
+
 void NoSeekReverseReader::readWholeFile()
 {
     const uint64_t frames = handle_.get_frame_count();
     const unsigned channels = handle_.get_channels();
     float* fileBuffer = new float[channels * frames];
     fileBuffer_.reset(fileBuffer);
-    fileFramesLeft_ = handle_.read_f32(fileBuffer, frames);
+    fileFrames_ = handle_.read_f32(fileBuffer, frames);
+    fileFramesLeft_ = fileFrames_;
 }
 
 //------------------------------------------------------------------------------
@@ -291,6 +325,7 @@ public:
     unsigned channels() const override { return 1; }
     unsigned sampleRate() const override { return 44100; }
     size_t readNextBlock(float*, size_t) override { return 0; }
+    bool seek(uint64_t) override { return false; }
     bool getInstrument(InstrumentInfo* ) override { return false; }
 
 private:
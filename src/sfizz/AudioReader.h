@@ -39,6 +39,9 @@ public:
     virtual unsigned channels() const = 0;
     virtual unsigned sampleRate() const = 0;
     virtual size_t readNextBlock(float* buffer, size_t frames) = 0;
+    //! Move to a frame, counted in the direction of reading. On failure, the
+    //! position is unspecified and the reader must not be used further.
+    virtual bool seek(uint64_t frame) = 0;
     virtual bool getInstrument(InstrumentInfo* instrument) = 0;
 };
 
@@ -65,6 +65,7 @@ public:
         for (auto& buffer : stereoBuffers) {
             buffer.addChannels(2);
         }
+        windowBuffer.addChannels(2);
         monoAvailable.resize(config::bufferPoolSize);
         stereoAvailable.resize(config::stereoBufferPoolSize);
         indexAvailable.resize(config::indexBufferPoolSize);
@@ -76,6 +77,7 @@ public:
         ASSERT(absl::c_all_of(monoAvailable, [](int value) { return value == 1; }));
         ASSERT(absl::c_all_of(indexAvailable, [](int value) { return value == 1; }));
         ASSERT(absl::c_all_of(stereoAvailable, [](int value) { return value == 1; }));
+        ASSERT(windowAvailable == 1);
         _setBufferSize(bufferSize);
     }
 
@@ -84,12 +86,14 @@ public:
         const auto availableIt = absl::c_find(monoAvailable, 1);
         if (availableIt == monoAvailable.end()) {
             DBG("[sfizz] No free buffers available...");
+            numExhaustions += 1;
             return {};
         }
         const auto freeIndex = std::distance(monoAvailable.begin(), availableIt);
 
         if (monoBuffers[freeIndex].size() < numFrames) {
             DBG("[sfizz] Someone asked for a buffer of size " << numFrames << "; only " << monoBuffers[freeIndex].size() << " available...");
+            numExhaustions += 1;
             return {};
         }
 
@@ -105,12 +109,14 @@ public:
         const auto availableIt = absl::c_find(indexAvailable, 1);
         if (availableIt == indexAvailable.end()) {
             DBG("[sfizz] No available index buffers in the pool");
+            numExhaustions += 1;
             return {};
         }
         const auto freeIndex = std::distance(indexAvailable.begin(), availableIt);
 
         if (indexBuffers[freeIndex].size() < numFrames) {
             DBG("[sfizz] Someone asked for a index buffer of size " << numFrames << "; only " << indexBuffers[freeIndex].size() << " available...");
+            numExhaustions += 1;
             return {};
         }
 
@@ -126,12 +132,14 @@ public:
         const auto availableIt = absl::c_find(stereoAvailable, 1);
         if (availableIt == stereoAvailable.end()) {
             DBG("[sfizz] No available stereo buffers in the pool");
+            numExhaustions += 1;
             return {};
         }
         const auto freeIndex = std::distance(stereoAvailable.begin(), availableIt);
 
         if (stereoBuffers[freeIndex].getNumFrames() < numFrames) {
             DBG("[sfizz] Someone asked for a stereo buffer of size " << numFrames << "; only " << stereoBuffers[freeIndex].getNumFrames() << " available...");
+            numExhaustions += 1;
             return {};
         }
 
@@ -142,6 +150,40 @@ public:
         return { sfz::AudioSpan<float>(stereoBuffers[freeIndex]).first(numFrames), &*availableIt };
     }
 
+    /**
+     * @brief Get a stereo buffer which holds a window of source frames for
+     * a block, that is the frames of the block and the interpolation padding
+     * on both sides.
+     */
+    SpanHolder<AudioSpan<float>> getWindowBuffer(size_t numFrames)
+    {
+        if (windowAvailable != 1) {
+            DBG("[sfizz] The window buffer is not available");
+            numExhaustions += 1;
+            return {};
+        }
+
+        if (windowBuffer.getNumFrames() < numFrames) {
+            DBG("[sfizz] Someone asked for a window buffer of size " << numFrames << "; only " << windowBuffer.getNumFrames() << " available...");
+            numExhaustions += 1;
+            return {};
+        }
+
+        windowAvailable -= 1;
+        return { sfz::AudioSpan<float>(windowBuffer).first(numFrames), &windowAvailable };
+    }
+
+    /**
+     * @brief Get the number of requests which could not be served since the
+     * last call, and reset it. This must not race with the requests.
+     */
+    size_t takeNumExhaustions() noexcept
+    {
+        const size_t number = numExhaustions;
+        numExhaustions = 0;
+        return number;
+    }
+
 #ifndef NDEBUG
     ~BufferPool()
     {
@@ -166,9 +208,12 @@ private:
             buffer.resize(bufferSize);
         }
 
+        windowBuffer.resize(bufferSize + 2 * config::excessFileFrames + 1);
+
         absl::c_fill(monoAvailable, 1);
         absl::c_fill(stereoAvailable, 1);
         absl::c_fill(indexAvailable, 1);
+        windowAvailable = 1;
     }
 
     std::array<sfz::Buffer<float>, config::bufferPoolSize> monoBuffers;
@@ -177,6 +222,9 @@ private:
     std::vector<int> indexAvailable;
     std::array<sfz::AudioBuffer<float>, config::stereoBufferPoolSize> stereoBuffers;
     std::vector<int> stereoAvailable;
+    sfz::AudioBuffer<float> windowBuffer;
+    int windowAvailable { 1 };
+    size_t numExhaustions { 0 };
 #ifndef NDEBUG
     mutable int maxBuffersUsed { 0 };
     mutable int maxIndexBuffersUsed { 0 };
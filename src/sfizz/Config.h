@@ -41,6 +41,8 @@ namespace config {
     constexpr int indexBufferPoolSize { 4 };
     constexpr int preloadSize { 8192 };
     constexpr bool loadInRam { false };
+    constexpr bool mappedStreaming { false };
+    constexpr size_t mappedReadaheadFrames { 65536 }; // hinted past the preload on mapping
     constexpr int loggerQueueSize { 256 };
     constexpr int voiceLoggerQueueSize { 256 };
     constexpr bool loggingEnabled { false };
@@ -106,6 +108,11 @@ namespace config {
        immediate level transitions. (eg. decay->sustain or release->off)
      */
     constexpr float egTransitionTime = 50e-3;
+    /**
+       Maximum duration during which an instrument replaced by a background
+       load keeps ringing out, fading linearly, before it is retired.
+     */
+    constexpr float instrumentSwapRingOutTime = 500e-3;
     /**
        Default metadata for MIDIName documents
      */
@@ -115,6 +122,13 @@ namespace config {
        Limit of how many "fxN" buses are accepted (in SFZv2, maximum is 4)
      */
     constexpr int maxEffectBuses { 256 };
+    /**
+       Idle effect buses: a bus which receives no input, and whose outputs
+       stay under the silence level for the idle time, is not processed until
+       it receives input again
+     */
+    constexpr float effectBusSilenceLevel { 1e-6f };
+    constexpr float effectBusIdleTime { 2.0f }; // in seconds
     // Wavetable constants; amplitude values are matched to reference
     static constexpr unsigned tableSize = 1024;
     static constexpr double tableRefSampleRate = 44100.0 * 1.1; // +10% aliasing permissivity
@@ -135,6 +149,36 @@ namespace config {
        Background file loading
      */
     static constexpr int backgroundLoaderPthreadPriority = 50; // expressed in %
+    /**
+       Streaming rings: the frames of a sample past its preloaded data are
+       streamed into a ring per voice, refilled when it is half consumed.
+       The rings are opt-in: the default size of 0 loads the whole file.
+     */
+    static constexpr size_t streamRingFrames = 0;
+    static constexpr size_t streamWindowFrames = 4096; // contiguous readable frames
+    static constexpr int numFileStreams = 2 * maxVoices;
+    static constexpr int streamWaitTimeout = 1000; // in ms, when freewheeling
+    // The load deadlines scale with the playback rate of the voices; this bounds
+    // them for the voices which barely move
+    static constexpr float minPlaybackRate = 1e-3f;
+    /**
+       Predictive loading: the files of the regions which are likely to play
+       next are loaded ahead, within a memory budget. The last notes played
+       are remembered to predict the files of a new keyswitch.
+     */
+    static constexpr size_t predictiveLoadingBudget = 64 * 1024 * 1024; // in bytes
+    static constexpr unsigned predictionNoteHistory = 8;
+    /**
+       Parallel voice rendering
+     */
+    static constexpr unsigned maxRenderThreads = 16;
+    static constexpr int renderWorkerPthreadPriority = 80; // expressed in %
+    static constexpr unsigned renderWorkersSpinCount = 1024;
+    /**
+       Batched voice rendering: the simple sample voices are rendered
+       together, this many at a time
+     */
+    static constexpr unsigned voiceBatchSize = 16;
     /**
        @brief Ratio to target under which smoothing is considered as completed
      */
@@ -1,6 +1,7 @@
 #include "EQPool.h"
 #include "Region.h"
 #include "Resources.h"
+#include "SynthConfig.h"
 #include "BufferPool.h"
 #include "SIMDHelpers.h"
 #include "utility/SwapAndPop.h"
@@ -28,6 +29,8 @@ void sfz::EQHolder::setup(const Region& region, unsigned eqId, float velocity)
     this->description = &region.equalizers[eqId];
     eq->setType(description->type);
     eq->setChannels(region.isStereo() ? 2 : 1);
+    eq->setCoefficientTables(resources.getSynthConfig().filterCoefficientTables
+        ? &resources.getFilterTables() : nullptr);
 
     // Setup the base values
     baseFrequency = description->frequency + velocity * description->vel2frequency;
@@ -24,6 +24,8 @@
 #include "effects/Gain.h"
 #include "effects/Width.h"
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace sfz {
 
@@ -89,6 +91,7 @@ std::unique_ptr<Effect> EffectFactory::makeEffect(absl::Span<const Opcode> membe
 ///
 EffectBus::EffectBus()
 {
+    setSampleRate(config::defaultSampleRate);
 }
 
 EffectBus::~EffectBus()
@@ -98,12 +101,14 @@ EffectBus::~EffectBus()
 void EffectBus::addEffect(std::unique_ptr<Effect> fx)
 {
     _effects.emplace_back(std::move(fx));
+    updateTailFrames();
 }
 
 void EffectBus::clearInputs(unsigned nframes)
 {
     AudioSpan<float>(_inputs).first(nframes).fill(0.0f);
     AudioSpan<float>(_outputs).first(nframes).fill(0.0f);
+    _hasInputs = false;
 }
 
 void EffectBus::addToInputs(const float* const addInput[], float addGain, unsigned nframes)
@@ -111,6 +116,17 @@ void EffectBus::addToInputs(const float* const addInput[], float addGain, unsign
     if (addGain == 0)
         return;
 
+    // A sleeping bus stays asleep as long as its inputs are silent
+    if (_sleeping && !_hasInputs) {
+        const float silenceLevel = config::effectBusSilenceLevel / std::abs(addGain);
+        bool silent = true;
+        for (unsigned c = 0; c < EffectChannels && silent; ++c)
+            silent = allWithin(absl::Span<const float> { addInput[c], nframes }, -silenceLevel, silenceLevel);
+        if (silent)
+            return;
+    }
+
+    _hasInputs = true;
     for (unsigned c = 0; c < EffectChannels; ++c) {
         absl::Span<const float> addIn { addInput[c], nframes };
         sfz::multiplyAdd1(addGain, addIn, _inputs.getSpan(c).first(nframes));
@@ -130,18 +146,32 @@ void EffectBus::applyGain(const float* gain, unsigned nframes)
 
 void EffectBus::setSampleRate(double sampleRate)
 {
+    _sampleRate = sampleRate;
+    _idleFrames = static_cast<size_t>(config::effectBusIdleTime * sampleRate);
+    _silentFrames = 0;
+    _framesSinceInputs = 0;
+    _sleeping = false;
+    updateTailFrames();
+
     for (const auto& effectPtr : _effects)
         effectPtr->setSampleRate(sampleRate);
 }
 
 void EffectBus::clear()
 {
+    _silentFrames = 0;
+    _framesSinceInputs = 0;
+    _sleeping = false;
+
     for (const auto& effectPtr : _effects)
         effectPtr->clear();
 }
 
 void EffectBus::process(unsigned nframes)
 {
+    if (isIdle())
+        return;
+
     size_t numEffects = _effects.size();
 
     if (numEffects > 0 && hasNonZeroOutput()) {
@@ -153,6 +183,41 @@ void EffectBus::process(unsigned nframes)
     } else
         fx::Nothing().process(
             AudioSpan<float>(_inputs), AudioSpan<float>(_outputs), nframes);
+
+    // Go to sleep once the inputs stopped and the tails decayed
+    const auto isSilent = [nframes](const AudioBuffer<float>& buffer) {
+        bool silent = true;
+        for (unsigned c = 0; c < EffectChannels && silent; ++c) {
+            silent = allWithin(buffer.getConstSpan(c).first(nframes),
+                -config::effectBusSilenceLevel, config::effectBusSilenceLevel);
+        }
+        return silent;
+    };
+
+    const bool inputSilent = !_hasInputs || isSilent(_inputs);
+    _framesSinceInputs = inputSilent ? std::min(_framesSinceInputs + nframes, _tailFrames) : 0;
+
+    const bool outputSilent = inputSilent && isSilent(_outputs);
+    _silentFrames = outputSilent ? std::min(_silentFrames + nframes, _idleFrames) : 0;
+
+    _sleeping = outputSilent && (_framesSinceInputs >= _tailFrames || _silentFrames >= _idleFrames);
+}
+
+double EffectBus::getTailTime() const noexcept
+{
+    double tailTime = 0.0;
+    for (const auto& effectPtr : _effects)
+        tailTime += effectPtr->getTailTime();
+    return tailTime;
+}
+
+void EffectBus::updateTailFrames() noexcept
+{
+    const double tailFrames = std::ceil(getTailTime() * _sampleRate);
+    if (tailFrames < static_cast<double>(std::numeric_limits<size_t>::max()))
+        _tailFrames = static_cast<size_t>(tailFrames);
+    else
+        _tailFrames = std::numeric_limits<size_t>::max();
 }
 
 void EffectBus::mixOutputsTo(float* const mainOutput[], float* const mixOutput[], unsigned nframes)
@@ -10,6 +10,7 @@
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include <array>
+#include <limits>
 #include <vector>
 #include <memory>
 
@@ -49,6 +50,13 @@ public:
      */
     virtual void process(const float* const inputs[], float* const outputs[], unsigned nframes) = 0;
 
+    /**
+       @brief Gets the time for the output to decay to silence after the input
+              stops, in seconds. This is 0 for an effect without memory, and
+              infinite if the effect does not know.
+     */
+    virtual double getTailTime() const { return std::numeric_limits<double>::infinity(); }
+
     /**
        @brief Type of the factory function used to instantiate an effect given
               the contents of the <effect> block
@@ -137,6 +145,28 @@ public:
      */
     void addToInputs(const float* const addInput[], float addGain, unsigned nframes);
 
+    /**
+       @brief Checks whether some audio was added to the inputs since they
+              were cleared.
+     */
+    bool hasInputs() const noexcept { return _hasInputs; }
+
+    /**
+       @brief Checks whether the bus can skip the cycle: it sleeps, and
+              received no input. An idle bus outputs silence.
+
+              The bus goes to sleep when its inputs and outputs are silent,
+              after the tails of its effects, or after the idle time if the
+              tails are longer. It wakes up on the next non-silent input.
+     */
+    bool isIdle() const noexcept { return _sleeping && !_hasInputs; }
+
+    /**
+       @brief Gets the time for the output of the bus to decay to silence
+              after the input stops, in seconds.
+     */
+    double getTailTime() const noexcept;
+
     /**
        @brief Apply a gain to the inputs
      */
@@ -153,7 +183,8 @@ public:
     void clear();
 
     /**
-       @brief Computes a cycle of the effect bus.
+       @brief Computes a cycle of the effect bus. This does nothing if the
+              bus is idle.
      */
     void process(unsigned nframes);
 
@@ -176,11 +207,23 @@ public:
      */
     size_t numEffects() const noexcept;
 private:
+    /**
+     * @brief Updates the length of the tail of the bus in frames.
+     */
+    void updateTailFrames() noexcept;
+
     std::vector<std::unique_ptr<Effect>> _effects;
     AudioBuffer<float> _inputs { EffectChannels, config::defaultSamplesPerBlock };
     AudioBuffer<float> _outputs { EffectChannels, config::defaultSamplesPerBlock };
     float _gainToMain { Default::effect };
     float _gainToMix { Default::effect };
+    double _sampleRate { config::defaultSampleRate };
+    bool _hasInputs { false };
+    bool _sleeping { false };
+    size_t _framesSinceInputs { 0 };
+    size_t _tailFrames { 0 };
+    size_t _silentFrames { 0 };
+    size_t _idleFrames { 0 };
 };
 
 } // namespace sfz
@@ -24,19 +24,25 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "FilePool.h"
+#include "PreloadCache.h"
+#include "SampleStore.h"
+#include "LoadScheduler.h"
 #include "AudioReader.h"
 #include "Buffer.h"
 #include "AudioBuffer.h"
 #include "AudioSpan.h"
 #include "Config.h"
+#include "Oversampler.h"
 #include "utility/SwapAndPop.h"
 #include "utility/Debug.h"
 #include <ThreadPool.h>
+#include <absl/container/flat_hash_set.h>
 #include <absl/types/span.h>
 #include <absl/strings/match.h>
 #include <absl/memory/memory.h>
 #include <algorithm>
 #include <memory>
+#include <string>
 #include <thread>
 #include <system_error>
 #if defined(_WIN32)
@@ -97,6 +103,29 @@ sfz::FileAudioBuffer readFromFile(sfz::AudioReader& reader, uint32_t numFrames)
     return baseBuffer;
 }
 
+sfz::FileAudioBuffer oversampleBuffer(sfz::FileAudioBuffer& input, sfz::Oversampling factor)
+{
+    sfz::FileAudioBuffer output;
+    output.addChannels(input.getNumChannels());
+    output.resize(input.getNumFrames() * static_cast<size_t>(factor));
+    output.clear();
+
+    sfz::Oversampler oversampler { factor };
+    oversampler.stream(input, output);
+    return output;
+}
+
+void oversampleFromFile(sfz::AudioReader& reader, sfz::FileAudioBuffer& output, sfz::Oversampling factor, std::atomic<size_t>* filledFrames)
+{
+    output.reset();
+    output.addChannels(reader.channels());
+    output.resize(static_cast<size_t>(reader.frames()) * static_cast<size_t>(factor));
+    output.clear();
+
+    sfz::Oversampler oversampler { factor };
+    oversampler.stream(reader, output, filledFrames);
+}
+
 void streamFromFile(sfz::AudioReader& reader, sfz::FileAudioBuffer& output, std::atomic<size_t>* filledFrames = nullptr)
 {
     const auto numFrames = static_cast<size_t>(reader.frames());
@@ -140,30 +169,50 @@ void streamFromFile(sfz::AudioReader& reader, sfz::FileAudioBuffer& output, std:
     }
 }
 
+bool mapFromFile(const fs::path& path, sfz::FileData& data, size_t numFrames)
+{
+    auto mapped = absl::make_unique<sfz::MappedAudioFile>();
+    if (!mapped->open(path) || mapped->numFrames() != numFrames)
+        return false;
+
+    // The preload covers the attack, prefetch what comes next
+    mapped->willNeed(data.getNumPreloadedFrames(), sfz::config::mappedReadaheadFrames);
+
+    data.mappedData = std::move(mapped);
+    data.availableFrames = numFrames;
+    return true;
+}
+
 sfz::FilePool::FilePool(sfz::Logger& logger)
     : logger(logger),
-      filesToLoad(alignedNew<FileQueue>()),
+      freeStreams(alignedNew<StreamQueue>()),
+      preloadCache(absl::make_unique<PreloadCache>()),
+      releasedFiles(alignedNew<FileReleaseQueue>()),
       threadPool(globalThreadPool())
 {
-    loadingJobs.reserve(config::maxVoices);
+    streams.reserve(config::numFileStreams);
+    for (int i = 0; i < config::numFileStreams; ++i) {
+        streams.emplace_back(absl::make_unique<FileStream>(*this));
+        freeStreams->push(streams.back().get());
+    }
+
     lastUsedFiles.reserve(config::maxVoices);
     garbageToCollect.reserve(config::maxVoices);
+    mappingsToCollect.reserve(config::maxVoices);
+    sharedDataToCollect.reserve(config::maxVoices);
+
+    // Last, as the workers may use everything above
+    scheduler = absl::make_unique<LoadScheduler>(*this, config::numBackgroundThreads);
 }
 
 sfz::FilePool::~FilePool()
 {
-    std::error_code ec;
+    scheduler.reset();
 
+    std::error_code ec;
     garbageFlag = false;
     semGarbageBarrier.post(ec);
     garbageThread.join();
-
-    dispatchFlag = false;
-    dispatchBarrier.post(ec);
-    dispatchThread.join();
-
-    for (auto& job : loadingJobs)
-        job.wait();
 }
 
 bool sfz::FilePool::checkSample(std::string& filename) const noexcept
@@ -247,6 +296,10 @@ absl::optional<sfz::FileInformation> sfz::FilePool::getFileInformation(const Fil
     if (!fs::exists(file))
         return {};
 
+    FileInformation cachedInformation;
+    if (preloadCache->loadInformation(file, fileId.isReverse(), cachedInformation))
+        return cachedInformation;
+
     AudioReaderPtr reader = createAudioReader(file, fileId.isReverse());
     const unsigned channels = reader->channels();
 
@@ -296,7 +349,30 @@ absl::optional<sfz::FileInformation> sfz::FilePool::getFileInformation(const Fil
     return returnedValue;
 }
 
-bool sfz::FilePool::preloadFile(const FileId& fileId, uint32_t maxOffset) noexcept
+uint32_t sfz::FilePool::getFramesToPreload(const FileInformation& information, uint32_t maxOffset) const noexcept
+{
+    const auto frames = static_cast<uint32_t>(information.end + 1);
+    if (loadInRam)
+        return frames;
+    else
+        return min(frames, maxOffset + preloadSize);
+}
+
+bool sfz::FilePool::needsPreloading(const FileId& fileId, uint32_t maxOffset) const noexcept
+{
+    const auto existingFile = preloadedFiles.find(fileId);
+    if (existingFile == preloadedFiles.end())
+        return true;
+
+    const FileData& data = existingFile->second;
+    if (data.information.oversamplingFactor != static_cast<int>(oversamplingFactor))
+        return true;
+
+    const size_t framesToPreload = getFramesToPreload(data.information, maxOffset) * static_cast<size_t>(oversamplingFactor);
+    return framesToPreload > data.getNumPreloadedFrames();
+}
+
+bool sfz::FilePool::readPreloadedFile(const FileId& fileId, uint32_t maxOffset, PreloadedFile& preloaded) noexcept
 {
     auto fileInformation = getFileInformation(fileId);
     if (!fileInformation)
@@ -304,37 +380,152 @@ bool sfz::FilePool::preloadFile(const FileId& fileId, uint32_t maxOffset) noexce
 
     fileInformation->maxOffset = maxOffset;
     const fs::path file { rootDirectory / fileId.filename() };
-    AudioReaderPtr reader = createAudioReader(file, fileId.isReverse());
+    const uint32_t framesToLoad = getFramesToPreload(*fileInformation, maxOffset);
 
-    const auto frames = static_cast<uint32_t>(reader->frames());
-    const auto framesToLoad = [&]() {
-        if (loadInRam)
-            return frames;
-        else
-            return min(frames, maxOffset + preloadSize);
-    }();
+    std::error_code ec;
+    preloaded.modificationTime = fs::last_write_time(file, ec);
+
+    const Oversampling factor = oversamplingFactor;
+    fileInformation->oversamplingFactor = static_cast<int>(factor);
+
+    SampleStore& store = SampleStore::instance();
+    std::string sharedKey;
+    const bool shared = sharedPreloading && SampleStore::makeKey(file, fileId.isReverse(), framesToLoad, factor, sharedKey);
+    if (shared) {
+        preloaded.data = store.find(sharedKey, fileInformation->sampleRate);
+        if (preloaded.data) {
+            preloaded.information = *fileInformation;
+            return true;
+        }
+    }
+
+    // The persistent cache holds the data of the file, which is upsampled
+    // after reading
+    auto data = absl::make_unique<FileAudioBuffer>();
+    FileInformation cachedInformation;
+    if (preloadCache->loadPreloadedData(file, fileId.isReverse(), framesToLoad, cachedInformation, *data)) {
+        fileInformation->sampleRate = cachedInformation.sampleRate;
+    } else {
+        AudioReaderPtr reader = createAudioReader(file, fileId.isReverse());
+        fileInformation->sampleRate = static_cast<double>(reader->sampleRate());
+        *data = readFromFile(*reader, framesToLoad);
+        preloadCache->storePreloadedData(file, fileId.isReverse(), framesToLoad, *fileInformation, *data);
+    }
+
+    if (factor != Oversampling::x1)
+        *data = oversampleBuffer(*data, factor);
+
+    preloaded.data = std::move(data);
+    if (shared)
+        preloaded.data = store.insert(sharedKey, std::move(preloaded.data), fileInformation->sampleRate);
+
+    preloaded.information = *fileInformation;
+    return true;
+}
 
+bool sfz::FilePool::insertPreloadedFile(const FileId& fileId, PreloadedFile&& preloaded) noexcept
+{
     const auto existingFile = preloadedFiles.find(fileId);
     if (existingFile != preloadedFiles.end()) {
-        if (framesToLoad > existingFile->second.preloadedData.getNumFrames()) {
-            preloadedFiles[fileId].information.maxOffset = maxOffset;
-            preloadedFiles[fileId].preloadedData = readFromFile(*reader, framesToLoad);
-        }
+        existingFile->second.information.maxOffset = preloaded.information.maxOffset;
+        existingFile->second.information.oversamplingFactor = preloaded.information.oversamplingFactor;
+        existingFile->second.preloadedData = std::move(preloaded.data);
+        existingFile->second.modificationTime = preloaded.modificationTime;
     } else {
-        fileInformation->sampleRate = static_cast<double>(reader->sampleRate());
         auto insertedPair = preloadedFiles.insert_or_assign(fileId, {
-            readFromFile(*reader, framesToLoad),
-            *fileInformation
+            std::move(preloaded.data),
+            std::move(preloaded.information)
         });
 
         if (!insertedPair.second)
             return false;
 
         insertedPair.first->second.status = FileData::Status::Preloaded;
+        insertedPair.first->second.modificationTime = preloaded.modificationTime;
     }
     return true;
 }
 
+bool sfz::FilePool::preloadFile(const FileId& fileId, uint32_t maxOffset) noexcept
+{
+    if (!needsPreloading(fileId, maxOffset)) {
+        ++numReusedPreloads;
+        return true;
+    }
+
+    PreloadedFile preloaded;
+    if (!readPreloadedFile(fileId, maxOffset, preloaded))
+        return false;
+
+    ++numReadPreloads;
+    return insertPreloadedFile(fileId, std::move(preloaded));
+}
+
+bool sfz::FilePool::preloadFiles(const std::vector<std::pair<FileId, uint32_t>>& files, const PreloadProgress& progress) noexcept
+{
+    const size_t numFiles = files.size();
+    size_t numDone = 0;
+
+    std::vector<const std::pair<FileId, uint32_t>*> pending;
+    pending.reserve(numFiles);
+    for (const auto& file : files) {
+        if (needsPreloading(file.first, file.second))
+            pending.push_back(&file);
+        else
+            ++numDone;
+    }
+    numReusedPreloads += numDone;
+
+    std::atomic<bool> cancelled { progress && !progress(numDone, numFiles) };
+    if (cancelled)
+        return false;
+
+    // The files are read in parallel, and inserted on this thread as they come
+    std::vector<PreloadedFile> results(pending.size());
+    std::vector<std::future<bool>> jobs;
+    jobs.reserve(pending.size());
+    for (size_t i = 0; i < pending.size(); ++i) {
+        jobs.push_back(threadPool->enqueue([this, i, &pending, &results, &cancelled]() {
+            if (cancelled.load(std::memory_order_relaxed))
+                return false;
+            return readPreloadedFile(pending[i]->first, pending[i]->second, results[i]);
+        }));
+    }
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (jobs[i].get() && !cancelled) {
+            insertPreloadedFile(pending[i]->first, std::move(results[i]));
+            ++numReadPreloads;
+        }
+
+        ++numDone;
+        if (!cancelled && progress && !progress(numDone, numFiles))
+            cancelled = true;
+    }
+
+    return !cancelled;
+}
+
+bool sfz::FilePool::setPreloadCacheDirectory(const fs::path& directory) noexcept
+{
+    return preloadCache->setDirectory(directory);
+}
+
+fs::path sfz::FilePool::getPreloadCacheDirectory() const noexcept
+{
+    return preloadCache->getDirectory();
+}
+
+size_t sfz::FilePool::getNumPreloadCacheHits() const noexcept
+{
+    return preloadCache->getNumHits();
+}
+
+size_t sfz::FilePool::getNumPreloadCacheMisses() const noexcept
+{
+    return preloadCache->getNumMisses();
+}
+
 sfz::FileDataHolder sfz::FilePool::loadFile(const FileId& fileId) noexcept
 {
     auto fileInformation = getFileInformation(fileId);
@@ -351,7 +542,7 @@ sfz::FileDataHolder sfz::FilePool::loadFile(const FileId& fileId) noexcept
     } else {
         fileInformation->sampleRate = static_cast<double>(reader->sampleRate());
         auto insertedPair = preloadedFiles.insert_or_assign(fileId, {
-            readFromFile(*reader, frames),
+            std::make_shared<const FileAudioBuffer>(readFromFile(*reader, frames)),
             *fileInformation
         });
         insertedPair.first->second.status = FileData::Status::Preloaded;
@@ -359,26 +550,180 @@ sfz::FileDataHolder sfz::FilePool::loadFile(const FileId& fileId) noexcept
     }
 }
 
-sfz::FileDataHolder sfz::FilePool::getFilePromise(const std::shared_ptr<FileId>& fileId) noexcept
+sfz::FileDataHolder sfz::FilePool::getFilePromise(const std::shared_ptr<FileId>& fileId, int64_t startFrame, float playbackRate) noexcept
 {
     const auto preloaded = preloadedFiles.find(*fileId);
     if (preloaded == preloadedFiles.end()) {
         DBG("[sfizz] File not found in the preloaded files: " << fileId);
         return {};
     }
-    QueuedFileData queuedData { fileId, &preloaded->second, std::chrono::high_resolution_clock::now() };
-    if (!filesToLoad->try_push(queuedData)) {
-        DBG("[sfizz] Could not enqueue the file to load for " << fileId << " (queue capacity " << filesToLoad->capacity() << ")");
+
+    FileData& data = preloaded->second;
+    if (data.predicted) {
+        numPredictionHits.fetch_add(1);
+        forgetPrediction(data);
+    }
+
+    // Hold the file first, or the load could be cancelled
+    FileDataHolder holder { &data };
+
+    // Due when the voice runs out of preloaded frames, which goes faster
+    // as the voice plays higher
+    const auto now = std::chrono::high_resolution_clock::now();
+    const double preloadedFrames = static_cast<double>(data.getNumPreloadedFrames()) / data.information.oversamplingFactor;
+    const double framesLeft = max(0.0, preloadedFrames - static_cast<double>(startFrame));
+    const double secondsLeft = framesLeft / (data.information.sampleRate * max(playbackRate, config::minPlaybackRate));
+
+    LoadScheduler::Request request;
+    request.type = LoadScheduler::Request::Type::Load;
+    request.id = fileId;
+    request.data = &data;
+    request.queuedTime = now;
+    request.deadline = now + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+        std::chrono::duration<double>(secondsLeft));
+    if (!scheduler->submit(std::move(request))) {
+        DBG("[sfizz] Could not enqueue the file to load for " << fileId);
         return {};
     }
 
-    std::error_code ec;
-    dispatchBarrier.post(ec);
-    ASSERT(!ec);
+    return holder;
+}
+
+bool sfz::FilePool::predictFile(const std::shared_ptr<FileId>& fileId) noexcept
+{
+    if (!predictiveLoading)
+        return false;
+
+    const auto preloaded = preloadedFiles.find(*fileId);
+    if (preloaded == preloadedFiles.end())
+        return false;
+
+    // Already loaded, loading, or entirely in memory
+    FileData& data = preloaded->second;
+    if (data.status != FileData::Status::Preloaded || data.predicted)
+        return false;
+
+    const auto numFrames = static_cast<size_t>(data.information.end + 1);
+    if (numFrames <= data.getNumPreloadedFrames())
+        return false;
+
+    const size_t numBytes = getLoadedMemory(data);
+    if (predictedMemory + numBytes > predictionBudget)
+        return false;
+
+    // No deadline, the predictions wait for the voices
+    const auto now = std::chrono::high_resolution_clock::now();
+    LoadScheduler::Request request;
+    request.type = LoadScheduler::Request::Type::Prediction;
+    request.id = fileId;
+    request.data = &data;
+    request.queuedTime = now;
+    if (!scheduler->submit(std::move(request)))
+        return false;
+
+    // Give the file the usual idle period before it can be collected
+    data.lastViewerLeftAt = now;
+    data.predicted = true;
+    predictedMemory.fetch_add(numBytes);
+    numPredictedLoads.fetch_add(1);
+    return true;
+}
+
+size_t sfz::FilePool::getLoadedMemory(const FileData& data) noexcept
+{
+    const auto numFrames = static_cast<size_t>(data.information.end + 1) * data.information.oversamplingFactor;
+    return numFrames * data.information.numChannels * sizeof(float);
+}
+
+void sfz::FilePool::forgetPrediction(FileData& data) noexcept
+{
+    data.predicted = false;
+    const size_t numBytes = getLoadedMemory(data);
+    size_t memory = predictedMemory.load();
+    while (!predictedMemory.compare_exchange_weak(memory, memory > numBytes ? memory - numBytes : 0))
+        ;
+}
+
+sfz::FileDataHolder sfz::FilePool::getPreloadedFile(const std::shared_ptr<FileId>& fileId) noexcept
+{
+    const auto preloaded = preloadedFiles.find(*fileId);
+    if (preloaded == preloadedFiles.end()) {
+        DBG("[sfizz] File not found in the preloaded files: " << fileId);
+        return {};
+    }
 
     return { &preloaded->second };
 }
 
+sfz::FileStreamHolder sfz::FilePool::getFileStream(const std::shared_ptr<FileId>& fileId, const FileData& data, float playbackRate) noexcept
+{
+    const size_t ringSize = streamRingSize;
+    if (ringSize == 0 || loadInRam || mappedStreaming)
+        return {};
+
+    // The rings hold the frames of the file as-is
+    if (data.information.oversamplingFactor != 1)
+        return {};
+
+    // Entirely in memory already
+    const auto numFrames = data.information.end + 1;
+    const auto preloadedFrames = static_cast<int64_t>(data.getNumPreloadedFrames());
+    if (numFrames <= preloadedFrames || data.status == FileData::Status::Done)
+        return {};
+
+    // Loading whole already, ahead of the voice
+    if (data.predicted)
+        return {};
+
+    FileStream* stream = nullptr;
+    if (!freeStreams->try_pop(stream)) {
+        DBG("[sfizz] No stream available for " << fileId);
+        return {};
+    }
+
+    stream->open(fileId, numFrames, static_cast<unsigned>(data.information.numChannels), preloadedFrames, ringSize, data.information.sampleRate, playbackRate);
+    return FileStreamHolder { stream };
+}
+
+void sfz::FilePool::setStreamRingSize(size_t numFrames) noexcept
+{
+    if (numFrames > 0)
+        numFrames = max(numFrames, 2 * config::streamWindowFrames);
+
+    streamRingSize = numFrames;
+}
+
+void sfz::FilePool::enqueueStream(FileStream* stream) noexcept
+{
+    LoadScheduler::Request request;
+    request.type = LoadScheduler::Request::Type::Stream;
+    request.stream = stream;
+    request.queuedTime = std::chrono::high_resolution_clock::now();
+
+    // Due when the voice reads past the streamed frames at its playback rate;
+    // a released stream only needs its clean up
+    if (stream->state_.load(std::memory_order_relaxed) & FileStream::kAttached) {
+        const int64_t framesLeft = stream->writtenEnd_.load(std::memory_order_relaxed)
+            - stream->readFrame_.load(std::memory_order_relaxed);
+        const float playbackRate = max(stream->playbackRate_.load(std::memory_order_relaxed), config::minPlaybackRate);
+        const double secondsLeft = max(0.0, static_cast<double>(framesLeft) / (stream->sampleRate_ * playbackRate));
+        request.deadline = request.queuedTime + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+            std::chrono::duration<double>(secondsLeft));
+    }
+
+    // Every stream is enqueued once at most, so this has room
+    const bool submitted = scheduler->submit(std::move(request));
+    ASSERT(submitted);
+    (void)submitted;
+}
+
+void sfz::FilePool::recycleStream(FileStream* stream) noexcept
+{
+    const bool pushed = freeStreams->try_push(stream);
+    ASSERT(pushed);
+    (void)pushed;
+}
+
 void sfz::FilePool::setPreloadSize(uint32_t preloadSize) noexcept
 {
     this->preloadSize = preloadSize;
@@ -388,22 +733,92 @@ void sfz::FilePool::setPreloadSize(uint32_t preloadSize) noexcept
     // Update all the preloaded sizes
     for (auto& preloadedFile : preloadedFiles) {
         const auto maxOffset = preloadedFile.second.information.maxOffset;
-        fs::path file { rootDirectory / preloadedFile.first.filename() };
-        AudioReaderPtr reader = createAudioReader(file, preloadedFile.first.isReverse());
-        preloadedFile.second.preloadedData = readFromFile(*reader, preloadSize + maxOffset);
+        preloadedFile.second.preloadedData = readPreloadedData(preloadedFile.first, preloadSize + maxOffset);
     }
 }
 
-void sfz::FilePool::loadingJob(const QueuedFileData& data) noexcept
+sfz::FileAudioBufferPtr sfz::FilePool::readPreloadedData(const FileId& fileId, uint32_t numFrames) const
 {
-    raiseCurrentThreadPriority();
+    fs::path file { rootDirectory / fileId.filename() };
+    AudioReaderPtr reader = createAudioReader(file, fileId.isReverse());
+    FileAudioBuffer data = readFromFile(*reader, numFrames);
+    if (oversamplingFactor != Oversampling::x1)
+        data = oversampleBuffer(data, oversamplingFactor);
+    return std::make_shared<const FileAudioBuffer>(std::move(data));
+}
+
+void sfz::FilePool::setOversamplingFactor(Oversampling factor) noexcept
+{
+    if (factor == oversamplingFactor)
+        return;
+
+    // The background loads write into the data which is about to change
+    waitForBackgroundLoading();
+    oversamplingFactor = factor;
+    predictedMemory = 0;
+    loadedMemory = 0;
+    {
+        std::lock_guard<SpinMutex> guard { garbageAndLastUsedMutex };
+        clearRecency();
+    }
+
+    // The preloaded data is read again like when loading, sharing it between
+    // the pools and using the persistent cache and the thread pool
+    std::vector<std::pair<FileId, uint32_t>> files;
+    files.reserve(preloadedFiles.size());
+    for (auto& preloadedFile : preloadedFiles) {
+        FileData& data = preloadedFile.second;
+        ASSERT(data.readerCount == 0);
+
+        files.emplace_back(preloadedFile.first, static_cast<uint32_t>(data.information.maxOffset));
+        data.fileData.reset();
+        data.sharedFileData.reset();
+        data.mappedData.reset();
+        data.availableFrames = 0;
+        data.loadedBytes = 0;
+        data.evicted = false;
+        data.predicted = false;
+        data.status = FileData::Status::Preloaded;
+    }
+
+    preloadFiles(files, nullptr);
+}
+
+size_t sfz::FilePool::getPreloadedMemory() const noexcept
+{
+    size_t numBytes = 0;
+    for (const auto& preloadedFile : preloadedFiles) {
+        const FileData& data = preloadedFile.second;
+        if (data.preloadedData)
+            numBytes += data.preloadedData->getNumFrames() * data.preloadedData->getNumChannels() * sizeof(float);
+    }
+    return numBytes;
+}
+
+void sfz::FilePool::runRequest(const LoadScheduler::Request& request) noexcept
+{
+    if (request.type == LoadScheduler::Request::Type::Stream)
+        streamingJob(request.stream);
+    else if (request.type == LoadScheduler::Request::Type::Eviction)
+        evictionJob();
+    else
+        loadingJob(request);
+}
 
+void sfz::FilePool::loadingJob(const LoadScheduler::Request& data) noexcept
+{
     std::shared_ptr<FileId> id = data.id.lock();
     if (!id) {
         // file ID was nulled, it means the region was deleted, ignore
         return;
     }
 
+    // The voices which requested the file are gone
+    if (data.type == LoadScheduler::Request::Type::Load && data.data->readerCount == 0 && !data.data->predicted) {
+        numCancelledLoads.fetch_add(1);
+        return;
+    }
+
     const auto loadStartTime = std::chrono::high_resolution_clock::now();
     const auto waitDuration = loadStartTime - data.queuedTime;
     const fs::path file { rootDirectory / id->filename() };
@@ -417,11 +832,12 @@ void sfz::FilePool::loadingJob(const QueuedFileData& data) noexcept
 
     FileData::Status currentStatus = data.data->status.load();
 
+    // A file which is being evicted can be loaded again right after
     unsigned spinCounter { 0 };
-    while (currentStatus == FileData::Status::Invalid) {
+    while (currentStatus == FileData::Status::Invalid || currentStatus == FileData::Status::Evicting) {
         // Spin until the state changes
         if (spinCounter > 1024) {
-            DBG("[sfizz] " << *id << " is stuck on Invalid? Leaving the load");
+            DBG("[sfizz] " << *id << " is stuck on " << (currentStatus == FileData::Status::Invalid ? "Invalid" : "Evicting") << "? Leaving the load");
             return;
         }
 
@@ -438,76 +854,185 @@ void sfz::FilePool::loadingJob(const QueuedFileData& data) noexcept
     if (!data.data->status.compare_exchange_strong(currentStatus, FileData::Status::Streaming))
         return;
 
+    if (data.data->evicted) {
+        data.data->evicted = false;
+        numReloads.fetch_add(1);
+    }
+
     const auto frames = static_cast<uint32_t>(reader->frames());
-    streamFromFile(*reader, data.data->fileData, &data.data->availableFrames);
+    const auto factor = static_cast<Oversampling>(data.data->information.oversamplingFactor);
+
+    // Reuse the data of a file loaded by another pool, or load it in a
+    // buffer which can be shared
+    SampleStore& store = SampleStore::instance();
+    std::string sharedKey;
+    const bool shared = sharedPreloading && SampleStore::makeKey(file, id->isReverse(), frames, factor, sharedKey);
+    double sampleRate = data.data->information.sampleRate;
+    FileAudioBufferPtr sharedData = shared ? store.find(sharedKey, sampleRate) : nullptr;
+    bool mapped = false;
+
+    if (sharedData) {
+        data.data->sharedFileData = std::move(sharedData);
+        data.data->availableFrames = data.data->sharedFileData->getNumFrames();
+    } else if (shared) {
+        // The buffer is attached before it fills, as the voices read it
+        // while it loads
+        auto buffer = std::make_shared<FileAudioBuffer>();
+        data.data->sharedFileData = buffer;
+        if (factor != Oversampling::x1)
+            oversampleFromFile(*reader, *buffer, factor, &data.data->availableFrames);
+        else
+            streamFromFile(*reader, *buffer, &data.data->availableFrames);
+        store.insert(sharedKey, std::move(buffer), sampleRate);
+    } else if (factor != Oversampling::x1) {
+        oversampleFromFile(*reader, data.data->fileData, factor, &data.data->availableFrames);
+    } else {
+        mapped = mappedStreaming && !id->isReverse() && mapFromFile(file, *data.data, frames);
+        if (!mapped)
+            streamFromFile(*reader, data.data->fileData, &data.data->availableFrames);
+    }
     const auto loadDuration = std::chrono::high_resolution_clock::now() - loadStartTime;
     logger.logFileTime(waitDuration, loadDuration, frames, id->filename());
 
+    // The mapped files are in the page cache rather than in memory
+    if (!mapped) {
+        const FileAudioBuffer& buffer = data.data->sharedFileData ? *data.data->sharedFileData : data.data->fileData;
+        data.data->loadedBytes = buffer.getNumFrames() * buffer.getNumChannels() * sizeof(float);
+        loadedMemory.fetch_add(data.data->loadedBytes);
+    }
+
     data.data->status = FileData::Status::Done;
 
     std::lock_guard<SpinMutex> guard { garbageAndLastUsedMutex };
+    if (!mapped)
+        linkMostRecent(*data.data);
     if (absl::c_find(lastUsedFiles, *id) == lastUsedFiles.end())
         lastUsedFiles.push_back(*id);
 }
 
+void sfz::FilePool::streamingJob(FileStream* stream) noexcept
+{
+    stream->process(rootDirectory);
+}
+
 void sfz::FilePool::clear()
 {
     std::lock_guard<SpinMutex> guard { garbageAndLastUsedMutex };
     emptyFileLoadingQueues();
     garbageToCollect.clear();
+    mappingsToCollect.clear();
+    sharedDataToCollect.clear();
     lastUsedFiles.clear();
+    clearRecency();
     preloadedFiles.clear();
+    numReusedPreloads = 0;
+    numReadPreloads = 0;
+    predictedMemory = 0;
+    loadedMemory = 0;
 }
 
-uint32_t sfz::FilePool::getPreloadSize() const noexcept
+void sfz::FilePool::clearForReload()
 {
-    return preloadSize;
+    std::lock_guard<SpinMutex> guard { garbageAndLastUsedMutex };
+    emptyFileLoadingQueues();
+    garbageToCollect.clear();
+    mappingsToCollect.clear();
+    sharedDataToCollect.clear();
+    lastUsedFiles.clear();
+    clearRecency();
+    numReusedPreloads = 0;
+    numReadPreloads = 0;
+    predictedMemory = 0;
+    loadedMemory = 0;
+
+    for (auto it = preloadedFiles.begin(); it != preloadedFiles.end();) {
+        FileData& data = it->second;
+        ASSERT(data.readerCount == 0);
+
+        // Drop the files modified since they were preloaded
+        std::error_code ec;
+        const fs::path file { rootDirectory / it->first.filename() };
+        const fs::file_time_type modificationTime = fs::last_write_time(file, ec);
+        if (ec || modificationTime != data.modificationTime) {
+            preloadedFiles.erase(it++);
+            continue;
+        }
+
+        // Only keep the preloaded part of the others
+        data.fileData.reset();
+        data.sharedFileData.reset();
+        data.mappedData.reset();
+        data.availableFrames = 0;
+        data.loadedBytes = 0;
+        data.evicted = false;
+        data.predicted = false;
+        data.status = FileData::Status::Preloaded;
+        ++it;
+    }
 }
 
-template <typename R>
-bool is_ready(std::future<R> const& f)
+void sfz::FilePool::seedPreloadedFiles(const FilePool& other)
 {
-    return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    // The modification times are checked relative to the root directory
+    rootDirectory = other.rootDirectory;
+
+    for (const auto& preloadedFile : other.preloadedFiles) {
+        const FileData& otherData = preloadedFile.second;
+        if (!otherData.preloadedData)
+            continue;
+
+        auto insertedPair = preloadedFiles.insert_or_assign(preloadedFile.first, {
+            otherData.preloadedData,
+            otherData.information
+        });
+        FileData& data = insertedPair.first->second;
+        data.modificationTime = otherData.modificationTime;
+        data.status = FileData::Status::Preloaded;
+    }
 }
 
-void sfz::FilePool::dispatchingJob() noexcept
+void sfz::FilePool::setRootDirectory(const fs::path& directory) noexcept
 {
-    while (dispatchBarrier.wait(), dispatchFlag) {
-        std::lock_guard<std::mutex> guard { loadingJobsMutex };
+    // The files kept for a reload are relative to the previous directory
+    if (directory != rootDirectory)
+        preloadedFiles.clear();
 
-        QueuedFileData queuedData;
-        if (filesToLoad->try_pop(queuedData)) {
-            if (queuedData.id.expired()) {
-                // file ID was nulled, it means the region was deleted, ignore
-            }
-            else
-                loadingJobs.push_back(
-                    threadPool->enqueue([this](const QueuedFileData& data) { loadingJob(data); }, std::move(queuedData)));
-        }
+    rootDirectory = directory;
+}
 
-        // Clear finished jobs
-        swapAndPopAll(loadingJobs, [](std::future<void>& future) {
-            return is_ready(future);
-        });
+void sfz::FilePool::removeUnusedPreloadedFiles(const std::vector<std::pair<FileId, uint32_t>>& files)
+{
+    absl::flat_hash_set<FileId> used;
+    used.reserve(files.size());
+    for (const auto& file : files)
+        used.insert(file.first);
+
+    for (auto it = preloadedFiles.begin(); it != preloadedFiles.end();) {
+        if (used.contains(it->first))
+            ++it;
+        else
+            preloadedFiles.erase(it++);
     }
 }
 
+uint32_t sfz::FilePool::getPreloadSize() const noexcept
+{
+    return preloadSize;
+}
+
 void sfz::FilePool::garbageJob() noexcept
 {
     while (semGarbageBarrier.wait(), garbageFlag) {
         std::lock_guard<SpinMutex> guard { garbageAndLastUsedMutex };
         garbageToCollect.clear();
+        mappingsToCollect.clear();
+        sharedDataToCollect.clear();
     }
 }
 
 void sfz::FilePool::waitForBackgroundLoading() noexcept
 {
-    std::lock_guard<std::mutex> guard { loadingJobsMutex };
-
-    for (auto& job : loadingJobs)
-        job.wait();
-
-    loadingJobs.clear();
+    scheduler->waitForIdle();
 }
 
 void sfz::FilePool::raiseCurrentThreadPriority() noexcept
@@ -552,10 +1077,10 @@ void sfz::FilePool::setRamLoading(bool loadInRam) noexcept
         for (auto& preloadedFile : preloadedFiles) {
             fs::path file { rootDirectory / preloadedFile.first.filename() };
             AudioReaderPtr reader = createAudioReader(file, preloadedFile.first.isReverse());
-            preloadedFile.second.preloadedData = readFromFile(
+            preloadedFile.second.preloadedData = std::make_shared<const FileAudioBuffer>(readFromFile(
                 *reader,
                 preloadedFile.second.information.end
-            );
+            ));
         }
     } else {
         setPreloadSize(preloadSize);
@@ -564,15 +1089,36 @@ void sfz::FilePool::setRamLoading(bool loadInRam) noexcept
 
 void sfz::FilePool::triggerGarbageCollection() noexcept
 {
+    // The budget is enforced by a background job, one at a time
+    if (loadedMemoryBudget > 0) {
+        if (!isOverMemoryBudget() || evictionPending.exchange(true))
+            return;
+
+        LoadScheduler::Request request;
+        request.type = LoadScheduler::Request::Type::Eviction;
+        request.queuedTime = std::chrono::high_resolution_clock::now();
+        if (!scheduler->submit(std::move(request)))
+            evictionPending = false;
+        return;
+    }
+
     const std::unique_lock<SpinMutex> guard { garbageAndLastUsedMutex, std::try_to_lock };
     if (!guard.owns_lock())
         return;
 
+    collectIdleFiles();
+
+    std::error_code ec;
+    semGarbageBarrier.post(ec);
+    ASSERT(!ec);
+}
+
+void sfz::FilePool::collectIdleFiles() noexcept
+{
+    updateRecency();
+
     const auto now = std::chrono::high_resolution_clock::now();
     swapAndPopAll(lastUsedFiles, [&](const FileId& id) {
-        if (garbageToCollect.size() == garbageToCollect.capacity())
-           return false;
-
         auto it = preloadedFiles.find(id);
         if (it == preloadedFiles.end()) {
             // Getting here means that the preloadedFiles got changed (probably cleared)
@@ -594,13 +1140,153 @@ void sfz::FilePool::triggerGarbageCollection() noexcept
         if (secondsIdle < config::fileClearingPeriod)
             return false;
 
-        data.availableFrames = 0;
-        data.status = FileData::Status::Preloaded;
-        garbageToCollect.push_back(std::move(data.fileData));
-        return true;
+        return collectFileData(data);
     });
+}
+
+void sfz::FilePool::evictionJob() noexcept
+{
+    {
+        std::lock_guard<SpinMutex> guard { garbageAndLastUsedMutex };
+        evictOverBudget(loadedMemoryBudget);
+    }
+    evictionPending = false;
 
     std::error_code ec;
     semGarbageBarrier.post(ec);
     ASSERT(!ec);
 }
+
+void sfz::FilePool::evictOverBudget(size_t budget) noexcept
+{
+    updateRecency();
+
+    // Evict the idle files, the least recently released first. The files in
+    // use are released later than all the idle ones, so they move to the end
+    // of the order; the walk stops when it gets back to them.
+    FileData* firstInUse = nullptr;
+    FileData* data = leastRecent;
+    while (data && data != firstInUse && budget > 0 && loadedMemory > budget) {
+        FileData* next = data->moreRecent;
+        if (data->readerCount != 0) {
+            unlinkRecent(*data);
+            linkMostRecent(*data);
+            if (!firstInUse)
+                firstInUse = data;
+        } else {
+            tryEvict(*data);
+        }
+        data = next;
+    }
+}
+
+bool sfz::FilePool::tryEvict(FileData& data) noexcept
+{
+    // The voices take the files on the audio thread while this runs. The
+    // loaded frames are withdrawn first, then the eviction takes the place
+    // of the readers if there are none; a voice which comes in between only
+    // sees the preloaded frames, and its load request waits for the eviction.
+    FileData::Status status = FileData::Status::Done;
+    if (!data.status.compare_exchange_strong(status, FileData::Status::Evicting))
+        return false;
+
+    const size_t availableFrames = data.availableFrames.exchange(0);
+    int readers = 0;
+    if (data.readerCount.compare_exchange_strong(readers, FileData::evictionReaders)) {
+        data.evicted = true;
+        const bool collected = collectFileData(data);
+        data.readerCount.fetch_sub(FileData::evictionReaders);
+        if (collected) {
+            numEvictions.fetch_add(1);
+            return true;
+        }
+        data.evicted = false;
+    }
+
+    data.availableFrames = availableFrames;
+    data.status = FileData::Status::Done;
+    return false;
+}
+
+bool sfz::FilePool::collectFileData(FileData& data) noexcept
+{
+    if (garbageToCollect.size() == garbageToCollect.capacity()
+        || mappingsToCollect.size() == mappingsToCollect.capacity()
+        || sharedDataToCollect.size() == sharedDataToCollect.capacity())
+        return false;
+
+    if (data.predicted) {
+        numPredictionMisses.fetch_add(1);
+        forgetPrediction(data);
+    }
+
+    unlinkRecent(data);
+    loadedMemory.fetch_sub(data.loadedBytes);
+    data.loadedBytes = 0;
+
+    data.availableFrames = 0;
+    garbageToCollect.push_back(std::move(data.fileData));
+    // The shared data is freed by the last pool which releases it
+    if (data.sharedFileData)
+        sharedDataToCollect.push_back(std::move(data.sharedFileData));
+    if (data.mappedData)
+        mappingsToCollect.push_back(std::move(data.mappedData));
+    // Last, as the file can be loaded again from there
+    data.status = FileData::Status::Preloaded;
+    return true;
+}
+
+void sfz::FilePool::linkMostRecent(FileData& data) noexcept
+{
+    if (data.releaseQueue.load(std::memory_order_relaxed))
+        return;
+
+    data.lessRecent = mostRecent;
+    data.moreRecent = nullptr;
+    if (mostRecent)
+        mostRecent->moreRecent = &data;
+    else
+        leastRecent = &data;
+    mostRecent = &data;
+    data.releaseQueue.store(releasedFiles.get(), std::memory_order_release);
+}
+
+void sfz::FilePool::unlinkRecent(FileData& data) noexcept
+{
+    if (!data.releaseQueue.load(std::memory_order_relaxed))
+        return;
+
+    if (data.lessRecent)
+        data.lessRecent->moreRecent = data.moreRecent;
+    else
+        leastRecent = data.moreRecent;
+    if (data.moreRecent)
+        data.moreRecent->lessRecent = data.lessRecent;
+    else
+        mostRecent = data.lessRecent;
+    data.lessRecent = nullptr;
+    data.moreRecent = nullptr;
+    data.releaseQueue.store(nullptr, std::memory_order_relaxed);
+}
+
+void sfz::FilePool::updateRecency() noexcept
+{
+    // The files which left the order since they were released are skipped
+    FileData* data = nullptr;
+    while (releasedFiles->try_pop(data)) {
+        if (data->releaseQueue.load(std::memory_order_relaxed)) {
+            unlinkRecent(*data);
+            linkMostRecent(*data);
+        }
+    }
+}
+
+void sfz::FilePool::clearRecency() noexcept
+{
+    while (FileData* data = leastRecent)
+        unlinkRecent(*data);
+
+    FileData* released = nullptr;
+    while (releasedFiles->try_pop(released))
+        ;
+}
@@ -31,6 +31,10 @@
 #include "AudioSpan.h"
 #include "FileId.h"
 #include "FileMetadata.h"
+#include "FileStream.h"
+#include "LoadScheduler.h"
+#include "MappedAudioFile.h"
+#include "Oversampler.h"
 #include "SIMDHelpers.h"
 #include "Logger.h"
 #include "SpinMutex.h"
@@ -41,16 +45,22 @@
 #include <absl/types/optional.h>
 #include <absl/strings/string_view.h>
 #include <atomic_queue/atomic_queue.h>
+#include <array>
 #include <chrono>
+#include <functional>
 #include <thread>
 #include <future>
 #include <memory>
+#include <utility>
+#include <vector>
 class ThreadPool;
 
 namespace sfz {
+class PreloadCache;
+
 using FileAudioBuffer = AudioBuffer<float, 2, config::defaultAlignment,
                                     sfz::config::excessFileFrames, sfz::config::excessFileFrames>;
-using FileAudioBufferPtr = std::shared_ptr<FileAudioBuffer>;
+using FileAudioBufferPtr = std::shared_ptr<const FileAudioBuffer>;
 
 struct FileInformation {
     int64_t end { Default::sampleEnd };
@@ -62,24 +72,40 @@ struct FileInformation {
     int numChannels { 0 };
     int rootKey { 0 };
     absl::optional<WavetableInfo> wavetable;
+    // The factor by which the audio data is oversampled. The frame positions
+    // and the sample rate above are the ones of the file.
+    int oversamplingFactor { 1 };
 };
 
+struct FileData;
+// Where the loaded files are reported when their last reader leaves
+using FileReleaseQueue = atomic_queue::AtomicQueue<FileData*, config::maxVoices>;
+
 // Strict C++11 disallows member initialization if aggregate initialization is to be used...
 struct FileData
 {
-    enum class Status { Invalid, Preloaded, Streaming, Done };
+    enum class Status { Invalid, Preloaded, Streaming, Done, Evicting };
+    // Held by the eviction in place of the readers; see FilePool::tryEvict
+    static constexpr int evictionReaders = -(1 << 24);
     FileData() = default;
-    FileData(FileAudioBuffer preloaded, FileInformation info)
+    FileData(FileAudioBufferPtr preloaded, FileInformation info)
     : preloadedData(std::move(preloaded)), information(std::move(info))
     {
 
     }
     AudioSpan<const float> getData()
     {
-        if (availableFrames > preloadedData.getNumFrames())
-            return AudioSpan<const float>(fileData).first(availableFrames);
+        const size_t frames = availableFrames;
+        if (frames <= getNumPreloadedFrames())
+            return getPreloadedData();
+        else if (mappedData && mappedData->canReadInPlace())
+            return AudioSpan<const float>({ mappedData->data() }, frames);
+        else if (mappedData)
+            return getPreloadedData(); // the rest is read in windows
+        else if (sharedFileData)
+            return makeSpan(*sharedFileData, frames);
         else
-            return AudioSpan<const float>(preloadedData);
+            return AudioSpan<const float>(fileData).first(frames);
     }
 
     FileData(const FileData& other) = delete;
@@ -90,8 +116,14 @@ struct FileData
         information = std::move(other.information);
         preloadedData = std::move(other.preloadedData);
         fileData = std::move(other.fileData);
+        sharedFileData = std::move(other.sharedFileData);
+        mappedData = std::move(other.mappedData);
         availableFrames = other.availableFrames.load();
         lastViewerLeftAt = other.lastViewerLeftAt;
+        modificationTime = other.modificationTime;
+        predicted = other.predicted.load();
+        loadedBytes = other.loadedBytes;
+        evicted = other.evicted;
         status = other.status.load();
     }
     FileData& operator=(FileData&& other)
@@ -100,19 +132,89 @@ struct FileData
         information = std::move(other.information);
         preloadedData = std::move(other.preloadedData);
         fileData = std::move(other.fileData);
+        sharedFileData = std::move(other.sharedFileData);
+        mappedData = std::move(other.mappedData);
         availableFrames = other.availableFrames.load();
         lastViewerLeftAt = other.lastViewerLeftAt;
+        modificationTime = other.modificationTime;
+        predicted = other.predicted.load();
+        loadedBytes = other.loadedBytes;
+        evicted = other.evicted;
         status = other.status.load();
         return *this;
     }
 
-    FileAudioBuffer preloadedData;
+    AudioSpan<const float> getPreloadedData() const noexcept
+    {
+        if (!preloadedData)
+            return {};
+
+        return makeSpan(*preloadedData, preloadedData->getNumFrames());
+    }
+    size_t getNumPreloadedFrames() const noexcept
+    {
+        return preloadedData ? preloadedData->getNumFrames() : 0;
+    }
+    /**
+     * @brief Get the mapping of the file when its frames past the preloaded
+     * ones must be copied out in windows, or null otherwise.
+     */
+    const MappedAudioFile* getWindowedMapping() const noexcept
+    {
+        if (availableFrames <= getNumPreloadedFrames() || !mappedData || mappedData->canReadInPlace())
+            return nullptr;
+
+        return mappedData.get();
+    }
+
+    // The preloaded data is read-only, and may be shared with the file pools
+    // of other synths
+    FileAudioBufferPtr preloadedData;
     FileInformation information;
     FileAudioBuffer fileData {};
+    // The data of the whole file instead of fileData, when it is shared with
+    // the file pools of other synths
+    FileAudioBufferPtr sharedFileData;
+    std::unique_ptr<MappedAudioFile> mappedData;
     std::atomic<Status> status { Status::Invalid };
     std::atomic<size_t> availableFrames { 0 };
     std::atomic<int> readerCount { 0 };
     std::chrono::time_point<std::chrono::high_resolution_clock> lastViewerLeftAt;
+    // The modification time of the file when it was preloaded
+    fs::file_time_type modificationTime {};
+    // Loaded ahead by a prediction, and not requested by a voice yet
+    std::atomic<bool> predicted { false };
+    // The memory of the loaded data, and whether it was evicted before
+    size_t loadedBytes { 0 };
+    bool evicted { false };
+    // The place of the loaded file in the recency order of its pool, which
+    // it belongs to if `releaseQueue` is set
+    FileData* lessRecent { nullptr };
+    FileData* moreRecent { nullptr };
+    std::atomic<FileReleaseQueue*> releaseQueue { nullptr };
+
+    /**
+     * @brief Report that the last reader left the file, so it becomes the
+     * most recently used one. If the queue is full, the file keeps its
+     * previous place.
+     */
+    void notifyRelease() noexcept
+    {
+        if (FileReleaseQueue* queue = releaseQueue.load(std::memory_order_acquire))
+            queue->try_push(this);
+    }
+
+private:
+    static AudioSpan<const float> makeSpan(const FileAudioBuffer& buffer, size_t numFrames) noexcept
+    {
+        std::array<const float*, config::numChannels> spans {};
+        const size_t numChannels = buffer.getNumChannels();
+        ASSERT(numChannels <= spans.size());
+        for (size_t i = 0; i < numChannels; ++i)
+            spans[i] = buffer.channelReader(i);
+
+        return AudioSpan<const float>(spans, numChannels, 0, numFrames);
+    }
 
     LEAK_DETECTOR(FileData);
 };
@@ -130,8 +232,11 @@ public:
     }
     FileDataHolder& operator=(FileDataHolder&& other)
     {
-        this->data = other.data;
-        other.data = nullptr;
+        if (this != &other) {
+            reset();
+            this->data = other.data;
+            other.data = nullptr;
+        }
         return *this;
     }
     FileDataHolder(FileData* data) : data(data)
@@ -146,13 +251,14 @@ public:
         if (!data)
             return;
 
-        data->readerCount -= 1;
         data->lastViewerLeftAt = std::chrono::high_resolution_clock::now();
+        if (data->readerCount.fetch_sub(1) == 1)
+            data->notifyRelease();
         data = nullptr;
     }
     ~FileDataHolder()
     {
-        ASSERT(!data || data->readerCount > 0);
+        ASSERT(!data || data->readerCount != 0);
         reset();
     }
     FileData& operator*() { return *data; }
@@ -180,6 +286,11 @@ private:
  * promise, which should decrease the  reference count to 1. A garbage
  * collection thread then runs regularly to clear the memory of all file handles
  * with a reference count of 1.
+ *
+ * Alternatively, a voice can stream the frames past the preloaded data into a
+ * fixed-size ring, which the background loaders refill ahead of its playhead.
+ * This is the default, and it bounds the memory used for streaming to the
+ * number of voices times the ring size.
  */
 
 
@@ -199,7 +310,7 @@ public:
      *
      * @param directory
      */
-    void setRootDirectory(const fs::path& directory) noexcept { rootDirectory = directory; }
+    void setRootDirectory(const fs::path& directory) noexcept;
     /**
      * @brief Get the number of preloaded sample files
      *
@@ -226,6 +337,24 @@ public:
      */
     bool preloadFile(const FileId& fileId, uint32_t maxOffset) noexcept;
 
+    /**
+     * @brief Function which is told the progress of `preloadFiles`, with the
+     * number of files done and the total number of files. Returning false
+     * cancels the preloading.
+     */
+    using PreloadProgress = std::function<bool(size_t, size_t)>;
+
+    /**
+     * @brief Preload a set of files in parallel on the background threads.
+     * The files must be distinct. The progress function is called on the
+     * calling thread each time a file is done.
+     *
+     * @param files the files with their maximum offsets, as in `preloadFile`
+     * @param progress the progress function, which may be empty
+     * @return true if the preloading was not cancelled
+     */
+    bool preloadFiles(const std::vector<std::pair<FileId, uint32_t>>& files, const PreloadProgress& progress) noexcept;
+
     /**
      * @brief Load a file and return its information. The file pool will store this
      * data for future requests so use this function responsibly.
@@ -259,12 +388,121 @@ public:
      */
     void clear();
     /**
-     * @brief Get a handle on a file, which triggers background loading
+     * @brief Clear the pool before loading a new version of the instrument,
+     * but keep the preloaded files which are unchanged on disk. The next
+     * preloads reuse them when they cover the requested offsets.
+     */
+    void clearForReload();
+    /**
+     * @brief Share the preloaded data of another pool, as if it had been
+     * preloaded here, so that a reload in this pool only reads the files
+     * which are new or modified. Call it on an empty pool, before the reload,
+     * and while the other pool does not load.
+     *
+     * @param other the pool of the instrument being replaced
+     */
+    void seedPreloadedFiles(const FilePool& other);
+    /**
+     * @brief Remove the preloaded files which are kept from a previous load,
+     * but not used anymore.
+     *
+     * @param files the files which are used, with their maximum offsets
+     */
+    void removeUnusedPreloadedFiles(const std::vector<std::pair<FileId, uint32_t>>& files);
+    /**
+     * @brief Get the number of files whose existing preloaded data was reused
+     * by the preloads since the last clear.
+     */
+    size_t getNumReusedPreloads() const noexcept { return numReusedPreloads; }
+    /**
+     * @brief Get the number of files which were read by the preloads since
+     * the last clear.
+     */
+    size_t getNumReadPreloads() const noexcept { return numReadPreloads; }
+    /**
+     * @brief Get a handle on a file, which triggers background loading.
+     * The loads are scheduled by deadline, which is when the voice runs out
+     * of preloaded frames at its playback rate. The load is cancelled if
+     * every handle on the file is released before it starts.
      *
      * @param fileId the file to preload
+     * @param startFrame the frame where the voice starts reading
+     * @param playbackRate the speed at which the voice reads the file,
+     *                     relative to its sample rate, e.g. 2 an octave up
+     * @return FileDataHolder a file data handle
+     */
+    FileDataHolder getFilePromise(const std::shared_ptr<FileId>& fileId, int64_t startFrame = 0, float playbackRate = 1.0f) noexcept;
+    /**
+     * @brief Load a file in the background ahead of the voices, when it is
+     * likely to play soon. The file is queued with a lower priority than the
+     * files requested by the voices, and only if it fits in the memory budget
+     * of the predictions. Called from the audio thread.
+     *
+     * @param fileId the file
+     * @return true if the file was queued
+     */
+    bool predictFile(const std::shared_ptr<FileId>& fileId) noexcept;
+    /**
+     * @brief Get a handle on the preloaded data of a file, without triggering
+     * any background loading.
+     *
+     * @param fileId the file
      * @return FileDataHolder a file data handle
      */
-    FileDataHolder getFilePromise(const std::shared_ptr<FileId>& fileId) noexcept;
+    FileDataHolder getPreloadedFile(const std::shared_ptr<FileId>& fileId) noexcept;
+    /**
+     * @brief Get a streaming ring for the frames of a file which lie past its
+     * preloaded data. This is the bounded alternative to `getFilePromise`.
+     *
+     * The handle is empty when streaming is not needed or not applicable:
+     * the file is entirely in memory, streaming is disabled or all the rings
+     * are in use.
+     *
+     * @param fileId the file
+     * @param data the preloaded data of the file
+     * @param playbackRate the speed at which the voice reads the file,
+     *                     relative to its sample rate, e.g. 2 an octave up
+     * @return FileStreamHolder a stream handle
+     */
+    FileStreamHolder getFileStream(const std::shared_ptr<FileId>& fileId, const FileData& data, float playbackRate = 1.0f) noexcept;
+    /**
+     * @brief Set the size of the streaming rings in frames. This applies to
+     * the streams opened after the change. A size of 0, the default,
+     * disables the rings, and files are loaded whole in the background
+     * instead.
+     *
+     * @param numFrames
+     */
+    void setStreamRingSize(size_t numFrames) noexcept;
+    /**
+     * @brief Get the size of the streaming rings in frames.
+     */
+    size_t getStreamRingSize() const noexcept { return streamRingSize; }
+    /**
+     * @brief Get the number of times a voice needed streamed frames which
+     * were not available yet.
+     */
+    size_t getNumStreamUnderruns() const noexcept { return streamUnderruns.load(); }
+    /**
+     * @brief Get the number of background jobs, file loads and stream
+     * refills, which are queued or running.
+     */
+    size_t getNumPendingLoads() const noexcept { return scheduler->getNumPending(); }
+    /**
+     * @brief Get the largest number of background jobs queued or running at
+     * once.
+     */
+    size_t getMaxPendingLoads() const noexcept { return scheduler->getMaxPending(); }
+    /**
+     * @brief Get the number of background jobs which started after the
+     * voice ran out of data.
+     */
+    uint64_t getNumLoadDeadlineMisses() const noexcept { return scheduler->getNumDeadlineMisses(); }
+    /**
+     * @brief Get the number of file loads which were dropped because their
+     * voices ended before the load started.
+     */
+    size_t getNumCancelledLoads() const noexcept { return numCancelledLoads; }
     /**
      * @brief Change the preloading size. This will trigger a full
      * reload of all samples, so don't call it on the audio thread.
@@ -278,6 +516,25 @@ public:
      * @return uint32_t
      */
     uint32_t getPreloadSize() const noexcept;
+    /**
+     * @brief Change the oversampling factor of the sample data. The preloaded
+     * data of all the files is read and upsampled again like in
+     * `preloadFiles`, and the files loaded in the background are upsampled
+     * as they are read. Oversampled files are not streamed into rings nor
+     * memory-mapped. Don't call it on the audio thread nor while voices use
+     * the files.
+     *
+     * @param factor
+     */
+    void setOversamplingFactor(Oversampling factor) noexcept;
+    /**
+     * @brief Get the oversampling factor of the sample data.
+     */
+    Oversampling getOversamplingFactor() const noexcept { return oversamplingFactor; }
+    /**
+     * @brief Get the memory used by the preloaded data, in bytes.
+     */
+    size_t getPreloadedMemory() const noexcept;
     /**
      * @brief Empty the file loading queues without actually loading
      * the files. All promises will be unfulfilled. Don't call this
@@ -306,6 +563,138 @@ public:
      * @param loadInRam
      */
     void setRamLoading(bool loadInRam) noexcept;
+    /**
+     * @brief Change whether the streamed files are memory-mapped instead of
+     * being decoded in memory, for the files whose frames can be used as-is.
+     * This affects the files which are streamed after the change.
+     *
+     * @param mappedStreaming
+     */
+    void setMappedStreaming(bool mappedStreaming) noexcept { this->mappedStreaming = mappedStreaming; }
+    /**
+     * @brief Check whether the streamed files are memory-mapped.
+     */
+    bool getMappedStreaming() const noexcept { return mappedStreaming; }
+    /**
+     * @brief Set the directory of the persistent preload cache, creating it
+     * if needed. The preloaded data of the files is read from this cache when
+     * it is up to date, and written to it otherwise. An empty path disables
+     * the cache.
+     *
+     * @param directory
+     * @return true if the cache directory is usable
+     */
+    bool setPreloadCacheDirectory(const fs::path& directory) noexcept;
+    /**
+     * @brief Get the directory of the persistent preload cache, which is
+     * empty if the cache is disabled.
+     */
+    fs::path getPreloadCacheDirectory() const noexcept;
+    /**
+     * @brief Share the sample data with the other file pools of the process
+     * which enable it, instead of reading it again; see `SampleStore`. The
+     * preloaded data is shared between the pools which preload the same file
+     * with the same size and direction, and so is the data of the files which
+     * are loaded whole in the background. The data is freed when none of the
+     * pools uses it anymore. The streaming rings, which follow the playhead
+     * of a voice, and the memory-mapped files are not shared.
+     * This affects the files which are preloaded after the change.
+     *
+     * @param sharedPreloading
+     */
+    void setSharedPreloading(bool sharedPreloading) noexcept { this->sharedPreloading = sharedPreloading; }
+    /**
+     * @brief Check whether the preloaded data is shared with other file pools.
+     */
+    bool getSharedPreloading() const noexcept { return sharedPreloading; }
+    /**
+     * @brief Enable loading the files which are predicted to play next; see
+     * `predictFile`.
+     *
+     * @param predictiveLoading
+     */
+    void setPredictiveLoading(bool predictiveLoading) noexcept { this->predictiveLoading = predictiveLoading; }
+    /**
+     * @brief Check whether the predicted files are loaded ahead.
+     */
+    bool getPredictiveLoading() const noexcept { return predictiveLoading; }
+    /**
+     * @brief Set the memory which the predicted files, loaded but not yet
+     * requested by a voice, may use in total.
+     *
+     * @param numBytes
+     */
+    void setPredictiveLoadingBudget(size_t numBytes) noexcept { predictionBudget = numBytes; }
+    /**
+     * @brief Get the memory budget of the predicted files, in bytes.
+     */
+    size_t getPredictiveLoadingBudget() const noexcept { return predictionBudget; }
+    /**
+     * @brief Get the memory of the predicted files which no voice requested
+     * yet, in bytes.
+     */
+    size_t getPredictedMemory() const noexcept { return predictedMemory; }
+    /**
+     * @brief Get the number of files loaded ahead by the predictions.
+     */
+    size_t getNumPredictedLoads() const noexcept { return numPredictedLoads; }
+    /**
+     * @brief Get the number of predicted files which a voice requested
+     * afterwards.
+     */
+    size_t getNumPredictionHits() const noexcept { return numPredictionHits; }
+    /**
+     * @brief Get the number of predicted files which were released without
+     * any voice requesting them.
+     */
+    size_t getNumPredictionMisses() const noexcept { return numPredictionMisses; }
+    /**
+     * @brief Get the number of preloads served by the persistent cache.
+     */
+    size_t getNumPreloadCacheHits() const noexcept;
+    /**
+     * @brief Get the number of preloads which missed the persistent cache.
+     */
+    size_t getNumPreloadCacheMisses() const noexcept;
+    /**
+     * @brief Set a ceiling to the memory of the files loaded whole in the
+     * background. With a budget, the loaded files stay in memory while they
+     * fit, and the idle ones are evicted by a background job, the least
+     * recently released first, when the loaded files exceed it. Without a
+     * budget, the files are freed once they are idle for
+     * `config::fileClearingPeriod`. The memory-mapped files do not count, as
+     * the system can reclaim them.
+     *
+     * @param numBytes the budget in bytes, or 0 to disable it
+     */
+    void setLoadedMemoryBudget(size_t numBytes) noexcept { loadedMemoryBudget = numBytes; }
+    /**
+     * @brief Get the budget of the loaded files in bytes, or 0 if disabled.
+     */
+    size_t getLoadedMemoryBudget() const noexcept { return loadedMemoryBudget; }
+    /**
+     * @brief Get the memory of the files loaded whole, in bytes.
+     */
+    size_t getLoadedMemory() const noexcept { return loadedMemory; }
+    /**
+     * @brief Check whether the loaded files exceed the budget, in which case
+     * the garbage collection should run soon.
+     */
+    bool isOverMemoryBudget() const noexcept
+    {
+        const size_t budget = loadedMemoryBudget;
+        return budget > 0 && loadedMemory > budget;
+    }
+    /**
+     * @brief Get the number of loaded files which were evicted to stay within
+     * the memory budget. The files freed after being idle do not count.
+     */
+    size_t getNumEvictions() const noexcept { return numEvictions; }
+    /**
+     * @brief Get the number of files which were loaded again after being
+     * evicted.
+     */
+    size_t getNumReloads() const noexcept { return numReloads; }
     /**
      * @brief Prepares unused data to be freed on a background thread.
      * This should be called regularly by the Synth, otherwise memory
@@ -313,44 +702,92 @@ public:
      */
     void triggerGarbageCollection() noexcept;
 private:
+    friend class FileStream;
+
     Logger& logger;
     fs::path rootDirectory;
 
     bool loadInRam { config::loadInRam };
+    std::atomic<bool> mappedStreaming { config::mappedStreaming };
+    std::atomic<bool> sharedPreloading { false };
     uint32_t preloadSize { config::preloadSize };
+    Oversampling oversamplingFactor { Oversampling::x1 };
+    std::atomic<size_t> streamRingSize { config::streamRingFrames };
+    std::atomic<size_t> streamUnderruns { 0 };
+    std::atomic<bool> predictiveLoading { false };
+    std::atomic<size_t> predictionBudget { config::predictiveLoadingBudget };
+    std::atomic<size_t> predictedMemory { 0 };
+    std::atomic<size_t> numPredictedLoads { 0 };
+    std::atomic<size_t> numPredictionHits { 0 };
+    std::atomic<size_t> numPredictionMisses { 0 };
+    std::atomic<size_t> loadedMemoryBudget { 0 };
+    std::atomic<size_t> loadedMemory { 0 };
+    std::atomic<size_t> numEvictions { 0 };
+    std::atomic<bool> evictionPending { false };
+    std::atomic<size_t> numReloads { 0 };
+    std::atomic<size_t> numCancelledLoads { 0 };
+    size_t numReusedPreloads { 0 };
+    size_t numReadPreloads { 0 };
 
     // Signals
-    volatile bool dispatchFlag { true };
     volatile bool garbageFlag { true };
-    RTSemaphore dispatchBarrier;
     RTSemaphore semGarbageBarrier;
 
-    // Structures for the background loaders
-    struct QueuedFileData
-    {
-        using TimePoint = std::chrono::time_point<std::chrono::high_resolution_clock>;
-        QueuedFileData() noexcept {}
-        QueuedFileData(std::weak_ptr<FileId> id, FileData* data, TimePoint queuedTime) noexcept
-        : id(id), data(data), queuedTime(queuedTime) {}
-        std::weak_ptr<FileId> id;
-        FileData* data { nullptr };
-        TimePoint queuedTime {};
+    static size_t getLoadedMemory(const FileData& data) noexcept;
+    void forgetPrediction(FileData& data) noexcept;
+
+    // Streaming rings, with the ones which are free
+    using StreamQueue = atomic_queue::AtomicQueue<FileStream*, config::numFileStreams>;
+    std::vector<std::unique_ptr<FileStream>> streams;
+    aligned_unique_ptr<StreamQueue> freeStreams;
+    void enqueueStream(FileStream* stream) noexcept;
+    void recycleStream(FileStream* stream) noexcept;
+
+    // Persistent cache of the preloaded data
+    std::unique_ptr<PreloadCache> preloadCache;
+
+    // Preloading, split in a reading part which can run on any thread and
+    // an insertion part which runs on the loading thread
+    struct PreloadedFile {
+        FileInformation information;
+        FileAudioBufferPtr data;
+        fs::file_time_type modificationTime {};
     };
-
-    using FileQueue = atomic_queue::AtomicQueue2<QueuedFileData, config::maxVoices>;
-    aligned_unique_ptr<FileQueue> filesToLoad;
-
-    void dispatchingJob() noexcept;
+    uint32_t getFramesToPreload(const FileInformation& information, uint32_t maxOffset) const noexcept;
+    FileAudioBufferPtr readPreloadedData(const FileId& fileId, uint32_t numFrames) const;
+    bool needsPreloading(const FileId& fileId, uint32_t maxOffset) const noexcept;
+    bool readPreloadedFile(const FileId& fileId, uint32_t maxOffset, PreloadedFile& preloaded) noexcept;
+    bool insertPreloadedFile(const FileId& fileId, PreloadedFile&& preloaded) noexcept;
+
+    // The background jobs, run by the scheduler
+    friend class LoadScheduler;
+    std::unique_ptr<LoadScheduler> scheduler;
+    void runRequest(const LoadScheduler::Request& request) noexcept;
     void garbageJob() noexcept;
-    void loadingJob(const QueuedFileData& data) noexcept;
-    std::mutex loadingJobsMutex;
-    std::vector<std::future<void>> loadingJobs;
-    std::thread dispatchThread { &FilePool::dispatchingJob, this };
+    void loadingJob(const LoadScheduler::Request& data) noexcept;
+    void evictionJob() noexcept;
+    void streamingJob(FileStream* stream) noexcept;
     std::thread garbageThread { &FilePool::garbageJob, this };
 
     SpinMutex garbageAndLastUsedMutex;
     std::vector<FileId> lastUsedFiles;
     std::vector<FileAudioBuffer> garbageToCollect;
+    std::vector<std::unique_ptr<MappedAudioFile>> mappingsToCollect;
+    std::vector<FileAudioBufferPtr> sharedDataToCollect;
+    void collectIdleFiles() noexcept;
+    void evictOverBudget(size_t budget) noexcept;
+    bool tryEvict(FileData& data) noexcept;
+    bool collectFileData(FileData& data) noexcept;
+
+    // The loaded files, the least recently released first, with the files
+    // released since the order was last updated
+    FileData* leastRecent { nullptr };
+    FileData* mostRecent { nullptr };
+    aligned_unique_ptr<FileReleaseQueue> releasedFiles;
+    void linkMostRecent(FileData& data) noexcept;
+    void unlinkRecent(FileData& data) noexcept;
+    void updateRecency() noexcept;
+    void clearRecency() noexcept;
 
     std::shared_ptr<ThreadPool> threadPool;
 
@@ -0,0 +1,281 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "FileStream.h"
+#include "FilePool.h"
+#include "AudioReader.h"
+#include "Config.h"
+#include "MathHelpers.h"
+#include "SIMDHelpers.h"
+#include "utility/Debug.h"
+#include <array>
+#include <chrono>
+#include <thread>
+
+namespace sfz {
+
+FileStream::FileStream(FilePool& filePool)
+    : filePool_(filePool)
+{
+}
+
+FileStream::~FileStream()
+{
+}
+
+void FileStream::open(const std::shared_ptr<FileId>& fileId, int64_t numFrames, unsigned numChannels,
+    int64_t preloadedFrames, size_t capacity, double sampleRate, float playbackRate) noexcept
+{
+    ASSERT(state_ == 0);
+    ASSERT(capacity >= config::streamWindowFrames);
+
+    fileId_ = fileId;
+    numFrames_ = numFrames;
+    endFrame_ = numFrames + config::excessFileFrames;
+    numChannels_ = numChannels;
+    capacity_ = capacity;
+    guard_ = config::streamWindowFrames;
+    sampleRate_ = sampleRate;
+
+    // Start early enough that a window ending past the preloaded frames
+    // is entirely contained in the ring
+    startFrame_ = max<int64_t>(0, preloadedFrames - static_cast<int64_t>(guard_));
+    readFrame_.store(startFrame_, std::memory_order_relaxed);
+    playbackRate_.store(playbackRate, std::memory_order_relaxed);
+    writtenEnd_.store(startFrame_, std::memory_order_relaxed);
+    failed_.store(false, std::memory_order_relaxed);
+
+    state_.store(kAttached | kBusy, std::memory_order_release);
+    filePool_.enqueueStream(this);
+}
+
+void FileStream::release() noexcept
+{
+    unsigned state = state_.load(std::memory_order_relaxed);
+    while (!state_.compare_exchange_weak(state, (state & ~kAttached) | kBusy, std::memory_order_acq_rel))
+        ;
+
+    // If there is no job running, schedule one to clean up in the background
+    if (!(state & kBusy))
+        filePool_.enqueueStream(this);
+}
+
+void FileStream::requestRefill() noexcept
+{
+    unsigned state = kAttached;
+    if (state_.compare_exchange_strong(state, kAttached | kBusy, std::memory_order_acq_rel))
+        filePool_.enqueueStream(this);
+}
+
+bool FileStream::getFrames(int64_t first, size_t numFrames, AudioSpan<const float>& window, bool wait) noexcept
+{
+    ASSERT(numFrames <= guard_);
+    if (numFrames > guard_ || first < startFrame_ || first < readFrame_.load(std::memory_order_relaxed)) {
+        filePool_.streamUnderruns.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const int64_t end = first + static_cast<int64_t>(numFrames);
+    if (end > writtenEnd_.load(std::memory_order_acquire)) {
+        if (wait) {
+            const auto deadline = std::chrono::steady_clock::now()
+                + std::chrono::milliseconds(config::streamWaitTimeout);
+            while (end > writtenEnd_.load(std::memory_order_acquire)
+                    && !failed_.load(std::memory_order_relaxed)
+                    && std::chrono::steady_clock::now() < deadline) {
+                requestRefill();
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+
+        if (end > writtenEnd_.load(std::memory_order_acquire)) {
+            filePool_.streamUnderruns.fetch_add(1, std::memory_order_relaxed);
+            requestRefill();
+            return false;
+        }
+    }
+
+    const size_t slot = static_cast<size_t>(first) % capacity_;
+    const std::array<const float*, 2> channels {{
+        ring_.channelReader(0),
+        ring_.channelReader(numChannels_ > 1 ? 1 : 0),
+    }};
+    window = AudioSpan<const float>(channels, numChannels_, slot, numFrames);
+    return true;
+}
+
+void FileStream::setReadFrame(int64_t frame, float playbackRate) noexcept
+{
+    playbackRate_.store(playbackRate, std::memory_order_relaxed);
+    if (frame > readFrame_.load(std::memory_order_relaxed))
+        readFrame_.store(frame, std::memory_order_release);
+
+    const int64_t written = writtenEnd_.load(std::memory_order_relaxed);
+    const int64_t lowWater = static_cast<int64_t>(capacity_ / 2);
+    if (written < endFrame_ && written - readFrame_.load(std::memory_order_relaxed) < lowWater)
+        requestRefill();
+}
+
+void FileStream::process(const fs::path& rootDirectory) noexcept
+{
+    if ((state_.load(std::memory_order_acquire) & kAttached) && !failed_.load()) {
+        bool filled = false;
+        try {
+            filled = fill(rootDirectory);
+        } catch (const std::exception& e) {
+            DBG("[sfizz] Error while streaming: " << e.what());
+        }
+        if (!filled)
+            failed_.store(true);
+    }
+
+    unsigned state = state_.load(std::memory_order_relaxed);
+    while (!state_.compare_exchange_weak(state, state & ~kBusy, std::memory_order_acq_rel))
+        ;
+
+    // Released while running, it's our turn to give the stream back
+    if (!(state & kAttached)) {
+        cleanUp();
+        filePool_.recycleStream(this);
+    }
+}
+
+bool FileStream::openReader(const fs::path& rootDirectory)
+{
+    reader_.reset();
+    readerPosition_ = 0;
+
+    std::shared_ptr<FileId> id = fileId_.lock();
+    if (!id)
+        return false;
+
+    std::error_code readError;
+    reader_ = createAudioReader(rootDirectory / id->filename(), id->isReverse(), &readError);
+    if (readError || !reader_ || reader_->channels() != numChannels_) {
+        DBG("[sfizz] Cannot open " << *id << " for streaming");
+        reader_.reset();
+        return false;
+    }
+
+    return true;
+}
+
+bool FileStream::skipTo(const fs::path& rootDirectory, int64_t frame)
+{
+    frame = min(frame, numFrames_);
+    if (readerPosition_ >= frame)
+        return true;
+
+    // Seek the decoder, which stays open between the refills
+    if (seekable_) {
+        if (reader_->seek(static_cast<uint64_t>(frame))) {
+            readerPosition_ = frame;
+            return true;
+        }
+
+        // The position is unknown after a failed seek, start over and skip
+        DBG("[sfizz] Cannot seek while streaming, skipping the frames instead");
+        seekable_ = false;
+        if (!openReader(rootDirectory))
+            return false;
+    }
+
+    // Read and drop the frames up to the position
+    const size_t chunkSize = static_cast<size_t>(config::chunkSize);
+    while (readerPosition_ < frame) {
+        const auto toSkip = static_cast<size_t>(min<int64_t>(chunkSize, frame - readerPosition_));
+        const size_t numRead = reader_->readNextBlock(readBuffer_.data(), toSkip);
+        if (numRead == 0) {
+            readerPosition_ = numFrames_;
+            break;
+        }
+        readerPosition_ += static_cast<int64_t>(numRead);
+    }
+
+    return true;
+}
+
+bool FileStream::fill(const fs::path& rootDirectory)
+{
+    const size_t chunkSize = static_cast<size_t>(config::chunkSize);
+    readBuffer_.resize(chunkSize * numChannels_);
+
+    if (!reader_) {
+        if (!openReader(rootDirectory))
+            return false;
+        seekable_ = true;
+    }
+
+    if (ring_.getNumChannels() == 0) {
+        ring_.addChannels(numChannels_);
+        ring_.resize(capacity_ + guard_);
+    }
+
+    int64_t written = writtenEnd_.load(std::memory_order_relaxed);
+    if (!skipTo(rootDirectory, written))
+        return false;
+
+    while (written < endFrame_ && (state_.load(std::memory_order_acquire) & kAttached)) {
+        const int64_t readFrame = readFrame_.load(std::memory_order_acquire);
+
+        // The voice went past what was written, no use streaming the frames in between
+        if (written < readFrame) {
+            if (!skipTo(rootDirectory, readFrame))
+                return false;
+            written = min(readFrame, endFrame_);
+            writtenEnd_.store(written, std::memory_order_release);
+            continue;
+        }
+
+        const int64_t limit = min(readFrame + static_cast<int64_t>(capacity_), endFrame_);
+        if (written >= limit)
+            break;
+
+        const size_t slot = static_cast<size_t>(written) % capacity_;
+        const size_t numFrames = min(
+            chunkSize, static_cast<size_t>(limit - written), capacity_ - slot);
+
+        size_t numRead = 0;
+        if (readerPosition_ == written && written < numFrames_) {
+            const auto toRead = static_cast<size_t>(min<int64_t>(numFrames, numFrames_ - written));
+            numRead = reader_->readNextBlock(readBuffer_.data(), toRead);
+            readerPosition_ += static_cast<int64_t>(numRead);
+            if (numRead < toRead)
+                readerPosition_ = numFrames_; // truncated file, the rest reads as zeroes
+        }
+
+        for (unsigned c = 0; c < numChannels_; ++c) {
+            float* output = ring_.channelWriter(c) + slot;
+            for (size_t i = 0; i < numRead; ++i)
+                output[i] = readBuffer_[i * numChannels_ + c];
+            for (size_t i = numRead; i < numFrames; ++i)
+                output[i] = 0.0f;
+
+            // Mirror the beginning of the ring past its end
+            if (slot < guard_) {
+                const size_t numMirrored = min(numFrames, guard_ - slot);
+                copy<float>(output, ring_.channelWriter(c) + capacity_ + slot, numMirrored);
+            }
+        }
+
+        written += static_cast<int64_t>(numFrames);
+        writtenEnd_.store(written, std::memory_order_release);
+    }
+
+    return true;
+}
+
+void FileStream::cleanUp() noexcept
+{
+    reader_.reset();
+    ring_.reset();
+    readBuffer_.clear();
+    readerPosition_ = 0;
+    seekable_ = true;
+    fileId_.reset();
+}
+
+} // namespace sfz
@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#pragma once
+#include "AudioBuffer.h"
+#include "AudioSpan.h"
+#include "Buffer.h"
+#include "FileId.h"
+#include "utility/LeakDetector.h"
+#include <ghc/fs_std.hpp>
+#include <atomic>
+#include <memory>
+
+namespace sfz {
+class FilePool;
+class AudioReader;
+
+/**
+ * @brief A fixed-size ring buffer which streams the part of a sample file
+ * which lies past its preloaded data, ahead of the playhead of a voice.
+ *
+ * The ring is refilled in chunks by the background loaders of the file pool,
+ * as the voice advances its read position. Frames which are older than the
+ * read position are recycled, so the memory used is bounded by the ring size
+ * whatever the length of the sample.
+ *
+ * The storage is followed by a mirror of its first frames, so that any
+ * window up to `getMaxWindow()` frames is contiguous in memory and can be
+ * read by the interpolators directly.
+ *
+ * The frames past the end of the file read as zeroes.
+ */
+class FileStream {
+public:
+    explicit FileStream(FilePool& filePool);
+    ~FileStream();
+
+    FileStream(const FileStream&) = delete;
+    FileStream& operator=(const FileStream&) = delete;
+
+    /**
+     * @brief Get the number of frames of the streamed file.
+     */
+    int64_t getNumFrames() const noexcept { return numFrames_; }
+
+    /**
+     * @brief Get the maximum number of frames which can be requested at
+     * once with `getFrames`.
+     */
+    size_t getMaxWindow() const noexcept { return guard_; }
+
+    /**
+     * @brief Get a contiguous window of frames.
+     *
+     * The window must not start before the current read position. When the
+     * frames are not streamed yet, this counts an underrun and fails, unless
+     * waiting was requested.
+     *
+     * @param first the first frame of the window
+     * @param numFrames the size of the window, at most `getMaxWindow()`
+     * @param window the window to fill
+     * @param wait whether to block until the frames are streamed, which
+     *             is only appropriate when rendering offline
+     * @return true if the frames are available
+     */
+    bool getFrames(int64_t first, size_t numFrames, AudioSpan<const float>& window, bool wait = false) noexcept;
+
+    /**
+     * @brief Indicate that the frames before a given position are no longer
+     * needed, and request a refill if the ring runs low.
+     *
+     * The read position never goes backwards.
+     *
+     * @param frame
+     * @param playbackRate the speed at which the voice reads the file,
+     *                     relative to its sample rate, to schedule the refills
+     */
+    void setReadFrame(int64_t frame, float playbackRate = 1.0f) noexcept;
+
+private:
+    friend class FilePool;
+    friend class FileStreamHolder;
+
+    enum : unsigned { kAttached = 1 << 0, kBusy = 1 << 1 };
+
+    /**
+     * @brief Set up the ring for a new file. Called from the audio thread on
+     * a stream which is free.
+     */
+    void open(const std::shared_ptr<FileId>& fileId, int64_t numFrames, unsigned numChannels,
+        int64_t preloadedFrames, size_t capacity, double sampleRate, float playbackRate) noexcept;
+
+    /**
+     * @brief Detach the ring from its voice. The ring goes back to the file
+     * pool once its background job, if any, has finished.
+     */
+    void release() noexcept;
+
+    /**
+     * @brief Request the background processing of the ring.
+     */
+    void requestRefill() noexcept;
+
+    /**
+     * @brief Process the ring in a background job: fill it ahead of the read
+     * position, or clean it up if it was released.
+     *
+     * @param rootDirectory the root directory of the files
+     */
+    void process(const fs::path& rootDirectory) noexcept;
+
+    bool fill(const fs::path& rootDirectory);
+    void cleanUp() noexcept;
+
+    /**
+     * @brief Open the reader of the file, at its first frame.
+     */
+    bool openReader(const fs::path& rootDirectory);
+
+    /**
+     * @brief Move the reader forward to a frame, seeking if the reader
+     * allows it, or reading and dropping the frames in between otherwise.
+     */
+    bool skipTo(const fs::path& rootDirectory, int64_t frame);
+
+    FilePool& filePool_;
+    std::atomic<unsigned> state_ { 0 };
+
+    // Set up when opening
+    std::weak_ptr<FileId> fileId_;
+    int64_t numFrames_ { 0 };
+    int64_t endFrame_ { 0 };
+    int64_t startFrame_ { 0 };
+    unsigned numChannels_ { 0 };
+    size_t capacity_ { 0 };
+    size_t guard_ { 0 };
+    double sampleRate_ { config::defaultSampleRate }; // to schedule the refills
+
+    // Positions in file frames
+    std::atomic<int64_t> readFrame_ { 0 };
+    std::atomic<float> playbackRate_ { 1.0f };
+    std::atomic<int64_t> writtenEnd_ { 0 };
+    std::atomic<bool> failed_ { false };
+
+    // Background only
+    AudioBuffer<float, 2> ring_;
+    Buffer<float> readBuffer_;
+    std::unique_ptr<AudioReader> reader_;
+    int64_t readerPosition_ { 0 };
+    bool seekable_ { true };
+
+    LEAK_DETECTOR(FileStream);
+};
+
+/**
+ * @brief A handle on a file stream, which releases it when reset.
+ */
+class FileStreamHolder {
+public:
+    FileStreamHolder() = default;
+    explicit FileStreamHolder(FileStream* stream) : stream(stream) {}
+    FileStreamHolder(const FileStreamHolder&) = delete;
+    FileStreamHolder& operator=(const FileStreamHolder&) = delete;
+    FileStreamHolder(FileStreamHolder&& other) noexcept
+    {
+        stream = other.stream;
+        other.stream = nullptr;
+    }
+    FileStreamHolder& operator=(FileStreamHolder&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            stream = other.stream;
+            other.stream = nullptr;
+        }
+        return *this;
+    }
+    ~FileStreamHolder() { reset(); }
+    void reset() noexcept
+    {
+        if (!stream)
+            return;
+
+        stream->release();
+        stream = nullptr;
+    }
+    FileStream* get() const noexcept { return stream; }
+    FileStream& operator*() const noexcept { return *stream; }
+    FileStream* operator->() const noexcept { return stream; }
+    explicit operator bool() const noexcept { return stream != nullptr; }
+private:
+    FileStream* stream { nullptr };
+    LEAK_DETECTOR(FileStreamHolder);
+};
+
+} // namespace sfz
@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "FilterBank.h"
+#include "MathHelpers.h"
+#include "SIMDHelpers.h"
+#include "utility/Debug.h"
+#include <cmath>
+
+namespace sfz {
+
+constexpr unsigned FilterBank::numShapes;
+constexpr unsigned FilterBank::numCoeffs;
+constexpr unsigned FilterBank::numMemory;
+
+namespace {
+
+float alphaScaleOf(float resonance) noexcept
+{
+    const float q = std::pow(10.0f, 0.05f * clamp(resonance, -60.0f, 60.0f));
+    return 0.5f / max(0.001f, q);
+}
+
+} // namespace
+
+bool FilterBank::supports(FilterType type) noexcept
+{
+    switch (type) {
+    case kFilterLpf2p:
+    case kFilterHpf2p:
+    case kFilterBpf2p:
+    case kFilterBrf2p:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void FilterBank::setupChannel(Channel& channel, FilterType type) noexcept
+{
+    ASSERT(supports(type));
+
+    // The numerators as (p0, p1, p2, p3, q1, q2), see `biquadVoiceBatch`
+    switch (type) {
+    case kFilterLpf2p:
+        channel.shape = {{ 0.0f, 1.0f, 0.0f, 0.0f, 2.0f, 0.0f }};
+        break;
+    case kFilterHpf2p:
+        channel.shape = {{ 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -2.0f }};
+        break;
+    case kFilterBpf2p:
+        channel.shape = {{ 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f }};
+        break;
+    case kFilterBrf2p:
+        channel.shape = {{ 1.0f, 0.0f, 0.0f, 0.0f, 2.0f, -2.0f }};
+        break;
+    default:
+        channel.shape = {};
+        break;
+    }
+
+    channel.coeffs = {};
+    channel.memory = {};
+    channel.resonance = 0.0f;
+    channel.alphaScale = alphaScaleOf(0.0f);
+    channel.prepared = false;
+}
+
+FilterBank::FilterBank(unsigned capacity)
+    : capacity_(capacity)
+{
+    channels_.resize(capacity);
+    inputs_.resize(capacity);
+    outputs_.resize(capacity);
+    cutoffs_.resize(capacity);
+    resonances_.resize(capacity);
+
+    frameInputs_.resize(capacity);
+    frameOutputs_.resize(capacity);
+    halfOmegas_.resize(capacity);
+    alphaScales_.resize(capacity);
+    poles_.resize(capacity);
+    shapes_.resize(numShapes * capacity);
+    coeffs_.resize(numCoeffs * capacity);
+    memory_.resize(numMemory * capacity);
+
+    setSampleRate(config::defaultSampleRate);
+}
+
+void FilterBank::setSampleRate(float sampleRate) noexcept
+{
+    sampleRate_ = sampleRate;
+    smoothingPole_ = std::exp(-1000.0f / sampleRate);
+    // The Faust filters clamp the cutoff at 20 kHz; the bank also keeps it
+    // below Nyquist, where the coefficients are computed.
+    maxCutoff_ = min(20000.0f, 0.5f * sampleRate);
+}
+
+void FilterBank::add(Channel& channel, const float* input, float* output,
+    const float* cutoffs, const float* resonances) noexcept
+{
+    ASSERT(!full());
+
+    const unsigned index = size_++;
+    channels_[index] = &channel;
+    inputs_[index] = input;
+    outputs_[index] = output;
+    cutoffs_[index] = cutoffs;
+    resonances_[index] = resonances;
+}
+
+void FilterBank::process(unsigned numFrames) noexcept
+{
+    const unsigned numFilters = size_;
+    if (numFilters == 0 || numFrames == 0)
+        return;
+
+    // Gather the channels, with the filters of the bank as stride
+    for (unsigned v = 0; v < numFilters; ++v) {
+        const Channel& channel = *channels_[v];
+        for (unsigned k = 0; k < numShapes; ++k)
+            shapes_[k * numFilters + v] = channel.shape[k];
+        for (unsigned k = 0; k < numCoeffs; ++k)
+            coeffs_[k * numFilters + v] = channel.coeffs[k];
+        for (unsigned k = 0; k < numMemory; ++k)
+            memory_[k * numFilters + v] = channel.memory[k];
+    }
+
+    const float omegaFactor = pi<float>() / sampleRate_;
+    unsigned frame = 0;
+    while (frame < numFrames) {
+        const unsigned current = min(numFrames - frame, static_cast<unsigned>(config::filterControlInterval));
+
+        for (unsigned v = 0; v < numFilters; ++v) {
+            Channel& channel = *channels_[v];
+            halfOmegas_[v] = omegaFactor * clamp(cutoffs_[v][frame], 1.0f, maxCutoff_);
+
+            // The resonance seldom moves, so its scale is only updated on change
+            const float resonance = resonances_[v][frame];
+            if (resonance != channel.resonance) {
+                channel.resonance = resonance;
+                channel.alphaScale = alphaScaleOf(resonance);
+            }
+            alphaScales_[v] = channel.alphaScale;
+
+            // A new filter starts on its target coefficients
+            poles_[v] = channel.prepared ? smoothingPole_ : 0.0f;
+            channel.prepared = true;
+
+            frameInputs_[v] = inputs_[v] + frame;
+            frameOutputs_[v] = outputs_[v] + frame;
+        }
+
+        biquadVoiceBatch<float>(
+            frameInputs_.data(), frameOutputs_.data(), halfOmegas_.data(), alphaScales_.data(),
+            poles_.data(), shapes_.data(), coeffs_.data(), memory_.data(),
+            numFilters, numFilters, current);
+
+        frame += current;
+    }
+
+    // Scatter the states back to the channels
+    for (unsigned v = 0; v < numFilters; ++v) {
+        Channel& channel = *channels_[v];
+        for (unsigned k = 0; k < numCoeffs; ++k)
+            channel.coeffs[k] = coeffs_[k * numFilters + v];
+        for (unsigned k = 0; k < numMemory; ++k)
+            channel.memory[k] = memory_[k * numFilters + v];
+    }
+}
+
+} // namespace sfz
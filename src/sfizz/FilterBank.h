@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#pragma once
+#include "Config.h"
+#include "SfzFilter.h"
+#include "utility/LeakDetector.h"
+#include <array>
+#include <vector>
+
+namespace sfz {
+
+/**
+ * @brief A bank of mono 2-pole filters, which processes the filters of
+ * several voices at once.
+ *
+ * The bank covers the RBJ 2-pole low-pass, high-pass, band-pass and
+ * band-reject filters. These only differ by the numerators of their
+ * coefficients, so voices of any of these types share the SIMD lanes.
+ * As in the Faust filters, the coefficients are computed every
+ * `config::filterControlInterval` frames, and smoothed at each frame; the
+ * bank computes them for 4 or 8 voices at once, and runs the filters in
+ * single precision.
+ *
+ * The state of each filter lives in a channel owned by its voice, so that a
+ * voice can be filtered in a different bank, or alone, from block to block.
+ */
+class FilterBank {
+public:
+    // The numerators, coefficients and past values of a filter
+    static constexpr unsigned numShapes = 6;
+    static constexpr unsigned numCoeffs = 5;
+    static constexpr unsigned numMemory = 4;
+
+    /**
+     * @brief The state of a filter, kept by its voice between the blocks.
+     */
+    struct Channel {
+        std::array<float, numShapes> shape {};
+        std::array<float, numCoeffs> coeffs {};
+        std::array<float, numMemory> memory {};
+        float resonance { 0.0f };
+        float alphaScale { 0.5f };
+        bool prepared { false };
+    };
+
+    /**
+     * @brief Check whether a filter type can be processed in a bank.
+     *
+     * @param type
+     */
+    static bool supports(FilterType type) noexcept;
+    /**
+     * @brief Setup a channel for a filter type, and clear its state.
+     *
+     * @param channel
+     * @param type a type which the bank supports
+     */
+    static void setupChannel(Channel& channel, FilterType type) noexcept;
+
+    /**
+     * @brief Construct a bank for a number of filters.
+     *
+     * @param capacity
+     */
+    explicit FilterBank(unsigned capacity = config::voiceBatchSize);
+    /**
+     * @brief Set the sample rate of the filters.
+     *
+     * @param sampleRate
+     */
+    void setSampleRate(float sampleRate) noexcept;
+    /**
+     * @brief Remove all the filters.
+     */
+    void clear() noexcept { size_ = 0; }
+    unsigned size() const noexcept { return size_; }
+    unsigned capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+    bool full() const noexcept { return size_ == capacity_; }
+    /**
+     * @brief Add a filter to the bank. The bank must not be full, and the
+     * buffers must stay valid until the bank is processed.
+     *
+     * @param channel the state of the filter
+     * @param input the input of the filter
+     * @param output the output of the filter, which may be the input
+     * @param cutoffs the cutoffs of the filter for each frame, in Hz
+     * @param resonances the resonances of the filter for each frame, in dB
+     */
+    void add(Channel& channel, const float* input, float* output,
+        const float* cutoffs, const float* resonances) noexcept;
+    /**
+     * @brief Process the filters of the bank.
+     *
+     * @param numFrames
+     */
+    void process(unsigned numFrames) noexcept;
+
+private:
+    unsigned capacity_ { 0 };
+    unsigned size_ { 0 };
+    float sampleRate_ { config::defaultSampleRate };
+    float smoothingPole_ { 0.0f };
+    float maxCutoff_ { 0.0f };
+
+    std::vector<Channel*> channels_;
+    std::vector<const float*> inputs_;
+    std::vector<float*> outputs_;
+    std::vector<const float*> cutoffs_;
+    std::vector<const float*> resonances_;
+
+    // Structure of arrays of the filters, in the order of the bank
+    std::vector<const float*> frameInputs_;
+    std::vector<float*> frameOutputs_;
+    std::vector<float> halfOmegas_;
+    std::vector<float> alphaScales_;
+    std::vector<float> poles_;
+    std::vector<float> shapes_;
+    std::vector<float> coeffs_;
+    std::vector<float> memory_;
+    LEAK_DETECTOR(FilterBank);
+};
+
+} // namespace sfz
@@ -1,6 +1,7 @@
 #include "FilterPool.h"
 #include "Region.h"
 #include "Resources.h"
+#include "SynthConfig.h"
 #include "BufferPool.h"
 #include "SIMDHelpers.h"
 #include "utility/SwapAndPop.h"
@@ -13,11 +14,14 @@ sfz::FilterHolder::FilterHolder(Resources& resources)
 {
     filter = absl::make_unique<Filter>();
     filter->init(config::defaultSampleRate);
+    bank = absl::make_unique<FilterBank>(1);
 }
 
 void sfz::FilterHolder::reset()
 {
     filter->clear();
+    if (banked)
+        FilterBank::setupChannel(bankChannel, description->type);
     prepared = false;
 }
 
@@ -29,6 +33,14 @@ void sfz::FilterHolder::setup(const Region& region, unsigned filterId, int noteN
     this->description = &region.filters[filterId];
     filter->setType(description->type);
     filter->setChannels(region.isStereo() ? 2 : 1);
+    filter->setCoefficientTables(resources.getSynthConfig().filterCoefficientTables
+        ? &resources.getFilterTables() : nullptr);
+
+    // Mono filters which a bank supports run in banks, in voice batches or alone
+    banked = resources.getSynthConfig().filterBanks && !region.isStereo()
+        && FilterBank::supports(description->type);
+    if (banked)
+        FilterBank::setupChannel(bankChannel, description->type);
 
     // Setup the base values
     baseCutoff = description->cutoff;
@@ -72,7 +84,6 @@ void sfz::FilterHolder::process(const float** inputs, float** outputs, unsigned
         return;
     }
 
-    ModMatrix& mm = resources.getModMatrix();
     BufferPool& bufferPool = resources.getBufferPool();
     auto cutoffSpan = bufferPool.getBuffer(numFrames);
     auto resonanceSpan = bufferPool.getBuffer(numFrames);
@@ -81,20 +92,15 @@ void sfz::FilterHolder::process(const float** inputs, float** outputs, unsigned
     if (!cutoffSpan || !resonanceSpan || !gainSpan)
         return;
 
-    fill<float>(*cutoffSpan, baseCutoff);
-    if (float* mod = mm.getModulation(cutoffTarget)) {
-        for (size_t i = 0; i < numFrames; ++i)
-            (*cutoffSpan)[i] *= centsFactor(mod[i]);
+    if (banked) {
+        computeParameters(*cutoffSpan, *resonanceSpan, {});
+        bank->clear();
+        bank->add(bankChannel, inputs[0], outputs[0], cutoffSpan->data(), resonanceSpan->data());
+        bank->process(numFrames);
+        return;
     }
-    sfz::clampAll(*cutoffSpan, Default::filterCutoff.bounds);
-
-    fill<float>(*resonanceSpan, baseResonance);
-    if (float* mod = mm.getModulation(resonanceTarget))
-        add<float>(absl::Span<float>(mod, numFrames), *resonanceSpan);
 
-    fill<float>(*gainSpan, baseGain);
-    if (float* mod = mm.getModulation(gainTarget))
-        add<float>(absl::Span<float>(mod, numFrames), *gainSpan);
+    computeParameters(*cutoffSpan, *resonanceSpan, *gainSpan);
 
     if (!prepared) {
         filter->prepare(cutoffSpan->front(), resonanceSpan->front(), gainSpan->front());
@@ -112,7 +118,36 @@ void sfz::FilterHolder::process(const float** inputs, float** outputs, unsigned
 }
 
 
+void sfz::FilterHolder::computeParameters(absl::Span<float> cutoffs, absl::Span<float> resonances, absl::Span<float> gains)
+{
+    ASSERT(description != nullptr);
+    ASSERT(resonances.size() == cutoffs.size());
+    ASSERT(gains.empty() || gains.size() == cutoffs.size());
+
+    ModMatrix& mm = resources.getModMatrix();
+    const size_t numFrames = cutoffs.size();
+
+    fill<float>(cutoffs, baseCutoff);
+    if (float* mod = mm.getModulation(cutoffTarget)) {
+        for (size_t i = 0; i < numFrames; ++i)
+            cutoffs[i] *= centsFactor(mod[i]);
+    }
+    sfz::clampAll(cutoffs, Default::filterCutoff.bounds);
+
+    fill<float>(resonances, baseResonance);
+    if (float* mod = mm.getModulation(resonanceTarget))
+        add<float>(absl::Span<float>(mod, numFrames), resonances);
+
+    if (gains.empty())
+        return;
+
+    fill<float>(gains, baseGain);
+    if (float* mod = mm.getModulation(gainTarget))
+        add<float>(absl::Span<float>(mod, numFrames), gains);
+}
+
 void sfz::FilterHolder::setSampleRate(float sampleRate)
 {
     filter->init(static_cast<double>(sampleRate));
+    bank->setSampleRate(sampleRate);
 }
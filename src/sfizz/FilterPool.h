@@ -1,5 +1,6 @@
 #pragma once
 #include "SfzFilter.h"
+#include "FilterBank.h"
 #include "Defaults.h"
 #include "modulations/ModMatrix.h"
 #include <vector>
@@ -32,6 +33,23 @@ public:
      * @param numFrames
      */
     void process(const float** inputs, float** outputs, unsigned numFrames);
+    /**
+     * @brief Compute the modulated parameters of the filter for a block
+     *
+     * @param cutoffs   the cutoffs in Hz
+     * @param resonances the resonances in dB
+     * @param gains     the gains in dB, or an empty span if not needed
+     */
+    void computeParameters(absl::Span<float> cutoffs, absl::Span<float> resonances, absl::Span<float> gains);
+    /**
+     * @brief Check whether the filter runs in a filter bank rather than
+     * on a Faust filter. This is decided on setup.
+     */
+    bool isBanked() const noexcept { return banked; }
+    /**
+     * @brief The state of the filter in a filter bank
+     */
+    FilterBank::Channel& getBankChannel() noexcept { return bankChannel; }
     /**
      * @brief Set the sample rate for a filter
      *
@@ -46,6 +64,9 @@ private:
     Resources& resources;
     const FilterDescription* description;
     std::unique_ptr<Filter> filter;
+    std::unique_ptr<FilterBank> bank;
+    FilterBank::Channel bankChannel;
+    bool banked { false };
     float baseCutoff { Default::filterCutoff };
     float baseResonance { Default::filterResonance };
     float baseGain { Default::filterGain };
@@ -63,6 +63,28 @@ void initializeInterpolators();
 template <InterpolatorModel M, class R>
 R interpolate(const R* values, R coeff);
 
+/**
+ * @brief Interpolate a block of mono or stereo frames, if the model is a
+ * windowed-sinc. This uses the SIMD dispatch, and computes the sinc kernel
+ * once for both channels.
+ *
+ * @tparam M the interpolator model
+ * @param inputLeft the left or mono source
+ * @param inputRight the right source, or null if mono
+ * @param outputLeft
+ * @param outputRight the right output, or null if mono
+ * @param indices the integral parts of the source positions
+ * @param coeffs the fractional parts of the source positions
+ * @param addingGains gains to add the interpolated frames to the outputs,
+ *                    or null to replace the outputs
+ * @param size the number of frames to output
+ * @return true if the model is a windowed-sinc and the block was processed
+ */
+template <InterpolatorModel M>
+bool interpolateSincBlock(const float* inputLeft, const float* inputRight,
+    float* outputLeft, float* outputRight, const int* indices, const float* coeffs,
+    const float* addingGains, unsigned size) noexcept;
+
 } // namespace sfz
 
 #include "Interpolators.hpp"
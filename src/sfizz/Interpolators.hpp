@@ -8,6 +8,7 @@
 #include "WindowedSinc.h"
 #include "MathHelpers.h"
 #include "SIMDConfig.h"
+#include "SIMDHelpers.h"
 #include <simde/simde-features.h>
 #if SIMDE_NATURAL_VECTOR_SIZE_GE(128)
 #include <simde/x86/sse.h>
@@ -249,4 +250,61 @@ class Interpolator<kInterpolatorSinc60, R> : public SincInterpolator<R, 60> {};
 template <class R>
 class Interpolator<kInterpolatorSinc72, R> : public SincInterpolator<R, 72> {};
 
+//------------------------------------------------------------------------------
+// Windowed sinc, blocks of frames
+
+template <size_t Points>
+class SincBlockInterpolator
+{
+public:
+    static inline bool process(const float* inputLeft, const float* inputRight,
+        float* outputLeft, float* outputRight, const int* indices, const float* coeffs,
+        const float* addingGains, unsigned size) noexcept
+    {
+        const auto &ws = *SincInterpolatorTraits<Points>::windowedSinc;
+        sincInterpolation<float>(ws.getTablePointer(), ws.getTableSize(), Points,
+            inputLeft, inputRight, outputLeft, outputRight, indices, coeffs, addingGains, size);
+        return true;
+    }
+};
+
+template <>
+class SincBlockInterpolator<0>
+{
+public:
+    static inline bool process(const float*, const float*, float*, float*,
+        const int*, const float*, const float*, unsigned) noexcept
+    {
+        return false;
+    }
+};
+
+template <InterpolatorModel M>
+struct SincInterpolatorPoints { enum { value = 0 }; };
+template <>
+struct SincInterpolatorPoints<kInterpolatorSinc8> { enum { value = 8 }; };
+template <>
+struct SincInterpolatorPoints<kInterpolatorSinc12> { enum { value = 12 }; };
+template <>
+struct SincInterpolatorPoints<kInterpolatorSinc16> { enum { value = 16 }; };
+template <>
+struct SincInterpolatorPoints<kInterpolatorSinc24> { enum { value = 24 }; };
+template <>
+struct SincInterpolatorPoints<kInterpolatorSinc36> { enum { value = 36 }; };
+template <>
+struct SincInterpolatorPoints<kInterpolatorSinc48> { enum { value = 48 }; };
+template <>
+struct SincInterpolatorPoints<kInterpolatorSinc60> { enum { value = 60 }; };
+template <>
+struct SincInterpolatorPoints<kInterpolatorSinc72> { enum { value = 72 }; };
+
+template <InterpolatorModel M>
+inline bool interpolateSincBlock(const float* inputLeft, const float* inputRight,
+    float* outputLeft, float* outputRight, const int* indices, const float* coeffs,
+    const float* addingGains, unsigned size) noexcept
+{
+    return SincBlockInterpolator<SincInterpolatorPoints<M>::value>::process(
+        inputLeft, inputRight, outputLeft, outputRight, indices, coeffs, addingGains, size);
+}
+
 } // namespace sfz
@@ -46,6 +46,19 @@ bool Layer::isSwitchedOn() const noexcept
     return keySwitched_ && previousKeySwitched_ && sequenceSwitched_ && pitchSwitched_ && bpmSwitched_ && aftertouchSwitched_ && ccSwitched_.all();
 }
 
+void Layer::advanceSequence() noexcept
+{
+    const Region& region = region_;
+    sequenceSwitched_ =
+        ((sequenceCounter_++ % region.sequenceLength) == region.sequencePosition - 1);
+}
+
+bool Layer::tracksSequence() const noexcept
+{
+    const Region& region = region_;
+    return region.usesSequenceSwitches || region.sequenceLength != 1 || region.sequencePosition != 1;
+}
+
 bool Layer::registerNoteOn(int noteNumber, float velocity, float randValue) noexcept
 {
     ASSERT(velocity >= 0.0f && velocity <= 1.0f);
@@ -53,11 +66,8 @@ bool Layer::registerNoteOn(int noteNumber, float velocity, float randValue) noex
     const Region& region = region_;
 
     const bool keyOk = region.keyRange.containsWithEnd(noteNumber);
-    if (keyOk) {
-        // Sequence activation
-        sequenceSwitched_ =
-            ((sequenceCounter_++ % region.sequenceLength) == region.sequencePosition - 1);
-    }
+    if (keyOk)
+        advanceSequence();
 
     const bool polyAftertouchActive =
         region.polyAftertouchRange.containsWithEnd(midiState_.getPolyAftertouch(noteNumber));
@@ -80,6 +90,26 @@ bool Layer::registerNoteOn(int noteNumber, float velocity, float randValue) noex
     return keyOk && velOk && randOk && (attackTrigger || firstLegatoNote || notFirstLegatoNote);
 }
 
+bool Layer::isLikelyNext(int noteNumber, float velocity) const noexcept
+{
+    const Region& region = region_;
+
+    if (!region.triggerOnNote || region.isGenerator())
+        return false;
+
+    if (!region.keyRange.containsWithEnd(noteNumber) || !region.velocityRange.containsWithEnd(velocity))
+        return false;
+
+    if (!(keySwitched_ && previousKeySwitched_ && pitchSwitched_ && bpmSwitched_ && aftertouchSwitched_ && ccSwitched_.all()))
+        return false;
+
+    // The note off does not advance the sequence, but the next note on does
+    if (region.trigger == Trigger::release || region.trigger == Trigger::release_key)
+        return sequenceSwitched_;
+
+    return (sequenceCounter_ % region.sequenceLength) == region.sequencePosition - 1;
+}
+
 bool Layer::registerNoteOff(int noteNumber, float velocity, float randValue) noexcept
 {
     ASSERT(velocity >= 0.0f && velocity <= 1.0f);
@@ -159,8 +189,7 @@ bool Layer::registerCC(int ccNumber, float ccValue, bool dontTrigger) noexcept
         if (!triggerRange->containsWithEnd(ccValue))
             return false;
 
-        sequenceSwitched_ =
-            ((sequenceCounter_++ % region.sequenceLength) == region.sequencePosition - 1);
+        advanceSequence();
         if (isSwitchedOn())
             return true;
     }
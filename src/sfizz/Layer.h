@@ -55,6 +55,16 @@ public:
      * @return false
      */
     bool isSwitchedOn() const noexcept;
+    /**
+     * @brief Advance the round-robin sequence, as done by a note on event
+     * which falls in the key range.
+     */
+    void advanceSequence() noexcept;
+    /**
+     * @brief Does the sequence activation depend on the number of events?
+     * If not, `advanceSequence` can be skipped.
+     */
+    bool tracksSequence() const noexcept;
     /**
      * @brief Register a new note on event. The region may be switched on or off using keys so
      * this function updates the keyswitches state.
@@ -67,6 +77,16 @@ public:
      * @return false
      */
     bool registerNoteOn(int noteNumber, float velocity, float randValue) noexcept;
+    /**
+     * @brief Check whether the region is likely to play on the next events
+     * of a note: the next note on for the attack regions, considering the
+     * round-robin sequence, and the note off for the release regions. The
+     * random ranges are not considered.
+     *
+     * @param noteNumber
+     * @param velocity
+     */
+    bool isLikelyNext(int noteNumber, float velocity) const noexcept;
     /**
      * @brief Register a new note off event. The region may be switched on or off using keys so
      * this function updates the keyswitches state.
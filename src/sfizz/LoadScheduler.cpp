@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "LoadScheduler.h"
+#include "FilePool.h"
+#include "utility/Debug.h"
+#include <algorithm>
+
+namespace sfz {
+
+constexpr size_t LoadScheduler::maxFileRequests;
+constexpr size_t LoadScheduler::capacity;
+
+namespace {
+
+// Orders the heap with the earliest deadline on top, then the oldest request
+bool isLessUrgent(const LoadScheduler::Request& lhs, const LoadScheduler::Request& rhs) noexcept
+{
+    if (lhs.deadline != rhs.deadline)
+        return lhs.deadline > rhs.deadline;
+    return lhs.queuedTime > rhs.queuedTime;
+}
+
+} // namespace
+
+LoadScheduler::LoadScheduler(FilePool& filePool, unsigned numWorkers)
+    : filePool_(filePool), submitted_(alignedNew<RequestQueue>())
+{
+    heap_.reserve(capacity);
+    workers_.reserve(numWorkers);
+    for (unsigned i = 0; i < numWorkers; ++i)
+        workers_.emplace_back(&LoadScheduler::workerJob, this);
+}
+
+LoadScheduler::~LoadScheduler()
+{
+    running_ = false;
+    std::error_code ec;
+    for (size_t i = 0; i < workers_.size(); ++i)
+        barrier_.post(ec);
+    for (std::thread& worker : workers_)
+        worker.join();
+}
+
+bool LoadScheduler::submit(Request request) noexcept
+{
+    const bool isFile = request.type != Request::Type::Stream;
+    if (isFile && numPendingFiles_.fetch_add(1) >= maxFileRequests) {
+        numPendingFiles_.fetch_sub(1);
+        return false;
+    }
+
+    // Count the request before queuing it, so waiting for idle does not miss it
+    const size_t numPending = numPending_.fetch_add(1) + 1;
+    const bool pushed = submitted_->try_push(std::move(request));
+    ASSERT(pushed);
+    (void)pushed;
+
+    size_t maxPending = maxPending_.load(std::memory_order_relaxed);
+    while (numPending > maxPending && !maxPending_.compare_exchange_weak(maxPending, numPending, std::memory_order_relaxed))
+        ;
+
+    std::error_code ec;
+    barrier_.post(ec);
+    ASSERT(!ec);
+    return true;
+}
+
+void LoadScheduler::waitForIdle() noexcept
+{
+    std::unique_lock<std::mutex> lock { idleMutex_ };
+    idle_.wait(lock, [this]() { return numPending_.load() == 0; });
+}
+
+bool LoadScheduler::takeMostUrgent(Request& request) noexcept
+{
+    std::lock_guard<std::mutex> guard { heapMutex_ };
+
+    Request submitted;
+    while (submitted_->try_pop(submitted)) {
+        heap_.push_back(std::move(submitted));
+        std::push_heap(heap_.begin(), heap_.end(), isLessUrgent);
+    }
+
+    if (heap_.empty())
+        return false;
+
+    std::pop_heap(heap_.begin(), heap_.end(), isLessUrgent);
+    request = std::move(heap_.back());
+    heap_.pop_back();
+    return true;
+}
+
+void LoadScheduler::workerJob() noexcept
+{
+    FilePool::raiseCurrentThreadPriority();
+
+    // Every submission posts once, so the requests never outnumber the posts
+    while (barrier_.wait(), running_) {
+        Request request;
+        if (!takeMostUrgent(request))
+            continue;
+
+        if (request.deadline < std::chrono::high_resolution_clock::now())
+            numDeadlineMisses_.fetch_add(1, std::memory_order_relaxed);
+
+        filePool_.runRequest(request);
+
+        if (request.type != Request::Type::Stream)
+            numPendingFiles_.fetch_sub(1);
+
+        if (numPending_.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock { idleMutex_ };
+            idle_.notify_all();
+        }
+    }
+}
+
+} // namespace sfz
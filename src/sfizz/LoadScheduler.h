@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#pragma once
+#include "Config.h"
+#include "RTSemaphore.h"
+#include "utility/LeakDetector.h"
+#include "utility/MemoryHelpers.h"
+#include <atomic_queue/atomic_queue.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sfz {
+class FilePool;
+class FileStream;
+struct FileData;
+struct FileId;
+
+/**
+ * @brief Runs the background jobs of a file pool, the most urgent first.
+ *
+ * The audio thread submits the requests to a bounded lock-free queue, and
+ * never blocks. The workers move the submitted requests into a heap ordered
+ * by deadline, and run the earliest one. Once built, the scheduler does not
+ * allocate, and the number of requests in flight is bounded.
+ *
+ * Only the submission is lock-free. The workers share the one heap under a
+ * mutex, so that they always take the most urgent request of all; they hold
+ * it just to move the requests, never while running one. The idle waits of
+ * the non-realtime threads use a condition variable.
+ */
+class LoadScheduler {
+public:
+    using TimePoint = std::chrono::time_point<std::chrono::high_resolution_clock>;
+    // Each stream has one request in flight at most, so the streams always
+    // have room besides the files
+    static constexpr size_t maxFileRequests = 2 * config::maxVoices;
+    static constexpr size_t capacity = maxFileRequests + config::numFileStreams;
+
+    struct Request {
+        enum class Type : uint8_t { Load, Prediction, Stream, Eviction };
+        Type type { Type::Load };
+        std::weak_ptr<FileId> id;
+        FileData* data { nullptr };
+        FileStream* stream { nullptr };
+        TimePoint queuedTime {};
+        // When the voice runs out of data without the request
+        TimePoint deadline { TimePoint::max() };
+    };
+
+    /**
+     * @brief Start the workers.
+     *
+     * @param filePool the file pool which runs the requests
+     * @param numWorkers the number of worker threads
+     */
+    LoadScheduler(FilePool& filePool, unsigned numWorkers);
+
+    /**
+     * @brief Stop the workers, after the requests which are running.
+     * The requests which wait are dropped.
+     */
+    ~LoadScheduler();
+
+    LoadScheduler(const LoadScheduler&) = delete;
+    LoadScheduler& operator=(const LoadScheduler&) = delete;
+
+    /**
+     * @brief Submit a request. Called from the audio thread.
+     *
+     * @param request
+     * @return false if too many files are requested already
+     */
+    bool submit(Request request) noexcept;
+
+    /**
+     * @brief Wait until all the submitted requests have run.
+     */
+    void waitForIdle() noexcept;
+
+    /**
+     * @brief Get the number of requests submitted and not finished.
+     */
+    size_t getNumPending() const noexcept { return numPending_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the largest number of requests in flight at once.
+     */
+    size_t getMaxPending() const noexcept { return maxPending_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the number of requests which started past their deadline.
+     */
+    uint64_t getNumDeadlineMisses() const noexcept { return numDeadlineMisses_.load(std::memory_order_relaxed); }
+
+private:
+    void workerJob() noexcept;
+    bool takeMostUrgent(Request& request) noexcept;
+
+    FilePool& filePool_;
+
+    using RequestQueue = atomic_queue::AtomicQueue2<Request, capacity>;
+    aligned_unique_ptr<RequestQueue> submitted_;
+    std::atomic<size_t> numPending_ { 0 };
+    std::atomic<size_t> numPendingFiles_ { 0 };
+    std::atomic<size_t> maxPending_ { 0 };
+    std::atomic<uint64_t> numDeadlineMisses_ { 0 };
+
+    // Workers only, shared to keep a single order of urgency
+    std::mutex heapMutex_;
+    std::vector<Request> heap_;
+
+    std::mutex idleMutex_;
+    std::condition_variable idle_;
+
+    volatile bool running_ { true };
+    RTSemaphore barrier_;
+    std::vector<std::thread> workers_;
+    LEAK_DETECTOR(LoadScheduler);
+};
+
+} // namespace sfz
@@ -101,6 +101,8 @@ sfz::Logger::~Logger()
 
 void sfz::Logger::logCallbackTime(const CallbackBreakdown& breakdown, int numVoices, size_t numSamples)
 {
+    telemetry.recordBlock(breakdown, numVoices, numSamples);
+
     if (!loggingEnabled)
         return;
 
@@ -113,6 +115,8 @@ void sfz::Logger::logCallbackTime(const CallbackBreakdown& breakdown, int numVoi
 
 void sfz::Logger::logFileTime(std::chrono::duration<double> waitDuration, std::chrono::duration<double> loadDuration, uint32_t fileSize, absl::string_view filename)
 {
+    telemetry.recordFileLoad(waitDuration, loadDuration);
+
     if (!loggingEnabled)
         return;
 
@@ -6,6 +6,7 @@
 
 #pragma once
 #include "Config.h"
+#include "Telemetry.h"
 #include "utility/LeakDetector.h"
 #include "utility/MemoryHelpers.h"
 #include <atomic_queue/atomic_queue.h>
@@ -108,7 +109,8 @@ public:
     void disableLogging();
 
     /**
-     * @brief Logs the callback duration, with breakdown per operations
+     * @brief Logs the callback duration, with breakdown per operations.
+     * The telemetry is always updated; the CSV log only if logging is enabled.
      *
      * @param breakdown The different timings for the callback
      * @param numVoices The number of active voices
@@ -117,7 +119,8 @@ public:
     void logCallbackTime(const CallbackBreakdown& breakdown, int numVoices, size_t numSamples);
 
     /**
-     * @brief Log a file loading and waiting duration
+     * @brief Log a file loading and waiting duration.
+     * The telemetry is always updated; the CSV log only if logging is enabled.
      *
      * @param waitDuration The time spent waiting before loading the file
      * @param loadDuration The time it took to load the file
@@ -125,6 +128,12 @@ public:
      * @param filename The file name
      */
     void logFileTime(Duration waitDuration, Duration loadDuration, uint32_t fileSize, absl::string_view filename);
+
+    /**
+     * @brief Get the realtime telemetry, which can be read at any time
+     */
+    Telemetry& getTelemetry() noexcept { return telemetry; }
+    const Telemetry& getTelemetry() const noexcept { return telemetry; }
 private:
     /**
      * @brief Move all events from the real time queues to the non-realtime vectors
@@ -132,6 +141,7 @@ private:
     void moveEvents() noexcept;
     bool loggingEnabled { config::loggingEnabled };
     std::string prefix { "" };
+    Telemetry telemetry;
 
     using CallbackTimeQueue = atomic_queue::AtomicQueue2<CallbackTime, config::loggerQueueSize, true, true, false, true>;
     using FileTimeQueue = atomic_queue::AtomicQueue2<FileTime, config::loggerQueueSize, true, true, false, true>;
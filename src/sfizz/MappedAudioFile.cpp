@@ -0,0 +1,368 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "MappedAudioFile.h"
+#include "Config.h"
+#include "utility/Debug.h"
+#include "utility/SwapAndPop.h"
+#include <absl/algorithm/container.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sfz {
+
+namespace {
+
+std::atomic<size_t> mappedBytesCounter { 0 };
+std::mutex mappedFilesMutex;
+std::vector<const MappedAudioFile*> mappedFiles;
+
+#if defined(_WIN32)
+struct HandleCloser {
+    ~HandleCloser() { if (handle && handle != INVALID_HANDLE_VALUE) CloseHandle(handle); }
+    HANDLE handle { nullptr };
+};
+#else
+struct FdCloser {
+    ~FdCloser() { if (fd != -1) ::close(fd); }
+    int fd { -1 };
+};
+#endif
+
+uint16_t readU16le(const unsigned char* p) { return p[0] | (p[1] << 8); }
+uint32_t readU32le(const unsigned char* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24); }
+
+bool hostIsLittleEndian()
+{
+    const uint16_t value = 1;
+    unsigned char bytes[2];
+    std::memcpy(bytes, &value, 2);
+    return bytes[0] == 1;
+}
+
+struct FloatDataLocation {
+    uint64_t offset { 0 };
+    size_t size { 0 };
+    unsigned numChannels { 0 };
+};
+
+/**
+ * @brief Locate the frames of a 32-bit float WAV file with 1 or 2 channels.
+ *
+ * @param read a function which copies a range of the file, or returns false
+ * @param fileSize
+ * @param location
+ */
+template <class Reader>
+bool findFloatData(const Reader& read, uint64_t fileSize, FloatDataLocation& location)
+{
+    unsigned char header[12];
+    if (!read(header, 12, 0))
+        return false;
+    if (std::memcmp(header, "RIFF", 4) != 0 || std::memcmp(header + 8, "WAVE", 4) != 0)
+        return false;
+
+    unsigned numChannels = 0;
+    uint64_t offset = 12;
+    while (offset + 8 <= fileSize) {
+        unsigned char chunkHeader[8];
+        if (!read(chunkHeader, 8, offset))
+            return false;
+
+        const uint32_t chunkSize = readU32le(chunkHeader + 4);
+        const uint64_t chunkData = offset + 8;
+
+        if (std::memcmp(chunkHeader, "fmt ", 4) == 0) {
+            unsigned char fmt[26] {};
+            const size_t fmtSize = std::min<size_t>(chunkSize, sizeof(fmt));
+            if (fmtSize < 16 || !read(fmt, fmtSize, chunkData))
+                return false;
+
+            uint16_t formatTag = readU16le(fmt);
+            const uint16_t channels = readU16le(fmt + 2);
+            const uint16_t bitsPerSample = readU16le(fmt + 14);
+            if (formatTag == 0xfffe && fmtSize >= 26) // WAVE_FORMAT_EXTENSIBLE
+                formatTag = readU16le(fmt + 24);
+
+            if (formatTag != 3 || channels < 1 || channels > 2 || bitsPerSample != 32)
+                return false;
+
+            numChannels = channels;
+        }
+        else if (std::memcmp(chunkHeader, "data", 4) == 0) {
+            if (numChannels == 0 || chunkData > fileSize)
+                return false;
+
+            location.offset = chunkData;
+            location.size = static_cast<size_t>(std::min<uint64_t>(chunkSize, fileSize - chunkData));
+            location.numChannels = numChannels;
+            return true;
+        }
+
+        offset = chunkData + chunkSize + (chunkSize & 1);
+    }
+
+    return false;
+}
+
+} // namespace
+
+MappedAudioFile::~MappedAudioFile()
+{
+    close();
+}
+
+bool MappedAudioFile::open(const fs::path& path)
+{
+    close();
+
+    if (!hostIsLittleEndian())
+        return false;
+
+#if defined(_WIN32)
+    HandleCloser file;
+    file.handle = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file.handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file.handle, &size) || size.QuadPart <= 0
+        || static_cast<uint64_t>(size.QuadPart) > std::numeric_limits<size_t>::max())
+        return false;
+
+    // The view keeps the file mapped after its handles are closed
+    HandleCloser mappingObject;
+    mappingObject.handle = CreateFileMappingW(file.handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingObject.handle)
+        return false;
+
+    void* view = MapViewOfFile(mappingObject.handle, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+        return false;
+
+    char* base = static_cast<char*>(view);
+    const size_t fileSize = static_cast<size_t>(size.QuadPart);
+    const auto read = [base, fileSize](void* dest, size_t numBytes, uint64_t offset) {
+        if (offset > fileSize || numBytes > fileSize - offset)
+            return false;
+        std::memcpy(dest, base + offset, numBytes);
+        return true;
+    };
+
+    FloatDataLocation location;
+    if (!findFloatData(read, fileSize, location)) {
+        UnmapViewOfFile(view);
+        return false;
+    }
+
+    const size_t frameBytes = location.numChannels * sizeof(float);
+    const size_t numFrames = location.size / frameBytes;
+    if (numFrames == 0 || location.offset % sizeof(float) != 0) {
+        UnmapViewOfFile(view);
+        return false;
+    }
+
+    // Views cannot be surrounded with zeroed pages, the frames are read in windows
+    mapping_ = base;
+    mappingSize_ = fileSize;
+    data_ = reinterpret_cast<const float*>(base + location.offset);
+    numFrames_ = numFrames;
+    numChannels_ = location.numChannels;
+    padded_ = false;
+#else
+    FdCloser file;
+    file.fd = ::open(path.c_str(), O_RDONLY);
+    if (file.fd == -1)
+        return false;
+
+    struct stat st;
+    if (fstat(file.fd, &st) != 0)
+        return false;
+
+    const int fd = file.fd;
+    const auto read = [fd](void* dest, size_t numBytes, uint64_t offset) {
+        return pread(fd, dest, numBytes, static_cast<off_t>(offset)) == static_cast<ssize_t>(numBytes);
+    };
+
+    FloatDataLocation location;
+    if (!findFloatData(read, static_cast<uint64_t>(st.st_size), location))
+        return false;
+
+    const size_t dataOffset = static_cast<size_t>(location.offset);
+    const size_t frameBytes = location.numChannels * sizeof(float);
+    const size_t numFrames = location.size / frameBytes;
+    if (numFrames == 0 || dataOffset % sizeof(float) != 0)
+        return false;
+
+    // Layout of the mapping, with zeroed padding around the frames
+    //   [anonymous pages][file pages ... frames ...][anonymous pages]
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const auto roundUp = [pageSize](size_t x) { return (x + pageSize - 1) / pageSize * pageSize; };
+    const size_t padding = config::excessFileFrames * frameBytes;
+    const size_t dataBytes = numFrames * frameBytes;
+    const size_t fileMapStart = dataOffset / pageSize * pageSize;
+    const size_t fileMapSize = roundUp(dataOffset + dataBytes) - fileMapStart;
+    const size_t headBytes = dataOffset - fileMapStart;
+    const size_t tailBytes = fileMapSize - headBytes - dataBytes;
+    const size_t frontSize = (headBytes < padding) ? roundUp(padding - headBytes) : 0;
+    const size_t backSize = (tailBytes < padding) ? roundUp(padding - tailBytes) : 0;
+    const size_t mappingSize = frontSize + fileMapSize + backSize;
+
+    void* mapping = mmap(nullptr, mappingSize, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANON, -1, 0);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    char* base = static_cast<char*>(mapping);
+    void* fileMapping = mmap(base + frontSize, fileMapSize, PROT_READ|PROT_WRITE,
+        MAP_PRIVATE|MAP_FIXED, file.fd, static_cast<off_t>(fileMapStart));
+    if (fileMapping == MAP_FAILED) {
+        munmap(mapping, mappingSize);
+        return false;
+    }
+
+    // Clear the neighboring bytes of other chunks; this only copies the
+    // pages at the boundaries, the rest remains shared with the page cache.
+    char* frames = base + frontSize + headBytes;
+    const size_t headClear = std::min(headBytes, padding);
+    const size_t tailClear = std::min(tailBytes, padding);
+    std::memset(frames - headClear, 0, headClear);
+    std::memset(frames + dataBytes, 0, tailClear);
+
+    mprotect(mapping, mappingSize, PROT_READ);
+    madvise(frames - headBytes, fileMapSize, MADV_SEQUENTIAL);
+
+    mapping_ = base;
+    mappingSize_ = mappingSize;
+    data_ = reinterpret_cast<const float*>(frames);
+    numFrames_ = numFrames;
+    numChannels_ = location.numChannels;
+    padded_ = true;
+#endif
+
+    mappedBytesCounter += mappingSize_;
+    std::lock_guard<std::mutex> lock { mappedFilesMutex };
+    mappedFiles.push_back(this);
+    return true;
+}
+
+void MappedAudioFile::close() noexcept
+{
+    if (!mapping_)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock { mappedFilesMutex };
+        swapAndPopFirst(mappedFiles, [this](const MappedAudioFile* f) { return f == this; });
+    }
+    mappedBytesCounter -= mappingSize_;
+#if defined(_WIN32)
+    UnmapViewOfFile(mapping_);
+#else
+    munmap(mapping_, mappingSize_);
+#endif
+
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    data_ = nullptr;
+    numFrames_ = 0;
+    numChannels_ = 0;
+    padded_ = false;
+}
+
+void MappedAudioFile::readFrames(int64_t firstFrame, AudioSpan<float> dest) const noexcept
+{
+    const size_t numChannels = numChannels_;
+    const size_t destFrames = dest.getNumFrames();
+    ASSERT(dest.getNumChannels() >= numChannels);
+
+    // The part of the range which is inside the file
+    const int64_t fileFrames = static_cast<int64_t>(numFrames_);
+    const int64_t begin = std::max<int64_t>(0, std::min(firstFrame, fileFrames));
+    const int64_t end = std::max<int64_t>(0, std::min(firstFrame + static_cast<int64_t>(destFrames), fileFrames));
+
+    for (size_t c = 0; c < numChannels; ++c) {
+        float* output = dest.getChannel(c);
+        size_t i = 0;
+        for (; i < destFrames && firstFrame + static_cast<int64_t>(i) < begin; ++i)
+            output[i] = 0.0f;
+
+        const float* input = data_ + static_cast<size_t>(begin) * numChannels + c;
+        for (int64_t frame = begin; frame < end; ++frame, ++i, input += numChannels)
+            output[i] = *input;
+
+        for (; i < destFrames; ++i)
+            output[i] = 0.0f;
+    }
+}
+
+size_t MappedAudioFile::residentBytes() const noexcept
+{
+    if (!mapping_)
+        return 0;
+
+#if defined(_WIN32)
+    return 0;
+#else
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t numPages = mappingSize_ / pageSize;
+#if defined(__APPLE__)
+    std::vector<char> residency(numPages);
+#else
+    std::vector<unsigned char> residency(numPages);
+#endif
+    if (mincore(mapping_, mappingSize_, residency.data()) != 0)
+        return 0;
+
+    const size_t residentPages = absl::c_count_if(residency, [](unsigned char r) { return (r & 1) != 0; });
+    return residentPages * pageSize;
+#endif
+}
+
+void MappedAudioFile::willNeed(size_t firstFrame, size_t numFrames) const noexcept
+{
+    if (!data_ || firstFrame >= numFrames_)
+        return;
+
+#if !defined(_WIN32)
+    numFrames = std::min(numFrames, numFrames_ - firstFrame);
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const float* first = data_ + firstFrame * numChannels_;
+    const float* last = first + numFrames * numChannels_;
+    const uintptr_t start = reinterpret_cast<uintptr_t>(first) / pageSize * pageSize;
+    const uintptr_t end = reinterpret_cast<uintptr_t>(last);
+    madvise(reinterpret_cast<void*>(start), end - start, MADV_WILLNEED);
+#endif
+}
+
+size_t MappedAudioFile::totalMappedBytes() noexcept
+{
+    return mappedBytesCounter.load();
+}
+
+size_t MappedAudioFile::totalResidentBytes() noexcept
+{
+    std::lock_guard<std::mutex> lock { mappedFilesMutex };
+    size_t total = 0;
+    for (const MappedAudioFile* file : mappedFiles)
+        total += file->residentBytes();
+    return total;
+}
+
+} // namespace sfz
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#pragma once
+#include "AudioSpan.h"
+#include "utility/LeakDetector.h"
+#include <ghc/fs_std.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace sfz {
+
+/**
+ * @brief A read-only memory mapping of the sample frames of an audio file.
+ *
+ * Only the formats whose frames can be used as-is are supported, which are
+ * WAV files holding one or two interleaved channels of 32-bit float.
+ *
+ * On POSIX systems, the frames of a mono file are surrounded by zeroes in the
+ * same way as the padding of a FileAudioBuffer, so the interpolators can read
+ * them in place past the boundaries. Otherwise, e.g. for stereo files or on
+ * Windows, the frames are copied out in windows using `readFrames`.
+ *
+ * The page cache is responsible for the residency of the frames; the loading
+ * of a given range can be hinted using `willNeed`.
+ */
+class MappedAudioFile {
+public:
+    MappedAudioFile() = default;
+    ~MappedAudioFile();
+
+    MappedAudioFile(const MappedAudioFile&) = delete;
+    MappedAudioFile& operator=(const MappedAudioFile&) = delete;
+
+    /**
+     * @brief Map the frames of an audio file.
+     *
+     * @param path the path of the file
+     * @return true if the file was mapped, false if it could not be mapped
+     *         or if its format is not supported
+     */
+    bool open(const fs::path& path);
+
+    /**
+     * @brief Release the mapping.
+     */
+    void close() noexcept;
+
+    /**
+     * @brief Get the mapped frames, interleaved, or null if nothing is mapped.
+     */
+    const float* data() const noexcept { return data_; }
+
+    /**
+     * @brief Get the number of mapped frames.
+     */
+    size_t numFrames() const noexcept { return numFrames_; }
+
+    /**
+     * @brief Get the number of interleaved channels of the frames.
+     */
+    unsigned numChannels() const noexcept { return numChannels_; }
+
+    /**
+     * @brief Check whether the frames can be read in place as a mono span,
+     * with zeroed padding around them. Otherwise, they must be read using
+     * `readFrames`.
+     */
+    bool canReadInPlace() const noexcept { return data_ && numChannels_ == 1 && padded_; }
+
+    /**
+     * @brief Copy a range of frames out of the mapping, deinterleaving the
+     * channels. The frames outside of the file are read as zeroes.
+     *
+     * @param firstFrame the first frame to read, which may be negative
+     * @param dest the destination, with at least as many channels as the file
+     */
+    void readFrames(int64_t firstFrame, AudioSpan<float> dest) const noexcept;
+
+    /**
+     * @brief Get the size of the mapping in bytes.
+     */
+    size_t mappedBytes() const noexcept { return mappingSize_; }
+
+    /**
+     * @brief Get the number of mapped bytes which are currently in memory.
+     * This queries the operating system, do not call it on the audio thread.
+     * This is not reported on Windows.
+     */
+    size_t residentBytes() const noexcept;
+
+    /**
+     * @brief Hint the system that a range of frames is going to be read soon.
+     * This has no effect on Windows.
+     *
+     * @param firstFrame
+     * @param numFrames
+     */
+    void willNeed(size_t firstFrame, size_t numFrames) const noexcept;
+
+    /**
+     * @brief Get the total size in bytes of the mappings of the process.
+     */
+    static size_t totalMappedBytes() noexcept;
+
+    /**
+     * @brief Get the total number of mapped bytes of the process which are
+     * currently in memory. This queries the operating system, do not call it
+     * on the audio thread.
+     */
+    static size_t totalResidentBytes() noexcept;
+
+private:
+    char* mapping_ { nullptr };
+    size_t mappingSize_ { 0 };
+    const float* data_ { nullptr };
+    size_t numFrames_ { 0 };
+    unsigned numChannels_ { 0 };
+    bool padded_ { false };
+    LEAK_DETECTOR(MappedAudioFile);
+};
+
+} // namespace sfz
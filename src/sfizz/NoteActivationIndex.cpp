@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "NoteActivationIndex.h"
+#include "Layer.h"
+#include "Region.h"
+#include "MathHelpers.h"
+#include "utility/Debug.h"
+
+namespace sfz {
+
+constexpr unsigned NoteActivationIndex::numVelocityBuckets;
+
+unsigned NoteActivationIndex::velocityBucket(float velocity) noexcept
+{
+    const int bucket = static_cast<int>(velocity * (numVelocityBuckets - 1));
+    return static_cast<unsigned>(clamp<int>(bucket, 0, numVelocityBuckets - 1));
+}
+
+void NoteActivationIndex::clear() noexcept
+{
+    layers_.clear();
+    segments_.resize(1);
+    for (auto& indices : segmentIndices_)
+        indices.fill(0);
+}
+
+void NoteActivationIndex::build(const std::array<std::vector<Layer*>, 128>& noteActivationLists)
+{
+    clear();
+
+    // The bucket `b` holds the velocities between b/127 and (b+1)/127; the
+    // bounds are widened a bit so that rounding never drops a candidate
+    constexpr float bucketWidth = 1.0f / (numVelocityBuckets - 1);
+    constexpr float tolerance = 1e-4f;
+
+    struct BucketRange {
+        int first;
+        int last;
+    };
+    std::vector<BucketRange> ranges;
+
+    for (unsigned key = 0; key < 128; ++key) {
+        const std::vector<Layer*>& keyLayers = noteActivationLists[key];
+        if (keyLayers.empty())
+            continue;
+
+        ranges.resize(keyLayers.size());
+        std::array<bool, numVelocityBuckets + 1> boundaries {};
+        boundaries[0] = true;
+        boundaries[numVelocityBuckets] = true;
+
+        for (size_t i = 0; i < keyLayers.size(); ++i) {
+            const Region& region = keyLayers[i]->getRegion();
+            BucketRange& range = ranges[i];
+
+            if (region.velocityOverride == VelocityOverride::previous) {
+                range = { 0, int(numVelocityBuckets) - 1 };
+            } else {
+                range = { int(numVelocityBuckets), -1 };
+                for (int b = 0; b < int(numVelocityBuckets); ++b) {
+                    const float low = b * bucketWidth - tolerance;
+                    const float high = (b + 1) * bucketWidth + tolerance;
+                    if (region.velocityRange.getStart() <= high && region.velocityRange.getEnd() >= low) {
+                        range.first = min(range.first, b);
+                        range.last = b;
+                    }
+                }
+            }
+
+            if (range.first <= range.last) {
+                boundaries[range.first] = true;
+                boundaries[range.last + 1] = true;
+            }
+        }
+
+        unsigned first = 0;
+        while (first < numVelocityBuckets) {
+            unsigned last = first;
+            while (!boundaries[last + 1])
+                ++last;
+
+            Segment segment;
+            segment.layersBegin = static_cast<uint32_t>(layers_.size());
+            for (size_t i = 0; i < keyLayers.size(); ++i) {
+                if (ranges[i].first <= int(first) && int(first) <= ranges[i].last)
+                    layers_.push_back(keyLayers[i]);
+            }
+            segment.layersEnd = static_cast<uint32_t>(layers_.size());
+
+            segment.sequenceBegin = segment.layersEnd;
+            for (size_t i = 0; i < keyLayers.size(); ++i) {
+                const bool candidate = ranges[i].first <= int(first) && int(first) <= ranges[i].last;
+                if (!candidate && keyLayers[i]->tracksSequence())
+                    layers_.push_back(keyLayers[i]);
+            }
+            segment.sequenceEnd = static_cast<uint32_t>(layers_.size());
+
+            const auto segmentIndex = static_cast<uint16_t>(segments_.size());
+            segments_.push_back(segment);
+            for (unsigned b = first; b <= last; ++b)
+                segmentIndices_[key][b] = segmentIndex;
+
+            first = last + 1;
+        }
+    }
+
+    ASSERT(segments_.size() <= 128 * numVelocityBuckets + 1);
+}
+
+NoteActivationIndex::Candidates NoteActivationIndex::getCandidates(int noteNumber, float velocity) const noexcept
+{
+    ASSERT(noteNumber >= 0 && noteNumber < 128);
+    const Segment& segment = segments_[segmentIndices_[noteNumber][velocityBucket(velocity)]];
+
+    Candidates candidates;
+    candidates.layers = { layers_.data() + segment.layersBegin, segment.layersEnd - segment.layersBegin };
+    candidates.sequenceOnly = { layers_.data() + segment.sequenceBegin, segment.sequenceEnd - segment.sequenceBegin };
+    return candidates;
+}
+
+} // namespace sfz
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#pragma once
+#include "utility/LeakDetector.h"
+#include <absl/types/span.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace sfz {
+struct Layer;
+
+/**
+ * @brief An index of the layers which can start on a note on event, by key
+ * and by velocity bucket.
+ *
+ * The velocity range is split in 128 buckets. For each key, the buckets
+ * where the same layers are candidates are merged in segments, so the index
+ * stays small for the usual velocity-layered instruments.
+ *
+ * A segment lists the candidate layers, in their original order, whose
+ * velocity range overlaps the segment; these still need to be checked
+ * entirely. It also lists the other layers of the key which count note on
+ * events for round-robin sequences, and which only need to advance their
+ * sequence.
+ */
+class NoteActivationIndex {
+public:
+    static constexpr unsigned numVelocityBuckets = 128;
+
+    /**
+     * @brief Layers to process on a note on event.
+     */
+    struct Candidates {
+        absl::Span<Layer* const> layers;
+        absl::Span<Layer* const> sequenceOnly;
+    };
+
+    /**
+     * @brief Build the index.
+     *
+     * @param noteActivationLists the layers for each key, in order
+     */
+    void build(const std::array<std::vector<Layer*>, 128>& noteActivationLists);
+
+    /**
+     * @brief Clear the index.
+     */
+    void clear() noexcept;
+
+    /**
+     * @brief Get the layers to process on a note on event.
+     *
+     * @param noteNumber
+     * @param velocity the normalized velocity
+     */
+    Candidates getCandidates(int noteNumber, float velocity) const noexcept;
+
+    /**
+     * @brief Get the velocity bucket of a normalized velocity.
+     */
+    static unsigned velocityBucket(float velocity) noexcept;
+
+private:
+    struct Segment {
+        uint32_t layersBegin;
+        uint32_t layersEnd;
+        uint32_t sequenceBegin;
+        uint32_t sequenceEnd;
+    };
+
+    std::vector<Layer*> layers_;
+    std::vector<Segment> segments_ { Segment { 0, 0, 0, 0 } };
+    std::array<std::array<uint16_t, numVelocityBuckets>, 128> segmentIndices_ {};
+    LEAK_DETECTOR(NoteActivationIndex);
+};
+
+} // namespace sfz
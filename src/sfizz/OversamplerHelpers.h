@@ -48,3 +48,24 @@ template <int NC> using Downsampler2x = hiir::Downsampler2xFpu<NC>;
 #endif
 
 #include "OversamplerHelpers.hxx"
+
+#include <cmath>
+
+namespace sfz {
+
+/**
+ * @brief Get the duration, in frames at the base rate, for the ringing of a
+ * 2x oversampling stage built on `OSCoeffs2x` to decay below the silence
+ * level of the effect buses.
+ *
+ * The slowest pole of the allpass cascade sits at the radius sqrt(a) of the
+ * 2x rate for its largest coefficient a, which decays by a factor a per
+ * frame at the base rate.
+ */
+inline double oversampler2xRingFrames() noexcept
+{
+    const double slowestCoef = OSCoeffs2x[11];
+    return std::ceil(std::log(config::effectBusSilenceLevel) / std::log(slowestCoef));
+}
+
+} // namespace sfz
@@ -4,6 +4,7 @@
 sfz::PolyphonyGroup::PolyphonyGroup()
 {
     voices.reserve(config::maxVoices);
+    offByVoices.reserve(config::maxVoices);
 }
 
 void sfz::PolyphonyGroup::setPolyphonyLimit(unsigned limit) noexcept
@@ -25,6 +26,18 @@ void sfz::PolyphonyGroup::removeVoice(const Voice* voice) noexcept
 void sfz::PolyphonyGroup::removeAllVoices() noexcept
 {
     voices.clear();
+    offByVoices.clear();
+}
+
+void sfz::PolyphonyGroup::registerOffByVoice(Voice* voice) noexcept
+{
+    if (absl::c_find(offByVoices, voice) == offByVoices.end())
+        offByVoices.push_back(voice);
+}
+
+void sfz::PolyphonyGroup::removeOffByVoice(const Voice* voice) noexcept
+{
+    swapAndPopFirst(offByVoices, [voice](const Voice* v) { return v == voice; });
 }
 
 unsigned sfz::PolyphonyGroup::numPlayingVoices() const noexcept
@@ -62,9 +62,30 @@ public:
      * @return std::vector<Voice*>&
      */
     std::vector<Voice*>& getActiveVoices() noexcept { return voices; }
+    /**
+     * @brief Register an active voice which is offed by this group,
+     * as its region has `off_by` set to it.
+     *
+     * @param voice
+     */
+    void registerOffByVoice(Voice* voice) noexcept;
+    /**
+     * @brief Remove a voice which is offed by this group.
+     * If the voice was not registered before, this has no effect.
+     *
+     * @param voice
+     */
+    void removeOffByVoice(const Voice* voice) noexcept;
+    /**
+     * @brief Get the active voices which are offed by this group
+     *
+     * @return const std::vector<Voice*>&
+     */
+    const std::vector<Voice*>& getOffByVoices() const noexcept { return offByVoices; }
 private:
     unsigned polyphonyLimit { config::maxVoices };
     std::vector<Voice*> voices;
+    std::vector<Voice*> offByVoices;
 };
 
 }
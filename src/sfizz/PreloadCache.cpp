@@ -0,0 +1,356 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "PreloadCache.h"
+#include "utility/Debug.h"
+#include "utility/StringViewHelpers.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sfz {
+
+namespace {
+
+constexpr char cacheMagic[8] = { 'S', 'F', 'Z', 'C', 'A', 'C', 'H', 'E' };
+constexpr uint32_t cacheVersion = 1;
+
+/**
+ * @brief Layout of the beginning of a cache file. It is followed by the path
+ * of the sample file, then by the frames of each channel, aligned on 4 bytes.
+ */
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t pathSize;
+    int64_t modificationTime;
+    uint64_t fileSize;
+    uint32_t reverse;
+    uint32_t preloadFrames;
+    uint32_t numFrames;
+    uint32_t numChannels;
+    int64_t end;
+    int64_t loopStart;
+    int64_t loopEnd;
+    double sampleRate;
+    int32_t rootKey;
+    uint32_t hasLoop;
+    uint32_t hasWavetable;
+    uint32_t wavetableTableSize;
+    int32_t wavetableCrossTableInterpolation;
+    uint32_t wavetableOneShot;
+};
+
+static_assert(std::is_trivially_copyable<CacheHeader>::value, "The header is written as-is");
+
+struct CacheKey {
+    std::string path;
+    int64_t modificationTime { 0 };
+    uint64_t fileSize { 0 };
+    bool reverse { false };
+};
+
+bool makeCacheKey(const fs::path& file, bool reverse, CacheKey& key)
+{
+    std::error_code ec;
+    const fs::path absolutePath = fs::absolute(file, ec);
+    if (ec)
+        return false;
+
+    key.fileSize = static_cast<uint64_t>(fs::file_size(file, ec));
+    if (ec)
+        return false;
+
+    key.modificationTime = static_cast<int64_t>(fs::last_write_time(file, ec).time_since_epoch().count());
+    if (ec)
+        return false;
+
+    key.path = absolutePath.u8string();
+    key.reverse = reverse;
+    return true;
+}
+
+fs::path cacheFilePath(const fs::path& directory, const CacheKey& key)
+{
+    uint64_t h = Fnv1aBasis;
+    for (char c : key.path)
+        h = hashByte(static_cast<uint8_t>(c), h);
+
+    const auto hashValue = [&h](uint64_t value) {
+        for (unsigned i = 0; i < 8; ++i)
+            h = hashByte(static_cast<uint8_t>(value >> (8 * i)), h);
+    };
+    hashValue(static_cast<uint64_t>(key.modificationTime));
+    hashValue(key.fileSize);
+    hashValue(key.reverse ? 1 : 0);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.sfzcache", static_cast<unsigned long long>(h));
+    return directory / name;
+}
+
+size_t framesOffset(size_t pathSize)
+{
+    return (sizeof(CacheHeader) + pathSize + 3) / 4 * 4;
+}
+
+/**
+ * @brief A read-only view on the contents of a cache file.
+ */
+class CacheFileView {
+public:
+    CacheFileView() = default;
+    CacheFileView(const CacheFileView&) = delete;
+    CacheFileView& operator=(const CacheFileView&) = delete;
+    ~CacheFileView()
+    {
+#if !defined(_WIN32)
+        if (data_)
+            munmap(const_cast<char*>(data_), size_);
+#endif
+    }
+
+    bool open(const fs::path& path)
+    {
+#if defined(_WIN32)
+        fs::ifstream stream(path, std::ios::binary);
+        if (!stream)
+            return false;
+        contents_.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        data_ = contents_.data();
+        size_ = contents_.size();
+        return size_ > 0;
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+
+        void* mapping = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+            return false;
+
+        data_ = static_cast<const char*>(mapping);
+        size_ = static_cast<size_t>(st.st_size);
+        return true;
+#endif
+    }
+
+    const char* data() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+
+private:
+    const char* data_ { nullptr };
+    size_t size_ { 0 };
+#if defined(_WIN32)
+    std::vector<char> contents_;
+#endif
+};
+
+} // namespace
+
+bool PreloadCache::setDirectory(const fs::path& directory)
+{
+    std::error_code ec;
+    if (!directory.empty() && !fs::is_directory(directory, ec)) {
+        fs::create_directories(directory, ec);
+        if (ec) {
+            DBG("[sfizz] Cannot create the preload cache directory " << directory << ": " << ec.message());
+            std::lock_guard<std::mutex> lock { directoryMutex_ };
+            directory_.clear();
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock { directoryMutex_ };
+    directory_ = directory;
+    return true;
+}
+
+fs::path PreloadCache::getDirectory() const
+{
+    std::lock_guard<std::mutex> lock { directoryMutex_ };
+    return directory_;
+}
+
+bool PreloadCache::loadInformation(const fs::path& file, bool reverse, FileInformation& information)
+{
+    return load(file, reverse, nullptr, information, nullptr);
+}
+
+bool PreloadCache::loadPreloadedData(const fs::path& file, bool reverse, uint32_t preloadFrames,
+    FileInformation& information, FileAudioBuffer& data)
+{
+    if (getDirectory().empty())
+        return false;
+
+    const bool hit = load(file, reverse, &preloadFrames, information, &data);
+    if (hit)
+        numHits_ += 1;
+    else
+        numMisses_ += 1;
+
+    return hit;
+}
+
+bool PreloadCache::load(const fs::path& file, bool reverse, const uint32_t* preloadFrames,
+    FileInformation& information, FileAudioBuffer* data)
+{
+    const fs::path directory = getDirectory();
+    if (directory.empty())
+        return false;
+
+    CacheKey key;
+    if (!makeCacheKey(file, reverse, key))
+        return false;
+
+    CacheFileView view;
+    if (!view.open(cacheFilePath(directory, key)) || view.size() < sizeof(CacheHeader))
+        return false;
+
+    CacheHeader header;
+    std::memcpy(&header, view.data(), sizeof(CacheHeader));
+
+    const bool valid = std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) == 0
+        && header.version == cacheVersion
+        && header.pathSize == key.path.size()
+        && header.modificationTime == key.modificationTime
+        && header.fileSize == key.fileSize
+        && header.reverse == (key.reverse ? 1u : 0u)
+        && (header.numChannels == 1 || header.numChannels == 2)
+        && view.size() >= framesOffset(header.pathSize) + size_t(header.numChannels) * header.numFrames * sizeof(float)
+        && std::memcmp(view.data() + sizeof(CacheHeader), key.path.data(), key.path.size()) == 0;
+    if (!valid)
+        return false;
+
+    if (preloadFrames && header.preloadFrames != *preloadFrames)
+        return false;
+
+    information = FileInformation {};
+    information.end = header.end;
+    information.loopStart = header.loopStart;
+    information.loopEnd = header.loopEnd;
+    information.hasLoop = header.hasLoop != 0;
+    information.sampleRate = header.sampleRate;
+    information.numChannels = static_cast<int>(header.numChannels);
+    information.rootKey = header.rootKey;
+    if (header.hasWavetable) {
+        WavetableInfo wavetable;
+        wavetable.tableSize = header.wavetableTableSize;
+        wavetable.crossTableInterpolation = header.wavetableCrossTableInterpolation;
+        wavetable.oneShot = header.wavetableOneShot != 0;
+        information.wavetable = wavetable;
+    }
+
+    if (data) {
+        data->reset();
+        data->addChannels(header.numChannels);
+        data->resize(header.numFrames);
+        data->clear();
+
+        const char* frames = view.data() + framesOffset(header.pathSize);
+        for (unsigned c = 0; c < header.numChannels; ++c) {
+            std::memcpy(data->channelWriter(c), frames, header.numFrames * sizeof(float));
+            frames += header.numFrames * sizeof(float);
+        }
+    }
+
+    return true;
+}
+
+void PreloadCache::storePreloadedData(const fs::path& file, bool reverse, uint32_t preloadFrames,
+    const FileInformation& information, const FileAudioBuffer& data)
+{
+    const fs::path directory = getDirectory();
+    if (directory.empty())
+        return;
+
+    const size_t numChannels = data.getNumChannels();
+    if (numChannels != 1 && numChannels != 2)
+        return;
+
+    CacheKey key;
+    if (!makeCacheKey(file, reverse, key))
+        return;
+
+    CacheHeader header {};
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.pathSize = static_cast<uint32_t>(key.path.size());
+    header.modificationTime = key.modificationTime;
+    header.fileSize = key.fileSize;
+    header.reverse = reverse ? 1 : 0;
+    header.preloadFrames = preloadFrames;
+    header.numFrames = static_cast<uint32_t>(data.getNumFrames());
+    header.numChannels = static_cast<uint32_t>(numChannels);
+    header.end = information.end;
+    header.loopStart = information.loopStart;
+    header.loopEnd = information.loopEnd;
+    header.sampleRate = information.sampleRate;
+    header.rootKey = information.rootKey;
+    header.hasLoop = information.hasLoop ? 1 : 0;
+    if (information.wavetable) {
+        header.hasWavetable = 1;
+        header.wavetableTableSize = information.wavetable->tableSize;
+        header.wavetableCrossTableInterpolation = information.wavetable->crossTableInterpolation;
+        header.wavetableOneShot = information.wavetable->oneShot ? 1 : 0;
+    }
+
+    // Write to a temporary file, then move it in place, so that concurrent
+    // readers never see a partial file
+    const fs::path path = cacheFilePath(directory, key);
+    std::random_device randomDevice;
+    fs::path temporaryPath = path;
+    temporaryPath += ".tmp" + std::to_string(randomDevice());
+
+    {
+        fs::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+        const char padding[4] {};
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+        stream.write(key.path.data(), static_cast<std::streamsize>(key.path.size()));
+        stream.write(padding, static_cast<std::streamsize>(framesOffset(key.path.size()) - sizeof(CacheHeader) - key.path.size()));
+        for (size_t c = 0; c < numChannels; ++c) {
+            stream.write(reinterpret_cast<const char*>(data.channelReader(c)),
+                static_cast<std::streamsize>(data.getNumFrames() * sizeof(float)));
+        }
+
+        if (!stream) {
+            DBG("[sfizz] Cannot write the preload cache file " << temporaryPath);
+            stream.close();
+            std::error_code ec;
+            fs::remove(temporaryPath, ec);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(temporaryPath, path, ec);
+    if (ec) {
+        fs::remove(path, ec);
+        fs::rename(temporaryPath, path, ec);
+        if (ec)
+            fs::remove(temporaryPath, ec);
+    }
+}
+
+} // namespace sfz
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#pragma once
+#include "FilePool.h"
+#include "utility/LeakDetector.h"
+#include <ghc/fs_std.hpp>
+#include <atomic>
+#include <mutex>
+
+namespace sfz {
+
+/**
+ * @brief A persistent cache of the preloaded data of sample files, stored in
+ * a directory with one cache file per sample file.
+ *
+ * A cache file holds the information of the sample file (loops, root key,
+ * wavetable...) followed by its preloaded frames. It is identified by the
+ * path, modification time, size and direction of the sample file, so any
+ * change in the sample file invalidates it. The preloaded frames are used
+ * only if they were cached for the same preload size.
+ *
+ * The cache files are machine-specific; they are rewritten whenever they
+ * do not match.
+ */
+class PreloadCache {
+public:
+    PreloadCache() = default;
+
+    /**
+     * @brief Set the cache directory, creating it if needed.
+     * An empty path disables the cache.
+     *
+     * @param directory
+     * @return true if the cache is usable
+     */
+    bool setDirectory(const fs::path& directory);
+
+    /**
+     * @brief Get the cache directory, which is empty if the cache is disabled.
+     */
+    fs::path getDirectory() const;
+
+    /**
+     * @brief Get the information of a sample file from the cache.
+     *
+     * @param file the sample file
+     * @param reverse whether the sample file is read backwards
+     * @param information the information to fill
+     * @return true if the cache had the information
+     */
+    bool loadInformation(const fs::path& file, bool reverse, FileInformation& information);
+
+    /**
+     * @brief Get the information and the preloaded frames of a sample file
+     * from the cache. This counts a hit or a miss.
+     *
+     * @param file the sample file
+     * @param reverse whether the sample file is read backwards
+     * @param preloadFrames the number of frames requested for preloading
+     * @param information the information to fill
+     * @param data the preloaded frames to fill
+     * @return true if the cache had the preloaded frames
+     */
+    bool loadPreloadedData(const fs::path& file, bool reverse, uint32_t preloadFrames,
+        FileInformation& information, FileAudioBuffer& data);
+
+    /**
+     * @brief Store the information and the preloaded frames of a sample file.
+     *
+     * @param file the sample file
+     * @param reverse whether the sample file is read backwards
+     * @param preloadFrames the number of frames requested for preloading
+     * @param information the information of the file
+     * @param data the preloaded frames
+     */
+    void storePreloadedData(const fs::path& file, bool reverse, uint32_t preloadFrames,
+        const FileInformation& information, const FileAudioBuffer& data);
+
+    /**
+     * @brief Get the number of preloads served by the cache.
+     */
+    size_t getNumHits() const noexcept { return numHits_.load(); }
+
+    /**
+     * @brief Get the number of preloads which were not in the cache.
+     */
+    size_t getNumMisses() const noexcept { return numMisses_.load(); }
+
+private:
+    bool load(const fs::path& file, bool reverse, const uint32_t* preloadFrames,
+        FileInformation& information, FileAudioBuffer* data);
+
+    mutable std::mutex directoryMutex_;
+    fs::path directory_;
+    std::atomic<size_t> numHits_ { 0 };
+    std::atomic<size_t> numMisses_ { 0 };
+    LEAK_DETECTOR(PreloadCache);
+};
+
+} // namespace sfz
@@ -378,6 +378,12 @@ struct Region {
 
     // Effects
     std::vector<float> gainToEffect;
+    struct EffectSend {
+        unsigned bus;
+        float gain;
+    };
+    std::vector<EffectSend> effectSends; // non-zero gains to the existing buses, built on load
+    int effectSendsId { -1 }; // the same for regions with identical effect sends, set on load
 
     bool triggerOnCC { false }; // whether the region triggers on CC events or note events
     bool triggerOnNote { true };
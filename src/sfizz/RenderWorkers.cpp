@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "RenderWorkers.h"
+#include "Config.h"
+#include "ScopedFTZ.h"
+#include "utility/Debug.h"
+#include <absl/memory/memory.h>
+#include <algorithm>
+#include <system_error>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace sfz {
+
+thread_local unsigned RenderWorkers::currentLane_ = 0;
+
+RenderWorkers::RenderWorkers()
+{
+}
+
+RenderWorkers::~RenderWorkers()
+{
+    stopWorkers();
+}
+
+bool RenderWorkers::setNumThreads(unsigned numThreads)
+{
+    numThreads = std::max(1u, std::min(numThreads, config::maxRenderThreads));
+    if (numThreads == numThreads_)
+        return true;
+
+    stopWorkers();
+
+    unsigned numSpawned = 0;
+    bool spawned = true;
+    try {
+        workers_.reserve(numThreads - 1);
+        for (unsigned lane = 1; lane < numThreads; ++lane) {
+            workers_.emplace_back(absl::make_unique<Worker>());
+            Worker* worker = workers_.back().get();
+            worker->thread = std::thread(&RenderWorkers::workerJob, this, lane, worker);
+            ++numSpawned;
+        }
+    }
+    catch (std::exception& ex) {
+        DBG("[sfizz] Cannot spawn the render worker threads: " << ex.what());
+        spawned = false;
+    }
+
+    // wait until the workers have set their priority
+    for (unsigned i = 0; i < numSpawned; ++i)
+        started_.wait();
+
+    if (!spawned) {
+        stopWorkers();
+        return false;
+    }
+
+    numThreads_ = numThreads;
+    return true;
+}
+
+void RenderWorkers::stopWorkers()
+{
+    quit_.store(true);
+    for (auto& worker : workers_)
+        worker->wakeUp.post();
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+
+    workers_.clear();
+    quit_.store(false);
+    numRealtimeRefusals_.store(0);
+    numThreads_ = 1;
+}
+
+void RenderWorkers::run(Task& task) noexcept
+{
+    const unsigned numWorkers = static_cast<unsigned>(workers_.size());
+    if (numWorkers == 0) {
+        task.processLane(0);
+        return;
+    }
+
+    task_ = &task;
+    pending_.store(numWorkers, std::memory_order_release);
+    for (auto& worker : workers_)
+        worker->wakeUp.post();
+
+    task.processLane(0);
+
+    // workers are running the same amount of work, expect them to be done shortly
+    unsigned spinCounter { 0 };
+    while (pending_.load(std::memory_order_acquire) != 0) {
+        if (++spinCounter > config::renderWorkersSpinCount)
+            std::this_thread::yield();
+    }
+
+    task_ = nullptr;
+}
+
+void RenderWorkers::workerJob(unsigned lane, Worker* worker) noexcept
+{
+    currentLane_ = lane;
+    if (!raiseCurrentThreadPriority())
+        numRealtimeRefusals_.fetch_add(1);
+
+    std::error_code ec;
+    started_.post(ec);
+    ASSERT(!ec);
+    // Flush the denormals like the audio thread, e.g. in the decaying effect tails
+    ScopedFTZ ftz;
+
+    for (;;) {
+        worker->wakeUp.wait();
+        if (quit_.load())
+            break;
+
+        task_->processLane(lane);
+        pending_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+bool RenderWorkers::raiseCurrentThreadPriority() noexcept
+{
+#if defined(_WIN32)
+    HANDLE thread = GetCurrentThread();
+    const int priority = THREAD_PRIORITY_TIME_CRITICAL;
+    if (!SetThreadPriority(thread, priority)) {
+        std::system_error error(GetLastError(), std::system_category());
+        DBG("[sfizz] Cannot set render worker thread priority: " << error.what());
+        return false;
+    }
+#else
+    pthread_t thread = pthread_self();
+    int policy;
+    sched_param param;
+
+    if (pthread_getschedparam(thread, &policy, &param) != 0) {
+        DBG("[sfizz] Cannot get render worker thread scheduling parameters");
+        return false;
+    }
+
+    policy = SCHED_FIFO;
+    const int minprio = sched_get_priority_min(policy);
+    const int maxprio = sched_get_priority_max(policy);
+    param.sched_priority = minprio + config::renderWorkerPthreadPriority * (maxprio - minprio) / 100;
+
+    if (pthread_setschedparam(thread, policy, &param) != 0) {
+        DBG("[sfizz] Cannot set render worker thread scheduling parameters");
+        return false;
+    }
+#endif
+    return true;
+}
+
+} // namespace sfz
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#pragma once
+#include "RTSemaphore.h"
+#include "utility/LeakDetector.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace sfz {
+
+/**
+ * @brief A pool of pre-spawned threads which share a rendering cycle with
+ * the calling (audio) thread.
+ *
+ * Each participating thread is identified by a lane number: the thread which
+ * calls `run` is always lane 0, and the worker threads are lanes 1 to N-1.
+ * Objects which keep scratch state (e.g. the buffer pool or the modulation
+ * matrix) use `currentLane()` to pick their per-thread state.
+ *
+ * Running a task does not allocate nor lock: workers are woken up with a
+ * semaphore and the completion is collected on an atomic counter.
+ */
+class RenderWorkers {
+public:
+    class Task {
+    public:
+        virtual ~Task() {}
+        /**
+         * @brief Process the part of the work which is assigned to a lane.
+         * This is called concurrently once for every lane.
+         *
+         * @param lane the lane number, from 0 to `getNumThreads() - 1`
+         */
+        virtual void processLane(unsigned lane) noexcept = 0;
+    };
+
+    RenderWorkers();
+    ~RenderWorkers();
+
+    /**
+     * @brief Set the number of threads which participate in a cycle,
+     * including the calling thread. A value of 1 disables the workers.
+     * This spawns or joins threads; do not call it on the audio thread.
+     * If the worker threads cannot be spawned, the cycles fall back to
+     * running serially on the calling thread.
+     *
+     * @param numThreads
+     * @return false if the worker threads could not be spawned
+     */
+    bool setNumThreads(unsigned numThreads);
+
+    /**
+     * @brief Get the number of threads which participate in a cycle.
+     */
+    unsigned getNumThreads() const noexcept { return numThreads_; }
+
+    /**
+     * @brief Check whether all the worker threads run with a realtime
+     * priority. The system may refuse it, e.g. if the process lacks the
+     * permission to use SCHED_FIFO; the workers then run at normal priority.
+     */
+    bool hasRealtimePriority() const noexcept { return numRealtimeRefusals_ == 0; }
+
+    /**
+     * @brief Run a task on all the lanes and return when every lane is done.
+     * The calling thread processes lane 0.
+     *
+     * @param task
+     */
+    void run(Task& task) noexcept;
+
+    /**
+     * @brief Get the lane number of the current thread.
+     * This is 0 for any thread which is not a render worker.
+     */
+    static unsigned currentLane() noexcept { return currentLane_; }
+
+private:
+    struct Worker {
+        std::thread thread;
+        RTSemaphore wakeUp;
+    };
+
+    void stopWorkers();
+    void workerJob(unsigned lane, Worker* worker) noexcept;
+    static bool raiseCurrentThreadPriority() noexcept;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    unsigned numThreads_ { 1 };
+    Task* task_ { nullptr };
+    std::atomic<unsigned> pending_ { 0 };
+    std::atomic<bool> quit_ { false };
+    RTSemaphore started_;
+    std::atomic<unsigned> numRealtimeRefusals_ { 0 };
+    static thread_local unsigned currentLane_;
+    LEAK_DETECTOR(RenderWorkers);
+};
+
+} // namespace sfz
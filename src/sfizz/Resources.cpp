@@ -15,7 +15,11 @@
 #include "Tuning.h"
 #include "BeatClock.h"
 #include "Metronome.h"
+#include "SfzFilter.h"
+#include "RenderWorkers.h"
 #include "modulations/ModMatrix.h"
+#include <absl/memory/memory.h>
+#include <vector>
 
 namespace sfz {
 
@@ -32,6 +36,9 @@ struct Resources::Impl {
     ModMatrix modMatrix;
     BeatClock beatClock;
     Metronome metronome;
+    FilterTables filterTables;
+    int samplesPerBlock { config::defaultSamplesPerBlock };
+    std::vector<std::unique_ptr<BufferPool>> workerBufferPools;
 };
 
 Resources::Resources()
@@ -50,12 +57,16 @@ void Resources::setSampleRate(float samplerate)
     impl.modMatrix.setSampleRate(samplerate);
     impl.beatClock.setSampleRate(samplerate);
     impl.metronome.init(samplerate);
+    impl.filterTables.setSampleRate(samplerate);
 }
 
 void Resources::setSamplesPerBlock(int samplesPerBlock)
 {
     Impl& impl = *impl_;
+    impl.samplesPerBlock = samplesPerBlock;
     impl.bufferPool.setBufferSize(samplesPerBlock);
+    for (auto& pool : impl.workerBufferPools)
+        pool->setBufferSize(samplesPerBlock);
     impl.midiState.setSamplesPerBlock(samplesPerBlock);
     impl.modMatrix.setSamplesPerBlock(samplesPerBlock);
     impl.beatClock.setSamplesPerBlock(samplesPerBlock);
@@ -65,7 +76,8 @@ void Resources::clear()
 {
     Impl& impl = *impl_;
     impl.curves = CurveSet::createPredefined();
-    impl.filePool.clear();
+    // The file pool is cleared by the synth, which keeps the unchanged
+    // preloaded files on reloads
     impl.wavePool.clearFileWaves();
     impl.logger.clear();
     impl.midiState.reset();
@@ -74,6 +86,31 @@ void Resources::clear()
     impl.metronome.clear();
 }
 
+void Resources::setNumRenderThreads(unsigned numThreads)
+{
+    Impl& impl = *impl_;
+    const size_t numWorkers = (numThreads > 1) ? (numThreads - 1) : 0;
+
+    impl.workerBufferPools.resize(numWorkers);
+    for (auto& pool : impl.workerBufferPools) {
+        if (!pool) {
+            pool = absl::make_unique<BufferPool>();
+            pool->setBufferSize(impl.samplesPerBlock);
+        }
+    }
+
+    impl.modMatrix.setNumRenderThreads(numThreads);
+}
+
+size_t Resources::takeNumBufferPoolExhaustions() noexcept
+{
+    Impl& impl = *impl_;
+    size_t number = impl.bufferPool.takeNumExhaustions();
+    for (auto& pool : impl.workerBufferPools)
+        number += pool->takeNumExhaustions();
+    return number;
+}
+
 const SynthConfig& Resources::getSynthConfig() const noexcept
 {
     return impl_->synthConfig;
@@ -81,7 +118,13 @@ const SynthConfig& Resources::getSynthConfig() const noexcept
 
 const BufferPool& Resources::getBufferPool() const noexcept
 {
-    return impl_->bufferPool;
+    // each render worker gets its own scratch buffers
+    const unsigned lane = RenderWorkers::currentLane();
+    if (lane == 0)
+        return impl_->bufferPool;
+
+    ASSERT(lane <= impl_->workerBufferPools.size());
+    return *impl_->workerBufferPools[lane - 1];
 }
 
 const MidiState& Resources::getMidiState() const noexcept
@@ -134,4 +177,9 @@ const Metronome& Resources::getMetronome() const noexcept
     return impl_->metronome;
 }
 
+const FilterTables& Resources::getFilterTables() const noexcept
+{
+    return impl_->filterTables;
+}
+
 } // namespace sfz
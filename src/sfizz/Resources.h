@@ -6,6 +6,7 @@
 
 #pragma once
 #include "absl/types/optional.h"
+#include <cstddef>
 #include <memory>
 
 namespace sfz {
@@ -22,6 +23,7 @@ class StretchTuning;
 class ModMatrix;
 class BeatClock;
 class Metronome;
+class FilterTables;
 
 class Resources
 {
@@ -33,6 +35,22 @@ public:
     void setSamplesPerBlock(int samplesPerBlock);
     void clear();
 
+    /**
+     * @brief Set the number of threads which render voices concurrently.
+     * This allocates the per-thread scratch state, which is selected
+     * afterwards according to `RenderWorkers::currentLane()`.
+     *
+     * @param numThreads
+     */
+    void setNumRenderThreads(unsigned numThreads);
+
+    /**
+     * @brief Get the number of requests refused by all the buffer pools
+     * since the last call, and reset it. Call it from the render thread,
+     * when no worker is rendering.
+     */
+    size_t takeNumBufferPoolExhaustions() noexcept;
+
     #define ACCESSOR_RW(Accessor, RetTy) \
         RetTy const& Accessor() const noexcept; \
         RetTy& Accessor() noexcept { return const_cast<RetTy&>(const_cast<const Resources*>(this)->Accessor()); }
@@ -49,6 +67,7 @@ public:
     ACCESSOR_RW(getModMatrix, ModMatrix);
     ACCESSOR_RW(getBeatClock, BeatClock);
     ACCESSOR_RW(getMetronome, Metronome);
+    ACCESSOR_RW(getFilterTables, FilterTables);
 
     #undef ACCESSOR_RW
 
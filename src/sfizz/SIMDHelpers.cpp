@@ -9,6 +9,7 @@
 #include "utility/Debug.h"
 #include "simd/HelpersSSE.h"
 #include "simd/HelpersAVX.h"
+#include "simd/HelpersNEON.h"
 #include "cpuid/cpuinfo.hpp"
 #include <array>
 #include <mutex>
@@ -44,6 +45,9 @@ struct SIMDDispatch {
     decltype(&sumSquaresScalar<T>) sumSquares = &sumSquaresScalar<T>;
     decltype(&clampAllScalar<T>) clampAll = &clampAllScalar<T>;
     decltype(&allWithinScalar<T>) allWithin = &allWithinScalar<T>;
+    decltype(&sincInterpolationScalar<T>) sincInterpolation = &sincInterpolationScalar<T>;
+    decltype(&linearVoiceBatchScalar<T>) linearVoiceBatch = &linearVoiceBatchScalar<T>;
+    decltype(&biquadVoiceBatchScalar<T>) biquadVoiceBatch = &biquadVoiceBatchScalar<T>;
 
 private:
     std::array<bool, static_cast<unsigned>(SIMDOps::_sentinel)> simdStatus;
@@ -92,6 +96,9 @@ void SIMDDispatch<float>::setStatus(SIMDOps op, bool enable)
             SIMD_OP(sumSquares)
             SIMD_OP(clampAll)
             SIMD_OP(allWithin)
+            SIMD_OP(sincInterpolation)
+            SIMD_OP(linearVoiceBatch)
+            SIMD_OP(biquadVoiceBatch)
         }
 #undef SIMD_OP
     }
@@ -101,6 +108,9 @@ void SIMDDispatch<float>::setStatus(SIMDOps op, bool enable)
     if (info.has_avx()) {
         switch (op) {
             default: break;
+            SIMD_OP(sincInterpolation)
+            SIMD_OP(linearVoiceBatch)
+            SIMD_OP(biquadVoiceBatch)
         }
     }
 #undef SIMD_OP
@@ -131,6 +141,9 @@ void SIMDDispatch<float>::setStatus(SIMDOps op, bool enable)
             SIMD_OP(sumSquares)
             SIMD_OP(clampAll)
             SIMD_OP(allWithin)
+            SIMD_OP(sincInterpolation)
+            SIMD_OP(linearVoiceBatch)
+            SIMD_OP(biquadVoiceBatch)
         }
     }
 #undef SIMD_OP
@@ -141,6 +154,7 @@ void SIMDDispatch<float>::setStatus(SIMDOps op, bool enable)
     if (info.has_neon()) {
         switch (op) {
             default: break;
+            SIMD_OP(sincInterpolation)
         }
     }
 #undef SIMD_OP
@@ -175,6 +189,9 @@ void SIMDDispatch<float>::resetStatus()
     setStatus(SIMDOps::upsampling, true);
     setStatus(SIMDOps::clampAll, false);
     setStatus(SIMDOps::allWithin, true);
+    setStatus(SIMDOps::sincInterpolation, true);
+    setStatus(SIMDOps::linearVoiceBatch, true);
+    setStatus(SIMDOps::biquadVoiceBatch, true);
 }
 
 ///
@@ -341,4 +358,31 @@ bool allWithin<float>(const float* input, float low, float high, unsigned size)
     return simdDispatch<float>().allWithin(input, low, high, size);
 }
 
+template <>
+void sincInterpolation<float>(const float* table, unsigned tableSize, unsigned points,
+    const float* inputLeft, const float* inputRight, float* outputLeft, float* outputRight,
+    const int* indices, const float* coeffs, const float* addingGains, unsigned size) noexcept
+{
+    simdDispatch<float>().sincInterpolation(table, tableSize, points, inputLeft, inputRight,
+        outputLeft, outputRight, indices, coeffs, addingGains, size);
+}
+
+template <>
+void linearVoiceBatch<float>(const float* const* sources, const float* positions, const float* increments,
+    const float* const* gains, const float* panLeft, const float* panRight,
+    float* outputLeft, float* outputRight, unsigned numVoices, unsigned size) noexcept
+{
+    simdDispatch<float>().linearVoiceBatch(sources, positions, increments, gains,
+        panLeft, panRight, outputLeft, outputRight, numVoices, size);
+}
+
+template <>
+void biquadVoiceBatch<float>(const float* const* inputs, float* const* outputs,
+    const float* halfOmegas, const float* alphaScales, const float* poles, const float* shapes,
+    float* coeffs, float* memory, unsigned stride, unsigned numVoices, unsigned size) noexcept
+{
+    simdDispatch<float>().biquadVoiceBatch(inputs, outputs, halfOmegas, alphaScales, poles,
+        shapes, coeffs, memory, stride, numVoices, size);
+}
+
 }
@@ -64,6 +64,9 @@ enum class SIMDOps {
     upsampling,
     clampAll,
     allWithin,
+    sincInterpolation,
+    linearVoiceBatch,
+    biquadVoiceBatch,
     _sentinel //
 };
 
@@ -753,4 +756,125 @@ bool allWithin(absl::Span<const T> input, T low, T high) noexcept
     return allWithin<T>(input.data(), low, high, input.size());
 }
 
+/**
+ * @brief Interpolate a mono or stereo source with a windowed-sinc table.
+ * Both channels are interpolated with the same kernel.
+ *
+ * The table is the one of a FixedWindowedSinc; the source must hold
+ * points/2 frames before and after each index.
+ *
+ * @tparam T the underlying type
+ * @param table the windowed-sinc table
+ * @param tableSize the size of the table
+ * @param points the number of points of the windowed-sinc
+ * @param inputLeft the left or mono source
+ * @param inputRight the right source, or null if mono
+ * @param outputLeft
+ * @param outputRight the right output, or null if mono
+ * @param indices the integral parts of the source positions
+ * @param coeffs the fractional parts of the source positions
+ * @param addingGains gains to add the interpolated frames to the outputs,
+ *                    or null to replace the outputs
+ * @param size the number of frames to output
+ */
+template <class T>
+void sincInterpolation(const float* table, unsigned tableSize, unsigned points,
+    const T* inputLeft, const T* inputRight, T* outputLeft, T* outputRight,
+    const int* indices, const T* coeffs, const T* addingGains, unsigned size) noexcept
+{
+    sincInterpolationScalar(table, tableSize, points, inputLeft, inputRight,
+        outputLeft, outputRight, indices, coeffs, addingGains, size);
+}
+
+template <>
+void sincInterpolation<float>(const float* table, unsigned tableSize, unsigned points,
+    const float* inputLeft, const float* inputRight, float* outputLeft, float* outputRight,
+    const int* indices, const float* coeffs, const float* addingGains, unsigned size) noexcept;
+
+/**
+ * @brief Render a batch of mono voices reading their sources at a constant
+ * rate with a linear interpolation, and add them to a stereo output.
+ *
+ * The voices are stored as a structure of arrays. For a voice v, the frame t
+ * is read at the position positions[v] + t * increments[v] of sources[v],
+ * then multiplied by gains[v][t] and panned with the constant gains panLeft[v]
+ * and panRight[v]. The sources must hold a frame past the last position.
+ *
+ * @tparam T the underlying type
+ * @param sources the sources of the voices
+ * @param positions the positions of the first frame in the sources
+ * @param increments the source frames to advance by for each output frame
+ * @param gains the gain envelopes of the voices, each of size at least size
+ * @param panLeft the left gains of the voices
+ * @param panRight the right gains of the voices
+ * @param outputLeft
+ * @param outputRight
+ * @param numVoices the number of voices
+ * @param size the number of frames to output
+ */
+template <class T>
+void linearVoiceBatch(const T* const* sources, const T* positions, const T* increments,
+    const T* const* gains, const T* panLeft, const T* panRight,
+    T* outputLeft, T* outputRight, unsigned numVoices, unsigned size) noexcept
+{
+    linearVoiceBatchScalar(sources, positions, increments, gains, panLeft, panRight,
+        outputLeft, outputRight, numVoices, size);
+}
+
+template <>
+void linearVoiceBatch<float>(const float* const* sources, const float* positions, const float* increments,
+    const float* const* gains, const float* panLeft, const float* panRight,
+    float* outputLeft, float* outputRight, unsigned numVoices, unsigned size) noexcept;
+
+/**
+ * @brief Process a batch of mono 2-pole filters, one per voice.
+ *
+ * The voices are stored as a structure of arrays, where the k-th value of
+ * the voice v is at index k * stride + v. Each filter is a biquad normalized
+ * by a0, whose coefficients smooth toward targets by the one-pole poles[v] at
+ * each frame. It runs in the form of the Faust filters, which keeps the
+ * products of the past frames with their coefficients:
+ *
+ *   y[n] = b0 x[n] + u[n-1] + w2[n-1] - a1 y[n-1]
+ *   u[n] = b1 x[n], w1[n] = b2 x[n], w2[n] = w1[n-1] - a2 y[n-1]
+ *
+ * With w the angular frequency and alpha the sine of w times
+ * alphaScales[v], the targets are
+ *
+ *   b0 = (p0 + p1 sin^2(w/2) + p2 cos^2(w/2) + p3 alpha) / (1 + alpha)
+ *   b1 = (q1 sin^2(w/2) + q2 cos^2(w/2)) / (1 + alpha)
+ *   b2 = b0 - 2 p3 alpha / (1 + alpha)
+ *   a1 = -2 cos(w) / (1 + alpha)
+ *   a2 = (1 - alpha) / (1 + alpha)
+ *
+ * where the shapes (p0, p1, p2, p3, q1, q2) select the filter type.
+ * The inputs and outputs may be the same.
+ *
+ * @tparam T the underlying type
+ * @param inputs the inputs of the voices
+ * @param outputs the outputs of the voices
+ * @param halfOmegas the halves of the angular frequencies, within [0, pi/2]
+ * @param alphaScales the scales of alpha, 1 / 2Q
+ * @param poles the smoothing poles, 0 to reach the targets at once
+ * @param shapes the 6 shapes of the voices
+ * @param coeffs the 5 smoothed coefficients of the voices, b0, b1, b2, a1, a2
+ * @param memory the 4 past values of the voices, u, w1, w2, y
+ * @param stride the distance between the values of a voice
+ * @param numVoices the number of voices
+ * @param size the number of frames to process
+ */
+template <class T>
+void biquadVoiceBatch(const T* const* inputs, T* const* outputs,
+    const T* halfOmegas, const T* alphaScales, const T* poles, const T* shapes,
+    T* coeffs, T* memory, unsigned stride, unsigned numVoices, unsigned size) noexcept
+{
+    biquadVoiceBatchScalar(inputs, outputs, halfOmegas, alphaScales, poles, shapes,
+        coeffs, memory, stride, numVoices, size);
+}
+
+template <>
+void biquadVoiceBatch<float>(const float* const* inputs, float* const* outputs,
+    const float* halfOmegas, const float* alphaScales, const float* poles, const float* shapes,
+    float* coeffs, float* memory, unsigned stride, unsigned numVoices, unsigned size) noexcept;
+
 } // namespace sfz
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "SampleStore.h"
+
+namespace sfz {
+
+SampleStore& SampleStore::instance()
+{
+    static SampleStore store;
+    return store;
+}
+
+bool SampleStore::makeKey(const fs::path& file, bool reverse, uint32_t numFrames, Oversampling factor, std::string& key)
+{
+    std::error_code ec;
+    const fs::path canonicalPath = fs::canonical(file, ec);
+    if (ec)
+        return false;
+
+    const auto modificationTime = fs::last_write_time(canonicalPath, ec).time_since_epoch().count();
+    if (ec)
+        return false;
+
+    key = canonicalPath.u8string();
+    key += '|';
+    key += std::to_string(modificationTime);
+    key += reverse ? "|r|" : "|f|";
+    key += std::to_string(numFrames);
+    key += "|x";
+    key += std::to_string(static_cast<int>(factor));
+    return true;
+}
+
+FileAudioBufferPtr SampleStore::find(const std::string& key, double& sampleRate)
+{
+    std::lock_guard<std::mutex> lock { mutex_ };
+    auto it = entries_.find(key);
+    if (it == entries_.end())
+        return {};
+
+    FileAudioBufferPtr data = it->second.data.lock();
+    if (!data) {
+        entries_.erase(it);
+        return {};
+    }
+
+    sampleRate = it->second.sampleRate;
+    return data;
+}
+
+FileAudioBufferPtr SampleStore::insert(const std::string& key, FileAudioBufferPtr data, double sampleRate)
+{
+    std::lock_guard<std::mutex> lock { mutex_ };
+    Entry& entry = entries_[key];
+
+    // Another pool may have read the same file meanwhile
+    if (FileAudioBufferPtr existing = entry.data.lock())
+        return existing;
+
+    entry.data = data;
+    entry.sampleRate = sampleRate;
+    return data;
+}
+
+size_t SampleStore::getNumEntries()
+{
+    std::lock_guard<std::mutex> lock { mutex_ };
+    removeExpired();
+    return entries_.size();
+}
+
+size_t SampleStore::getMemory()
+{
+    std::lock_guard<std::mutex> lock { mutex_ };
+    removeExpired();
+
+    size_t numBytes = 0;
+    for (const auto& entry : entries_) {
+        if (FileAudioBufferPtr data = entry.second.data.lock())
+            numBytes += data->getNumFrames() * data->getNumChannels() * sizeof(float);
+    }
+    return numBytes;
+}
+
+void SampleStore::removeExpired()
+{
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.data.expired())
+            entries_.erase(it++);
+        else
+            ++it;
+    }
+}
+
+} // namespace sfz
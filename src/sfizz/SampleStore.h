@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#pragma once
+#include "FilePool.h"
+#include "utility/LeakDetector.h"
+#include <ghc/fs_std.hpp>
+#include <absl/container/flat_hash_map.h>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace sfz {
+
+/**
+ * @brief The sample data which the file pools of a process share, when they
+ * enable sharing.
+ *
+ * The store holds the preloaded data of the files, as well as the data of
+ * the files which were loaded whole in the background. The entries are
+ * identified by the canonical path and modification time of the file, its
+ * direction, the number of frames read and the oversampling factor.
+ *
+ * The store only references the data weakly: the file pools own it, and it
+ * is freed when the last pool which uses it releases it.
+ */
+class SampleStore {
+public:
+    /**
+     * @brief Get the store of the process.
+     */
+    static SampleStore& instance();
+
+    /**
+     * @brief Identify the data of a file.
+     *
+     * @param file the path of the file
+     * @param reverse whether the file is read in reverse
+     * @param numFrames the number of frames read from the file
+     * @param factor the oversampling factor of the data
+     * @param key the identifier
+     * @return true if the file could be identified
+     */
+    static bool makeKey(const fs::path& file, bool reverse, uint32_t numFrames, Oversampling factor, std::string& key);
+
+    /**
+     * @brief Find the data of a file.
+     *
+     * @param key the identifier of the data
+     * @param sampleRate the sample rate of the file, set if found
+     * @return the data, or null if no pool uses it
+     */
+    FileAudioBufferPtr find(const std::string& key, double& sampleRate);
+
+    /**
+     * @brief Publish the data of a file, unless another pool did it first.
+     *
+     * @param key the identifier of the data
+     * @param data the data
+     * @param sampleRate the sample rate of the file
+     * @return the data which is shared, which is the one published first
+     */
+    FileAudioBufferPtr insert(const std::string& key, FileAudioBufferPtr data, double sampleRate);
+
+    /**
+     * @brief Get the number of entries in use by some pool.
+     */
+    size_t getNumEntries();
+
+    /**
+     * @brief Get the memory of the entries in use, in bytes.
+     */
+    size_t getMemory();
+
+private:
+    SampleStore() = default;
+    void removeExpired();
+
+    struct Entry {
+        std::weak_ptr<const FileAudioBuffer> data;
+        double sampleRate { config::defaultSampleRate };
+    };
+
+    absl::flat_hash_map<std::string, Entry> entries_;
+    std::mutex mutex_;
+    LEAK_DETECTOR(SampleStore);
+};
+
+} // namespace sfz
@@ -8,21 +8,367 @@
 #include "SfzFilter.h"
 #include "SfzFilterImpls.hpp"
 #include "SIMDHelpers.h"
+#include "MathHelpers.h"
 #include "utility/StringViewHelpers.h"
 #include "utility/Debug.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 
 namespace sfz {
 
+//------------------------------------------------------------------------------
+// Coefficient tables
+
+constexpr unsigned FilterTables::cutoffPointsPerOctave;
+constexpr unsigned FilterTables::pointsPerDecibel;
+
+namespace {
+
+// The cutoff table covers the octaves of 1 Hz to 20 kHz
+constexpr unsigned cutoffOctaves = 15;
+constexpr unsigned numCutoffPoints = cutoffOctaves * FilterTables::cutoffPointsPerOctave + 1;
+constexpr float minCutoff = 1.0f;
+constexpr float maxCutoff = 20000.0f;
+constexpr float minResonance = -60.0f;
+constexpr float maxResonance = 60.0f;
+constexpr float minPeakShelfGain = -120.0f;
+constexpr float maxPeakShelfGain = 60.0f;
+
+double interpolateTable(const std::vector<double>& table, double position)
+{
+    const int index = std::min(static_cast<int>(position), static_cast<int>(table.size()) - 2);
+    const double mu = position - static_cast<double>(index);
+    return table[index] + mu * (table[index + 1] - table[index]);
+}
+
+} // namespace
+
+FilterTables::FilterTables()
+{
+    const unsigned resonanceSize = static_cast<unsigned>(maxResonance - minResonance) * pointsPerDecibel + 1;
+    fResonance.resize(resonanceSize);
+    for (unsigned i = 0; i < resonanceSize; ++i) {
+        const double q = minResonance + static_cast<double>(i) / pointsPerDecibel;
+        fResonance[i] = std::pow(10.0, 0.05 * q);
+    }
+
+    const unsigned gainSize = static_cast<unsigned>(maxPeakShelfGain - minPeakShelfGain) * pointsPerDecibel + 1;
+    fGain.resize(gainSize);
+    for (unsigned i = 0; i < gainSize; ++i) {
+        const double pksh = minPeakShelfGain + static_cast<double>(i) / pointsPerDecibel;
+        fGain[i] = std::pow(10.0, 0.025 * pksh);
+    }
+
+    fCosSin.resize(2 * numCutoffPoints);
+    setSampleRate(config::defaultSampleRate);
+}
+
+void FilterTables::setSampleRate(double sampleRate)
+{
+    if (fSampleRate == sampleRate)
+        return;
+
+    fSampleRate = sampleRate;
+
+    // The points of an octave are linearly spaced, so that a cutoff finds
+    // its octave and position from its exponent and mantissa
+    const double omegaFactor = 2.0 * pi<double>() / sampleRate;
+    for (unsigned i = 0; i < numCutoffPoints; ++i) {
+        const unsigned octave = i / cutoffPointsPerOctave;
+        const unsigned point = i % cutoffPointsPerOctave;
+        const double cutoff = std::ldexp(1.0 + static_cast<double>(point) / cutoffPointsPerOctave, octave);
+        fCosSin[2 * i] = std::cos(omegaFactor * cutoff);
+        fCosSin[2 * i + 1] = std::sin(omegaFactor * cutoff);
+    }
+}
+
+void FilterTables::cosSin(float cutoff, double& c, double& s) const
+{
+    cutoff = clamp(cutoff, minCutoff, maxCutoff);
+    const int octave = fp_exponent(cutoff);
+    const Fraction<uint64_t> mantissa = fp_mantissa(cutoff);
+    const double position = static_cast<double>(octave * cutoffPointsPerOctave)
+        + static_cast<double>(mantissa.num) * (static_cast<double>(cutoffPointsPerOctave) / mantissa.den);
+    const int index = std::min(static_cast<int>(position), static_cast<int>(numCutoffPoints) - 2);
+    const double mu = position - static_cast<double>(index);
+    const double* point = &fCosSin[2 * index];
+    c = point[0] + mu * (point[2] - point[0]);
+    s = point[1] + mu * (point[3] - point[1]);
+}
+
+double FilterTables::resonanceQ(float q) const
+{
+    const double position = (clamp(q, minResonance, maxResonance) - minResonance) * pointsPerDecibel;
+    return interpolateTable(fResonance, position);
+}
+
+double FilterTables::peakShelfAmplitude(float pksh) const
+{
+    const double position = (clamp(pksh, minPeakShelfGain, maxPeakShelfGain) - minPeakShelfGain) * pointsPerDecibel;
+    return interpolateTable(fGain, position);
+}
+
+namespace {
+
+/**
+   Check whether a modulation input holds a single value over a cycle.
+   The inputs are only read once per control interval, so only these frames
+   are compared.
+ */
+bool isConstant(const float* values, unsigned nframes)
+{
+    for (unsigned i = config::filterControlInterval; i < nframes; i += config::filterControlInterval) {
+        if (values[i] != values[0])
+            return false;
+    }
+    return true;
+}
+
+/**
+   The RBJ filters which compute their coefficients from the tables, as
+   cascades of 1 to 3 biquads. They run in the same form and precision as
+   the Faust filters: the normalized coefficients are smoothed at each frame,
+   and shared by the stages.
+ */
+struct TableBiquad {
+    enum Shape { kNone, kLpf, kHpf, kBpf, kBrf, kPeq, kLsh, kHsh, kEqPeak, kEqLshelf, kEqHshelf };
+    enum { maxStages = 3, maxChannels = 2, numCoeffs = 5 };
+
+    Shape shape = kNone;
+    unsigned stages = 0;
+    // b0, b1, b2, a1, a2
+    double coeffs[numCoeffs] {};
+    double target[numCoeffs] {};
+    // b1*x[n-1], b2*x[n-1], b2*x[n-2]-a2*y[n-2], y[n-1] of each stage
+    double memory[maxStages][maxChannels][4] {};
+    float params[3] {};
+    bool configured = false;
+
+    void setup(Shape newShape, unsigned newStages)
+    {
+        shape = newShape;
+        stages = newStages;
+        clear();
+    }
+
+    void clear()
+    {
+        std::fill_n(coeffs, numCoeffs, 0.0);
+        std::fill_n(&memory[0][0][0], maxStages * maxChannels * 4, 0.0);
+        configured = false;
+    }
+
+    void configure(const FilterTables& tables, float cutoff, float q, float pksh);
+
+    void prepare(const FilterTables& tables, float cutoff, float q, float pksh)
+    {
+        clear();
+        configure(tables, cutoff, q, pksh);
+        std::copy_n(target, numCoeffs, coeffs);
+    }
+
+    void compute(const float *const in[], float *const out[], unsigned channels, unsigned nframes, double pole);
+
+    template <unsigned Stages, unsigned Channels>
+    void computeFixed(const float *const in[], float *const out[], unsigned nframes, double pole);
+};
+
+void TableBiquad::configure(const FilterTables& tables, float cutoff, float q, float pksh)
+{
+    // Skip the coefficients when the parameters did not move
+    if (configured && cutoff == params[0] && q == params[1] && pksh == params[2])
+        return;
+
+    params[0] = cutoff;
+    params[1] = q;
+    params[2] = pksh;
+    configured = true;
+
+    double c;
+    double s;
+    tables.cosSin(cutoff, c, s);
+
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0, a0 = 1.0, a1 = 0.0, a2 = 0.0;
+    switch (shape) {
+    case kNone:
+        break;
+    case kLpf:
+    case kHpf:
+    case kBpf:
+    case kBrf:
+    case kPeq: {
+        const double alpha = 0.5 * s / std::max<double>(0.001, tables.resonanceQ(q));
+        a0 = 1.0 + alpha;
+        a1 = -2.0 * c;
+        a2 = 1.0 - alpha;
+        if (shape == kLpf) {
+            b0 = 0.5 * (1.0 - c);
+            b1 = 1.0 - c;
+            b2 = b0;
+        } else if (shape == kHpf) {
+            b0 = 0.5 * (1.0 + c);
+            b1 = -1.0 - c;
+            b2 = b0;
+        } else if (shape == kBpf) {
+            b0 = alpha;
+            b1 = 0.0;
+            b2 = -alpha;
+        } else if (shape == kBrf) {
+            b0 = 1.0;
+            b1 = -2.0 * c;
+            b2 = 1.0;
+        } else {
+            const double A = tables.peakShelfAmplitude(pksh);
+            b0 = 1.0 + alpha * A;
+            b1 = -2.0 * c;
+            b2 = 1.0 - alpha * A;
+            a0 = 1.0 + alpha / A;
+            a2 = 1.0 - alpha / A;
+        }
+        break;
+    }
+    case kEqPeak: {
+        // The bandwidth in octaves, converted to Q as in the Faust equalizer
+        const double w0 = 2.0 * pi<double>() * clamp(cutoff, minCutoff, maxCutoff) / tables.sampleRate();
+        const double bw = clamp(q, 0.01f, 12.0f);
+        const double Q = std::max<double>(0.001, 0.5 / std::sinh(0.5 * M_LN2 * bw * w0 / s));
+        const double alpha = 0.5 * s / Q;
+        const double A = tables.peakShelfAmplitude(pksh);
+        b0 = 1.0 + alpha * A;
+        b1 = -2.0 * c;
+        b2 = 1.0 - alpha * A;
+        a0 = 1.0 + alpha / A;
+        a1 = -2.0 * c;
+        a2 = 1.0 - alpha / A;
+        break;
+    }
+    case kLsh:
+    case kHsh:
+    case kEqLshelf:
+    case kEqHshelf: {
+        const double A = tables.peakShelfAmplitude(pksh);
+        // A flat shelf passes the input whatever its Q
+        double Q = 1.0;
+        if (shape == kLsh || shape == kHsh)
+            Q = tables.resonanceQ(q);
+        else if (A != 1.0) {
+            // The slope as in the Faust equalizer, limited to its domain
+            const double Ap = A * A + 1.0;
+            const double Am = (A - 1.0) * (A - 1.0);
+            const double slope = std::min<double>((Ap / Am) - 0.01, std::max<double>(0.01, (q * Ap) / Am));
+            Q = 1.0 / std::sqrt((A + 1.0 / A) * (1.0 / slope - 1.0) + 2.0);
+        }
+        const double t = std::sqrt(A) * s / std::max<double>(0.001, Q);
+        if (shape == kLsh || shape == kEqLshelf) {
+            b0 = A * ((A + 1.0) - (A - 1.0) * c + t);
+            b1 = 2.0 * A * ((A - 1.0) - (A + 1.0) * c);
+            b2 = A * ((A + 1.0) - (A - 1.0) * c - t);
+            a0 = (A + 1.0) + (A - 1.0) * c + t;
+            a1 = -2.0 * ((A - 1.0) + (A + 1.0) * c);
+            a2 = (A + 1.0) + (A - 1.0) * c - t;
+        } else {
+            b0 = A * ((A + 1.0) + (A - 1.0) * c + t);
+            b1 = -2.0 * A * ((A - 1.0) + (A + 1.0) * c);
+            b2 = A * ((A + 1.0) + (A - 1.0) * c - t);
+            a0 = (A + 1.0) - (A - 1.0) * c + t;
+            a1 = 2.0 * ((A - 1.0) - (A + 1.0) * c);
+            a2 = (A + 1.0) - (A - 1.0) * c - t;
+        }
+        break;
+    }
+    }
+
+    const double k = 1.0 / a0;
+    target[0] = b0 * k;
+    target[1] = b1 * k;
+    target[2] = b2 * k;
+    target[3] = a1 * k;
+    target[4] = a2 * k;
+}
+
+template <unsigned Stages, unsigned Channels>
+void TableBiquad::computeFixed(const float *const in[], float *const out[], unsigned nframes, double pole)
+{
+    // Work on local copies, which the compiler keeps in registers
+    double step[numCoeffs];
+    double b0 = coeffs[0], b1 = coeffs[1], b2 = coeffs[2], a1 = coeffs[3], a2 = coeffs[4];
+    double m[Stages][Channels][4];
+    for (unsigned k = 0; k < numCoeffs; ++k)
+        step[k] = (1.0 - pole) * target[k];
+    for (unsigned stage = 0; stage < Stages; ++stage)
+        for (unsigned ch = 0; ch < Channels; ++ch)
+            std::copy_n(memory[stage][ch], 4, m[stage][ch]);
+
+    for (unsigned i = 0; i < nframes; ++i) {
+        b0 = step[0] + pole * b0;
+        b1 = step[1] + pole * b1;
+        b2 = step[2] + pole * b2;
+        a1 = step[3] + pole * a1;
+        a2 = step[4] + pole * a2;
+
+        for (unsigned ch = 0; ch < Channels; ++ch) {
+            double x = in[ch][i];
+            for (unsigned stage = 0; stage < Stages; ++stage) {
+                double* s = m[stage][ch];
+                const double w2 = s[1] - a2 * s[3];
+                const double y = b0 * x + s[0] + s[2] - a1 * s[3];
+                s[0] = b1 * x;
+                s[1] = b2 * x;
+                s[2] = w2;
+                s[3] = y;
+                x = y;
+            }
+            out[ch][i] = static_cast<float>(x);
+        }
+    }
+
+    coeffs[0] = b0;
+    coeffs[1] = b1;
+    coeffs[2] = b2;
+    coeffs[3] = a1;
+    coeffs[4] = a2;
+    for (unsigned stage = 0; stage < Stages; ++stage)
+        for (unsigned ch = 0; ch < Channels; ++ch)
+            std::copy_n(m[stage][ch], 4, memory[stage][ch]);
+}
+
+void TableBiquad::compute(const float *const in[], float *const out[], unsigned channels, unsigned nframes, double pole)
+{
+    ASSERT(channels >= 1 && channels <= maxChannels);
+
+    switch (stages * maxChannels + channels - 1) {
+    #define CASE(s, c)                                    \
+        case s * maxChannels + c - 1:                     \
+            computeFixed<s, c>(in, out, nframes, pole);   \
+            break;
+    CASE(1, 1) CASE(1, 2)
+    CASE(2, 1) CASE(2, 2)
+    CASE(3, 1) CASE(3, 2)
+    #undef CASE
+    default:
+        break;
+    }
+}
+
+} // namespace
+
 //------------------------------------------------------------------------------
 // SFZ v2 multi-mode filter
 
 struct Filter::Impl {
     double fSampleRate = sfz::config::defaultSampleRate;
+    double fSmoothingPole = std::exp(-1000.0 / sfz::config::defaultSampleRate);
     FilterType fType = kFilterNone;
     unsigned fChannels = 1;
     enum { maxChannels = 2 };
 
+    const FilterTables* fTables = nullptr;
+    TableBiquad fTable;
+
+    bool usesTables() const { return fTables && fTable.stages > 0; }
+    void setupTable();
+
     union U {
         U() {}
         ~U() {}
@@ -64,6 +410,8 @@ void Filter::init(double sampleRate)
         dsp->init(sampleRate);
 
     P->fSampleRate = sampleRate;
+    P->fSmoothingPole = std::exp(-1000.0 / sampleRate);
+    P->fTable.clear();
 }
 
 void Filter::clear()
@@ -72,6 +420,8 @@ void Filter::clear()
 
     if (dsp)
         dsp->instanceClear();
+
+    P->fTable.clear();
 }
 
 void Filter::prepare(float cutoff, float q, float pksh)
@@ -81,6 +431,11 @@ void Filter::prepare(float cutoff, float q, float pksh)
     if (!dsp)
         return;
 
+    if (P->usesTables()) {
+        P->fTable.prepare(*P->fTables, cutoff, q, pksh);
+        return;
+    }
+
     // compute a dummy 1-frame cycle with smoothing off
 
     float buffer[Impl::maxChannels] = {0};
@@ -108,6 +463,12 @@ void Filter::process(const float *const in[], float *const out[], float cutoff,
         return;
     }
 
+    if (P->usesTables()) {
+        P->fTable.configure(*P->fTables, cutoff, q, pksh);
+        P->fTable.compute(in, out, channels, nframes, P->fSmoothingPole);
+        return;
+    }
+
     dsp->configureStandard(cutoff, q, pksh);
     dsp->compute(nframes, const_cast<float **>(in), const_cast<float **>(out));
 }
@@ -123,6 +484,16 @@ void Filter::processModulated(const float *const in[], float *const out[], const
         return;
     }
 
+    if (nframes == 0)
+        return;
+
+    // Constant parameters need a single configuration for the whole cycle
+    if (isConstant(cutoff, nframes) && isConstant(q, nframes) && isConstant(pksh, nframes)) {
+        process(in, out, cutoff[0], q[0], pksh[0], nframes);
+        return;
+    }
+
+    const bool usesTables = P->usesTables();
     unsigned frame = 0;
     while (frame < nframes) {
         unsigned current = nframes - frame;
@@ -138,8 +509,13 @@ void Filter::processModulated(const float *const in[], float *const out[], const
             current_out[c] = out[c] + frame;
         }
 
-        dsp->configureStandard(cutoff[frame], q[frame], pksh[frame]);
-        dsp->compute(current, const_cast<float **>(current_in), const_cast<float **>(current_out));
+        if (usesTables) {
+            P->fTable.configure(*P->fTables, cutoff[frame], q[frame], pksh[frame]);
+            P->fTable.compute(current_in, current_out, channels, current, P->fSmoothingPole);
+        } else {
+            dsp->configureStandard(cutoff[frame], q[frame], pksh[frame]);
+            dsp->compute(current, const_cast<float **>(current_in), const_cast<float **>(current_out));
+        }
 
         frame += current;
     }
@@ -163,6 +539,8 @@ void Filter::setChannels(unsigned channels)
         dsp = P->newDsp(channels, P->fType);
         if (dsp)
             dsp->init(P->fSampleRate);
+
+        P->fTable.clear();
     }
 }
 
@@ -183,9 +561,17 @@ void Filter::setType(FilterType type)
         dsp = P->newDsp(P->fChannels, type);
         if (dsp)
             dsp->init(P->fSampleRate);
+
+        P->setupTable();
     }
 }
 
+void Filter::setCoefficientTables(const FilterTables* tables)
+{
+    P->fTables = tables;
+    P->fTable.clear();
+}
+
 sfzFilterDsp *Filter::Impl::getDsp(unsigned channels, FilterType type)
 {
     switch (idDsp(channels, type)) {
@@ -212,15 +598,42 @@ sfzFilterDsp *Filter::Impl::newDsp(unsigned channels, FilterType type)
     }
 }
 
+void Filter::Impl::setupTable()
+{
+    switch (fType) {
+    default: fTable.setup(TableBiquad::kNone, 0); break;
+    case kFilterLpf2p: fTable.setup(TableBiquad::kLpf, 1); break;
+    case kFilterLpf4p: fTable.setup(TableBiquad::kLpf, 2); break;
+    case kFilterLpf6p: fTable.setup(TableBiquad::kLpf, 3); break;
+    case kFilterHpf2p: fTable.setup(TableBiquad::kHpf, 1); break;
+    case kFilterHpf4p: fTable.setup(TableBiquad::kHpf, 2); break;
+    case kFilterHpf6p: fTable.setup(TableBiquad::kHpf, 3); break;
+    case kFilterBpf2p: fTable.setup(TableBiquad::kBpf, 1); break;
+    case kFilterBpf4p: fTable.setup(TableBiquad::kBpf, 2); break;
+    case kFilterBpf6p: fTable.setup(TableBiquad::kBpf, 3); break;
+    case kFilterBrf2p: fTable.setup(TableBiquad::kBrf, 1); break;
+    case kFilterPeq: fTable.setup(TableBiquad::kPeq, 1); break;
+    case kFilterLsh: fTable.setup(TableBiquad::kLsh, 1); break;
+    case kFilterHsh: fTable.setup(TableBiquad::kHsh, 1); break;
+    }
+}
+
 //------------------------------------------------------------------------------
 // SFZ v1 equalizer filter
 
 struct FilterEq::Impl {
     double fSampleRate = sfz::config::defaultSampleRate;
+    double fSmoothingPole = std::exp(-1000.0 / sfz::config::defaultSampleRate);
     EqType fType = kEqNone;
     unsigned fChannels = 1;
     enum { maxChannels = 2 };
 
+    const FilterTables* fTables = nullptr;
+    TableBiquad fTable;
+
+    bool usesTables() const { return fTables && fTable.stages > 0; }
+    void setupTable();
+
     union U {
         U() {}
         ~U() {}
@@ -262,6 +675,8 @@ void FilterEq::init(double sampleRate)
         dsp->init(sampleRate);
 
     P->fSampleRate = sampleRate;
+    P->fSmoothingPole = std::exp(-1000.0 / sampleRate);
+    P->fTable.clear();
 }
 
 void FilterEq::clear()
@@ -270,6 +685,8 @@ void FilterEq::clear()
 
     if (dsp)
         dsp->instanceClear();
+
+    P->fTable.clear();
 }
 
 void FilterEq::prepare(float cutoff, float bw, float pksh)
@@ -279,6 +696,11 @@ void FilterEq::prepare(float cutoff, float bw, float pksh)
     if (!dsp)
         return;
 
+    if (P->usesTables()) {
+        P->fTable.prepare(*P->fTables, cutoff, bw, pksh);
+        return;
+    }
+
     // compute a dummy 1-frame cycle with smoothing off
 
     float buffer[Impl::maxChannels] = {0};
@@ -306,6 +728,12 @@ void FilterEq::process(const float *const in[], float *const out[], float cutoff
         return;
     }
 
+    if (P->usesTables()) {
+        P->fTable.configure(*P->fTables, cutoff, bw, pksh);
+        P->fTable.compute(in, out, channels, nframes, P->fSmoothingPole);
+        return;
+    }
+
     dsp->configureEq(cutoff, bw, pksh);
     dsp->compute(nframes, const_cast<float **>(in), const_cast<float **>(out));
 }
@@ -321,6 +749,16 @@ void FilterEq::processModulated(const float *const in[], float *const out[], con
         return;
     }
 
+    if (nframes == 0)
+        return;
+
+    // Constant parameters need a single configuration for the whole cycle
+    if (isConstant(cutoff, nframes) && isConstant(bw, nframes) && isConstant(pksh, nframes)) {
+        process(in, out, cutoff[0], bw[0], pksh[0], nframes);
+        return;
+    }
+
+    const bool usesTables = P->usesTables();
     unsigned frame = 0;
     while (frame < nframes) {
         unsigned current = nframes - frame;
@@ -336,8 +774,13 @@ void FilterEq::processModulated(const float *const in[], float *const out[], con
             current_out[c] = out[c] + frame;
         }
 
-        dsp->configureEq(cutoff[frame], bw[frame], pksh[frame]);
-        dsp->compute(current, const_cast<float **>(current_in), const_cast<float **>(current_out));
+        if (usesTables) {
+            P->fTable.configure(*P->fTables, cutoff[frame], bw[frame], pksh[frame]);
+            P->fTable.compute(current_in, current_out, channels, current, P->fSmoothingPole);
+        } else {
+            dsp->configureEq(cutoff[frame], bw[frame], pksh[frame]);
+            dsp->compute(current, const_cast<float **>(current_in), const_cast<float **>(current_out));
+        }
 
         frame += current;
     }
@@ -362,6 +805,8 @@ void FilterEq::setChannels(unsigned channels)
         dsp = P->newDsp(channels, P->fType);
         if (dsp)
             dsp->init(P->fSampleRate);
+
+        P->fTable.clear();
     }
 }
 
@@ -382,9 +827,17 @@ void FilterEq::setType(EqType type)
         dsp = P->newDsp(P->fChannels, type);
         if (dsp)
             dsp->init(P->fSampleRate);
+
+        P->setupTable();
     }
 }
 
+void FilterEq::setCoefficientTables(const FilterTables* tables)
+{
+    P->fTables = tables;
+    P->fTable.clear();
+}
+
 sfzFilterDsp *FilterEq::Impl::getDsp(unsigned channels, EqType type)
 {
     switch (idDsp(channels, type)) {
@@ -411,4 +864,14 @@ sfzFilterDsp *FilterEq::Impl::newDsp(unsigned channels, EqType type)
     }
 }
 
+void FilterEq::Impl::setupTable()
+{
+    switch (fType) {
+    default: fTable.setup(TableBiquad::kNone, 0); break;
+    case kEqPeak: fTable.setup(TableBiquad::kEqPeak, 1); break;
+    case kEqLshelf: fTable.setup(TableBiquad::kEqLshelf, 1); break;
+    case kEqHshelf: fTable.setup(TableBiquad::kEqHshelf, 1); break;
+    }
+}
+
 } // namespace sfz
@@ -8,11 +8,67 @@
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include <memory>
+#include <vector>
 
 namespace sfz {
 
 enum FilterType : int;
 
+/**
+   Tables of the transcendental terms of the RBJ filter coefficients, which
+   the filters and equalizers can use instead of computing them exactly.
+   The terms are interpolated linearly between the points of the tables.
+
+   Tables:
+     cutoff: the cosine and sine of the angular frequency, from 1 Hz to
+       20 kHz, with points linearly spaced within each octave
+     resonance: the linear Q of a resonance in dB, from -60 to 60 dB
+     gain: the amplitude of a peak/shelf gain in dB, from -120 to 60 dB
+ */
+class FilterTables {
+public:
+    FilterTables();
+
+    /**
+       Build the tables which depend on the sample rate.
+       It does nothing if the sample rate is unchanged.
+     */
+    void setSampleRate(double sampleRate);
+
+    /**
+       Get the sample rate of the tables.
+     */
+    double sampleRate() const { return fSampleRate; }
+
+    /**
+       Get the cosine and sine of the angular frequency of a cutoff in Hz.
+       The cutoff is clamped to the range of the table.
+     */
+    void cosSin(float cutoff, double& c, double& s) const;
+
+    /**
+       Get the linear Q of a resonance in dB.
+     */
+    double resonanceQ(float q) const;
+
+    /**
+       Get the amplitude of a peak/shelf gain in dB, as `10^(pksh/40)`.
+     */
+    double peakShelfAmplitude(float pksh) const;
+
+    // Number of points of the cutoff table within an octave
+    static constexpr unsigned cutoffPointsPerOctave = 256;
+    // Number of points of the resonance and gain tables within a dB
+    static constexpr unsigned pointsPerDecibel = 16;
+
+private:
+    double fSampleRate = 0.0;
+    // Cosine and sine pairs
+    std::vector<double> fCosSin;
+    std::vector<double> fResonance;
+    std::vector<double> fGain;
+};
+
 /**
    Multi-mode filter for SFZ v2
    Available for mono and stereo. (channels=1, channels=2)
@@ -64,6 +120,15 @@ public:
      */
     void processModulated(const float *const in[], float *const out[], const float *cutoff, const float *q, const float *pksh, unsigned nframes);
 
+    /**
+       Set the tables to compute the coefficients with, or null to compute
+       them exactly. The tables apply to the 2-pole RBJ filters and their
+       cascades, and the other types compute their coefficients exactly.
+       The tables must outlive the filter, and match its sample rate.
+       This clears the filter memory.
+     */
+    void setCoefficientTables(const FilterTables* tables);
+
     /**
        Get the number of channels.
      */
@@ -169,6 +234,14 @@ public:
      */
     void processModulated(const float *const in[], float *const out[], const float *cutoff, const float *bw, const float *pksh, unsigned nframes);
 
+    /**
+       Set the tables to compute the coefficients with, or null to compute
+       them exactly. The tables must outlive the equalizer, and match its
+       sample rate.
+       This clears the filter memory.
+     */
+    void setCoefficientTables(const FilterTables* tables);
+
     /**
        Get the number of channels.
      */
@@ -45,8 +45,24 @@ namespace sfz {
 // unless set to permissive, the loader rejects sfz files with errors
 static constexpr bool loaderParsesPermissively = true;
 
+/**
+ * @brief Order the voices by effect sends, so the voices which share their
+ * sends are mixed into the buses together.
+ */
+static void sortVoicesBySends(std::vector<Voice*>& voices) noexcept
+{
+    std::sort(voices.begin(), voices.end(), [](const Voice* lhs, const Voice* rhs) {
+        const int lhsSends = lhs->getRegion()->effectSendsId;
+        const int rhsSends = rhs->getRegion()->effectSendsId;
+        if (lhsSends != rhsSends)
+            return lhsSends < rhsSends;
+        return lhs->getId().number() < rhs->getId().number();
+    });
+}
+
 Synth::Synth()
-: impl_(new Impl) // NOLINT: (paul) I don't get why clang-tidy complains here
+: impl_(new Impl), // NOLINT: (paul) I don't get why clang-tidy complains here
+  swap_(new InstrumentSwap)
 {
 }
 
@@ -65,6 +81,7 @@ Synth::Impl::Impl()
     effectFactory_.registerStandardEffectTypes();
     effectBuses_.reserve(5); // sufficient room for main and fx1-4
     resetVoices(config::numVoices);
+    setupRenderLanes();
 
     // modulation sources
     MidiState& midiState = resources_.getMidiState();
@@ -229,7 +246,7 @@ void Synth::Impl::buildRegion(const std::vector<Opcode>& regionOpcodes)
     lastLayer->initializeActivations();
 }
 
-void Synth::Impl::clear()
+void Synth::Impl::clear(bool keepPreloadedFiles)
 {
     FilePool& filePool = resources_.getFilePool();
     MidiState& midiState = resources_.getMidiState();
@@ -246,6 +263,7 @@ void Synth::Impl::clear()
         list.clear();
     for (auto& list : noteActivationLists_)
         list.clear();
+    noteActivationIndex_.clear();
     for (auto& list : ccActivationLists_)
         list.clear();
     previousKeyswitchLists_.clear();
@@ -264,10 +282,15 @@ void Synth::Impl::clear()
     numGroups_ = 0;
     numMasters_ = 0;
     currentSwitch_ = absl::nullopt;
+    noteHistorySize_ = 0;
+    noteHistoryIndex_ = 0;
     defaultPath_ = "";
     image_ = "";
     midiState.reset();
-    filePool.clear();
+    if (keepPreloadedFiles)
+        filePool.clearForReload();
+    else
+        filePool.clear();
     filePool.setRamLoading(config::loadInRam);
     clearCCLabels();
     currentUsedCCs_.clear();
@@ -519,57 +542,322 @@ void Synth::Impl::handleEffectOpcodes(const std::vector<Opcode>& rawMembers)
 bool Synth::loadSfzFile(const fs::path& file)
 {
     Impl& impl = *impl_;
+    return impl.loadSfzFile(file, false);
+}
 
-    impl.clear();
+bool Synth::reloadSfzFile(const fs::path& file)
+{
+    Impl& impl = *impl_;
+    return impl.loadSfzFile(file, true);
+}
+
+bool Synth::Impl::loadSfzFile(const fs::path& file, bool keepPreloadedFiles)
+{
+    clear(keepPreloadedFiles);
 
     std::error_code ec;
     fs::path realFile = fs::canonical(file, ec);
 
     bool success = true;
-    Parser& parser = impl.parser_;
-    parser.parseFile(ec ? file : realFile);
+    parser_.parseFile(ec ? file : realFile);
 
     // permissive parsing for compatibility
     if (!loaderParsesPermissively)
-        success = parser.getErrorCount() == 0;
+        success = parser_.getErrorCount() == 0;
 
-    success = success && !impl.layers_.empty();
+    success = success && !layers_.empty();
 
     if (!success) {
-        parser.clear();
+        parser_.clear();
+        return false;
+    }
+
+    if (!finalizeSfzLoad()) {
+        clear();
         return false;
     }
 
-    impl.finalizeSfzLoad();
     return true;
 }
 
 bool Synth::loadSfzString(const fs::path& path, absl::string_view text)
 {
     Impl& impl = *impl_;
+    return impl.loadSfzString(path, text, false);
+}
+
+bool Synth::reloadSfzString(const fs::path& path, absl::string_view text)
+{
+    Impl& impl = *impl_;
+    return impl.loadSfzString(path, text, true);
+}
 
-    impl.clear();
+bool Synth::Impl::loadSfzString(const fs::path& path, absl::string_view text, bool keepPreloadedFiles)
+{
+    clear(keepPreloadedFiles);
 
     bool success = true;
-    Parser& parser = impl.parser_;
-    parser.parseString(path, text);
+    parser_.parseString(path, text);
 
     // permissive parsing for compatibility
     if (!loaderParsesPermissively)
-        success = parser.getErrorCount() == 0;
+        success = parser_.getErrorCount() == 0;
 
-    success = success && !impl.layers_.empty();
+    success = success && !layers_.empty();
 
     if (!success) {
-        parser.clear();
+        parser_.clear();
+        return false;
+    }
+
+    if (!finalizeSfzLoad()) {
+        clear();
         return false;
     }
 
-    impl.finalizeSfzLoad();
     return true;
 }
 
-void Synth::Impl::finalizeSfzLoad()
+void Synth::setLoadProgressCallback(LoadProgressCallback callback)
+{
+    Impl& impl = *impl_;
+    impl.loadProgressCallback_ = std::move(callback);
+}
+
+bool Synth::loadSfzFileInBackground(const fs::path& file)
+{
+    return loadInBackground([&file](Synth& synth) {
+        return synth.reloadSfzFile(file);
+    });
+}
+
+bool Synth::loadSfzStringInBackground(const fs::path& path, absl::string_view text)
+{
+    return loadInBackground([&path, text](Synth& synth) {
+        return synth.reloadSfzString(path, text);
+    });
+}
+
+bool Synth::isInstrumentSwapPending() const noexcept
+{
+    return swap_->replaced.load() != nullptr;
+}
+
+void Synth::copySettingsTo(Synth& other) const
+{
+    const Impl& impl = *impl_;
+    Impl& otherImpl = *other.impl_;
+
+    if (otherImpl.samplesPerBlock_ != impl.samplesPerBlock_)
+        other.setSamplesPerBlock(impl.samplesPerBlock_);
+    if (otherImpl.sampleRate_ != impl.sampleRate_)
+        other.setSampleRate(impl.sampleRate_);
+    other.setNumVoices(impl.numVoices_);
+    other.setNumRenderThreads(getNumRenderThreads());
+
+    const FilePool& filePool = impl.resources_.getFilePool();
+    FilePool& otherFilePool = otherImpl.resources_.getFilePool();
+    // Changing these reads the preloaded data again
+    if (otherFilePool.getPreloadSize() != filePool.getPreloadSize())
+        otherFilePool.setPreloadSize(filePool.getPreloadSize());
+    if (otherFilePool.getOversamplingFactor() != filePool.getOversamplingFactor())
+        otherFilePool.setOversamplingFactor(filePool.getOversamplingFactor());
+    otherFilePool.setStreamRingSize(filePool.getStreamRingSize());
+    otherFilePool.setMappedStreaming(filePool.getMappedStreaming());
+    otherFilePool.setSharedPreloading(filePool.getSharedPreloading());
+    otherFilePool.setPredictiveLoading(filePool.getPredictiveLoading());
+    otherFilePool.setPredictiveLoadingBudget(filePool.getPredictiveLoadingBudget());
+    otherFilePool.setLoadedMemoryBudget(filePool.getLoadedMemoryBudget());
+    const fs::path cacheDirectory = filePool.getPreloadCacheDirectory();
+    if (otherFilePool.getPreloadCacheDirectory() != cacheDirectory)
+        otherFilePool.setPreloadCacheDirectory(cacheDirectory);
+
+    otherImpl.loadProgressCallback_ = impl.loadProgressCallback_;
+    otherImpl.broadcastReceiver = impl.broadcastReceiver;
+    otherImpl.broadcastData = impl.broadcastData;
+
+    std::lock_guard<SpinMutex> settingsLock { swap_->settingsMutex };
+    copyLiveSettingsTo(other);
+}
+
+void Synth::copyLiveSettingsTo(Synth& other) const
+{
+    const Impl& impl = *impl_;
+    Impl& otherImpl = *other.impl_;
+
+    otherImpl.volume_ = impl.volume_;
+
+    // The instrument decides whether the sustain cancels the release
+    SynthConfig& otherConfig = otherImpl.resources_.getSynthConfig();
+    const bool sustainCancelsRelease = otherConfig.sustainCancelsRelease;
+    otherConfig = impl.resources_.getSynthConfig();
+    otherConfig.sustainCancelsRelease = sustainCancelsRelease;
+
+    otherImpl.resources_.getTuning() = impl.resources_.getTuning();
+    otherImpl.resources_.getStretch() = impl.resources_.getStretch();
+}
+
+bool Synth::loadInBackground(const std::function<bool(Synth&)>& load)
+{
+    InstrumentSwap& swap = *swap_;
+    std::lock_guard<std::mutex> loadLock { swap.loadMutex };
+
+    std::unique_ptr<InstrumentSwap::Staged> staged { new InstrumentSwap::Staged };
+    Synth& synth = staged->synth;
+    copySettingsTo(synth);
+    {
+        std::lock_guard<SpinMutex> settingsLock { swap.settingsMutex };
+        for (const auto& definition : impl_->parser_.getExternalDefinitions())
+            synth.impl_->parser_.addExternalDefinition(definition.first, definition.second);
+    }
+
+    // The new instrument shares the preloaded data of the current one, and
+    // only reads the files which are new or modified
+    synth.impl_->resources_.getFilePool().seedPreloadedFiles(impl_->resources_.getFilePool());
+
+    if (!load(synth))
+        return false;
+
+    swap.startRetirementThread();
+
+    // Apply the settings which were changed during the load
+    copySettingsTo(synth);
+
+    const size_t blockSize = static_cast<size_t>(getSamplesPerBlock());
+    staged->ringOut = AudioBuffer<float>(config::numChannels, blockSize);
+    staged->ringOutGain.resize(blockSize);
+    staged->ringOutFrames = static_cast<size_t>(config::instrumentSwapRingOutTime * impl_->sampleRate_);
+
+    // The settings which may change on the audio thread are applied last,
+    // with their setters held off until the new instrument is published
+    std::lock_guard<SpinMutex> settingsLock { swap.settingsMutex };
+    copyLiveSettingsTo(synth);
+
+    // The staged synth now holds the replaced instrument, which the audio
+    // thread takes over at its next block
+    Impl* replaced = impl_.exchange(synth.impl_.exchange(nullptr));
+    synth.impl_.exchange(replaced);
+    InstrumentSwap::push(swap.replaced, staged.release());
+    return true;
+}
+
+void Synth::takeReplacedInstruments() noexcept
+{
+    InstrumentSwap& swap = *swap_;
+    if (!swap.replaced.load(std::memory_order_relaxed))
+        return;
+
+    InstrumentSwap::Staged* replaced = swap.replaced.exchange(nullptr);
+    if (!replaced)
+        return;
+
+    // The most recent instrument rings out, the others are retired at once
+    if (swap.retiring)
+        swap.retire(swap.retiring.release());
+    if (replaced->next) {
+        swap.retire(replaced->next);
+        replaced->next = nullptr;
+    }
+
+    replaced->ringOutPosition = 0;
+    swap.retiring.reset(replaced);
+}
+
+void Synth::renderRetiringInstrument(AudioSpan<float> buffer) noexcept
+{
+    InstrumentSwap& swap = *swap_;
+    InstrumentSwap::Staged* retiring = swap.retiring.get();
+    if (!retiring)
+        return;
+
+    const bool finished = retiring->ringOutPosition >= retiring->ringOutFrames
+        || retiring->synth.getNumActiveVoices() == 0;
+
+    if (finished) {
+        swap.retire(swap.retiring.release());
+        return;
+    }
+
+    const size_t numFrames = min(buffer.getNumFrames(), retiring->ringOut.getNumFrames());
+    AudioSpan<float> ringOut = AudioSpan<float>(retiring->ringOut).first(numFrames);
+    retiring->synth.renderBlock(ringOut);
+
+    const float step = -1.0f / retiring->ringOutFrames;
+    const float start = 1.0f + step * retiring->ringOutPosition;
+    absl::Span<float> gain = absl::MakeSpan(retiring->ringOutGain).first(numFrames);
+    linearRamp<float>(gain, start, step);
+    for (float& g : gain)
+        g = max(g, 0.0f);
+
+    const size_t numChannels = min(buffer.getNumChannels(), ringOut.getNumChannels());
+    for (size_t c = 0; c < numChannels; ++c)
+        multiplyAdd<float>(gain, ringOut.getConstSpan(c), buffer.getSpan(c).first(numFrames));
+
+    retiring->ringOutPosition += numFrames;
+}
+
+Synth::ImplHolder::~ImplHolder()
+{
+    delete ptr_.load();
+}
+
+Synth::InstrumentSwap::~InstrumentSwap()
+{
+    if (retirementThread.joinable()) {
+        std::error_code ec;
+        retirementFlag = false;
+        retirementBarrier.post(ec);
+        retirementThread.join();
+    }
+
+    deleteChain(replaced.exchange(nullptr));
+    deleteChain(retired.exchange(nullptr));
+}
+
+void Synth::InstrumentSwap::push(std::atomic<Staged*>& list, Staged* chain) noexcept
+{
+    Staged* last = chain;
+    while (last->next)
+        last = last->next;
+
+    Staged* head = list.load(std::memory_order_relaxed);
+    do
+        last->next = head;
+    while (!list.compare_exchange_weak(head, chain, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void Synth::InstrumentSwap::deleteChain(Staged* chain) noexcept
+{
+    while (chain) {
+        Staged* next = chain->next;
+        delete chain;
+        chain = next;
+    }
+}
+
+void Synth::InstrumentSwap::retire(Staged* chain) noexcept
+{
+    push(retired, chain);
+    std::error_code ec;
+    retirementBarrier.post(ec);
+}
+
+void Synth::InstrumentSwap::startRetirementThread()
+{
+    if (retirementThread.joinable())
+        return;
+
+    retirementFlag = true;
+    retirementThread = std::thread(&InstrumentSwap::retirementJob, this);
+}
+
+void Synth::InstrumentSwap::retirementJob() noexcept
+{
+    while (retirementBarrier.wait(), retirementFlag)
+        deleteChain(retired.exchange(nullptr, std::memory_order_acquire));
+}
+
+bool Synth::Impl::finalizeSfzLoad()
 {
     const fs::path& rootDirectory = parser_.originalDirectory();
     FilePool& filePool = resources_.getFilePool();
@@ -630,7 +918,7 @@ void Synth::Impl::finalizeSfzLoad()
                 bool allZeros = true;
                 int numChannels = sample->information.numChannels;
                 for (int i = 0; i < numChannels; ++i) {
-                    allZeros &= allWithin(sample->preloadedData.getConstSpan(i),
+                    allZeros &= allWithin(sample->preloadedData->getConstSpan(i),
                         -config::virtuallyZero, config::virtuallyZero);
                 }
 
@@ -764,16 +1052,47 @@ void Synth::Impl::finalizeSfzLoad()
         ++currentRegionIndex;
     }
 
-    for (const auto& toLoad: filesToLoad) {
-        filePool.preloadFile(toLoad.first, toLoad.second);
+    std::vector<std::pair<FileId, uint32_t>> preloads;
+    preloads.reserve(filesToLoad.size());
+    for (const auto& toLoad: filesToLoad)
+        preloads.emplace_back(toLoad.first, static_cast<uint32_t>(toLoad.second));
+
+    if (!filePool.preloadFiles(preloads, loadProgressCallback_)) {
+        DBG("[sfizz] The load was cancelled");
+        return false;
     }
 
+    // Drop the files kept from the previous load which are not used anymore
+    filePool.removeUnusedPreloadedFiles(preloads);
+
     if (currentRegionCount < layers_.size()) {
         DBG("Removing " << (layers_.size() - currentRegionCount)
             << " out of " << layers_.size() << " regions");
     }
     layers_.resize(currentRegionCount);
 
+    noteActivationIndex_.build(noteActivationLists_);
+
+    // Compact the effect sends, and number the distinct ones so the voices
+    // which share their sends get mixed into the buses together
+    absl::flat_hash_map<std::vector<float>, int> effectSendsIds;
+    std::vector<float> sendsKey;
+    for (const LayerPtr& layerPtr : layers_) {
+        Region& region = layerPtr->getRegion();
+        region.effectSends.clear();
+        sendsKey.clear();
+        for (size_t i = 0, n = min(region.gainToEffect.size(), effectBuses_.size()); i < n; ++i) {
+            const float gain = region.gainToEffect[i];
+            if (gain == 0.0f || !effectBuses_[i])
+                continue;
+            region.effectSends.push_back({ static_cast<unsigned>(i), gain });
+            sendsKey.push_back(static_cast<float>(i));
+            sendsKey.push_back(gain);
+        }
+        const int nextId = static_cast<int>(effectSendsIds.size());
+        region.effectSendsId = effectSendsIds.emplace(sendsKey, nextId).first->second;
+    }
+
     // collect all CCs used in regions, with matrix not yet connected
     BitArray<config::numCCs> usedCCs;
     for (const LayerPtr& layerPtr : layers_) {
@@ -821,6 +1140,8 @@ void Synth::Impl::finalizeSfzLoad()
 
     setupModMatrix();
 
+    setupRenderLanes();
+
     // cache the set of used CCs for future access
     currentUsedCCs_ = collectAllUsedCCs();
 
@@ -846,22 +1167,27 @@ void Synth::Impl::finalizeSfzLoad()
                 swLastSlots_.set(key);
         }
     }
+
+    return true;
 }
 
 bool Synth::loadScalaFile(const fs::path& path)
 {
+    std::lock_guard<SpinMutex> settingsLock { swap_->settingsMutex };
     Impl& impl = *impl_;
     return impl.resources_.getTuning().loadScalaFile(path);
 }
 
 bool Synth::loadScalaString(const std::string& text)
 {
+    std::lock_guard<SpinMutex> settingsLock { swap_->settingsMutex };
     Impl& impl = *impl_;
     return impl.resources_.getTuning().loadScalaString(text);
 }
 
 void Synth::setScalaRootKey(int rootKey)
 {
+    std::lock_guard<SpinMutex> settingsLock { swap_->settingsMutex };
     Impl& impl = *impl_;
     impl.resources_.getTuning().setScalaRootKey(rootKey);
 }
@@ -874,6 +1200,7 @@ int Synth::getScalaRootKey() const
 
 void Synth::setTuningFrequency(float frequency)
 {
+    std::lock_guard<SpinMutex> settingsLock { swap_->settingsMutex };
     Impl& impl = *impl_;
     impl.resources_.getTuning().setTuningFrequency(frequency);
 }
@@ -886,9 +1213,10 @@ float Synth::getTuningFrequency() const
 
 void Synth::loadStretchTuningByRatio(float ratio)
 {
-    Impl& impl = *impl_;
     SFIZZ_CHECK(ratio >= 0.0f && ratio <= 1.0f);
     ratio = clamp(ratio, 0.0f, 1.0f);
+    std::lock_guard<SpinMutex> settingsLock { swap_->settingsMutex };
+    Impl& impl = *impl_;
 
     absl::optional<StretchTuning>& stretch = impl.resources_.getStretch();
     if (ratio > 0.0f)
@@ -923,6 +1251,8 @@ void Synth::setSamplesPerBlock(int samplesPerBlock) noexcept
         if (bus)
             bus->setSamplesPerBlock(samplesPerBlock);
     }
+
+    impl.setupRenderLanes();
 }
 
 int Synth::getSamplesPerBlock() const noexcept
@@ -941,6 +1271,9 @@ void Synth::setSampleRate(float sampleRate) noexcept
 
     impl.resources_.setSampleRate(sampleRate);
 
+    for (auto& lane : impl.renderLanes_)
+        lane.batch.setSampleRate(sampleRate);
+
     for (auto& bus : impl.effectBuses_) {
         if (bus)
             bus->setSampleRate(sampleRate);
@@ -949,6 +1282,8 @@ void Synth::setSampleRate(float sampleRate) noexcept
 
 void Synth::renderBlock(AudioSpan<float> buffer) noexcept
 {
+    takeReplacedInstruments();
+
     Impl& impl = *impl_;
     ScopedFTZ ftz;
     CallbackBreakdown callbackBreakdown;
@@ -975,7 +1310,7 @@ void Synth::renderBlock(AudioSpan<float> buffer) noexcept
     const auto timeSinceLastCollection =
         std::chrono::duration_cast<std::chrono::seconds>(now - impl.lastGarbageCollection_);
 
-    if (timeSinceLastCollection.count() > config::fileClearingPeriod) {
+    if (timeSinceLastCollection.count() > config::fileClearingPeriod || filePool.isOverMemoryBudget()) {
         impl.lastGarbageCollection_ = now;
         filePool.triggerGarbageCollection();
     }
@@ -1014,45 +1349,109 @@ void Synth::renderBlock(AudioSpan<float> buffer) noexcept
         ScopedTiming logger { callbackBreakdown.renderMethod, ScopedTiming::Operation::addToDuration };
         tempMixSpan->fill(0.0f);
 
-        for (auto& voice : impl.voiceManager_) {
-            if (voice.isFree())
-                continue;
+        if (impl.renderWorkers_.getNumThreads() > 1) {
+            impl.distributeVoicesToLanes();
+            mm.generatePerCycleModulations();
+            impl.renderNumFrames_ = numFrames;
+            impl.renderWorkers_.run(impl);
+
+            for (auto& lane : impl.renderLanes_)
+                callbackBreakdown.data += lane.batch.takeRenderDuration();
+
+            // Sum the lane accumulators in lane order
+            const unsigned numLanes = static_cast<unsigned>(impl.renderLanes_.size());
+            for (unsigned lane = 0; lane < numLanes; ++lane) {
+                const Impl::RenderLane& renderLane = impl.renderLanes_[lane];
+                if (renderLane.voices.empty())
+                    continue;
+
+                const size_t numBuses = min(impl.effectBuses_.size(), renderLane.busInputs.size());
+                for (size_t i = 0; i < numBuses; ++i) {
+                    auto& bus = impl.effectBuses_[i];
+                    if (bus && renderLane.busInputs[i] && renderLane.busSends[i])
+                        bus->addToInputs(AudioSpan<float>(*renderLane.busInputs[i]), 1.0f, numFrames);
+                }
+            }
 
-            mm.beginVoice(voice.getId(), voice.getRegion()->getId(), voice.getTriggerEvent().value);
+            for (auto& voice : impl.voiceManager_) {
+                if (voice.isFree())
+                    continue;
 
-            const Region* region = voice.getRegion();
-            ASSERT(region != nullptr);
+                callbackBreakdown.data += voice.getLastDataDuration();
+                callbackBreakdown.amplitude += voice.getLastAmplitudeDuration();
+                callbackBreakdown.filters += voice.getLastFilterDuration();
+                callbackBreakdown.panning += voice.getLastPanningDuration();
 
-            voice.renderBlock(*tempSpan);
-            for (size_t i = 0, n = impl.effectBuses_.size(); i < n; ++i) {
-                if (auto& bus = impl.effectBuses_[i]) {
-                    float addGain = region->getGainToEffectBus(i);
-                    bus->addToInputs(*tempSpan, addGain, numFrames);
-                }
+                if (voice.toBeCleanedUp())
+                    voice.reset();
+            }
+        }
+        else {
+            Impl::RenderLane& renderLane = impl.renderLanes_.front();
+            renderLane.voices.clear();
+            for (auto& voice : impl.voiceManager_) {
+                if (voice.isFree())
+                    continue;
+
+                ASSERT(voice.getRegion() != nullptr);
+                renderLane.voices.push_back(&voice);
             }
-            callbackBreakdown.data += voice.getLastDataDuration();
-            callbackBreakdown.amplitude += voice.getLastAmplitudeDuration();
-            callbackBreakdown.filters += voice.getLastFilterDuration();
-            callbackBreakdown.panning += voice.getLastPanningDuration();
+            sortVoicesBySends(renderLane.voices);
 
-            mm.endVoice();
+            for (Voice* voice : renderLane.voices) {
+                impl.renderLaneVoice(renderLane, 0, *voice, *tempSpan, numFrames);
 
-            if (voice.toBeCleanedUp())
-                voice.reset();
+                callbackBreakdown.data += voice->getLastDataDuration();
+                callbackBreakdown.amplitude += voice->getLastAmplitudeDuration();
+                callbackBreakdown.filters += voice->getLastFilterDuration();
+                callbackBreakdown.panning += voice->getLastPanningDuration();
+            }
+            impl.flushLaneBatch(renderLane, 0, *tempSpan, numFrames);
+            impl.flushLaneSends(renderLane, 0, numFrames);
+            callbackBreakdown.data += renderLane.batch.takeRenderDuration();
+
+            // The batched voices are referenced until the batch is rendered,
+            // so the ended voices are cleaned up afterwards
+            for (auto& voice : impl.voiceManager_) {
+                if (voice.toBeCleanedUp())
+                    voice.reset();
+            }
         }
     }
 
+    size_t numSkippedEffectBuses = 0;
     { // Apply effect buses
         // -- note(jpc) there is always a "main" bus which is initially empty.
         //    without any <effect>, the signal is just going to flow through it.
         ScopedTiming logger { callbackBreakdown.effects, ScopedTiming::Operation::addToDuration };
 
+        // The idle buses output silence, and are skipped
+        Impl::EffectBusTask& busTask = impl.effectBusTask_;
+        busTask.buses.clear();
         for (auto& bus : impl.effectBuses_) {
-            if (bus) {
+            if (!bus)
+                continue;
+            if (bus->isIdle())
+                ++numSkippedEffectBuses;
+            else
+                busTask.buses.push_back(bus.get());
+        }
+
+        const bool parallelBuses = impl.resources_.getSynthConfig().parallelEffectBuses
+            && impl.renderWorkers_.getNumThreads() > 1 && busTask.buses.size() > 1;
+        if (parallelBuses) {
+            busTask.numFrames = numFrames;
+            busTask.nextBus.store(0, std::memory_order_relaxed);
+            impl.renderWorkers_.run(busTask);
+        }
+        else {
+            for (EffectBus* bus : busTask.buses)
                 bus->process(numFrames);
-                bus->mixOutputsTo(buffer, *tempMixSpan, numFrames);
-            }
         }
+
+        // Mix in the order of the buses, whichever thread processed them
+        for (EffectBus* bus : busTask.buses)
+            bus->mixOutputsTo(buffer, *tempMixSpan, numFrames);
     }
 
     // Add the Mix output (fxNtomix opcodes)
@@ -1093,15 +1492,241 @@ void Synth::renderBlock(AudioSpan<float> buffer) noexcept
     logger.logCallbackTime(
         callbackBreakdown, impl.voiceManager_.getNumActiveVoices(), numFrames);
 
+    Telemetry& telemetry = logger.getTelemetry();
+    telemetry.addStolenVoices(impl.voiceManager_.takeNumStolenVoices());
+    telemetry.addBufferPoolExhaustions(impl.resources_.takeNumBufferPoolExhaustions());
+    telemetry.setFileQueueDepth(filePool.getNumPendingLoads());
+    telemetry.setStreamUnderruns(filePool.getNumStreamUnderruns());
+    telemetry.addEffectBusBlocks(impl.effectBusTask_.buses.size(), numSkippedEffectBuses);
+
     // Reset the dispatch counter
     impl.dispatchDuration_ = Duration(0);
 
+    // Mix the replaced instrument while it rings out
+    renderRetiringInstrument(buffer);
+
     ASSERT(!hasNanInf(buffer.getConstSpan(0)));
     ASSERT(!hasNanInf(buffer.getConstSpan(1)));
     SFIZZ_CHECK(isReasonableAudio(buffer.getConstSpan(0)));
     SFIZZ_CHECK(isReasonableAudio(buffer.getConstSpan(1)));
 }
 
+void Synth::Impl::distributeVoicesToLanes() noexcept
+{
+    for (auto& renderLane : renderLanes_)
+        renderLane.voices.clear();
+    std::fill(laneCosts_.begin(), laneCosts_.end(), 0);
+
+    laneVoices_.clear();
+    for (auto& voice : voiceManager_) {
+        if (voice.isFree())
+            continue;
+
+        ASSERT(voice.getRegion() != nullptr);
+        laneVoices_.push_back(&voice);
+    }
+
+    if (laneVoices_.empty())
+        return;
+
+    std::sort(laneVoices_.begin(), laneVoices_.end(), [](const Voice* lhs, const Voice* rhs) {
+        const int lhsRegion = lhs->getRegion()->getId().number();
+        const int rhsRegion = rhs->getRegion()->getId().number();
+        if (lhsRegion != rhsRegion)
+            return lhsRegion < rhsRegion;
+        return lhs->getId().number() < rhs->getId().number();
+    });
+
+    laneGroups_.clear();
+    for (size_t i = 0, n = laneVoices_.size(); i < n; ++i) {
+        const Region* region = laneVoices_[i]->getRegion();
+        if (i == 0 || region != laneVoices_[i - 1]->getRegion())
+            laneGroups_.push_back({ i, i, 0 });
+
+        // The voice itself, then each of its filters and equalizers
+        LaneGroup& group = laneGroups_.back();
+        group.end = i + 1;
+        group.cost += 1 + region->filters.size() + region->equalizers.size();
+    }
+
+    std::sort(laneGroups_.begin(), laneGroups_.end(), [](const LaneGroup& lhs, const LaneGroup& rhs) {
+        if (lhs.cost != rhs.cost)
+            return lhs.cost > rhs.cost;
+        return lhs.begin < rhs.begin;
+    });
+
+    for (const LaneGroup& group : laneGroups_) {
+        const auto lane = static_cast<size_t>(
+            std::min_element(laneCosts_.begin(), laneCosts_.end()) - laneCosts_.begin());
+        RenderLane& renderLane = renderLanes_[lane];
+        for (size_t i = group.begin; i < group.end; ++i)
+            renderLane.voices.push_back(laneVoices_[i]);
+        laneCosts_[lane] += group.cost;
+    }
+}
+
+void Synth::Impl::processLane(unsigned lane) noexcept
+{
+    RenderLane& renderLane = renderLanes_[lane];
+    if (renderLane.voices.empty())
+        return;
+
+    const size_t numFrames = renderNumFrames_;
+    BufferPool& bufferPool = resources_.getBufferPool();
+
+    auto tempSpan = bufferPool.getStereoBuffer(numFrames);
+    if (!tempSpan) {
+        DBG("[sfizz] Could not get a temporary buffer for render lane " << lane);
+        return;
+    }
+
+    for (size_t i = 0, n = renderLane.busInputs.size(); i < n; ++i) {
+        auto& input = renderLane.busInputs[i];
+        if (input)
+            AudioSpan<float>(*input).first(numFrames).fill(0.0f);
+        renderLane.busSends[i] = false;
+    }
+
+    sortVoicesBySends(renderLane.voices);
+    for (Voice* voice : renderLane.voices)
+        renderLaneVoice(renderLane, lane, *voice, *tempSpan, numFrames);
+
+    flushLaneBatch(renderLane, lane, *tempSpan, numFrames);
+    flushLaneSends(renderLane, lane, numFrames);
+}
+
+void Synth::Impl::renderLaneVoice(RenderLane& renderLane, unsigned lane, Voice& voice, AudioSpan<float> tempSpan, size_t numFrames) noexcept
+{
+    const Region* region = voice.getRegion();
+    ModMatrix& mm = resources_.getModMatrix();
+    mm.beginVoice(voice.getId(), region->getId(), voice.getTriggerEvent().value);
+
+    VoiceBatch& batch = renderLane.batch;
+    bool batched = false;
+    if (resources_.getSynthConfig().batchedVoiceRendering) {
+        if (batch.full() || !batch.acceptsSendsOf(*region))
+            flushLaneBatch(renderLane, lane, tempSpan, numFrames);
+        batched = voice.renderBatched(batch, numFrames);
+    }
+
+    if (!batched) {
+        voice.renderBlock(tempSpan);
+        addToLaneSends(renderLane, lane, *region, tempSpan, numFrames);
+    }
+
+    mm.endVoice();
+}
+
+void Synth::Impl::flushLaneBatch(RenderLane& renderLane, unsigned lane, AudioSpan<float> tempSpan, size_t numFrames) noexcept
+{
+    VoiceBatch& batch = renderLane.batch;
+    if (batch.empty())
+        return;
+
+    AudioSpan<float> output = tempSpan.first(numFrames);
+    batch.process(output);
+    addToLaneSends(renderLane, lane, *batch.getReference(), output, numFrames);
+    batch.clear();
+}
+
+void Synth::Impl::addToLaneSends(RenderLane& renderLane, unsigned lane, const Region& region, AudioSpan<float> span, size_t numFrames) noexcept
+{
+    if (region.effectSends.empty())
+        return;
+
+    const Region* reference = renderLane.sendsReference;
+    if (reference && reference->effectSendsId != region.effectSendsId) {
+        flushLaneSends(renderLane, lane, numFrames);
+        reference = nullptr;
+    }
+
+    AudioSpan<float> input = span.first(numFrames);
+    AudioSpan<float> sendsInput = AudioSpan<float>(renderLane.sendsInput).first(numFrames);
+    if (reference)
+        sendsInput.add(input);
+    else
+        sendsInput.copy(input);
+    renderLane.sendsReference = &region;
+}
+
+void Synth::Impl::flushLaneSends(RenderLane& renderLane, unsigned lane, size_t numFrames) noexcept
+{
+    const Region* reference = renderLane.sendsReference;
+    if (!reference)
+        return;
+
+    addToEffectBuses(renderLane, lane, *reference, AudioSpan<float>(renderLane.sendsInput).first(numFrames), numFrames);
+    renderLane.sendsReference = nullptr;
+}
+
+void Synth::Impl::addToEffectBuses(RenderLane& renderLane, unsigned lane, const Region& region, AudioSpan<float> span, size_t numFrames) noexcept
+{
+    (void)lane;
+    for (const Region::EffectSend& send : region.effectSends) {
+        if (send.bus >= effectBuses_.size() || !effectBuses_[send.bus])
+            continue;
+
+        if (renderLane.busInputs.empty())
+            effectBuses_[send.bus]->addToInputs(span, send.gain, numFrames);
+        else if (send.bus < renderLane.busInputs.size() && renderLane.busInputs[send.bus]) {
+            AudioSpan<float> input = AudioSpan<float>(*renderLane.busInputs[send.bus]).first(numFrames);
+            for (unsigned c = 0; c < EffectChannels; ++c)
+                multiplyAdd1<float>(send.gain, span.getConstSpan(c), input.getSpan(c));
+            renderLane.busSends[send.bus] = true;
+        }
+    }
+}
+
+void Synth::Impl::EffectBusTask::processLane(unsigned lane) noexcept
+{
+    (void)lane;
+    const size_t numBuses = buses.size();
+    for (size_t i = nextBus.fetch_add(1, std::memory_order_relaxed); i < numBuses;
+         i = nextBus.fetch_add(1, std::memory_order_relaxed))
+        buses[i]->process(numFrames);
+}
+
+void Synth::Impl::setupRenderLanes()
+{
+    const unsigned numLanes = renderWorkers_.getNumThreads();
+    renderLanes_.resize(numLanes);
+
+    for (unsigned lane = 0; lane < numLanes; ++lane) {
+        RenderLane& renderLane = renderLanes_[lane];
+        renderLane.voices.reserve(config::maxVoices);
+        renderLane.batch.setSamplesPerBlock(samplesPerBlock_);
+        renderLane.batch.setSampleRate(sampleRate_);
+        renderLane.sendsInput.resize(samplesPerBlock_);
+        renderLane.sendsReference = nullptr;
+
+        // a single lane mixes directly into the effect buses
+        if (numLanes == 1) {
+            renderLane.busInputs.clear();
+            renderLane.busSends.clear();
+            continue;
+        }
+
+        renderLane.busInputs.resize(effectBuses_.size());
+        renderLane.busSends.assign(effectBuses_.size(), false);
+        for (size_t i = 0, n = effectBuses_.size(); i < n; ++i) {
+            auto& input = renderLane.busInputs[i];
+            if (!effectBuses_[i])
+                input.reset();
+            else if (!input)
+                input = absl::make_unique<AudioBuffer<float>>(EffectChannels, samplesPerBlock_);
+            else
+                input->resize(samplesPerBlock_);
+        }
+    }
+
+    laneVoices_.reserve(config::maxVoices);
+    laneGroups_.reserve(config::maxVoices);
+    laneCosts_.assign(numLanes, 0);
+
+    effectBusTask_.buses.reserve(effectBuses_.size());
+    resources_.setNumRenderThreads(numLanes);
+}
+
 void Synth::noteOn(int delay, int noteNumber, int velocity) noexcept
 {
     const float normalizedVelocity = normalizeVelocity(velocity);
@@ -1131,6 +1756,10 @@ void Synth::hdNoteOff(int delay, int noteNumber, float normalizedVelocity) noexc
     Impl& impl = *impl_;
     ScopedTiming logger { impl.dispatchDuration_, ScopedTiming::Operation::addToDuration };
 
+    // Let the voices of a replaced instrument release
+    if (InstrumentSwap::Staged* retiring = swap_->retiring.get())
+        retiring->synth.hdNoteOff(delay, noteNumber, normalizedVelocity);
+
     // FIXME: Some keyboards (e.g. Casio PX5S) can send a real note-off velocity. In this case, do we have a
     // way in sfz to specify that a release trigger should NOT use the note-on velocity?
     // auto replacedVelocity = (velocity == 0 ? getNoteVelocity(noteNumber) : velocity);
@@ -1160,12 +1789,18 @@ void Synth::Impl::startVoice(Layer* layer, int delay, const TriggerEvent& trigge
 
 void Synth::Impl::checkOffGroups(const Region* region, int delay, int number)
 {
-    for (auto& voice : voiceManager_) {
-        if (voice.checkOffGroup(region, delay, number)) {
-            const TriggerEvent& event = voice.getTriggerEvent();
-            noteOffDispatch(delay, event.number, event.value);
-        }
+    // Off the voices first, since dispatching the note offs can start or
+    // steal voices and change the group lists
+    std::array<TriggerEvent, config::maxVoices> offedEvents;
+    size_t numOffed = 0;
+
+    for (Voice* voice : voiceManager_.getVoicesOffBy(region->group)) {
+        if (voice->checkOffGroup(region, delay, number))
+            offedEvents[numOffed++] = voice->getTriggerEvent();
     }
+
+    for (size_t i = 0; i < numOffed; ++i)
+        noteOffDispatch(delay, offedEvents[i].number, offedEvents[i].value);
 }
 
 void Synth::Impl::noteOffDispatch(int delay, int noteNumber, float velocity) noexcept
@@ -1197,7 +1832,9 @@ void Synth::Impl::noteOnDispatch(int delay, int noteNumber, float velocity) noex
     const auto randValue = randNoteDistribution_(Random::randomGenerator);
     SisterVoiceRingBuilder ring;
 
-    if (!lastKeyswitchLists_[noteNumber].empty()) {
+    const bool isKeyswitch = !lastKeyswitchLists_[noteNumber].empty();
+    const bool switchChanged = isKeyswitch && currentSwitch_ != static_cast<uint8_t>(noteNumber);
+    if (isKeyswitch) {
         if (currentSwitch_ && *currentSwitch_ != noteNumber) {
             for (Layer* layer : lastKeyswitchLists_[*currentSwitch_])
                 layer->keySwitched_ = false;
@@ -1214,7 +1851,13 @@ void Synth::Impl::noteOnDispatch(int delay, int noteNumber, float velocity) noex
     for (Layer* layer : downKeyswitchLists_[noteNumber])
         layer->keySwitched_ = true;
 
-    for (Layer* layer : noteActivationLists_[noteNumber]) {
+    const NoteActivationIndex::Candidates candidates =
+        noteActivationIndex_.getCandidates(noteNumber, velocity);
+
+    for (Layer* layer : candidates.sequenceOnly)
+        layer->advanceSequence();
+
+    for (Layer* layer : candidates.layers) {
         if (layer->registerNoteOn(noteNumber, velocity, randValue)) {
             const Region& region = layer->getRegion();
             checkOffGroups(&region, delay, noteNumber);
@@ -1227,6 +1870,32 @@ void Synth::Impl::noteOnDispatch(int delay, int noteNumber, float velocity) noex
         const Region& region = layer->getRegion();
         layer->previousKeySwitched_ = (region.previousKeyswitch == noteNumber);
     }
+
+    if (!resources_.getFilePool().getPredictiveLoading())
+        return;
+
+    if (switchChanged) {
+        // Replay the recent notes on the new articulation
+        for (unsigned i = 0; i < noteHistorySize_; ++i)
+            predictLoads(noteHistory_[i].first, noteHistory_[i].second);
+    } else if (!isKeyswitch) {
+        noteHistory_[noteHistoryIndex_] = { noteNumber, velocity };
+        noteHistoryIndex_ = (noteHistoryIndex_ + 1) % config::predictionNoteHistory;
+        noteHistorySize_ = min(noteHistorySize_ + 1, config::predictionNoteHistory);
+        predictLoads(noteNumber, velocity);
+    }
+}
+
+void Synth::Impl::predictLoads(int noteNumber, float velocity) noexcept
+{
+    FilePool& filePool = resources_.getFilePool();
+    const NoteActivationIndex::Candidates candidates =
+        noteActivationIndex_.getCandidates(noteNumber, velocity);
+
+    for (Layer* layer : candidates.layers) {
+        if (layer->isLikelyNext(noteNumber, velocity))
+            filePool.predictFile(layer->getRegion().sampleId);
+    }
 }
 
 void Synth::Impl::startDelayedSustainReleases(Layer* layer, int delay, SisterVoiceRingBuilder& ring) noexcept
@@ -1681,6 +2350,18 @@ const std::vector<std::string>& Synth::getUnknownOpcodes() const noexcept
     Impl& impl = *impl_;
     return impl.unknownOpcodes_;
 }
+size_t Synth::getNumReusedPreloadedSamples() const noexcept
+{
+    Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getNumReusedPreloads();
+}
+
+size_t Synth::getNumReadPreloadedSamples() const noexcept
+{
+    Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getNumReadPreloads();
+}
+
 size_t Synth::getNumPreloadedSamples() const noexcept
 {
     Impl& impl = *impl_;
@@ -1705,6 +2386,7 @@ int Synth::getSampleQuality(ProcessMode mode)
 void Synth::setSampleQuality(ProcessMode mode, int quality)
 {
     SFIZZ_CHECK(quality >= 0 && quality <= 10);
+    std::lock_guard<SpinMutex> settingsLock { swap_->settingsMutex };
     Impl& impl = *impl_;
     quality = clamp(quality, 0, 10);
     SynthConfig& synthConfig = impl.resources_.getSynthConfig();
@@ -1740,6 +2422,7 @@ int Synth::getOscillatorQuality(ProcessMode mode)
 void Synth::setOscillatorQuality(ProcessMode mode, int quality)
 {
     SFIZZ_CHECK(quality >= 0 && quality <= 3);
+    std::lock_guard<SpinMutex> settingsLock { swap_->settingsMutex };
     Impl& impl = *impl_;
     quality = clamp(quality, 0, 3);
     SynthConfig& synthConfig = impl.resources_.getSynthConfig();
@@ -1764,6 +2447,7 @@ float Synth::getVolume() const noexcept
 }
 void Synth::setVolume(float volume) noexcept
 {
+    std::lock_guard<SpinMutex> settingsLock { swap_->settingsMutex };
     Impl& impl = *impl_;
     impl.volume_ = Default::volume.bounds.clamp(volume);
 }
@@ -1786,6 +2470,36 @@ void Synth::setNumVoices(int numVoices) noexcept
     impl.resetVoices(numVoices);
 }
 
+int Synth::getNumRenderThreads() const noexcept
+{
+    Impl& impl = *impl_;
+    return static_cast<int>(impl.renderWorkers_.getNumThreads());
+}
+
+void Synth::setNumRenderThreads(int numThreads) noexcept
+{
+    Impl& impl = *impl_;
+    const unsigned clampedThreads = static_cast<unsigned>(
+        clamp(numThreads, 1, static_cast<int>(config::maxRenderThreads)));
+
+    // fast path
+    if (clampedThreads == impl.renderWorkers_.getNumThreads())
+        return;
+
+    if (!impl.renderWorkers_.setNumThreads(clampedThreads))
+        DBG("[sfizz] Cannot spawn " << clampedThreads << " render threads, rendering serially");
+    else if (!impl.renderWorkers_.hasRealtimePriority())
+        DBG("[sfizz] The render threads were refused a realtime priority");
+
+    impl.setupRenderLanes();
+}
+
+bool Synth::hasRealtimeRenderThreads() const noexcept
+{
+    Impl& impl = *impl_;
+    return impl.renderWorkers_.hasRealtimePriority();
+}
+
 void Synth::Impl::resetVoices(int numVoices)
 {
     numVoices_ = numVoices;
@@ -1916,8 +2630,173 @@ uint32_t Synth::getPreloadSize() const noexcept
     return impl.resources_.getFilePool().getPreloadSize();
 }
 
+void Synth::setOversamplingFactor(Oversampling factor) noexcept
+{
+    Impl& impl = *impl_;
+    FilePool& filePool = impl.resources_.getFilePool();
+
+    // fast path
+    if (factor == filePool.getOversamplingFactor())
+        return;
+
+    // The voices hold on to the data which is replaced
+    impl.voiceManager_.reset();
+    filePool.setOversamplingFactor(factor);
+}
+
+Oversampling Synth::getOversamplingFactor() const noexcept
+{
+    Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getOversamplingFactor();
+}
+
+size_t Synth::getPreloadedMemory() const noexcept
+{
+    Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getPreloadedMemory();
+}
+
+void Synth::setStreamRingSize(uint32_t numFrames) noexcept
+{
+    Impl& impl = *impl_;
+    impl.resources_.getFilePool().setStreamRingSize(numFrames);
+}
+
+uint32_t Synth::getStreamRingSize() const noexcept
+{
+    Impl& impl = *impl_;
+    return static_cast<uint32_t>(impl.resources_.getFilePool().getStreamRingSize());
+}
+
+size_t Synth::getNumStreamUnderruns() const noexcept
+{
+    Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getNumStreamUnderruns();
+}
+
+bool Synth::setPreloadCacheDirectory(const std::string& directory) noexcept
+{
+    Impl& impl = *impl_;
+    return impl.resources_.getFilePool().setPreloadCacheDirectory(fs::path(directory));
+}
+
+size_t Synth::getNumPreloadCacheHits() const noexcept
+{
+    Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getNumPreloadCacheHits();
+}
+
+size_t Synth::getNumPreloadCacheMisses() const noexcept
+{
+    Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getNumPreloadCacheMisses();
+}
+
+void Synth::setSharedPreloading(bool shared) noexcept
+{
+    Impl& impl = *impl_;
+    impl.resources_.getFilePool().setSharedPreloading(shared);
+}
+
+bool Synth::getSharedPreloading() const noexcept
+{
+    const Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getSharedPreloading();
+}
+
+void Synth::setPredictiveLoading(bool predictive) noexcept
+{
+    Impl& impl = *impl_;
+    impl.resources_.getFilePool().setPredictiveLoading(predictive);
+}
+
+bool Synth::getPredictiveLoading() const noexcept
+{
+    const Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getPredictiveLoading();
+}
+
+void Synth::setPredictiveLoadingBudget(size_t numBytes) noexcept
+{
+    Impl& impl = *impl_;
+    impl.resources_.getFilePool().setPredictiveLoadingBudget(numBytes);
+}
+
+size_t Synth::getPredictiveLoadingBudget() const noexcept
+{
+    const Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getPredictiveLoadingBudget();
+}
+
+size_t Synth::getNumPredictedLoads() const noexcept
+{
+    const Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getNumPredictedLoads();
+}
+
+size_t Synth::getNumPredictionHits() const noexcept
+{
+    const Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getNumPredictionHits();
+}
+
+size_t Synth::getNumPredictionMisses() const noexcept
+{
+    const Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getNumPredictionMisses();
+}
+
+size_t Synth::getPredictedMemory() const noexcept
+{
+    const Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getPredictedMemory();
+}
+
+void Synth::setLoadedMemoryBudget(size_t numBytes) noexcept
+{
+    Impl& impl = *impl_;
+    impl.resources_.getFilePool().setLoadedMemoryBudget(numBytes);
+}
+
+size_t Synth::getLoadedMemoryBudget() const noexcept
+{
+    const Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getLoadedMemoryBudget();
+}
+
+size_t Synth::getLoadedMemory() const noexcept
+{
+    const Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getLoadedMemory();
+}
+
+size_t Synth::getNumEvictions() const noexcept
+{
+    const Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getNumEvictions();
+}
+
+size_t Synth::getNumReloads() const noexcept
+{
+    const Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getNumReloads();
+}
+
+size_t Synth::getNumLoadDeadlineMisses() const noexcept
+{
+    const Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getNumLoadDeadlineMisses();
+}
+
+size_t Synth::getNumCancelledLoads() const noexcept
+{
+    const Impl& impl = *impl_;
+    return impl.resources_.getFilePool().getNumCancelledLoads();
+}
+
 void Synth::enableFreeWheeling() noexcept
 {
+    std::lock_guard<SpinMutex> settingsLock { swap_->settingsMutex };
     Impl& impl = *impl_;
     SynthConfig& synthConfig = impl.resources_.getSynthConfig();
     if (!synthConfig.freeWheeling) {
@@ -1927,6 +2806,7 @@ void Synth::enableFreeWheeling() noexcept
 }
 void Synth::disableFreeWheeling() noexcept
 {
+    std::lock_guard<SpinMutex> settingsLock { swap_->settingsMutex };
     Impl& impl = *impl_;
     SynthConfig& synthConfig = impl.resources_.getSynthConfig();
     if (synthConfig.freeWheeling) {
@@ -1935,6 +2815,28 @@ void Synth::disableFreeWheeling() noexcept
     }
 }
 
+void Synth::enableMappedStreaming() noexcept
+{
+    Impl& impl = *impl_;
+    impl.resources_.getFilePool().setMappedStreaming(true);
+}
+
+void Synth::disableMappedStreaming() noexcept
+{
+    Impl& impl = *impl_;
+    impl.resources_.getFilePool().setMappedStreaming(false);
+}
+
+size_t Synth::getMappedBytes() const noexcept
+{
+    return MappedAudioFile::totalMappedBytes();
+}
+
+size_t Synth::getResidentMappedBytes() const noexcept
+{
+    return MappedAudioFile::totalResidentBytes();
+}
+
 void Synth::Impl::resetAllControllers(int delay) noexcept
 {
     MidiState& midiState = resources_.getMidiState();
@@ -1986,6 +2888,7 @@ bool Synth::shouldReloadFile()
 
 bool Synth::shouldReloadScala()
 {
+    std::lock_guard<SpinMutex> settingsLock { swap_->settingsMutex };
     Impl& impl = *impl_;
     return impl.resources_.getTuning().shouldReloadScala();
 }
@@ -2002,6 +2905,18 @@ void Synth::disableLogging() noexcept
     impl.resources_.getLogger().disableLogging();
 }
 
+const Telemetry& Synth::getTelemetry() const noexcept
+{
+    const Impl& impl = *impl_;
+    return impl.resources_.getLogger().getTelemetry();
+}
+
+void Synth::resetTelemetry() noexcept
+{
+    Impl& impl = *impl_;
+    impl.resources_.getLogger().getTelemetry().reset();
+}
+
 void Synth::allSoundOff() noexcept
 {
     Impl& impl = *impl_;
@@ -2009,16 +2924,21 @@ void Synth::allSoundOff() noexcept
         voice.reset();
     for (auto& effectBus : impl.effectBuses_)
         effectBus->clear();
+
+    if (InstrumentSwap::Staged* retiring = swap_->retiring.get())
+        retiring->synth.allSoundOff();
 }
 
 void Synth::addExternalDefinition(const std::string& id, const std::string& value)
 {
+    std::lock_guard<SpinMutex> settingsLock { swap_->settingsMutex };
     Impl& impl = *impl_;
     impl.parser_.addExternalDefinition(id, value);
 }
 
 void Synth::clearExternalDefinitions()
 {
+    std::lock_guard<SpinMutex> settingsLock { swap_->settingsMutex };
     Impl& impl = *impl_;
     impl.parser_.clearExternalDefinitions();
 }
@@ -8,12 +8,15 @@
 #include "AudioSpan.h"
 #include "Resources.h"
 #include "Messaging.h"
+#include "Oversampler.h"
 #include "utility/NumericId.h"
 #include "utility/LeakDetector.h"
 #include <ghc/fs_std.hpp>
 #include <absl/strings/string_view.h>
 #include <memory>
+#include <atomic>
 #include <bitset>
+#include <functional>
 #include <string>
 #include <vector>
 template <size_t> class BitArray;
@@ -28,6 +31,7 @@ class EffectBus;
 struct Region;
 struct Layer;
 class Voice;
+class Telemetry;
 
 using CCNamePair = std::pair<uint16_t, std::string>;
 using NoteNamePair = std::pair<uint8_t, std::string>;
@@ -119,6 +123,91 @@ public:
      *         @true otherwise.
      */
     bool loadSfzString(const fs::path& path, absl::string_view text);
+    /**
+     * @brief Reload an SFZ file, keeping the preloaded samples which are
+     * still in use and unchanged on disk.
+     *
+     * This is similar to loadSfzFile() in functionality, but only the new or
+     * modified samples are read again. This makes reloading a large
+     * instrument after a small edit much faster. The number of reused and
+     * read samples is reported by getNumReusedPreloadedSamples() and
+     * getNumReadPreloadedSamples().
+     *
+     * @param file
+     * @return true
+     * @return false if the file was not found or no regions were loaded.
+     */
+    bool reloadSfzFile(const fs::path& file);
+    /**
+     * @brief Reload an SFZ document from memory, keeping the preloaded
+     * samples which are still in use and unchanged on disk.
+     *
+     * This is similar to reloadSfzFile() in functionality, and accepts a
+     * virtual path like loadSfzString().
+     *
+     * @param path The virtual path of the SFZ file, as string.
+     * @param text The contents of the virtual SFZ file.
+     *
+     * @return @false if no regions were loaded,
+     *         @true otherwise.
+     */
+    bool reloadSfzString(const fs::path& path, absl::string_view text);
+    /**
+     * @brief Function which is told the progress of the sample preloading
+     * while an SFZ is loaded, with the number of files preloaded and the total
+     * number of files. Returning false cancels the load.
+     */
+    using LoadProgressCallback = std::function<bool(size_t numLoaded, size_t numTotal)>;
+    /**
+     * @brief Set the function which is told the progress of the loads. It is
+     * called on the loading thread. When a load is cancelled, the synth is
+     * left empty and the load function returns false.
+     *
+     * @param callback the progress function, which may be empty
+     */
+    void setLoadProgressCallback(LoadProgressCallback callback);
+    /**
+     * @brief Load a new SFZ file in the background, while the current
+     * instrument keeps playing.
+     *
+     * The new instrument is built apart with the settings of the synth, and
+     * shares the preloaded samples of the current one which are unchanged on
+     * disk, like reloadSfzFile(). When it is ready, the settings which
+     * changed during the load are applied to it again, and it replaces the
+     * current one before this function returns.
+     * The audio thread takes over the replaced instrument at the start of the
+     * next call to renderBlock(); it stops receiving note on events and rings
+     * out for a short while, then it is deleted on a background thread.
+     *
+     * Call it from a loading thread; it can run concurrently with the audio
+     * callbacks, and with the volume, tuning, quality and freewheeling
+     * setters, which may be called on the audio thread. It must not run
+     * concurrently with the other loading functions, nor with the changes of
+     * the sample rate, the block size, the voices or the preloading.
+     *
+     * @param file
+     * @return false if the file was not found or no regions were loaded,
+     *         in which case the current instrument is kept.
+     */
+    bool loadSfzFileInBackground(const fs::path& file);
+    /**
+     * @brief Load a new SFZ document from memory in the background, while the
+     * current instrument keeps playing.
+     *
+     * This is similar to loadSfzFileInBackground() in functionality, and
+     * accepts a virtual path like loadSfzString().
+     *
+     * @param path The virtual path of the SFZ file, as string.
+     * @param text The contents of the virtual SFZ file.
+     * @return false if no regions were loaded, in which case the current
+     *         instrument is kept.
+     */
+    bool loadSfzStringInBackground(const fs::path& path, absl::string_view text);
+    /**
+     * @brief Check whether an instrument replaced by a background load waits
+     * for the audio thread to take it over and make it ring out.
+     */
+    bool isInstrumentSwapPending() const noexcept;
     /**
      * @brief Sets the tuning from a Scala file loaded from the file system.
      *
@@ -281,6 +370,20 @@ public:
      * @return size_t
      */
     size_t getNumPreloadedSamples() const noexcept;
+    /**
+     * @brief Get the number of preloaded samples which the last load reused
+     * from the previous instrument
+     *
+     * @return size_t
+     */
+    size_t getNumReusedPreloadedSamples() const noexcept;
+    /**
+     * @brief Get the number of preloaded samples which the last load read
+     * from disk
+     *
+     * @return size_t
+     */
+    size_t getNumReadPreloadedSamples() const noexcept;
 
     /**
      * @brief Set the maximum size of the blocks for the callback. The actual
@@ -557,6 +660,38 @@ public:
      */
     void setNumVoices(int numVoices) noexcept;
 
+    /**
+     * @brief Get the number of threads which render the voices.
+     *
+     * @return int
+     */
+    int getNumRenderThreads() const noexcept;
+    /**
+     * @brief Change the number of threads which render the voices, including
+     * the thread calling renderBlock. The default of 1 renders all voices
+     * serially; higher values spawn worker threads which share the active
+     * voices with the audio thread. The voices of a given region are always
+     * rendered on the same thread; the regions are balanced between the
+     * threads according to a static estimate of the cost of their voices,
+     * and the threads are mixed in a fixed order, so the output does not
+     * depend on the timing of the threads.
+     * This function spawns or joins threads; prefer calling it out of the
+     * RT thread. If the threads cannot be spawned, the voices are rendered
+     * serially and getNumRenderThreads returns 1.
+     *
+     * @param numThreads
+     */
+    void setNumRenderThreads(int numThreads) noexcept;
+
+    /**
+     * @brief Check whether the render threads got a realtime priority.
+     * The system may refuse it, in which case they run at normal priority
+     * and may miss the deadline of the audio thread under load.
+     *
+     * @return true if all the worker threads run with a realtime priority
+     */
+    bool hasRealtimeRenderThreads() const noexcept;
+
     /**
      * @brief Set the preloaded file size.
      * This function takes a lock and disables the callback; prefer calling
@@ -575,6 +710,198 @@ public:
      */
     uint32_t getPreloadSize() const noexcept;
 
+    /**
+     * @brief Set the oversampling factor of the sample data.
+     *
+     * The samples are upsampled when they are preloaded, and when they are
+     * loaded in the background. Interpolating oversampled data aliases less
+     * when a sample is pitched up, so a lower sample quality can be used, at
+     * the expense of memory: the preloaded data grows with the factor.
+     * Oversampled samples are loaded whole in the background instead of
+     * being streamed into rings.
+     *
+     * This reloads the preloaded data and stops all the voices, so don't call
+     * it from the audio thread.
+     *
+     * @param factor
+     */
+    void setOversamplingFactor(Oversampling factor) noexcept;
+
+    /**
+     * @brief Get the oversampling factor of the sample data.
+     *
+     * @return Oversampling
+     */
+    Oversampling getOversamplingFactor() const noexcept;
+
+    /**
+     * @brief Get the memory used by the preloaded sample data, in bytes.
+     *
+     * @return size_t
+     */
+    size_t getPreloadedMemory() const noexcept;
+
+    /**
+     * @brief Set the size of the streaming rings, in frames.
+     * The frames of a sample past its preloaded part are streamed into a
+     * ring of this size per voice. This applies to the voices started after
+     * the call. The rings are disabled by default with a size of 0, which
+     * loads the whole sample file in memory instead; a size of 32768 frames
+     * suits most disks.
+     *
+     * @param numFrames
+     */
+    void setStreamRingSize(uint32_t numFrames) noexcept;
+
+    /**
+     * @brief Get the size of the streaming rings, in frames.
+     */
+    uint32_t getStreamRingSize() const noexcept;
+
+    /**
+     * @brief Get the number of times a voice needed streamed frames which
+     * were not available yet, and output silence instead.
+     */
+    size_t getNumStreamUnderruns() const noexcept;
+
+    /**
+     * @brief Set the directory of the persistent preload cache.
+     * The preloaded data of the samples is saved in this directory, and
+     * reused by the next loads as long as the sample files are unchanged.
+     * This applies to the instruments loaded after the call. An empty path
+     * disables the cache.
+     *
+     * @param directory
+     * @return true if the cache directory is usable
+     */
+    bool setPreloadCacheDirectory(const std::string& directory) noexcept;
+
+    /**
+     * @brief Get the number of sample preloads served by the persistent cache.
+     */
+    size_t getNumPreloadCacheHits() const noexcept;
+
+    /**
+     * @brief Get the number of sample preloads which missed the persistent
+     * cache, and were read from the sample files.
+     */
+    size_t getNumPreloadCacheMisses() const noexcept;
+
+    /**
+     * @brief Share the preloaded data of the samples, and the data of the
+     * samples which are loaded whole, with the other synths of the process
+     * which enabled it, instead of reading it again. The data is freed when
+     * the last synth which uses it releases it. This applies to the
+     * instruments loaded after the call.
+     *
+     * @param shared
+     */
+    void setSharedPreloading(bool shared) noexcept;
+
+    /**
+     * @brief Return whether the sample data is shared with the other synths.
+     */
+    bool getSharedPreloading() const noexcept;
+
+    /**
+     * @brief Load ahead the samples which are likely to play next, as
+     * predicted from the last notes, the round-robin sequences and the
+     * current keyswitch. The files are loaded in the background with a lower
+     * priority than the ones the voices request, within a memory budget.
+     *
+     * @param predictive
+     */
+    void setPredictiveLoading(bool predictive) noexcept;
+
+    /**
+     * @brief Return whether the predicted samples are loaded ahead.
+     */
+    bool getPredictiveLoading() const noexcept;
+
+    /**
+     * @brief Set the memory which the samples loaded ahead, and not played
+     * yet, may use in total.
+     *
+     * @param numBytes
+     */
+    void setPredictiveLoadingBudget(size_t numBytes) noexcept;
+
+    /**
+     * @brief Get the memory budget of the samples loaded ahead, in bytes.
+     */
+    size_t getPredictiveLoadingBudget() const noexcept;
+
+    /**
+     * @brief Get the number of samples loaded ahead by the predictions.
+     */
+    size_t getNumPredictedLoads() const noexcept;
+
+    /**
+     * @brief Get the number of samples loaded ahead which a voice played
+     * afterwards. With the number of predicted loads, this gives the hit
+     * rate of the predictions.
+     */
+    size_t getNumPredictionHits() const noexcept;
+
+    /**
+     * @brief Get the number of samples loaded ahead which were released
+     * without being played.
+     */
+    size_t getNumPredictionMisses() const noexcept;
+
+    /**
+     * @brief Get the memory of the samples loaded ahead and not played yet,
+     * in bytes.
+     */
+    size_t getPredictedMemory() const noexcept;
+
+    /**
+     * @brief Set a ceiling to the memory of the samples loaded whole in the
+     * background. With a budget, the loaded samples stay in memory while
+     * they fit, and the least recently played ones are evicted in the
+     * background when they exceed it. Without a budget, the samples are freed a few seconds after they
+     * stop playing.
+     *
+     * @param numBytes the budget in bytes, or 0 to disable it
+     */
+    void setLoadedMemoryBudget(size_t numBytes) noexcept;
+
+    /**
+     * @brief Get the budget of the loaded samples in bytes, or 0 if disabled.
+     */
+    size_t getLoadedMemoryBudget() const noexcept;
+
+    /**
+     * @brief Get the memory of the samples loaded whole, in bytes.
+     */
+    size_t getLoadedMemory() const noexcept;
+
+    /**
+     * @brief Get the number of loaded samples which were evicted to stay
+     * within the memory budget.
+     */
+    size_t getNumEvictions() const noexcept;
+
+    /**
+     * @brief Get the number of samples which were loaded again after being
+     * evicted.
+     */
+    size_t getNumReloads() const noexcept;
+
+    /**
+     * @brief Get the number of background loads and stream refills which
+     * started after the voice ran out of data. The jobs run by deadline, the
+     * most urgent first, so this stays at 0 unless the disk or the loading
+     * threads cannot keep up.
+     */
+    size_t getNumLoadDeadlineMisses() const noexcept;
+
+    /**
+     * @brief Get the number of background loads which were dropped because
+     * their voices ended before the load started.
+     */
+    size_t getNumCancelledLoads() const noexcept;
+
     /**
      * @brief Gets the number of allocated buffers.
      *
@@ -589,6 +916,23 @@ public:
      */
     int getAllocatedBytes() const noexcept { return Buffer<float>::counter().getTotalBytes(); }
 
+    /**
+     * @brief Gets the number of bytes of the memory-mapped sample files.
+     * This is counted over all the synth instances.
+     *
+     * @return  The mapped bytes.
+     */
+    size_t getMappedBytes() const noexcept;
+
+    /**
+     * @brief Gets the number of bytes of the memory-mapped sample files which
+     * are currently in memory. This is counted over all the synth instances.
+     * It queries the operating system, so don't call it on the audio thread.
+     *
+     * @return  The resident mapped bytes.
+     */
+    size_t getResidentMappedBytes() const noexcept;
+
     /**
      * @brief Enable freewheeling on the synth. This will wait for background
      * loaded files to finish loading before each render callback to ensure that
@@ -602,6 +946,23 @@ public:
      *
      */
     void disableFreeWheeling() noexcept;
+    /**
+     * @brief Enable the memory mapping of streamed files. Files whose frames
+     * can be read as-is (32-bit float WAV, mono or interleaved stereo) are
+     * then served from the page cache past their preloaded part, instead of
+     * being decoded in memory. Other files are still decoded, as well as the
+     * oversampled and reversed samples. Mono files are read in place on POSIX
+     * systems; stereo files, and all files on Windows, are deinterleaved in
+     * windows as they play. This affects the files which are streamed after
+     * the call.
+     *
+     */
+    void enableMappedStreaming() noexcept;
+    /**
+     * @brief Disable the memory mapping of streamed files.
+     *
+     */
+    void disableMappedStreaming() noexcept;
 
     Resources& getResources() noexcept;
     const Resources& getResources() const noexcept;
@@ -639,6 +1000,16 @@ public:
      */
     void disableLogging() noexcept;
 
+    /**
+     * @brief Get the telemetry, which is collected on every block and can be
+     * read from any thread.
+     */
+    const Telemetry& getTelemetry() const noexcept;
+    /**
+     * @brief Reset the counters and histograms of the telemetry.
+     */
+    void resetTelemetry() noexcept;
+
     /**
      * @brief Shuts down the current processing, clear buffers and reset the voices.
      *
@@ -712,8 +1083,65 @@ public:
     void setBroadcastCallback(sfizz_receive_t* broadcast, void* data);
 
 private:
+    /**
+     * @brief Apply the settings of this synth to another one. The settings
+     * which are equal already are left alone, so it can be applied again
+     * cheaply.
+     */
+    void copySettingsTo(Synth& other) const;
+    /**
+     * @brief Apply the settings which may change on the audio thread, like
+     * the volume or the tuning, to another synth. The caller holds the
+     * settings lock of the instrument swap.
+     */
+    void copyLiveSettingsTo(Synth& other) const;
+    /**
+     * @brief Build an instrument with a load function, and make it replace
+     * the current one.
+     */
+    bool loadInBackground(const std::function<bool(Synth&)>& load);
+    /**
+     * @brief Take over the instruments which were replaced since the last
+     * block, to make the most recent one ring out. This is called on the
+     * audio thread, at the start of a block.
+     */
+    void takeReplacedInstruments() noexcept;
+    /**
+     * @brief Mix the instrument which rings out after a swap, and retire it
+     * when it is done.
+     *
+     * @param buffer
+     */
+    void renderRetiringInstrument(AudioSpan<float> buffer) noexcept;
+
     struct Impl;
-    std::unique_ptr<Impl> impl_;
+
+    /**
+     * @brief The owning pointer to the state of the synth, which a background
+     * load replaces atomically while the audio thread runs.
+     */
+    class ImplHolder {
+    public:
+        explicit ImplHolder(Impl* impl) noexcept : ptr_(impl) {}
+        ~ImplHolder();
+        ImplHolder(const ImplHolder&) = delete;
+        ImplHolder& operator=(const ImplHolder&) = delete;
+
+        Impl& operator*() const noexcept { return *ptr_.load(std::memory_order_acquire); }
+        Impl* operator->() const noexcept { return ptr_.load(std::memory_order_acquire); }
+        /**
+         * @brief Replace the state, and give up the ownership of the previous one.
+         */
+        Impl* exchange(Impl* impl) noexcept { return ptr_.exchange(impl, std::memory_order_acq_rel); }
+
+    private:
+        std::atomic<Impl*> ptr_;
+    };
+
+    ImplHolder impl_;
+
+    struct InstrumentSwap;
+    std::unique_ptr<InstrumentSwap> swap_;
 
     LEAK_DETECTOR(Synth);
 };
@@ -30,5 +30,27 @@ struct SynthConfig
     }
 
     bool sustainCancelsRelease { Default::sustainCancelsRelease };
+
+    // Voices render with pipelines specialized for their region when set,
+    // otherwise with the generic pipeline
+    bool specializedRenderPipelines { true };
+
+    // Simple sample voices are rendered together in batches when set,
+    // otherwise each voice renders on its own
+    bool batchedVoiceRendering { true };
+
+    // The mono 2-pole filters of the voices run in voice-parallel filter
+    // banks when set, otherwise on the Faust filters. This applies to the
+    // voices started afterwards.
+    bool filterBanks { true };
+
+    // The filters and equalizers of the voices compute their coefficients
+    // from interpolated tables when set, otherwise exactly. This applies to
+    // the voices started afterwards.
+    bool filterCoefficientTables { false };
+
+    // The effect buses which are not idle are processed in parallel on the
+    // render threads when set, if there are several, otherwise in sequence
+    bool parallelEffectBuses { true };
 };
 }
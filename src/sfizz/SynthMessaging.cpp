@@ -6,6 +6,7 @@
 
 #include "SynthPrivate.h"
 #include "FilePool.h"
+#include "Logger.h"
 #include "Curve.h"
 #include "MidiState.h"
 #include "utility/StringViewHelpers.h"
@@ -189,6 +190,155 @@ void sfz::Synth::dispatchMessage(Client& client, int delay, const char* path, co
 
         //----------------------------------------------------------------------
 
+        // Telemetry: times are in seconds, percentiles are bucket upper bounds
+
+        MATCH("/telemetry/blocks", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'h'>(delay, path, static_cast<int64_t>(telemetry.getNumBlocks()));
+        } break;
+
+        MATCH("/telemetry/frames", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'h'>(delay, path, static_cast<int64_t>(telemetry.getNumFrames()));
+        } break;
+
+        MATCH("/telemetry/time/dispatch", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'d'>(delay, path, telemetry.getStageTime(Telemetry::Stage::Dispatch).count());
+        } break;
+
+        MATCH("/telemetry/time/render", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'d'>(delay, path, telemetry.getStageTime(Telemetry::Stage::RenderMethod).count());
+        } break;
+
+        MATCH("/telemetry/time/data", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'d'>(delay, path, telemetry.getStageTime(Telemetry::Stage::Data).count());
+        } break;
+
+        MATCH("/telemetry/time/amplitude", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'d'>(delay, path, telemetry.getStageTime(Telemetry::Stage::Amplitude).count());
+        } break;
+
+        MATCH("/telemetry/time/filters", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'d'>(delay, path, telemetry.getStageTime(Telemetry::Stage::Filters).count());
+        } break;
+
+        MATCH("/telemetry/time/panning", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'d'>(delay, path, telemetry.getStageTime(Telemetry::Stage::Panning).count());
+        } break;
+
+        MATCH("/telemetry/time/effects", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'d'>(delay, path, telemetry.getStageTime(Telemetry::Stage::Effects).count());
+        } break;
+
+        MATCH("/telemetry/active_voices", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'i'>(delay, path, telemetry.getActiveVoices());
+        } break;
+
+        MATCH("/telemetry/max_active_voices", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'i'>(delay, path, telemetry.getMaxActiveVoices());
+        } break;
+
+        MATCH("/telemetry/stolen_voices", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'h'>(delay, path, static_cast<int64_t>(telemetry.getStolenVoices()));
+        } break;
+
+        MATCH("/telemetry/file_queue_depth", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'h'>(delay, path, static_cast<int64_t>(telemetry.getFileQueueDepth()));
+        } break;
+
+        MATCH("/telemetry/max_file_queue_depth", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'h'>(delay, path, static_cast<int64_t>(telemetry.getMaxFileQueueDepth()));
+        } break;
+
+        MATCH("/telemetry/buffer_pool_exhaustions", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'h'>(delay, path, static_cast<int64_t>(telemetry.getBufferPoolExhaustions()));
+        } break;
+
+        MATCH("/telemetry/effect_bus_blocks", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'h'>(delay, path, static_cast<int64_t>(telemetry.getEffectBusBlocks()));
+        } break;
+
+        MATCH("/telemetry/skipped_effect_bus_blocks", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'h'>(delay, path, static_cast<int64_t>(telemetry.getSkippedEffectBusBlocks()));
+        } break;
+
+        MATCH("/telemetry/stream_underruns", "") {
+            const Telemetry& telemetry = impl.resources_.getLogger().getTelemetry();
+            client.receive<'h'>(delay, path, static_cast<int64_t>(telemetry.getStreamUnderruns()));
+        } break;
+
+        MATCH("/telemetry/callback_time/mean", "") {
+            const LatencyHistogram& histogram = impl.resources_.getLogger().getTelemetry().getCallbackTimes();
+            client.receive<'d'>(delay, path, histogram.mean() * 1e-9);
+        } break;
+
+        MATCH("/telemetry/callback_time/p50", "") {
+            const LatencyHistogram& histogram = impl.resources_.getLogger().getTelemetry().getCallbackTimes();
+            client.receive<'d'>(delay, path, histogram.percentile(0.5) * 1e-9);
+        } break;
+
+        MATCH("/telemetry/callback_time/p99", "") {
+            const LatencyHistogram& histogram = impl.resources_.getLogger().getTelemetry().getCallbackTimes();
+            client.receive<'d'>(delay, path, histogram.percentile(0.99) * 1e-9);
+        } break;
+
+        MATCH("/telemetry/callback_time/p999", "") {
+            const LatencyHistogram& histogram = impl.resources_.getLogger().getTelemetry().getCallbackTimes();
+            client.receive<'d'>(delay, path, histogram.percentile(0.999) * 1e-9);
+        } break;
+
+        MATCH("/telemetry/callback_time/max", "") {
+            const LatencyHistogram& histogram = impl.resources_.getLogger().getTelemetry().getCallbackTimes();
+            client.receive<'d'>(delay, path, histogram.max() * 1e-9);
+        } break;
+
+        MATCH("/telemetry/file_wait_time/p50", "") {
+            const LatencyHistogram& histogram = impl.resources_.getLogger().getTelemetry().getFileWaitTimes();
+            client.receive<'d'>(delay, path, histogram.percentile(0.5) * 1e-9);
+        } break;
+
+        MATCH("/telemetry/file_wait_time/p99", "") {
+            const LatencyHistogram& histogram = impl.resources_.getLogger().getTelemetry().getFileWaitTimes();
+            client.receive<'d'>(delay, path, histogram.percentile(0.99) * 1e-9);
+        } break;
+
+        MATCH("/telemetry/file_wait_time/max", "") {
+            const LatencyHistogram& histogram = impl.resources_.getLogger().getTelemetry().getFileWaitTimes();
+            client.receive<'d'>(delay, path, histogram.max() * 1e-9);
+        } break;
+
+        MATCH("/telemetry/file_load_time/p50", "") {
+            const LatencyHistogram& histogram = impl.resources_.getLogger().getTelemetry().getFileLoadTimes();
+            client.receive<'d'>(delay, path, histogram.percentile(0.5) * 1e-9);
+        } break;
+
+        MATCH("/telemetry/file_load_time/p99", "") {
+            const LatencyHistogram& histogram = impl.resources_.getLogger().getTelemetry().getFileLoadTimes();
+            client.receive<'d'>(delay, path, histogram.percentile(0.99) * 1e-9);
+        } break;
+
+        MATCH("/telemetry/file_load_time/max", "") {
+            const LatencyHistogram& histogram = impl.resources_.getLogger().getTelemetry().getFileLoadTimes();
+            client.receive<'d'>(delay, path, histogram.max() * 1e-9);
+        } break;
+
+        //----------------------------------------------------------------------
+
         MATCH("/region&/delay", "") {
             GET_REGION_OR_BREAK(indices[0])
             client.receive<'f'>(delay, path, region.delay);
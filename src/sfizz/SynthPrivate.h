@@ -5,8 +5,15 @@
 #include "SisterVoiceRing.h"
 #include "TriggerEvent.h"
 #include "VoiceManager.h"
+#include "VoiceBatch.h"
 #include "Layer.h"
+#include "NoteActivationIndex.h"
+#include "RenderWorkers.h"
+#include "AudioBuffer.h"
 #include "BitArray.h"
+#include "Buffer.h"
+#include "RTSemaphore.h"
+#include "SpinMutex.h"
 #include "modulations/sources/ADSREnvelope.h"
 #include "modulations/sources/Controller.h"
 #include "modulations/sources/FlexEnvelope.h"
@@ -15,10 +22,13 @@
 #include "modulations/sources/LFO.h"
 #include "parser/Parser.h"
 #include "parser/ParserListener.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 namespace sfz {
 
-struct Synth::Impl final: public Parser::Listener {
+struct Synth::Impl final: public Parser::Listener, public RenderWorkers::Task {
     Impl();
     ~Impl();
 
@@ -55,8 +65,28 @@ struct Synth::Impl final: public Parser::Listener {
      * to bring back the synth in its original state.
      *
      * The callback mutex should be taken to call this function.
+     *
+     * @param keepPreloadedFiles keep the preloaded files which are unchanged
+     *                           on disk, for a reload of the instrument
+     */
+    void clear(bool keepPreloadedFiles = false);
+
+    /**
+     * @brief Load an SFZ file, replacing the current instrument.
+     *
+     * @param file
+     * @param keepPreloadedFiles reuse the preloaded files which are unchanged
+     */
+    bool loadSfzFile(const fs::path& file, bool keepPreloadedFiles);
+
+    /**
+     * @brief Load an SFZ document from memory, replacing the current instrument.
+     *
+     * @param path the virtual path of the SFZ file
+     * @param text the contents of the SFZ file
+     * @param keepPreloadedFiles reuse the preloaded files which are unchanged
      */
-    void clear();
+    bool loadSfzString(const fs::path& path, absl::string_view text, bool keepPreloadedFiles);
 
     /**
      * @brief Helper function to dispatch <global> opcodes
@@ -113,6 +143,89 @@ struct Synth::Impl final: public Parser::Listener {
      */
     void setupModMatrix();
 
+    /**
+     * @brief Allocate the per-thread storage used by the parallel voice
+     * and effect rendering, according to the number of threads and effect buses.
+     */
+    void setupRenderLanes();
+
+    /**
+     * @brief Render the voices assigned to a render lane into the
+     * accumulators of the lane.
+     *
+     * @param lane
+     */
+    void processLane(unsigned lane) noexcept final;
+
+    /**
+     * @brief Distribute the active voices to the render lanes for a cycle.
+     * The voices of a region stay together, since they share the per-region
+     * modulation buffers; the regions are given to the least loaded lane in
+     * order of decreasing cost, where the cost of a voice is estimated from
+     * the processing of its region. The estimate and the ties are broken
+     * by region and voice numbers, so the distribution is reproducible.
+     */
+    void distributeVoicesToLanes() noexcept;
+
+    struct RenderLane;
+    /**
+     * @brief Render a voice of a render lane, either in the batch of the lane
+     * or on its own, and mix it into the effect buses.
+     *
+     * @param renderLane
+     * @param lane the index of the render lane
+     * @param voice
+     * @param tempSpan a stereo span of at least numFrames frames
+     * @param numFrames
+     */
+    void renderLaneVoice(RenderLane& renderLane, unsigned lane, Voice& voice, AudioSpan<float> tempSpan, size_t numFrames) noexcept;
+
+    /**
+     * @brief Render the batch of a render lane, mix it into the effect buses
+     * and clear it.
+     *
+     * @param renderLane
+     * @param lane the index of the render lane
+     * @param tempSpan a stereo span of at least numFrames frames
+     * @param numFrames
+     */
+    void flushLaneBatch(RenderLane& renderLane, unsigned lane, AudioSpan<float> tempSpan, size_t numFrames) noexcept;
+
+    /**
+     * @brief Accumulate a rendered span with the others which share the
+     * effect sends of its region; the accumulated sends are mixed into the
+     * effect buses when the sends change.
+     *
+     * @param renderLane
+     * @param lane the index of the render lane
+     * @param region
+     * @param span
+     * @param numFrames
+     */
+    void addToLaneSends(RenderLane& renderLane, unsigned lane, const Region& region, AudioSpan<float> span, size_t numFrames) noexcept;
+
+    /**
+     * @brief Mix the accumulated sends of a render lane into the effect buses.
+     *
+     * @param renderLane
+     * @param lane the index of the render lane
+     * @param numFrames
+     */
+    void flushLaneSends(RenderLane& renderLane, unsigned lane, size_t numFrames) noexcept;
+
+    /**
+     * @brief Mix a rendered span into the effect buses, according to the
+     * sends of a region; directly with a single lane, or into the lane
+     * accumulators.
+     *
+     * @param renderLane
+     * @param lane the index of the render lane
+     * @param region
+     * @param span
+     * @param numFrames
+     */
+    void addToEffectBuses(RenderLane& renderLane, unsigned lane, const Region& region, AudioSpan<float> span, size_t numFrames) noexcept;
+
     /**
      * @brief Get the modification time of all included sfz files
      *
@@ -129,6 +242,15 @@ struct Synth::Impl final: public Parser::Listener {
      */
     void noteOnDispatch(int delay, int noteNumber, float velocity) noexcept;
 
+    /**
+     * @brief Load ahead the files of the regions which are likely to play on
+     * the next events of a note
+     *
+     * @param noteNumber
+     * @param velocity
+     */
+    void predictLoads(int noteNumber, float velocity) noexcept;
+
     /**
      * @brief Check all regions and start voices for note off events
      *
@@ -179,8 +301,10 @@ struct Synth::Impl final: public Parser::Listener {
     /**
      * @brief Finalize SFZ loading, following a successful execution of the
      *        parsing step.
+     *
+     * @return false if the load was cancelled
      */
-    void finalizeSfzLoad();
+    bool finalizeSfzLoad();
 
     template<class T>
     static void collectUsedCCsFromCCMap(BitArray<config::numCCs>& usedCCs, const CCMap<T> map) noexcept
@@ -253,6 +377,10 @@ struct Synth::Impl final: public Parser::Listener {
 
     // Set as sw_default if present in the file
     absl::optional<uint8_t> currentSwitch_;
+    // The last notes played, to predict the files of a new keyswitch
+    std::array<std::pair<int, float>, config::predictionNoteHistory> noteHistory_ {};
+    unsigned noteHistorySize_ { 0 };
+    unsigned noteHistoryIndex_ { 0 };
     std::vector<std::string> unknownOpcodes_;
     using RegionViewVector = std::vector<Region*>;
     using LayerViewVector = std::vector<Layer*>;
@@ -272,6 +400,7 @@ struct Synth::Impl final: public Parser::Listener {
     std::array<LayerViewVector, 128> upKeyswitchLists_;
     LayerViewVector previousKeyswitchLists_;
     std::array<LayerViewVector, 128> noteActivationLists_;
+    NoteActivationIndex noteActivationIndex_;
     std::array<LayerViewVector, config::numCCs> ccActivationLists_;
 
     // Effect factory and buses
@@ -332,6 +461,9 @@ struct Synth::Impl final: public Parser::Listener {
     BitArray<config::numCCs> changedCCsThisCycle_;
     BitArray<config::numCCs> changedCCsLastCycle_;
 
+    // Progress of the loads
+    LoadProgressCallback loadProgressCallback_;
+
     // Messaging
     sfizz_receive_t* broadcastReceiver = nullptr;
     void* broadcastData = nullptr;
@@ -344,6 +476,111 @@ struct Synth::Impl final: public Parser::Listener {
     }
 
     bool playheadMoved_ { false };
+
+    // Parallel voice rendering
+    struct RenderLane {
+        // Not copyable, so the lanes are moved when resizing; the move
+        // of the batch is not noexcept with the leak detector
+        RenderLane() = default;
+        RenderLane(const RenderLane&) = delete;
+        RenderLane(RenderLane&&) = default;
+        VoiceViewVector voices;
+        // the accumulators of the effect bus inputs, when rendering on several
+        // lanes; a single lane mixes directly into the effect buses
+        std::vector<std::unique_ptr<AudioBuffer<float>>> busInputs;
+        std::vector<bool> busSends; // whether the bus inputs received a send this cycle
+        VoiceBatch batch;
+        // the sum of the voices sharing the effect sends of the reference region
+        AudioBuffer<float> sendsInput { EffectChannels, config::defaultSamplesPerBlock };
+        const Region* sendsReference { nullptr };
+    };
+    std::vector<RenderLane> renderLanes_;
+    size_t renderNumFrames_ { 0 };
+    // Scratch storage of distributeVoicesToLanes
+    struct LaneGroup {
+        size_t begin;
+        size_t end;
+        size_t cost;
+    };
+    VoiceViewVector laneVoices_;
+    std::vector<LaneGroup> laneGroups_;
+    std::vector<size_t> laneCosts_;
+    RenderWorkers renderWorkers_;
+
+    /**
+     * @brief The effect buses to process in a cycle. The buses are
+     * independent until they are mixed, so the lanes take the buses one
+     * at a time until all are processed.
+     */
+    struct EffectBusTask final : public RenderWorkers::Task {
+        void processLane(unsigned lane) noexcept final;
+        std::vector<EffectBus*> buses;
+        std::atomic<size_t> nextBus { 0 };
+        unsigned numFrames { 0 };
+    };
+    EffectBusTask effectBusTask_;
+};
+
+/**
+ * @brief The instrument hot-swap. An instrument loaded in the background is
+ * published by the loading thread, which exchanges its state with the current
+ * one; the audio thread takes over the replaced state to make it ring out,
+ * then it is deleted on the retirement thread.
+ */
+struct Synth::InstrumentSwap {
+    ~InstrumentSwap();
+
+    /**
+     * @brief A synth which holds an instrument apart from the current one,
+     * with the storage to mix it while it rings out.
+     */
+    struct Staged {
+        Synth synth;
+        AudioBuffer<float> ringOut;
+        Buffer<float> ringOutGain;
+        size_t ringOutFrames { 0 };
+        size_t ringOutPosition { 0 };
+        // The next one in a list of replaced or retired instruments
+        Staged* next { nullptr };
+    };
+
+    /**
+     * @brief Push a chain of instruments on a lock-free list.
+     */
+    static void push(std::atomic<Staged*>& list, Staged* chain) noexcept;
+    /**
+     * @brief Delete a chain of instruments.
+     */
+    static void deleteChain(Staged* chain) noexcept;
+    /**
+     * @brief Hand over a chain of instruments to the retirement thread.
+     * This is called on the audio thread.
+     */
+    void retire(Staged* chain) noexcept;
+
+    /**
+     * @brief Start the retirement thread, unless it is running already.
+     */
+    void startRetirementThread();
+    void retirementJob() noexcept;
+
+    // Background loads run one at a time
+    std::mutex loadMutex;
+    // Held by the setters of the settings which may change on the audio
+    // thread, and by a load while it copies them and publishes the new
+    // instrument, so that no change goes to the replaced one
+    SpinMutex settingsMutex;
+    // The instruments which were replaced and which the audio thread did not
+    // take over yet, the most recent first
+    std::atomic<Staged*> replaced { nullptr };
+
+    // Only accessed by the audio thread
+    std::unique_ptr<Staged> retiring;
+
+    std::atomic<Staged*> retired { nullptr };
+    RTSemaphore retirementBarrier;
+    std::atomic<bool> retirementFlag { false };
+    std::thread retirementThread;
 };
 
 } // namespace sfz
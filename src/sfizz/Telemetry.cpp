@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "Telemetry.h"
+#include "Logger.h"
+#include <cmath>
+
+namespace sfz {
+
+constexpr unsigned LatencyHistogram::subBucketBits;
+constexpr unsigned LatencyHistogram::numSubBuckets;
+constexpr unsigned LatencyHistogram::maxExponent;
+constexpr unsigned LatencyHistogram::numBuckets;
+constexpr unsigned Telemetry::numStages;
+
+namespace {
+
+template <class T>
+void atomicStoreMax(std::atomic<T>& target, T value) noexcept
+{
+    T current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        ;
+}
+
+uint64_t toNanoseconds(std::chrono::duration<double> duration) noexcept
+{
+    const double ns = std::chrono::duration<double, std::nano>(duration).count();
+    return ns > 0.0 ? static_cast<uint64_t>(ns) : uint64_t(0);
+}
+
+} // namespace
+
+unsigned LatencyHistogram::bucketIndex(uint64_t nanoseconds) noexcept
+{
+    if (nanoseconds < numSubBuckets)
+        return static_cast<unsigned>(nanoseconds);
+
+    if (nanoseconds >> maxExponent)
+        return numBuckets - 1;
+
+    unsigned exponent = subBucketBits;
+    while (nanoseconds >> (exponent + 1))
+        ++exponent;
+
+    const unsigned shift = exponent - subBucketBits;
+    const unsigned subBucket = static_cast<unsigned>(nanoseconds >> shift) - numSubBuckets;
+    return (exponent - subBucketBits + 1) * numSubBuckets + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(unsigned index) noexcept
+{
+    if (index < numSubBuckets)
+        return index;
+
+    const unsigned shift = index / numSubBuckets - 1;
+    const uint64_t subBucket = index % numSubBuckets;
+    const uint64_t lowerBound = (numSubBuckets + subBucket) << shift;
+    return lowerBound + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) noexcept
+{
+    buckets_[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(nanoseconds, std::memory_order_relaxed);
+    atomicStoreMax(max_, nanoseconds);
+}
+
+uint64_t LatencyHistogram::percentile(double quantile) const noexcept
+{
+    // Count again from the buckets, which is consistent with the walk below
+    uint64_t total = 0;
+    for (const auto& bucket : buckets_)
+        total += bucket.load(std::memory_order_relaxed);
+
+    if (total == 0)
+        return 0;
+
+    quantile = quantile < 0.0 ? 0.0 : (quantile > 1.0 ? 1.0 : quantile);
+    uint64_t rank = static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(total)));
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t cumulated = 0;
+    for (unsigned i = 0; i < numBuckets; ++i) {
+        cumulated += buckets_[i].load(std::memory_order_relaxed);
+        if (cumulated >= rank)
+            return bucketUpperBound(i);
+    }
+
+    return bucketUpperBound(numBuckets - 1);
+}
+
+double LatencyHistogram::mean() const noexcept
+{
+    const uint64_t n = count();
+    if (n == 0)
+        return 0.0;
+
+    return static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(n);
+}
+
+void LatencyHistogram::reset() noexcept
+{
+    for (auto& bucket : buckets_)
+        bucket.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+void Telemetry::recordBlock(const CallbackBreakdown& breakdown, int numVoices, size_t numFrames) noexcept
+{
+    const std::array<std::chrono::duration<double>, numStages> stageTimes {{
+        breakdown.dispatch,
+        breakdown.renderMethod,
+        breakdown.data,
+        breakdown.amplitude,
+        breakdown.filters,
+        breakdown.panning,
+        breakdown.effects,
+    }};
+
+    for (unsigned i = 0; i < numStages; ++i)
+        stageNanoseconds_[i].fetch_add(toNanoseconds(stageTimes[i]), std::memory_order_relaxed);
+
+    numBlocks_.fetch_add(1, std::memory_order_relaxed);
+    numFrames_.fetch_add(numFrames, std::memory_order_relaxed);
+    activeVoices_.store(numVoices, std::memory_order_relaxed);
+    atomicStoreMax(maxActiveVoices_, numVoices);
+    callbackTimes_.record(breakdown.dispatch + breakdown.renderMethod);
+}
+
+void Telemetry::recordFileLoad(std::chrono::duration<double> waitDuration, std::chrono::duration<double> loadDuration) noexcept
+{
+    fileWaitTimes_.record(waitDuration);
+    fileLoadTimes_.record(loadDuration);
+}
+
+void Telemetry::addEffectBusBlocks(uint64_t processed, uint64_t skipped) noexcept
+{
+    effectBusBlocks_.fetch_add(processed, std::memory_order_relaxed);
+    skippedEffectBusBlocks_.fetch_add(skipped, std::memory_order_relaxed);
+}
+
+void Telemetry::setFileQueueDepth(size_t depth) noexcept
+{
+    fileQueueDepth_.store(depth, std::memory_order_relaxed);
+    atomicStoreMax(maxFileQueueDepth_, depth);
+}
+
+void Telemetry::setStreamUnderruns(uint64_t total) noexcept
+{
+    streamUnderrunsTotal_.store(total, std::memory_order_relaxed);
+}
+
+uint64_t Telemetry::getStreamUnderruns() const noexcept
+{
+    const uint64_t total = streamUnderrunsTotal_.load(std::memory_order_relaxed);
+    const uint64_t atReset = streamUnderrunsAtReset_.load(std::memory_order_relaxed);
+    return total > atReset ? total - atReset : 0;
+}
+
+std::chrono::duration<double> Telemetry::getStageTime(Stage stage) const noexcept
+{
+    const auto index = static_cast<unsigned>(stage);
+    if (index >= numStages)
+        return std::chrono::duration<double>(0);
+
+    const uint64_t ns = stageNanoseconds_[index].load(std::memory_order_relaxed);
+    return std::chrono::duration<double, std::nano>(static_cast<double>(ns));
+}
+
+void Telemetry::reset() noexcept
+{
+    numBlocks_.store(0, std::memory_order_relaxed);
+    numFrames_.store(0, std::memory_order_relaxed);
+    for (auto& stage : stageNanoseconds_)
+        stage.store(0, std::memory_order_relaxed);
+    maxActiveVoices_.store(activeVoices_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    stolenVoices_.store(0, std::memory_order_relaxed);
+    maxFileQueueDepth_.store(fileQueueDepth_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    bufferPoolExhaustions_.store(0, std::memory_order_relaxed);
+    effectBusBlocks_.store(0, std::memory_order_relaxed);
+    skippedEffectBusBlocks_.store(0, std::memory_order_relaxed);
+    streamUnderrunsAtReset_.store(streamUnderrunsTotal_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    callbackTimes_.reset();
+    fileWaitTimes_.reset();
+    fileLoadTimes_.reset();
+}
+
+} // namespace sfz
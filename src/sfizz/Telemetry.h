@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#pragma once
+#include "utility/LeakDetector.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace sfz {
+
+struct CallbackBreakdown;
+
+/**
+ * @brief A fixed-size histogram of durations, with a log-linear bucketing
+ * in the manner of HDR histograms.
+ *
+ * Each power of two is split in 16 linear sub-buckets, so the values are
+ * stored with a relative precision of about 6%, from 1 ns up to about 18
+ * minutes. Recording is wait-free and allocation-free, and the histogram
+ * can be read concurrently; a read which races with a record may be off
+ * by that one value.
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned subBucketBits = 4;
+    static constexpr unsigned numSubBuckets = 1u << subBucketBits;
+    static constexpr unsigned maxExponent = 40;
+    static constexpr unsigned numBuckets = (maxExponent - subBucketBits + 1) * numSubBuckets;
+
+    /**
+     * @brief Record a value in nanoseconds.
+     */
+    void record(uint64_t nanoseconds) noexcept;
+
+    /**
+     * @brief Record a duration.
+     */
+    template <class Rep, class Period>
+    void record(std::chrono::duration<Rep, Period> duration) noexcept
+    {
+        const double ns = std::chrono::duration<double, std::nano>(duration).count();
+        record(ns > 0.0 ? static_cast<uint64_t>(ns) : uint64_t(0));
+    }
+
+    /**
+     * @brief Get the value under which a fraction of the recorded values
+     * fall, in nanoseconds. This is the upper bound of the matching bucket,
+     * or 0 if nothing was recorded.
+     *
+     * @param quantile between 0 and 1, e.g. 0.99 for the 99th percentile
+     */
+    uint64_t percentile(double quantile) const noexcept;
+
+    /**
+     * @brief Get the number of recorded values.
+     */
+    uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the largest recorded value, in nanoseconds.
+     */
+    uint64_t max() const noexcept { return max_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the mean of the recorded values, in nanoseconds.
+     */
+    double mean() const noexcept;
+
+    /**
+     * @brief Clear the histogram.
+     */
+    void reset() noexcept;
+
+    /**
+     * @brief Get the bucket holding a value.
+     */
+    static unsigned bucketIndex(uint64_t nanoseconds) noexcept;
+
+    /**
+     * @brief Get the largest value held by a bucket.
+     */
+    static uint64_t bucketUpperBound(unsigned index) noexcept;
+
+private:
+    std::array<std::atomic<uint64_t>, numBuckets> buckets_ {};
+    std::atomic<uint64_t> count_ { 0 };
+    std::atomic<uint64_t> sum_ { 0 };
+    std::atomic<uint64_t> max_ { 0 };
+    LEAK_DETECTOR(LatencyHistogram);
+};
+
+/**
+ * @brief Counters and histograms describing the activity of the synth.
+ *
+ * The render thread and the background loaders update them without locks
+ * nor allocations, and they can be read at any time from any thread while
+ * the synth keeps running.
+ */
+class Telemetry {
+public:
+    enum class Stage : unsigned {
+        Dispatch,
+        RenderMethod,
+        Data,
+        Amplitude,
+        Filters,
+        Panning,
+        Effects,
+        Count
+    };
+    static constexpr unsigned numStages = static_cast<unsigned>(Stage::Count);
+
+    /**
+     * @brief Record a rendered block. Called from the render thread.
+     *
+     * @param breakdown the timings of the block per stage
+     * @param numVoices the number of active voices at the end of the block
+     * @param numFrames the number of frames of the block
+     */
+    void recordBlock(const CallbackBreakdown& breakdown, int numVoices, size_t numFrames) noexcept;
+
+    /**
+     * @brief Record a file load. Called from the loading threads.
+     *
+     * @param waitDuration the time the file spent in the queue
+     * @param loadDuration the time spent loading the file
+     */
+    void recordFileLoad(std::chrono::duration<double> waitDuration, std::chrono::duration<double> loadDuration) noexcept;
+
+    /**
+     * @brief Add to the number of stolen voices.
+     */
+    void addStolenVoices(uint64_t number) noexcept { stolenVoices_.fetch_add(number, std::memory_order_relaxed); }
+
+    /**
+     * @brief Add to the number of requests refused by the buffer pools.
+     */
+    void addBufferPoolExhaustions(uint64_t number) noexcept { bufferPoolExhaustions_.fetch_add(number, std::memory_order_relaxed); }
+
+    /**
+     * @brief Add to the numbers of effect bus blocks, processed and skipped
+     * while the buses were idle.
+     */
+    void addEffectBusBlocks(uint64_t processed, uint64_t skipped) noexcept;
+
+    /**
+     * @brief Set the number of files waiting to be loaded.
+     */
+    void setFileQueueDepth(size_t depth) noexcept;
+
+    /**
+     * @brief Set the total number of stream underruns. This mirrors the
+     * counter of the file pool, and restarts from 0 on a reset.
+     */
+    void setStreamUnderruns(uint64_t total) noexcept;
+
+    uint64_t getNumBlocks() const noexcept { return numBlocks_.load(std::memory_order_relaxed); }
+    uint64_t getNumFrames() const noexcept { return numFrames_.load(std::memory_order_relaxed); }
+    /**
+     * @brief Get the time spent in a stage since the last reset.
+     */
+    std::chrono::duration<double> getStageTime(Stage stage) const noexcept;
+    int getActiveVoices() const noexcept { return activeVoices_.load(std::memory_order_relaxed); }
+    int getMaxActiveVoices() const noexcept { return maxActiveVoices_.load(std::memory_order_relaxed); }
+    uint64_t getStolenVoices() const noexcept { return stolenVoices_.load(std::memory_order_relaxed); }
+    size_t getFileQueueDepth() const noexcept { return fileQueueDepth_.load(std::memory_order_relaxed); }
+    size_t getMaxFileQueueDepth() const noexcept { return maxFileQueueDepth_.load(std::memory_order_relaxed); }
+    uint64_t getBufferPoolExhaustions() const noexcept { return bufferPoolExhaustions_.load(std::memory_order_relaxed); }
+    uint64_t getEffectBusBlocks() const noexcept { return effectBusBlocks_.load(std::memory_order_relaxed); }
+    uint64_t getSkippedEffectBusBlocks() const noexcept { return skippedEffectBusBlocks_.load(std::memory_order_relaxed); }
+    uint64_t getStreamUnderruns() const noexcept;
+
+    /**
+     * @brief The histogram of the callback times, dispatch and rendering.
+     */
+    const LatencyHistogram& getCallbackTimes() const noexcept { return callbackTimes_; }
+    /**
+     * @brief The histogram of the time files wait before being loaded.
+     */
+    const LatencyHistogram& getFileWaitTimes() const noexcept { return fileWaitTimes_; }
+    /**
+     * @brief The histogram of the file loading times.
+     */
+    const LatencyHistogram& getFileLoadTimes() const noexcept { return fileLoadTimes_; }
+
+    /**
+     * @brief Reset the counters and histograms. The current number of
+     * active voices and the queue depth are kept.
+     */
+    void reset() noexcept;
+
+private:
+    std::atomic<uint64_t> numBlocks_ { 0 };
+    std::atomic<uint64_t> numFrames_ { 0 };
+    std::array<std::atomic<uint64_t>, numStages> stageNanoseconds_ {};
+    std::atomic<int> activeVoices_ { 0 };
+    std::atomic<int> maxActiveVoices_ { 0 };
+    std::atomic<uint64_t> stolenVoices_ { 0 };
+    std::atomic<size_t> fileQueueDepth_ { 0 };
+    std::atomic<size_t> maxFileQueueDepth_ { 0 };
+    std::atomic<uint64_t> bufferPoolExhaustions_ { 0 };
+    std::atomic<uint64_t> effectBusBlocks_ { 0 };
+    std::atomic<uint64_t> skippedEffectBusBlocks_ { 0 };
+    std::atomic<uint64_t> streamUnderrunsTotal_ { 0 };
+    std::atomic<uint64_t> streamUnderrunsAtReset_ { 0 };
+    LatencyHistogram callbackTimes_;
+    LatencyHistogram fileWaitTimes_;
+    LatencyHistogram fileLoadTimes_;
+    LEAK_DETECTOR(Telemetry);
+};
+
+} // namespace sfz
@@ -160,6 +160,13 @@ Tuning::~Tuning()
 {
 }
 
+Tuning& Tuning::operator=(const Tuning& other)
+{
+    if (this != &other)
+        *impl_ = *other.impl_;
+    return *this;
+}
+
 bool Tuning::loadScalaFile(const fs::path& path)
 {
     Tunings::Scale scl;
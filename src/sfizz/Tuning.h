@@ -15,6 +15,11 @@ public:
     Tuning();
     ~Tuning();
 
+    /**
+     * @brief Copy the scale, root key and tuning frequency of another tuning.
+     */
+    Tuning& operator=(const Tuning& other);
+
     /**
      * @brief Load a scale from a file in the Scala format.
      */
@@ -5,6 +5,7 @@
 // If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
 
 #include "Voice.h"
+#include "VoiceBatch.h"
 #include "Layer.h"
 #include "AudioBuffer.h"
 #include "Config.h"
@@ -88,6 +89,32 @@ struct Voice::Impl
         absl::Span<const int> indices, absl::Span<const float> coeffs,
         absl::Span<const float> addingGains, int quality);
 
+    /**
+     * @brief Fill a destination with the interpolated sample, reading the
+     *        streamed frames from the ring if there is one.
+     *
+     * The indices are split in windows which fit either in the preloaded
+     * data or in the streaming ring. A window which is not streamed in time
+     * is left silent.
+     *
+     * @param source the preloaded sample
+     * @param dest the destination buffer
+     * @param indices the integral parts of the source positions
+     * @param coeffs the fractional parts of the source positions
+     * @param quality the quality level 1-10
+     */
+    template <bool Adding>
+    void fillFromSource(
+        const AudioSpan<const float>& source, const AudioSpan<float>& dest,
+        absl::Span<const int> indices, absl::Span<const float> coeffs,
+        absl::Span<const float> addingGains, int quality) noexcept;
+
+    /**
+     * @brief Check whether the sample can be played from a streaming ring,
+     *        which holds a limited span of frames.
+     */
+    bool canStreamSample() const noexcept;
+
     /**
      * @brief Get a S-shaped curve that is applicable to loop crossfading.
      */
@@ -114,12 +141,14 @@ struct Voice::Impl
      *
      * @param buffer
      */
+    template <bool Crossfades = true>
     void ampStageMono(AudioSpan<float> buffer) noexcept;
     /**
      * @brief Amplitude stage for a stereo source
      *
      * @param buffer
      */
+    template <bool Crossfades = true>
     void ampStageStereo(AudioSpan<float> buffer) noexcept;
     /**
      * @brief Amplitude stage for a mono source
@@ -135,6 +164,54 @@ struct Voice::Impl
      */
     void filterStageMono(AudioSpan<float> buffer) noexcept;
     void filterStageStereo(AudioSpan<float> buffer) noexcept;
+
+    /**
+     * @brief A render pipeline, which fills the buffer from the source and
+     * runs the amplitude, panning and filter stages.
+     *
+     * @param buffer the whole block
+     * @param delayedBuffer the part of the block after the initial delay
+     */
+    using RenderPipeline = void (*)(Impl& impl, AudioSpan<float> buffer, AudioSpan<float> delayedBuffer);
+
+    /**
+     * @brief The generic render pipeline, which checks the region on every block.
+     */
+    static void renderGeneric(Impl& impl, AudioSpan<float> buffer, AudioSpan<float> delayedBuffer) noexcept;
+
+    /**
+     * @brief A render pipeline specialized for a kind of region, which skips
+     * the stages that the region does not use.
+     *
+     * @tparam Oscillator whether the source is an oscillator or a sample
+     * @tparam Stereo whether the source is stereo
+     * @tparam Crossfades whether the region has CC crossfades
+     * @tparam Filters whether the region has filters or equalizers
+     */
+    template <bool Oscillator, bool Stereo, bool Crossfades, bool Filters>
+    static void renderSpecialized(Impl& impl, AudioSpan<float> buffer, AudioSpan<float> delayedBuffer) noexcept;
+
+    /**
+     * @brief Select the render pipeline of a region.
+     *
+     * @param region
+     * @param specialized whether to use the specialized pipelines
+     */
+    static RenderPipeline selectRenderPipeline(const Region& region, bool specialized) noexcept;
+    /**
+     * @brief Check whether the voices of a region can be rendered in batches,
+     * as far as the region alone is concerned.
+     *
+     * @param region
+     */
+    static bool canBatchRegion(const Region& region) noexcept;
+    /**
+     * @brief Finish a rendered block: check whether the voice ended and
+     * advance its age.
+     *
+     * @param numFrames
+     */
+    void endBlock(size_t numFrames) noexcept;
     /**
      * @brief Compute the pitch envelope. This envelope is meant to multiply
      * the frequency parameter for each sample (which translates to floating
@@ -219,6 +296,8 @@ struct Voice::Impl
     StateListener* stateListener_ = nullptr;
 
     const Region* region_ { nullptr };
+    RenderPipeline renderPipeline_ { &renderGeneric };
+    bool batchable_ { false };
 
     State state_ { State::idle };
     bool noteIsOff_ { false };
@@ -245,6 +324,9 @@ struct Voice::Impl
     uint32_t count_ { 1 };
     int sampleEnd_ { 0 };
     int sampleSize_ { 0 };
+    // the positions above are in frames of the sample data, which may be
+    // oversampled compared to the file
+    int oversamplingFactor_ { 1 };
 
     struct {
         int start { 0 };
@@ -257,6 +339,7 @@ struct Voice::Impl
     } loop_;
 
     FileDataHolder currentPromise_;
+    FileStreamHolder currentStream_;
 
     int samplesPerBlock_ { config::defaultSamplesPerBlock };
     float sampleRate_ { config::defaultSampleRate };
@@ -433,6 +516,18 @@ bool Voice::startVoice(Layer* layer, int delay, const TriggerEvent& event) noexc
     if (delay < 0)
         delay = 0;
 
+    // do Scala retuning and reconvert the frequency into a 12TET key number;
+    // this comes first, the file loads are scheduled by the playback rate
+    Tuning& tuning = resources.getTuning();
+    const float numberRetuned = tuning.getKeyFractional12TET(impl.triggerEvent_.number);
+
+    impl.pitchRatio_ = basePitchVariation(region, numberRetuned, impl.triggerEvent_.value, midiState, curveSet);
+
+    // apply stretch tuning if set
+    if (absl::optional<StretchTuning>& stretch = resources.getStretch())
+        impl.pitchRatio_ *= stretch->getRatioForFractionalKey(numberRetuned);
+
+    impl.oversamplingFactor_ = 1;
     if (region.isOscillator()) {
         WavetablePool& wavePool = resources.getWavePool();
         const WavetableMulti* wave = nullptr;
@@ -469,26 +564,25 @@ bool Voice::startVoice(Layer* layer, int delay, const TriggerEvent& event) noexc
         impl.setupOscillatorUnison();
     } else {
         FilePool& filePool = resources.getFilePool();
-        impl.currentPromise_ = filePool.getFilePromise(region.sampleId);
+        const auto offset = static_cast<int64_t>(sampleOffset(region, midiState));
+        impl.currentPromise_ = filePool.getPreloadedFile(region.sampleId);
+        if (impl.currentPromise_) {
+            impl.updateLoopInformation();
+            if (impl.canStreamSample())
+                impl.currentStream_ = filePool.getFileStream(region.sampleId, *impl.currentPromise_, impl.pitchRatio_);
+            if (!impl.currentStream_)
+                impl.currentPromise_ = filePool.getFilePromise(region.sampleId, offset, impl.pitchRatio_);
+        }
         if (!impl.currentPromise_) {
             impl.switchState(State::cleanMeUp);
             return false;
         }
-        impl.updateLoopInformation();
-        impl.speedRatio_ = static_cast<float>(impl.currentPromise_->information.sampleRate / impl.sampleRate_);
-        impl.sourcePosition_ = sampleOffset(region, midiState);
+        const FileInformation& information = impl.currentPromise_->information;
+        impl.oversamplingFactor_ = information.oversamplingFactor;
+        impl.speedRatio_ = static_cast<float>(information.sampleRate * information.oversamplingFactor / impl.sampleRate_);
+        impl.sourcePosition_ = static_cast<int>(offset) * impl.oversamplingFactor_;
     }
 
-    // do Scala retuning and reconvert the frequency into a 12TET key number
-    Tuning& tuning = resources.getTuning();
-    const float numberRetuned = tuning.getKeyFractional12TET(impl.triggerEvent_.number);
-
-    impl.pitchRatio_ = basePitchVariation(region, numberRetuned, impl.triggerEvent_.value, midiState, curveSet);
-
-    // apply stretch tuning if set
-    if (absl::optional<StretchTuning>& stretch = resources.getStretch())
-        impl.pitchRatio_ *= stretch->getRatioForFractionalKey(numberRetuned);
-
     impl.pitchKeycenter_ = region.pitchKeycenter;
     impl.baseVolumedB_ = baseVolumedB(region, midiState, impl.triggerEvent_.number);
     impl.baseGain_ = region.getBaseGain();
@@ -498,6 +592,10 @@ bool Voice::startVoice(Layer* layer, int delay, const TriggerEvent& event) noexc
     impl.gainSmoother_.reset();
     impl.resetCrossfades();
 
+    impl.renderPipeline_ = Impl::selectRenderPipeline(
+        region, resources.getSynthConfig().specializedRenderPipelines);
+    impl.batchable_ = Impl::canBatchRegion(region);
+
     for (unsigned i = 0; i < region.filters.size(); ++i) {
         impl.filters_[i].setup(region, i, impl.triggerEvent_.number, impl.triggerEvent_.value);
     }
@@ -509,7 +607,7 @@ bool Voice::startVoice(Layer* layer, int delay, const TriggerEvent& event) noexc
     impl.triggerDelay_ = delay;
     impl.initialDelay_ = delay + static_cast<int>(regionDelay(region, midiState) * impl.sampleRate_);
     impl.baseFrequency_ = tuning.getFrequencyOfKey(impl.triggerEvent_.number);
-    impl.sampleEnd_ = int(sampleEnd(region, midiState));
+    impl.sampleEnd_ = int(sampleEnd(region, midiState)) * impl.oversamplingFactor_;
     impl.sampleSize_ = impl.sampleEnd_- impl.sourcePosition_ - 1;
     impl.bendSmoother_.setSmoothing(region.bendSmooth, impl.sampleRate_);
     impl.bendSmoother_.reset(region.getBendInCents(midiState.getPitchBend()));
@@ -779,12 +877,160 @@ void Voice::renderBlock(AudioSpan<float> buffer) noexcept
     auto delayed_buffer = buffer.subspan(delay);
     impl.initialDelay_ -= static_cast<int>(delay);
 
+    impl.renderPipeline_(impl, buffer, delayed_buffer);
+    impl.powerFollower_.process(buffer);
+    impl.endBlock(buffer.getNumFrames());
+
+#if 0
+    ASSERT(!hasNanInf(buffer.getConstSpan(0)));
+    ASSERT(!hasNanInf(buffer.getConstSpan(1)));
+    SFIZZ_CHECK(isReasonableAudio(buffer.getConstSpan(0)));
+    SFIZZ_CHECK(isReasonableAudio(buffer.getConstSpan(1)));
+#endif
+}
+
+bool Voice::renderBatched(VoiceBatch& batch, size_t numFrames) noexcept
+{
+    Impl& impl = *impl_;
+    ASSERT(static_cast<int>(numFrames) <= impl.samplesPerBlock_);
+    ASSERT(!batch.full());
+
+    const Region* region = impl.region_;
+    if (!impl.batchable_ || region == nullptr || region->disabled() || numFrames == 0)
+        return false;
+
+    if (impl.state_ != State::playing || !impl.currentPromise_ || impl.followPower_
+        || impl.initialDelay_ > 0 || impl.getCurrentSampleQuality() != 1)
+        return false;
+
+    ModMatrix& mm = impl.resources_.getModMatrix();
+    if (mm.validTarget(impl.pitchTarget_) || mm.validTarget(impl.panTarget_))
+        return false;
+
+    // A filter must run in a filter bank
+    FilterHolder* filter = nullptr;
+    if (!region->filters.empty()) {
+        filter = &impl.filters_.front();
+        if (!filter->isBanked())
+            return false;
+    }
+
+    // The pitch must be constant over the block
+    const EventVector& pitchEvents = impl.resources_.getMidiState().getPitchEvents();
+    if (pitchEvents.size() != 1 || region->bendStep > 1.0f)
+        return false;
+
+    const float bend = region->getBendInCents(pitchEvents.front().value);
+    if (impl.bendSmoother_.current() != bend)
+        return false;
+
+    // The whole block must be read before the end of the sample
+    const auto source = impl.currentPromise_->getData();
+    FileStream* stream = impl.currentStream_.get();
+    const int sourceFrames = stream ?
+        static_cast<int>(stream->getNumFrames()) : static_cast<int>(source.getNumFrames());
+    const int fileEnd = int(impl.currentPromise_->information.end) * impl.oversamplingFactor_;
+    const int sampleEnd = min(impl.sampleEnd_, fileEnd, sourceFrames) - 1;
+
+    const float increment = impl.pitchRatio_ * impl.speedRatio_ * centsFactor(bend);
+    const float position = impl.floatPositionOffset_ + (impl.age_ == 0 ? 0.0f : increment);
+    const float lastPosition = position + increment * static_cast<float>(numFrames - 1);
+    const int firstIndex = impl.sourcePosition_ + static_cast<int>(position);
+    const int lastIndex = impl.sourcePosition_ + static_cast<int>(lastPosition);
+    if (lastIndex + 1 >= sampleEnd)
+        return false;
+
+    // Find the frames to read, preloaded or streamed, as in fillFromSource
+    constexpr int padding = config::excessFileFrames;
+    const int windowSize = lastIndex - firstIndex + 2 * padding + 1;
+    const bool streamed = stream && lastIndex + padding >= static_cast<int>(source.getNumFrames());
+    if (streamed && windowSize > static_cast<int>(stream->getMaxWindow()))
+        return false;
+
+    // Keep the positions small, to preserve the precision of the fractions
+    const float* data = source.getChannel(0) + impl.sourcePosition_;
+    int dataStart = impl.sourcePosition_;
+    {
+        ScopedTiming logger { impl.dataDuration_ };
+        if (streamed) {
+            // The frames of the previous block are rendered by now, so the
+            // ring can recycle them; rendering per voice does this at the end
+            // of the block instead.
+            stream->setReadFrame(impl.sourcePosition_ - padding, increment / impl.speedRatio_);
+
+            AudioSpan<const float> window;
+            const bool wait = impl.resources_.getSynthConfig().freeWheeling;
+            if (stream->getFrames(firstIndex - padding, static_cast<size_t>(windowSize), window, wait)) {
+                data = window.getChannel(0);
+                dataStart = firstIndex - padding;
+            } else {
+                data = nullptr;
+            }
+        }
+    }
+
+    // Constant panning, as computed by the pan stage
+    float panLeft { 1.0f };
+    float panRight { 1.0f };
+    {
+        ScopedTiming logger { impl.panningDuration_ };
+        const float panValue = region->pan;
+        pan(&panValue, &panLeft, &panRight, 1);
+    }
+
+    {
+        ScopedTiming logger { impl.amplitudeDuration_ };
+        absl::Span<float> gains;
+        if (data) {
+            const float dataPosition = position + static_cast<float>(impl.sourcePosition_ - dataStart);
+            gains = batch.addVoice(*region, data, dataPosition, increment, panLeft, panRight, numFrames, filter);
+        } else {
+            // The streamed frames are missing, read silence like fillFromSource
+            static const float silence[2] {};
+            gains = batch.addVoice(*region, silence, 0.0f, 0.0f, panLeft, panRight, numFrames, filter);
+        }
+        impl.amplitudeEnvelope(gains);
+    }
+
+    impl.filterDuration_ = Duration(0);
+
+    const int lastOffset = static_cast<int>(lastPosition);
+    impl.sourcePosition_ += lastOffset;
+    impl.floatPositionOffset_ = lastPosition - static_cast<float>(lastOffset);
+
+    impl.endBlock(numFrames);
+    return true;
+}
+
+void Voice::Impl::endBlock(size_t numFrames) noexcept
+{
+    if (!region_->flexAmpEG) {
+        if (!egAmplitude_.isSmoothing())
+            switchState(State::cleanMeUp);
+    }
+    else {
+        if (flexEGs_[*region_->flexAmpEG]->isFinished())
+            switchState(State::cleanMeUp);
+    }
+
+    age_ += static_cast<int>(numFrames);
+    if (triggerDelay_) {
+        // Should be OK but just in case;
+        age_ = min(age_ - *triggerDelay_, 0);
+        triggerDelay_ = absl::nullopt;
+    }
+}
+
+void Voice::Impl::renderGeneric(Impl& impl, AudioSpan<float> buffer, AudioSpan<float> delayedBuffer) noexcept
+{
+    const Region* region = impl.region_;
+
     { // Fill buffer with raw data
         ScopedTiming logger { impl.dataDuration_ };
         if (region->isOscillator())
-            impl.fillWithGenerator(delayed_buffer);
+            impl.fillWithGenerator(delayedBuffer);
         else
-            impl.fillWithData(delayed_buffer);
+            impl.fillWithData(delayedBuffer);
     }
 
     if (region->isStereo()) {
@@ -796,31 +1042,73 @@ void Voice::renderBlock(AudioSpan<float> buffer) noexcept
         impl.filterStageMono(buffer);
         impl.panStageMono(buffer);
     }
+}
 
-    if (!region->flexAmpEG) {
-        if (!impl.egAmplitude_.isSmoothing())
-            impl.switchState(State::cleanMeUp);
+template <bool Oscillator, bool Stereo, bool Crossfades, bool Filters>
+void Voice::Impl::renderSpecialized(Impl& impl, AudioSpan<float> buffer, AudioSpan<float> delayedBuffer) noexcept
+{
+    { // Fill buffer with raw data
+        ScopedTiming logger { impl.dataDuration_ };
+        IF_CONSTEXPR (Oscillator)
+            impl.fillWithGenerator(delayedBuffer);
+        else
+            impl.fillWithData(delayedBuffer);
     }
-    else {
-        if (impl.flexEGs_[*region->flexAmpEG]->isFinished())
-            impl.switchState(State::cleanMeUp);
+
+    IF_CONSTEXPR (Stereo) {
+        impl.ampStageStereo<Crossfades>(buffer);
+        impl.panStageStereo(buffer);
+        IF_CONSTEXPR (Filters)
+            impl.filterStageStereo(buffer);
+    } else {
+        impl.ampStageMono<Crossfades>(buffer);
+        IF_CONSTEXPR (Filters)
+            impl.filterStageMono(buffer);
+        impl.panStageMono(buffer);
     }
+}
 
-    impl.powerFollower_.process(buffer);
+Voice::Impl::RenderPipeline Voice::Impl::selectRenderPipeline(const Region& region, bool specialized) noexcept
+{
+    if (!specialized)
+        return &renderGeneric;
+
+    // Indexed by oscillator, stereo, crossfades and filters, in this bit order
+    static const RenderPipeline pipelines[16] = {
+        &renderSpecialized<false, false, false, false>,
+        &renderSpecialized<false, false, false, true>,
+        &renderSpecialized<false, false, true, false>,
+        &renderSpecialized<false, false, true, true>,
+        &renderSpecialized<false, true, false, false>,
+        &renderSpecialized<false, true, false, true>,
+        &renderSpecialized<false, true, true, false>,
+        &renderSpecialized<false, true, true, true>,
+        &renderSpecialized<true, false, false, false>,
+        &renderSpecialized<true, false, false, true>,
+        &renderSpecialized<true, false, true, false>,
+        &renderSpecialized<true, false, true, true>,
+        &renderSpecialized<true, true, false, false>,
+        &renderSpecialized<true, true, false, true>,
+        &renderSpecialized<true, true, true, false>,
+        &renderSpecialized<true, true, true, true>,
+    };
 
-    impl.age_ += buffer.getNumFrames();
-    if (impl.triggerDelay_) {
-        // Should be OK but just in case;
-        impl.age_ = min(impl.age_ - *impl.triggerDelay_, 0);
-        impl.triggerDelay_ = absl::nullopt;
-    }
+    const bool crossfades = !region.crossfadeCCInRange.empty() || !region.crossfadeCCOutRange.empty();
+    const bool filters = !region.filters.empty() || !region.equalizers.empty();
+    const unsigned index = (region.isOscillator() ? 8 : 0) | (region.isStereo() ? 4 : 0)
+        | (crossfades ? 2 : 0) | (filters ? 1 : 0);
 
-#if 0
-    ASSERT(!hasNanInf(buffer.getConstSpan(0)));
-    ASSERT(!hasNanInf(buffer.getConstSpan(1)));
-    SFIZZ_CHECK(isReasonableAudio(buffer.getConstSpan(0)));
-    SFIZZ_CHECK(isReasonableAudio(buffer.getConstSpan(1)));
-#endif
+    return pipelines[index];
+}
+
+bool Voice::Impl::canBatchRegion(const Region& region) noexcept
+{
+    return !region.isOscillator() && !region.isStereo()
+        && region.crossfadeCCInRange.empty() && region.crossfadeCCOutRange.empty()
+        && (region.filters.empty()
+            || (region.filters.size() == 1 && FilterBank::supports(region.filters.front().type)))
+        && region.equalizers.empty()
+        && !region.shouldLoop() && !region.sampleCount;
 }
 
 void Voice::Impl::resetCrossfades() noexcept
@@ -912,6 +1200,7 @@ void Voice::Impl::amplitudeEnvelope(absl::Span<float> modulationSpan) noexcept
     gainSmoother_.process(modulationSpan, modulationSpan);
 }
 
+template <bool Crossfades>
 void Voice::Impl::ampStageMono(AudioSpan<float> buffer) noexcept
 {
     ScopedTiming logger { amplitudeDuration_ };
@@ -926,10 +1215,13 @@ void Voice::Impl::ampStageMono(AudioSpan<float> buffer) noexcept
         return;
 
     amplitudeEnvelope(*modulationSpan);
-    applyCrossfades(*modulationSpan);
+    // Without crossfade CCs, the crossfade gain is constantly 1
+    IF_CONSTEXPR (Crossfades)
+        applyCrossfades(*modulationSpan);
     applyGain<float>(*modulationSpan, leftBuffer);
 }
 
+template <bool Crossfades>
 void Voice::Impl::ampStageStereo(AudioSpan<float> buffer) noexcept
 {
     ScopedTiming logger { amplitudeDuration_ };
@@ -942,7 +1234,9 @@ void Voice::Impl::ampStageStereo(AudioSpan<float> buffer) noexcept
         return;
 
     amplitudeEnvelope(*modulationSpan);
-    applyCrossfades(*modulationSpan);
+    // Without crossfade CCs, the crossfade gain is constantly 1
+    IF_CONSTEXPR (Crossfades)
+        applyCrossfades(*modulationSpan);
     buffer.applyGain(*modulationSpan);
 }
 
@@ -1064,6 +1358,13 @@ void Voice::Impl::fillWithData(AudioSpan<float> buffer) noexcept
     }
 
     auto source = currentPromise_->getData();
+    FileStream* stream = currentStream_.get();
+    const MappedAudioFile* mapping = currentPromise_->getWindowedMapping();
+    size_t sourceFrames = source.getNumFrames();
+    if (stream)
+        sourceFrames = static_cast<size_t>(stream->getNumFrames());
+    else if (mapping)
+        sourceFrames = mapping->numFrames();
 
     BufferPool& bufferPool = resources_.getBufferPool();
     const CurveSet& curves = resources_.getCurves();
@@ -1075,6 +1376,7 @@ void Voice::Impl::fillWithData(AudioSpan<float> buffer) noexcept
     auto indices = bufferPool.getIndexBuffer(numSamples);
     if (!indices || !coeffs)
         return;
+    float blockAdvance = 0.0f;
     {
         auto jumps = bufferPool.getBuffer(numSamples);
         if (!jumps)
@@ -1093,6 +1395,7 @@ void Voice::Impl::fillWithData(AudioSpan<float> buffer) noexcept
 
         jumps->front() += floatPositionOffset_;
         cumsum<float>(*jumps, *jumps);
+        blockAdvance = jumps->back() - floatPositionOffset_;
         sfzInterpolationCast<float>(*jumps, *indices, *coeffs);
         add1<int>(sourcePosition_, *indices);
     }
@@ -1102,7 +1405,7 @@ void Voice::Impl::fillWithData(AudioSpan<float> buffer) noexcept
     const auto loop = this->loop_;
 
     // Looping logic
-    const bool hasLoopSamples = static_cast<size_t>(loop.end) < source.getNumFrames();
+    const bool hasLoopSamples = static_cast<size_t>(loop.end) < sourceFrames;
     const bool loopCountReached = region_->loopCount && loop_.restarts >= *region_->loopCount;
     const bool loopContinuous = (region_->loopMode == LoopMode::loop_continuous);
     const bool loopSustain = (region_->loopMode == LoopMode::loop_sustain) && !released();
@@ -1146,7 +1449,8 @@ void Voice::Impl::fillWithData(AudioSpan<float> buffer) noexcept
         numPartitions = 1;
     }
 
-    const auto sampleEnd = min( int(sampleEnd_), int(currentPromise_->information.end), int(source.getNumFrames())) - 1;
+    const int fileEnd = int(currentPromise_->information.end) * oversamplingFactor_;
+    const auto sampleEnd = min( int(sampleEnd_), fileEnd, int(sourceFrames)) - 1;
 
     int blockRestarts { 0 };
     int oldIndex {};
@@ -1233,7 +1537,7 @@ void Voice::Impl::fillWithData(AudioSpan<float> buffer) noexcept
         absl::Span<const int> ptIndices = indices->subspan(ptStart, ptSize);
         absl::Span<const float> ptCoeffs = coeffs->subspan(ptStart, ptSize);
 
-        fillInterpolatedWithQuality<false>(
+        fillFromSource<false>(
             source, ptBuffer, ptIndices, ptCoeffs, {}, quality);
 
         if (ptType == kPartitionLoopXfade) {
@@ -1323,7 +1627,7 @@ void Voice::Impl::fillWithData(AudioSpan<float> buffer) noexcept
                         xfCurve[i] = clamp(xfInCurvePos[i], 0.0f, 1.0f);
                 }
                 // apply in curve
-                fillInterpolatedWithQuality<true>(
+                fillFromSource<true>(
                     source, xfInBuffer, xfInIndices, xfInCoeffs, xfCurve, quality);
             }
         }
@@ -1332,6 +1636,13 @@ void Voice::Impl::fillWithData(AudioSpan<float> buffer) noexcept
     sourcePosition_ = indices->back();
     floatPositionOffset_ = coeffs->back();
 
+    // Let the ring recycle the frames which will not be read anymore
+    if (stream) {
+        const int nextFrame = shouldLoop ? min(sourcePosition_, loop.xfInStart) : sourcePosition_;
+        const float playbackRate = blockAdvance / (static_cast<float>(numSamples) * speedRatio_);
+        stream->setReadFrame(nextFrame - config::excessFileFrames, playbackRate);
+    }
+
 #if 1
     ASSERT(!hasNanInf(buffer.getConstSpan(0)));
     ASSERT(!hasNanInf(buffer.getConstSpan(1)));
@@ -1346,6 +1657,14 @@ void Voice::Impl::fillInterpolated(
     absl::Span<const int> indices, absl::Span<const float> coeffs,
     absl::Span<const float> addingGains)
 {
+    const bool stereo = source.getNumChannels() > 1;
+    if (interpolateSincBlock<M>(
+            source.getConstSpan(0).data(), stereo ? source.getConstSpan(1).data() : nullptr,
+            dest.getChannel(0), stereo ? dest.getChannel(1) : nullptr,
+            indices.data(), coeffs.data(), Adding ? addingGains.data() : nullptr,
+            static_cast<unsigned>(indices.size())))
+        return;
+
     auto* ind = indices.data();
     auto* coeff = coeffs.data();
     auto* addingGain = addingGains.data();
@@ -1383,85 +1702,134 @@ void Voice::Impl::fillInterpolated(
 }
 
 template <bool Adding>
-void Voice::Impl::fillInterpolatedWithQuality(
+void Voice::Impl::fillFromSource(
     const AudioSpan<const float>& source, const AudioSpan<float>& dest,
     absl::Span<const int> indices, absl::Span<const float> coeffs,
-    absl::Span<const float> addingGains, int quality)
+    absl::Span<const float> addingGains, int quality) noexcept
 {
-    switch (clamp(quality, 0, 10)) {
-    case 0:
-        {
-            constexpr auto itp = kInterpolatorNearest;
-            fillInterpolated<itp, Adding>(source, dest, indices, coeffs, addingGains);
+    FileStream* stream = currentStream_.get();
+    const MappedAudioFile* mapping = stream ? nullptr : currentPromise_->getWindowedMapping();
+    if (!stream && !mapping) {
+        fillInterpolatedWithQuality<Adding>(source, dest, indices, coeffs, addingGains, quality);
+        return;
+    }
+
+    BufferPool& bufferPool = resources_.getBufferPool();
+    auto windowIndices = bufferPool.getIndexBuffer(indices.size());
+    if (!windowIndices)
+        return;
+
+    // The mapped frames are deinterleaved in a window buffer
+    constexpr int padding = config::excessFileFrames;
+    SpanHolder<AudioSpan<float>> mappedWindow;
+    if (mapping) {
+        mappedWindow = bufferPool.getWindowBuffer(samplesPerBlock_ + 2 * padding + 1);
+        if (!mappedWindow)
+            return;
+    }
+
+    const int preloadedFrames = static_cast<int>(source.getNumFrames());
+    const int maxWindow = stream ?
+        static_cast<int>(stream->getMaxWindow()) : static_cast<int>(mappedWindow->getNumFrames());
+    const bool wait = resources_.getSynthConfig().freeWheeling;
+
+    size_t i = 0;
+    while (i < indices.size()) {
+        // Gather the indices which fit in a window
+        int low = indices[i];
+        int high = indices[i];
+        size_t j = i + 1;
+        for (; j < indices.size(); ++j) {
+            const int newLow = min(low, indices[j]);
+            const int newHigh = max(high, indices[j]);
+            if (newHigh - newLow + 2 * padding + 1 > maxWindow)
+                break;
+            low = newLow;
+            high = newHigh;
         }
-        break;
-    case 1:
-        {
-            constexpr auto itp = kInterpolatorLinear;
-            fillInterpolated<itp, Adding>(source, dest, indices, coeffs, addingGains);
+
+        const size_t size = j - i;
+        AudioSpan<float> chunkDest = dest.subspan(i, size);
+        const absl::Span<const float> chunkCoeffs = coeffs.subspan(i, size);
+        const absl::Span<const float> chunkGains = Adding ? addingGains.subspan(i, size) : addingGains;
+
+        const size_t windowSize = static_cast<size_t>(high - low + 2 * padding + 1);
+        AudioSpan<const float> window;
+        if (high + padding < preloadedFrames) {
+            fillInterpolatedWithQuality<Adding>(
+                source, chunkDest, indices.subspan(i, size), chunkCoeffs, chunkGains, quality);
+        } else if (mapping) {
+            AudioSpan<float> windowFrames = mappedWindow->first(windowSize);
+            mapping->readFrames(low - padding, windowFrames);
+            if (mapping->numChannels() == 1)
+                window = AudioSpan<const float>({ windowFrames.getChannel(0) }, windowSize);
+            else
+                window = windowFrames;
+            const absl::Span<int> chunkIndices = windowIndices->subspan(i, size);
+            absl::c_copy(indices.subspan(i, size), chunkIndices.begin());
+            subtract1(low - padding, chunkIndices);
+            fillInterpolatedWithQuality<Adding>(
+                window, chunkDest, chunkIndices, chunkCoeffs, chunkGains, quality);
+        } else if (stream->getFrames(low - padding, windowSize, window, wait)) {
+            const absl::Span<int> chunkIndices = windowIndices->subspan(i, size);
+            absl::c_copy(indices.subspan(i, size), chunkIndices.begin());
+            subtract1(low - padding, chunkIndices);
+            fillInterpolatedWithQuality<Adding>(
+                window, chunkDest, chunkIndices, chunkCoeffs, chunkGains, quality);
+        } else IF_CONSTEXPR (!Adding) {
+            chunkDest.fill(0.0f);
         }
-        break;
-    case 2:
-        {
+
+        i = j;
+    }
+}
+
+bool Voice::Impl::canStreamSample() const noexcept
+{
+    // Repeated samples jump back to their beginning
+    if (region_->sampleCount)
+        return false;
+
+    if (!region_->shouldLoop())
+        return true;
+
+    // The whole loop must stay in the ring
+    const int loopFrames = loop_.end - loop_.xfInStart + 2 * config::excessFileFrames + 1;
+    return static_cast<size_t>(loopFrames) <= resources_.getFilePool().getStreamRingSize();
+}
+
+template <bool Adding>
+void Voice::Impl::fillInterpolatedWithQuality(
+    const AudioSpan<const float>& source, const AudioSpan<float>& dest,
+    absl::Span<const int> indices, absl::Span<const float> coeffs,
+    absl::Span<const float> addingGains, int quality)
+{
+    using FillFunction = void (*)(
+        const AudioSpan<const float>&, const AudioSpan<float>&,
+        absl::Span<const int>, absl::Span<const float>, absl::Span<const float>);
+
+    // Indexed by quality level
+    static const FillFunction fillFunctions[11] = {
+        &fillInterpolated<kInterpolatorNearest, Adding>,
+        &fillInterpolated<kInterpolatorLinear, Adding>,
 #if 0
-            // B-spline response has faster decay of aliasing, but not zero-crossings at integer positions
-            constexpr auto itp = kInterpolatorBspline3;
+        // B-spline response has faster decay of aliasing, but not zero-crossings at integer positions
+        &fillInterpolated<kInterpolatorBspline3, Adding>,
 #else
-            // Hermite polynomial, has less pass-band attenuation
-            constexpr auto itp = kInterpolatorHermite3;
+        // Hermite polynomial, has less pass-band attenuation
+        &fillInterpolated<kInterpolatorHermite3, Adding>,
 #endif
-            fillInterpolated<itp, Adding>(source, dest, indices, coeffs, addingGains);
-        }
-        break;
-    case 3:
-        {
-            constexpr auto itp = kInterpolatorSinc8;
-            fillInterpolated<itp, Adding>(source, dest, indices, coeffs, addingGains);
-        }
-        break;
-    case 4:
-        {
-            constexpr auto itp = kInterpolatorSinc12;
-            fillInterpolated<itp, Adding>(source, dest, indices, coeffs, addingGains);
-        }
-        break;
-    case 5:
-        {
-            constexpr auto itp = kInterpolatorSinc16;
-            fillInterpolated<itp, Adding>(source, dest, indices, coeffs, addingGains);
-        }
-        break;
-    case 6:
-        {
-            constexpr auto itp = kInterpolatorSinc24;
-            fillInterpolated<itp, Adding>(source, dest, indices, coeffs, addingGains);
-        }
-        break;
-    case 7:
-        {
-            constexpr auto itp = kInterpolatorSinc36;
-            fillInterpolated<itp, Adding>(source, dest, indices, coeffs, addingGains);
-        }
-        break;
-    case 8:
-        {
-            constexpr auto itp = kInterpolatorSinc48;
-            fillInterpolated<itp, Adding>(source, dest, indices, coeffs, addingGains);
-        }
-        break;
-    case 9:
-        {
-            constexpr auto itp = kInterpolatorSinc60;
-            fillInterpolated<itp, Adding>(source, dest, indices, coeffs, addingGains);
-        }
-        break;
-    case 10:
-        {
-            constexpr auto itp = kInterpolatorSinc72;
-            fillInterpolated<itp, Adding>(source, dest, indices, coeffs, addingGains);
-        }
-        break;
-    }
+        &fillInterpolated<kInterpolatorSinc8, Adding>,
+        &fillInterpolated<kInterpolatorSinc12, Adding>,
+        &fillInterpolated<kInterpolatorSinc16, Adding>,
+        &fillInterpolated<kInterpolatorSinc24, Adding>,
+        &fillInterpolated<kInterpolatorSinc36, Adding>,
+        &fillInterpolated<kInterpolatorSinc48, Adding>,
+        &fillInterpolated<kInterpolatorSinc60, Adding>,
+        &fillInterpolated<kInterpolatorSinc72, Adding>,
+    };
+
+    fillFunctions[clamp(quality, 0, 10)](source, dest, indices, coeffs, addingGains);
 }
 
 const Curve& Voice::Impl::getSCurve()
@@ -1685,8 +2053,10 @@ void Voice::reset() noexcept
     Impl& impl = *impl_;
     impl.switchState(State::idle);
     impl.region_ = nullptr;
+    impl.currentStream_.reset();
     impl.currentPromise_.reset();
     impl.sourcePosition_ = 0;
+    impl.oversamplingFactor_ = 1;
     impl.age_ = 0;
     impl.count_ = 1;
     impl.floatPositionOffset_ = 0.0f;
@@ -1729,10 +2099,11 @@ void Voice::Impl::updateLoopInformation() noexcept
     const Region& region = *region_;
     MidiState& midiState = resources_.getMidiState();
     const FileInformation& info = currentPromise_->information;
-    const double rate = info.sampleRate;
+    const int factor = info.oversamplingFactor;
+    const double rate = info.sampleRate * factor;
 
-    loop_.start = static_cast<int>(loopStart(region, midiState));
-    loop_.end = max(static_cast<int>(loopEnd(region, midiState)), loop_.start);
+    loop_.start = static_cast<int>(loopStart(region, midiState)) * factor;
+    loop_.end = max((static_cast<int>(loopEnd(region, midiState)) + 1) * factor - 1, loop_.start);
     loop_.size = loop_.end + 1 - loop_.start;
     loop_.xfSize = static_cast<int>(lroundPositive(region.loopCrossfade * rate));
     // Clamp the crossfade to the part available before the loop starts
@@ -2065,7 +2436,7 @@ int Voice::getRemainingDelay() const noexcept
 int Voice::getSourcePosition() const noexcept
 {
     Impl& impl = *impl_;
-    return impl.sourcePosition_;
+    return impl.sourcePosition_ / impl.oversamplingFactor_;
 }
 
 LFO* Voice::getLFO(size_t index)
@@ -19,6 +19,7 @@ namespace sfz {
 enum InterpolatorModel : int;
 class LFO;
 class FlexEnvelope;
+class VoiceBatch;
 struct Layer;
 
 struct ExtendedCCValues {
@@ -198,6 +199,20 @@ public:
      */
     void renderBlock(AudioSpan<float, 2> buffer) noexcept;
 
+    /**
+     * @brief Render a block of data for this voice as part of a batch, if
+     * possible. Only simple sample voices qualify: mono, unlooped, unfiltered,
+     * with a linear interpolation and a constant pitch and panning over the
+     * block. The batch then holds references to the voice data until it is
+     * processed.
+     *
+     * @param batch the batch to add the voice to, which must not be full
+     * @param numFrames the number of frames of the block
+     * @return true if the voice joined the batch, false if it must be
+     *         rendered by renderBlock instead
+     */
+    bool renderBatched(VoiceBatch& batch, size_t numFrames) noexcept;
+
     /**
      * @brief Is the voice free?
      *
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "VoiceBatch.h"
+#include "FilterPool.h"
+#include "Region.h"
+#include "SIMDHelpers.h"
+#include "utility/Debug.h"
+
+namespace sfz {
+
+constexpr unsigned VoiceBatch::capacity;
+
+void VoiceBatch::setSamplesPerBlock(int samplesPerBlock)
+{
+    samplesPerBlock_ = static_cast<size_t>(samplesPerBlock);
+    gainRows_.resize(capacity * samplesPerBlock_);
+    filterRows_.resize(capacity * samplesPerBlock_);
+    cutoffRows_.resize(capacity * samplesPerBlock_);
+    resonanceRows_.resize(capacity * samplesPerBlock_);
+    clear();
+}
+
+void VoiceBatch::setSampleRate(float sampleRate) noexcept
+{
+    filterBank_.setSampleRate(sampleRate);
+}
+
+void VoiceBatch::clear() noexcept
+{
+    numVoices_ = 0;
+    numFiltered_ = 0;
+    filterBank_.clear();
+    reference_ = nullptr;
+}
+
+bool VoiceBatch::acceptsSendsOf(const Region& region) const noexcept
+{
+    return reference_ == nullptr || reference_->effectSendsId == region.effectSendsId;
+}
+
+absl::Span<float> VoiceBatch::addVoice(const Region& region, const float* source, float position,
+    float increment, float panLeft, float panRight, size_t numFrames, FilterHolder* filter) noexcept
+{
+    ASSERT(!full());
+    ASSERT(numFrames <= samplesPerBlock_);
+    ASSERT(filter == nullptr || filter->isBanked());
+
+    float* gains = gainRows_.data() + numVoices_ * samplesPerBlock_;
+    if (reference_ == nullptr)
+        reference_ = &region;
+
+    if (filter) {
+        const size_t index = numFiltered_++;
+        FilteredVoice& voice = filtered_[index];
+        voice.source = source;
+        voice.position = position;
+        voice.increment = increment;
+        voice.gains = gains;
+        voice.panLeft = panLeft;
+        voice.panRight = panRight;
+
+        float* row = filterRows_.data() + index * samplesPerBlock_;
+        float* cutoffs = cutoffRows_.data() + index * samplesPerBlock_;
+        float* resonances = resonanceRows_.data() + index * samplesPerBlock_;
+        filter->computeParameters(absl::MakeSpan(cutoffs, numFrames), absl::MakeSpan(resonances, numFrames), {});
+        filterBank_.add(filter->getBankChannel(), row, row, cutoffs, resonances);
+    } else {
+        const size_t index = numVoices_ - numFiltered_;
+        sources_[index] = source;
+        positions_[index] = position;
+        increments_[index] = increment;
+        gains_[index] = gains;
+        panLeft_[index] = panLeft;
+        panRight_[index] = panRight;
+    }
+
+    ++numVoices_;
+    return absl::MakeSpan(gains, numFrames);
+}
+
+void VoiceBatch::process(AudioSpan<float> output) noexcept
+{
+    ScopedTiming logger { renderDuration_, ScopedTiming::Operation::addToDuration };
+
+    const size_t numFrames = output.getNumFrames();
+    ASSERT(numFrames <= samplesPerBlock_);
+    output.fill(0.0f);
+
+    const size_t numUnfiltered = numVoices_ - numFiltered_;
+    if (numUnfiltered > 0) {
+        linearVoiceBatch<float>(
+            sources_.data(), positions_.data(), increments_.data(), gains_.data(),
+            panLeft_.data(), panRight_.data(), output.getChannel(0), output.getChannel(1),
+            static_cast<unsigned>(numUnfiltered), static_cast<unsigned>(numFrames));
+    }
+
+    if (numFiltered_ == 0)
+        return;
+
+    // Render the filtered voices to their rows, filter them together,
+    // then pan them as the unfiltered ones
+    for (size_t v = 0; v < numFiltered_; ++v) {
+        const FilteredVoice& voice = filtered_[v];
+        float* row = filterRows_.data() + v * samplesPerBlock_;
+        for (size_t t = 0; t < numFrames; ++t) {
+            const float position = voice.position + voice.increment * static_cast<float>(t);
+            const int index = static_cast<int>(position);
+            const float coeff = position - static_cast<float>(index);
+            const float* source = voice.source + index;
+            row[t] = (source[0] * (1.0f - coeff) + source[1] * coeff) * voice.gains[t];
+        }
+    }
+
+    filterBank_.process(static_cast<unsigned>(numFrames));
+
+    for (size_t v = 0; v < numFiltered_; ++v) {
+        const FilteredVoice& voice = filtered_[v];
+        const absl::Span<const float> row { filterRows_.data() + v * samplesPerBlock_, numFrames };
+        multiplyAdd1<float>(voice.panLeft, row, output.getSpan(0));
+        multiplyAdd1<float>(voice.panRight, row, output.getSpan(1));
+    }
+}
+
+Duration VoiceBatch::takeRenderDuration() noexcept
+{
+    const Duration duration = renderDuration_;
+    renderDuration_ = Duration(0);
+    return duration;
+}
+
+} // namespace sfz
@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#pragma once
+#include "AudioSpan.h"
+#include "Buffer.h"
+#include "Config.h"
+#include "FilterBank.h"
+#include "Logger.h"
+#include "utility/LeakDetector.h"
+#include <absl/types/span.h>
+#include <array>
+
+namespace sfz {
+
+struct Region;
+class FilterHolder;
+
+/**
+ * @brief A batch of simple sample voices, rendered together.
+ *
+ * The voices are mono samples read at a constant rate with a linear
+ * interpolation, which only differ by their source, position, rate, gain
+ * envelope and constant panning. The batch stores these as a structure of
+ * arrays, so that several voices advance in one SIMD instruction, and mixes
+ * them down to a stereo span at once.
+ *
+ * A voice may have a filter which runs in a filter bank. These voices are
+ * rendered to mono rows and filtered together before they are mixed.
+ *
+ * All voices of a batch share the effect sends of the first one.
+ */
+class VoiceBatch {
+public:
+    static constexpr unsigned capacity = config::voiceBatchSize;
+
+    /**
+     * @brief Allocate the gain envelopes for a block size.
+     *
+     * @param samplesPerBlock
+     */
+    void setSamplesPerBlock(int samplesPerBlock);
+    /**
+     * @brief Set the sample rate of the filters.
+     *
+     * @param sampleRate
+     */
+    void setSampleRate(float sampleRate) noexcept;
+    /**
+     * @brief Remove all the voices.
+     */
+    void clear() noexcept;
+    size_t size() const noexcept { return numVoices_; }
+    bool empty() const noexcept { return numVoices_ == 0; }
+    bool full() const noexcept { return numVoices_ == capacity; }
+    /**
+     * @brief The region whose effect sends apply to the batch, or null
+     * if the batch is empty.
+     */
+    const Region* getReference() const noexcept { return reference_; }
+    /**
+     * @brief Check whether a voice of a region can join the batch, which
+     * depends on its effect sends.
+     *
+     * @param region
+     */
+    bool acceptsSendsOf(const Region& region) const noexcept;
+    /**
+     * @brief Add a voice to the batch. The batch must not be full.
+     *
+     * @param region the region of the voice
+     * @param source the source of the voice, from its first frame to read
+     * @param position the position of the first frame in the source
+     * @param increment the source frames to advance by for each output frame
+     * @param panLeft the left gain of the voice
+     * @param panRight the right gain of the voice
+     * @param numFrames the number of frames to render
+     * @param filter the filter of the voice, which runs in a bank, or null
+     * @return the gain envelope of the voice, to be filled by the caller
+     */
+    absl::Span<float> addVoice(const Region& region, const float* source, float position,
+        float increment, float panLeft, float panRight, size_t numFrames,
+        FilterHolder* filter = nullptr) noexcept;
+    /**
+     * @brief Render the voices of the batch into a stereo span, overwriting it.
+     *
+     * @param output
+     */
+    void process(AudioSpan<float> output) noexcept;
+    /**
+     * @brief Get the time spent rendering since the last call, and reset it.
+     */
+    Duration takeRenderDuration() noexcept;
+
+private:
+    std::array<const float*, capacity> sources_ {};
+    std::array<float, capacity> positions_ {};
+    std::array<float, capacity> increments_ {};
+    std::array<const float*, capacity> gains_ {};
+    std::array<float, capacity> panLeft_ {};
+    std::array<float, capacity> panRight_ {};
+    Buffer<float> gainRows_;
+    size_t samplesPerBlock_ { 0 };
+    size_t numVoices_ { 0 };
+
+    // The filtered voices, rendered to rows before the filter bank
+    struct FilteredVoice {
+        const float* source { nullptr };
+        float position { 0.0f };
+        float increment { 0.0f };
+        const float* gains { nullptr };
+        float panLeft { 0.0f };
+        float panRight { 0.0f };
+    };
+    std::array<FilteredVoice, capacity> filtered_ {};
+    size_t numFiltered_ { 0 };
+    Buffer<float> filterRows_;
+    Buffer<float> cutoffRows_;
+    Buffer<float> resonanceRows_;
+    FilterBank filterBank_ { capacity };
+
+    const Region* reference_ { nullptr };
+    Duration renderDuration_ { 0 };
+    LEAK_DETECTOR(VoiceBatch);
+};
+
+} // namespace sfz
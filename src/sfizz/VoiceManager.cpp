@@ -21,6 +21,11 @@ void VoiceManager::onVoiceStateChanging(NumericId<Voice> id, Voice::State state)
         swapAndPopFirst(activeVoices_, [voice](const Voice* v) { return v == voice; });
         ASSERT(polyphonyGroups_.contains(group));
         polyphonyGroups_[group].removeVoice(voice);
+        if (region->offBy) {
+            auto offByGroup = polyphonyGroups_.find(static_cast<int>(*region->offBy));
+            if (offByGroup != polyphonyGroups_.end())
+                offByGroup->second.removeOffByVoice(voice);
+        }
     } else if (state == Voice::State::playing) {
         Voice* voice = getVoiceById(id);
         const Region* region = voice->getRegion();
@@ -29,6 +34,12 @@ void VoiceManager::onVoiceStateChanging(NumericId<Voice> id, Voice::State state)
         RegionSet::registerVoiceInHierarchy(region, voice);
         ASSERT(polyphonyGroups_.contains(group));
         polyphonyGroups_[group].registerVoice(voice);
+        // Only the groups of regions can off voices, and these all exist
+        if (region->offBy) {
+            auto offByGroup = polyphonyGroups_.find(static_cast<int>(*region->offBy));
+            if (offByGroup != polyphonyGroups_.end())
+                offByGroup->second.registerOffByVoice(voice);
+        }
     }
 }
 
@@ -104,6 +115,15 @@ const PolyphonyGroup* VoiceManager::getPolyphonyGroupView(int idx) noexcept
     return &polyphonyGroups_[idx];
 }
 
+absl::Span<Voice* const> VoiceManager::getVoicesOffBy(int64_t groupIdx) const noexcept
+{
+    auto group = polyphonyGroups_.find(static_cast<int>(groupIdx));
+    if (group == polyphonyGroups_.end())
+        return {};
+
+    return absl::MakeConstSpan(group->second.getOffByVoices());
+}
+
 void VoiceManager::clear()
 {
     for (auto& pg : polyphonyGroups_)
@@ -178,7 +198,7 @@ void VoiceManager::requireNumVoices(int numVoices, Resources& resources)
 void VoiceManager::checkRegionPolyphony(const Region* region, int delay) noexcept
 {
     Voice* candidate = stealer_->checkRegionPolyphony(region, absl::MakeSpan(activeVoices_));
-    SisterVoiceRing::offAllSisters(candidate, delay);
+    stealVoice(candidate, delay);
 }
 
 void VoiceManager::checkNotePolyphony(const Region* region, int delay, const TriggerEvent& triggerEvent) noexcept
@@ -219,7 +239,7 @@ void VoiceManager::checkNotePolyphony(const Region* region, int delay, const Tri
     while (notePolyphonyCounter > targetPolyphony && it < temp_.end()) {
         Voice* voice = *it;
         if (!voice->offedOrFree())
-            SisterVoiceRing::offAllSisters(voice, delay);
+            stealVoice(voice, delay);
 
         notePolyphonyCounter--;
         it++;
@@ -231,7 +251,7 @@ void VoiceManager::checkGroupPolyphony(const Region* region, int delay) noexcept
     auto& group = polyphonyGroups_[region->group];
     Voice* candidate = stealer_->checkPolyphony(
         absl::MakeSpan(group.getActiveVoices()), group.getPolyphonyLimit());
-    SisterVoiceRing::offAllSisters(candidate, delay);
+    stealVoice(candidate, delay);
 }
 
 void VoiceManager::checkSetPolyphony(const Region* region, int delay) noexcept
@@ -240,7 +260,7 @@ void VoiceManager::checkSetPolyphony(const Region* region, int delay) noexcept
     while (parent != nullptr) {
         Voice* candidate = stealer_->checkPolyphony(
             absl::MakeSpan(parent->getActiveVoices()), parent->getPolyphonyLimit());
-        SisterVoiceRing::offAllSisters(candidate, delay);
+        stealVoice(candidate, delay);
         parent = parent->getParent();
     }
 }
@@ -249,7 +269,23 @@ void VoiceManager::checkEnginePolyphony(int delay) noexcept
 {
     Voice* candidate = stealer_->checkPolyphony(
         absl::MakeSpan(activeVoices_), numRequiredVoices_);
-    SisterVoiceRing::offAllSisters(candidate, delay);
+    stealVoice(candidate, delay);
+}
+
+void VoiceManager::stealVoice(Voice* voice, int delay) noexcept
+{
+    if (voice == nullptr)
+        return;
+
+    numStolenVoices_ += SisterVoiceRing::countSisterVoices(voice);
+    SisterVoiceRing::offAllSisters(voice, delay);
+}
+
+size_t VoiceManager::takeNumStolenVoices() noexcept
+{
+    const size_t number = numStolenVoices_;
+    numStolenVoices_ = 0;
+    return number;
 }
 
 } // namespace sfz
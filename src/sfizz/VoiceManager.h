@@ -7,6 +7,7 @@
 #pragma once
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "Config.h"
 #include "PolyphonyGroup.h"
 #include "Region.h"
@@ -80,6 +81,15 @@ struct VoiceManager final : public Voice::StateListener
      */
     const PolyphonyGroup* getPolyphonyGroupView(int idx) noexcept;
 
+    /**
+     * @brief Get the active voices which can be offed by a group, as their
+     * region has `off_by` set to it. This is empty if there is no such group.
+     *
+     * @param groupIdx
+     * @return absl::Span<Voice* const>
+     */
+    absl::Span<Voice* const> getVoicesOffBy(int64_t groupIdx) const noexcept;
+
     /**
      * @brief Clear all voices and polyphony groups.
      * Also resets the stealing algorithm to default.
@@ -116,6 +126,14 @@ struct VoiceManager final : public Voice::StateListener
      */
     size_t getNumPolyphonyGroups() const noexcept { return polyphonyGroups_.size(); }
 
+    /**
+     * @brief Get the number of voices released by the polyphony checks
+     * since the last call, and reset it.
+     *
+     * @return size_t
+     */
+    size_t takeNumStolenVoices() noexcept;
+
     /**
      * @brief Find a voice that is not currently playing
      *
@@ -141,6 +159,15 @@ private:
     // These are the `group=` groups where you can off voices
     absl::flat_hash_map<int, PolyphonyGroup> polyphonyGroups_;
     std::unique_ptr<VoiceStealer> stealer_ { absl::make_unique<OldestStealer>() };
+    size_t numStolenVoices_ { 0 };
+
+    /**
+     * @brief Release a voice and its sisters because of a polyphony limit
+     *
+     * @param voice
+     * @param delay
+     */
+    void stealVoice(Voice* voice, int delay) noexcept;
 
     /**
      * @brief Check the region polyphony, releasing voices if necessary
@@ -46,6 +46,11 @@ namespace fx {
         _lfoPhase = 0.0;
     }
 
+    double Apan::getTailTime() const
+    {
+        return 0.0;
+    }
+
     void Apan::process(const float* const inputs[], float* const outputs[], unsigned nframes)
     {
         float dry = _dry;
@@ -37,6 +37,7 @@ namespace fx {
         AudioBuffer<float, 2> _gain2x { 2, _oversampling * config::defaultSamplesPerBlock };
         hiir::Downsampler2x<12> _downsampler2x[EffectChannels];
         hiir::Upsampler2x<12> _upsampler2x[EffectChannels];
+        double _sampleRate { config::defaultSampleRate };
     };
 
     Compressor::Compressor()
@@ -54,6 +55,7 @@ namespace fx {
     void Compressor::setSampleRate(double sampleRate)
     {
         Impl& impl = *_impl;
+        impl._sampleRate = sampleRate;
         for (faustCompressor& comp : impl._compressor) {
             comp.classInit(_oversampling * sampleRate);
             comp.instanceConstants(_oversampling * sampleRate);
@@ -81,6 +83,13 @@ namespace fx {
             comp.instanceClear();
     }
 
+    double Compressor::getTailTime() const
+    {
+        const Impl& impl = *_impl;
+        // the signal rings through the upsampler, then the downsampler
+        return 2.0 * oversampler2xRingFrames() / impl._sampleRate;
+    }
+
     void Compressor::process(const float* const inputs[], float* const outputs[], unsigned nframes)
     {
         Impl& impl = *_impl;
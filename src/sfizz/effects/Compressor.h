@@ -40,6 +40,12 @@ namespace fx {
           */
         void process(const float* const inputs[], float* const outputs[], unsigned nframes) override;
 
+        /**
+         * @brief Gets the time for the output to decay to silence after the
+         * input stops, in seconds.
+         */
+        double getTailTime() const override;
+
         /**
           * @brief Instantiates given the contents of the <effect> block.
           */
@@ -110,6 +110,11 @@ void Disto::clear()
     }
 }
 
+double Disto::getTailTime() const
+{
+    return 0.0;
+}
+
 void Disto::process(const float* const inputs[], float* const outputs[], unsigned nframes)
 {
     // Note(jpc): assumes `inputs` and `outputs` to be different buffers
@@ -50,6 +50,13 @@ namespace fx {
         prepareFilter();
     }
 
+    double Eq::getTailTime() const
+    {
+        // the ringing of the filters is short, and caught by the silence
+        // detection of the bus
+        return 0.0;
+    }
+
     void Eq::process(const float* const inputs[], float* const outputs[], unsigned nframes)
     {
         absl::Span<float> cutoff = _tempBuffer.getSpan(0).first(nframes);
@@ -12,6 +12,7 @@
 #include <absl/memory/memory.h>
 #include <absl/strings/ascii.h>
 #include <cmath>
+#include <limits>
 
 /**
    Note(jpc): implementation status
@@ -38,6 +39,7 @@ namespace fx {
 
     struct Fverb::Impl {
         faustFverb dsp;
+        double tailTime { 0.0 };
 
         struct Profile {
             float tailDensity; // %
@@ -159,6 +161,12 @@ namespace fx {
         dsp.instanceClear();
     }
 
+    double Fverb::getTailTime() const
+    {
+        const Impl& impl = *impl_;
+        return impl.tailTime;
+    }
+
     void Fverb::process(const float* const inputs[], float* const outputs[], unsigned nframes)
     {
         Impl& impl = *impl_;
@@ -232,11 +240,13 @@ namespace fx {
         const float decayMax = profile->decayAtMaxSize;
         const float decayMin = decayMax * 0.5f;
 
+        const float decay = decayMax * size * 0.01f + decayMin * (1.0f - size * 0.01f);
+
         Impl& impl = *reverb->impl_;
         faustFverb& dsp = impl.dsp;
         dsp.setPredelay(predelay * 1e3);
         dsp.setTailDensity(profile->tailDensity);
-        dsp.setDecay(decayMax * size * 0.01f + decayMin * (1.0f - size * 0.01f));
+        dsp.setDecay(decay);
         dsp.setModulatorFrequency(profile->modulationFrequency);
         dsp.setModulatorDepth(profile->modulationDepth);
         dsp.setDry(profile->dry * dry * 0.01f);
@@ -246,6 +256,16 @@ namespace fx {
         // NOTE(jpc): damp formula not well calibrated, but sounds ok-ish
         dsp.setDamping(Impl::lpfCutoff(100 - 0.5 * damp));
 
+        // NOTE: rough estimate, the tank attenuates by the decay about every
+        // 0.2 s; count the time to decay by 120 dB after the predelay
+        const double decayGain = clamp(decay * 0.01, 0.0, 1.0);
+        if (decayGain >= 1.0)
+            impl.tailTime = std::numeric_limits<double>::infinity();
+        else if (decayGain > 0.0)
+            impl.tailTime = predelay + 0.2 * std::log(1e-6) / std::log(decayGain);
+        else
+            impl.tailTime = predelay;
+
         return fx;
     }
 
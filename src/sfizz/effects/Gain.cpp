@@ -36,6 +36,11 @@ namespace fx {
     {
     }
 
+    double Gain::getTailTime() const
+    {
+        return 0.0;
+    }
+
     void Gain::process(const float* const inputs[], float* const outputs[], unsigned nframes)
     {
         const float baseGain = _gain;
@@ -40,6 +40,7 @@ namespace fx {
         AudioBuffer<float, 2> _gain2x { 2, _oversampling * config::defaultSamplesPerBlock };
         hiir::Downsampler2x<12> _downsampler2x[EffectChannels];
         hiir::Upsampler2x<12> _upsampler2x[EffectChannels];
+        double _sampleRate { config::defaultSampleRate };
     };
 
     Gate::Gate()
@@ -57,6 +58,7 @@ namespace fx {
     void Gate::setSampleRate(double sampleRate)
     {
         Impl& impl = *_impl;
+        impl._sampleRate = sampleRate;
         for (faustGate& gate : impl._gate) {
             gate.classInit(_oversampling * sampleRate);
             gate.instanceConstants(_oversampling * sampleRate);
@@ -84,6 +86,13 @@ namespace fx {
             gate.instanceClear();
     }
 
+    double Gate::getTailTime() const
+    {
+        const Impl& impl = *_impl;
+        // the signal rings through the upsampler, then the downsampler
+        return 2.0 * oversampler2xRingFrames() / impl._sampleRate;
+    }
+
     void Gate::process(const float* const inputs[], float* const outputs[], unsigned nframes)
     {
         Impl& impl = *_impl;
@@ -33,6 +33,7 @@ namespace fx {
 
     void Limiter::setSampleRate(double sampleRate)
     {
+        _sampleRate = sampleRate;
         _limiter->classInit(_oversampling * sampleRate);
         _limiter->instanceConstants(_oversampling * sampleRate);
 
@@ -54,6 +55,12 @@ namespace fx {
         _limiter->instanceClear();
     }
 
+    double Limiter::getTailTime() const
+    {
+        // the signal rings through the upsampler, then the downsampler
+        return 2.0 * oversampler2xRingFrames() / _sampleRate;
+    }
+
     void Limiter::process(const float* const inputs[], float* const outputs[], unsigned nframes)
     {
         auto inOut2x = AudioSpan<float>( _tempBuffer2x).first(2 * nframes);
@@ -41,6 +41,12 @@ namespace fx {
           */
         void process(const float* const inputs[], float* const outputs[], unsigned nframes) override;
 
+        /**
+         * @brief Gets the time for the output to decay to silence after the
+         * input stops, in seconds.
+         */
+        double getTailTime() const override;
+
         /**
           * @brief Instantiates given the contents of the <effect> block.
           */
@@ -48,6 +54,7 @@ namespace fx {
 
     private:
         std::unique_ptr<faustLimiter> _limiter;
+        double _sampleRate { config::defaultSampleRate };
         AudioBuffer<float, 2> _tempBuffer2x { 2, 2 * config::defaultSamplesPerBlock };
         hiir::Downsampler2x<12> _downsampler2x[EffectChannels];
         hiir::Upsampler2x<12> _upsampler2x[EffectChannels];
@@ -47,6 +47,8 @@ namespace fx {
 
     void Lofi::setSampleRate(double sampleRate)
     {
+        _sampleRate = sampleRate;
+
         for (unsigned c = 0; c < EffectChannels; ++c) {
             _bitred[c].init(sampleRate);
             _decim[c].init(sampleRate);
@@ -66,6 +68,18 @@ namespace fx {
         }
     }
 
+    double Lofi::getTailTime() const
+    {
+        // each active stage rings through its downsampler, and the decimator
+        // holds its last sample for up to a period
+        double tailFrames = 0.0;
+        if (_bitred_depth > 0)
+            tailFrames += oversampler2xRingFrames();
+        if (_decim_depth > 0)
+            tailFrames += oversampler2xRingFrames() + std::ceil(Decim::holdTime(_decim_depth) * _sampleRate);
+        return tailFrames / _sampleRate;
+    }
+
     void Lofi::process(const float* const inputs[2], float* const outputs[2], unsigned nframes)
     {
         for (unsigned c = 0; c < EffectChannels; ++c) {
@@ -167,6 +181,13 @@ namespace fx {
         fDepth = clamp(depth, 0.0f, 100.0f);
     }
 
+    float Lofi::Decim::holdTime(float depth)
+    {
+        // exponential curve fit
+        const float a = 1.289079e+00, b = 1.384141e-01, c = 1.313298e-04;
+        return std::pow(a, b * clamp(depth, 0.0f, 100.0f)) * c - c;
+    }
+
     void Lofi::Decim::process(const float* in, float* out, uint32_t nframes)
     {
         if (fDepth == 0) {
@@ -176,12 +197,7 @@ namespace fx {
             return;
         }
 
-        const float dt = [this]() {
-            // exponential curve fit
-            const float a = 1.289079e+00, b = 1.384141e-01, c = 1.313298e-04;
-            const float denom = std::pow(a, b * fDepth) * c - c;
-            return fSampleTime / denom;
-        }();
+        const float dt = fSampleTime / holdTime(fDepth);
 
         float phase = fPhase;
         float lastValue = fLastValue;
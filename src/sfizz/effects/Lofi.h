@@ -37,12 +37,19 @@ namespace fx {
           */
         void process(const float* const inputs[], float* const outputs[], unsigned nframes) override;
 
+        /**
+         * @brief Gets the time for the output to decay to silence after the
+         * input stops, in seconds.
+         */
+        double getTailTime() const override;
+
         /**
           * @brief Instantiates given the contents of the <effect> block.
           */
         static std::unique_ptr<Effect> makeInstance(absl::Span<const Opcode> members);
 
     private:
+        double _sampleRate = config::defaultSampleRate;
         float _bitred_depth = 0;
         float _decim_depth = 0;
 
@@ -67,6 +74,7 @@ namespace fx {
             void clear();
             void setDepth(float depth);
             void process(const float* in, float* out, uint32_t nframes);
+            static float holdTime(float depth);
 
         private:
             float fSampleTime = 0.0;
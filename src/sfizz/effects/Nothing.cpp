@@ -24,6 +24,11 @@ namespace fx {
     {
     }
 
+    double Nothing::getTailTime() const
+    {
+        return 0.0;
+    }
+
     void Nothing::process(const float* const inputs[], float* const outputs[], unsigned nframes)
     {
         for (unsigned c = 0; c < EffectChannels; ++c) {
@@ -35,6 +35,12 @@ namespace fx {
          * @brief Copy the input signal to the output
          */
         void process(const float* const inputs[], float* const outputs[], unsigned nframes) override;
+
+        /**
+         * @brief Gets the time for the output to decay to silence after the
+         * input stops, in seconds.
+         */
+        double getTailTime() const override;
     };
 
 } // namespace fx
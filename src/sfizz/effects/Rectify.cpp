@@ -47,6 +47,11 @@ namespace fx {
         }
     }
 
+    double Rectify::getTailTime() const
+    {
+        return 0.0;
+    }
+
     void Rectify::process(const float* const inputs[], float* const outputs[], unsigned nframes)
     {
         // Note(jpc) I define opcode `rectify` to be a mix amount.
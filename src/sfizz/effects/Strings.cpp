@@ -29,6 +29,9 @@ Extensions
 namespace sfz {
 namespace fx {
 
+    // Time for the strings to decay by 60 dB
+    static constexpr double releaseTime = 50e-3;
+
     Strings::Strings()
     {
         ResonantArray* array = nullptr;
@@ -71,7 +74,6 @@ namespace fx {
 
         // TODO(jpc) find how to adjust the string feedbacks
         //     for now set a fixed release time for all strings
-        const double releaseTime = 50e-3;
         const double releaseFeedback = std::exp(-6.91 / (releaseTime * sampleRate));
         sfz::fill<float>(feedbacks, releaseFeedback);
 
@@ -96,6 +98,12 @@ namespace fx {
         _stringsArray->clear();
     }
 
+    double Strings::getTailTime() const
+    {
+        // 120 dB of decay reaches the silence
+        return 2 * releaseTime;
+    }
+
     void Strings::process(const float* const inputs[], float* const outputs[], unsigned nframes)
     {
         auto inputL = absl::MakeConstSpan(inputs[0], nframes);
@@ -36,6 +36,11 @@ namespace fx {
     {
     }
 
+    double Width::getTailTime() const
+    {
+        return 0.0;
+    }
+
     void Width::process(const float* const inputs[], float* const outputs[], unsigned nframes)
     {
         const float baseWidth = _width;
@@ -30,3 +30,51 @@ bool sfizz_load_or_import_file(sfizz_synth_t* synth, const char* path, const cha
 
     return true;
 }
+
+bool sfizz_reload_or_import_file(sfizz_synth_t* synth, const char* path, const char** format)
+{
+    const sfz::InstrumentFormatRegistry& ireg = sfz::InstrumentFormatRegistry::getInstance();
+    const sfz::InstrumentFormat* ifmt = ireg.getMatchingFormat(path);
+
+    if (!ifmt) {
+        if (!sfizz_reload_file(synth, path))
+            return false;
+        if (format)
+            *format = nullptr;
+    }
+    else {
+        auto importer = ifmt->createImporter();
+        std::string virtualPath = std::string(path) + ".sfz";
+        std::string sfzText = importer->convertToSfz(path);
+        if (!sfizz_reload_string(synth, virtualPath.c_str(), sfzText.c_str()))
+            return false;
+        if (format)
+            *format = ifmt->name();
+    }
+
+    return true;
+}
+
+bool sfizz_load_or_import_file_in_background(sfizz_synth_t* synth, const char* path, const char** format)
+{
+    const sfz::InstrumentFormatRegistry& ireg = sfz::InstrumentFormatRegistry::getInstance();
+    const sfz::InstrumentFormat* ifmt = ireg.getMatchingFormat(path);
+
+    if (!ifmt) {
+        if (!sfizz_load_file_in_background(synth, path))
+            return false;
+        if (format)
+            *format = nullptr;
+    }
+    else {
+        auto importer = ifmt->createImporter();
+        std::string virtualPath = std::string(path) + ".sfz";
+        std::string sfzText = importer->convertToSfz(path);
+        if (!sfizz_load_string_in_background(synth, virtualPath.c_str(), sfzText.c_str()))
+            return false;
+        if (format)
+            *format = ifmt->name();
+    }
+
+    return true;
+}
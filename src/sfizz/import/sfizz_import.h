@@ -33,6 +33,54 @@ extern "C" {
  */
 bool sfizz_load_or_import_file(sfizz_synth_t* synth, const char* path, const char** format);
 
+/**
+ * @brief Reloads or imports again an instrument file, keeping the preloaded
+ * samples which are still in use and unchanged on disk.
+ *
+ * This is similar to sfizz_load_or_import_file() in functionality, and
+ * reloads like sfizz_reload_file().
+ * @since 1.1.0
+ *
+ * @param synth   The synth.
+ * @param path    A null-terminated string representing a path to an instrument
+ *                in SFZ format, or another format which can be imported.
+ * @param format  An optional pointer to a string pointer, which receives the
+ *                null-terminated name of the format if the file was imported,
+ *                or null if the file was loaded directly as SFZ.
+ *
+ * @return @true when file loading went OK,
+ *         @false if some error occured while loading.
+ *
+ * @par Thread-safety constraints
+ * - @b CT: the function must be invoked from the Control thread
+ * - @b OFF: the function cannot be invoked while a thread is calling @b RT functions
+ */
+bool sfizz_reload_or_import_file(sfizz_synth_t* synth, const char* path, const char** format);
+
+/**
+ * @brief Loads or imports an instrument file in the background, while the
+ * current instrument keeps playing.
+ *
+ * This is similar to sfizz_load_or_import_file() in functionality, and
+ * replaces the instrument like sfizz_load_file_in_background().
+ * @since 1.1.0
+ *
+ * @param synth   The synth.
+ * @param path    A null-terminated string representing a path to an instrument
+ *                in SFZ format, or another format which can be imported.
+ * @param format  An optional pointer to a string pointer, which receives the
+ *                null-terminated name of the format if the file was imported,
+ *                or null if the file was loaded directly as SFZ.
+ *
+ * @return @true when file loading went OK,
+ *         @false if some error occured while loading, in which case the
+ *         current instrument is kept.
+ *
+ * @par Thread-safety constraints
+ * - @b CT: the function must be invoked from the Control thread
+ */
+bool sfizz_load_or_import_file_in_background(sfizz_synth_t* synth, const char* path, const char** format);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -11,6 +11,7 @@
 #include "Buffer.h"
 #include "Config.h"
 #include "SIMDHelpers.h"
+#include "RenderWorkers.h"
 #include "utility/Debug.h"
 #include <absl/container/flat_hash_map.h>
 #include <absl/strings/string_view.h>
@@ -24,10 +25,22 @@ struct ModMatrix::Impl {
     uint32_t samplesPerBlock_ {};
 
     uint32_t numFrames_ {};
-    NumericId<Voice> currentVoiceId_ {};
-    NumericId<Region> currentRegionId_ {};
 
-    float currentVoiceTriggerValue_ {};
+    struct VoiceState {
+        NumericId<Voice> voiceId {};
+        NumericId<Region> regionId {};
+        float triggerValue {};
+    };
+
+    // one current voice for each render thread
+    std::vector<VoiceState> voiceStates_ { 1 };
+
+    VoiceState& currentVoice() noexcept
+    {
+        const unsigned lane = RenderWorkers::currentLane();
+        ASSERT(lane < voiceStates_.size());
+        return voiceStates_[lane];
+    }
 
     struct Source {
         ModKey key;
@@ -49,8 +62,41 @@ struct ModMatrix::Impl {
         absl::flat_hash_map<uint32_t, ConnectionData> connectedSources;
         bool bufferReady {};
         Buffer<float> buffer;
+        // compiled by `init`: ranges in `connections_` and `evaluationOrder_`
+        bool multiplicative {};
+        uint32_t connectionsBegin {};
+        uint32_t connectionsEnd {};
+        uint32_t evaluationBegin {};
+        uint32_t evaluationEnd {};
     };
 
+    static constexpr uint32_t noTarget = ~uint32_t(0);
+
+    /**
+     * @brief A connection compiled for the audio thread. The region numbers
+     * are negative when the source or the depth modulation is not per-voice.
+     */
+    struct Connection {
+        uint32_t source {};
+        float sourceDepth {};
+        float velToDepth {};
+        int sourceRegion { -1 };
+        uint32_t depthModTarget { noTarget };
+        int depthModRegion { -1 };
+    };
+
+    // connections of all targets, grouped by target
+    std::vector<Connection> connections_;
+    // for each target, the targets it depends on in topological order,
+    // followed by the target itself
+    std::vector<uint32_t> evaluationOrder_;
+    // one scratch buffer for the modulated depths, for each render thread
+    std::vector<Buffer<float>> depthBuffers_ { 1 };
+
+    void compileConnections();
+    void appendEvaluationOrder(uint32_t targetIndex, std::vector<uint8_t>& visitState);
+    void runConnections(Target& target, const VoiceState& voice, absl::Span<float> depthBuffer);
+
     absl::flat_hash_map<ModKey, uint32_t> sourceIndex_;
     absl::flat_hash_map<ModKey, uint32_t> targetIndex_;
 
@@ -89,6 +135,8 @@ void ModMatrix::clear()
     impl.sourceIndicesForRegion_.clear();
     impl.targetIndicesForRegion_.clear();
     impl.maxRegionIdx_ = -1;
+    impl.connections_.clear();
+    impl.evaluationOrder_.clear();
 }
 
 void ModMatrix::setSampleRate(double sampleRate)
@@ -119,6 +167,17 @@ void ModMatrix::setSamplesPerBlock(unsigned samplesPerBlock)
     }
     for (Impl::Target &target : impl.targets_)
         target.buffer.resize(samplesPerBlock);
+    for (Buffer<float>& depthBuffer : impl.depthBuffers_)
+        depthBuffer.resize(samplesPerBlock);
+}
+
+void ModMatrix::setNumRenderThreads(unsigned numThreads)
+{
+    Impl& impl = *impl_;
+    impl.voiceStates_.resize(std::max(1u, numThreads));
+    impl.depthBuffers_.resize(std::max(1u, numThreads));
+    for (Buffer<float>& depthBuffer : impl.depthBuffers_)
+        depthBuffer.resize(impl.samplesPerBlock_);
 }
 
 ModMatrix::SourceId ModMatrix::registerSource(const ModKey& key, ModGenerator& gen)
@@ -253,6 +312,75 @@ void ModMatrix::init()
             impl.targetIndicesForRegion_[target.key.region().number()].push_back(i);
         }
     }
+
+    impl.compileConnections();
+}
+
+void ModMatrix::Impl::compileConnections()
+{
+    connections_.clear();
+    evaluationOrder_.clear();
+
+    std::vector<uint32_t> sourceIndices;
+    for (Target& target : targets_) {
+        target.multiplicative = (target.key.flags() & kModIsMultiplicative) != 0;
+        ASSERT(target.multiplicative || (target.key.flags() & kModIsAdditive));
+
+        // sort the sources, so that the evaluation order is reproducible
+        sourceIndices.clear();
+        for (const auto& cs : target.connectedSources)
+            sourceIndices.push_back(cs.first);
+        std::sort(sourceIndices.begin(), sourceIndices.end());
+
+        target.connectionsBegin = static_cast<uint32_t>(connections_.size());
+        for (uint32_t sourceIndex : sourceIndices) {
+            const ConnectionData& data = target.connectedSources.find(sourceIndex)->second;
+            const Source& source = sources_[sourceIndex];
+
+            Connection conn;
+            conn.source = sourceIndex;
+            conn.sourceDepth = data.sourceDepth_;
+            conn.velToDepth = data.velToDepth_;
+            if (source.key.flags() & kModIsPerVoice)
+                conn.sourceRegion = source.key.region().number();
+            if (static_cast<size_t>(data.sourceDepthModId_.number()) < targets_.size()) {
+                const Target& depthModTarget = targets_[data.sourceDepthModId_.number()];
+                conn.depthModTarget = static_cast<uint32_t>(data.sourceDepthModId_.number());
+                if (depthModTarget.key.flags() & kModIsPerVoice)
+                    conn.depthModRegion = depthModTarget.key.region().number();
+            }
+            connections_.push_back(conn);
+        }
+        target.connectionsEnd = static_cast<uint32_t>(connections_.size());
+    }
+
+    // 0: not visited, 1: being visited, 2: visited
+    std::vector<uint8_t> visitState;
+    for (uint32_t i = 0; i < targets_.size(); ++i) {
+        Target& target = targets_[i];
+        visitState.assign(targets_.size(), 0);
+        target.evaluationBegin = static_cast<uint32_t>(evaluationOrder_.size());
+        appendEvaluationOrder(i, visitState);
+        target.evaluationEnd = static_cast<uint32_t>(evaluationOrder_.size());
+    }
+}
+
+void ModMatrix::Impl::appendEvaluationOrder(uint32_t targetIndex, std::vector<uint8_t>& visitState)
+{
+    // a target in a cycle of depth modulations sees no depth modulation
+    // from the target which closes the cycle
+    if (visitState[targetIndex] != 0)
+        return;
+
+    visitState[targetIndex] = 1;
+    const Target& target = targets_[targetIndex];
+    for (uint32_t c = target.connectionsBegin; c < target.connectionsEnd; ++c) {
+        const uint32_t depthModTarget = connections_[c].depthModTarget;
+        if (depthModTarget != noTarget)
+            appendEvaluationOrder(depthModTarget, visitState);
+    }
+    visitState[targetIndex] = 2;
+    evaluationOrder_.push_back(targetIndex);
 }
 
 void ModMatrix::initVoice(NumericId<Voice> voiceId, NumericId<Region> regionId, unsigned delay)
@@ -326,14 +454,32 @@ void ModMatrix::endCycle()
     impl.numFrames_ = 0;
 }
 
-void ModMatrix::beginVoice(NumericId<Voice> voiceId, NumericId<Region> regionId, float triggerValue)
+void ModMatrix::generatePerCycleModulations()
 {
     Impl& impl = *impl_;
+    const uint32_t numFrames = impl.numFrames_;
 
-    impl.currentVoiceId_ = voiceId;
-    impl.currentRegionId_ = regionId;
+    for (auto idx: impl.sourceIndicesForGlobal_) {
+        Impl::Source& source = impl.sources_[idx];
+        if (!source.bufferReady) {
+            absl::Span<float> buffer(source.buffer.data(), numFrames);
+            source.gen->generate(source.key, {}, buffer);
+            source.bufferReady = true;
+        }
+    }
 
-    impl.currentVoiceTriggerValue_ = triggerValue;
+    for (auto idx: impl.targetIndicesForGlobal_)
+        getModulation(TargetId(static_cast<int>(idx)));
+}
+
+void ModMatrix::beginVoice(NumericId<Voice> voiceId, NumericId<Region> regionId, float triggerValue)
+{
+    Impl& impl = *impl_;
+    Impl::VoiceState& voice = impl.currentVoice();
+
+    voice.voiceId = voiceId;
+    voice.regionId = regionId;
+    voice.triggerValue = triggerValue;
 
     ASSERT(regionId);
 
@@ -352,9 +498,10 @@ void ModMatrix::beginVoice(NumericId<Voice> voiceId, NumericId<Region> regionId,
 void ModMatrix::endVoice()
 {
     Impl& impl = *impl_;
+    Impl::VoiceState& voice = impl.currentVoice();
     const uint32_t numFrames = impl.numFrames_;
-    const NumericId<Voice> voiceId = impl.currentVoiceId_;
-    const NumericId<Region> regionId = impl.currentRegionId_;
+    const NumericId<Voice> voiceId = voice.voiceId;
+    const NumericId<Region> regionId = voice.regionId;
 
     ASSERT(regionId);
     ASSERT(static_cast<size_t>(regionId.number()) < impl.sourceIndicesForRegion_.size());
@@ -369,10 +516,7 @@ void ModMatrix::endVoice()
         }
     }
 
-    impl.currentVoiceId_ = {};
-    impl.currentRegionId_ = {};
-
-    impl.currentVoiceTriggerValue_ = 0.0f;
+    voice = Impl::VoiceState();
 }
 
 float* ModMatrix::getModulation(TargetId targetId)
@@ -381,112 +525,108 @@ float* ModMatrix::getModulation(TargetId targetId)
         return nullptr;
 
     Impl& impl = *impl_;
-    const NumericId<Region> regionId = impl.currentRegionId_;
-    const float triggerValue = impl.currentVoiceTriggerValue_;
-    const uint32_t targetIndex = targetId.number();
-    Impl::Target &target = impl.targets_[targetIndex];
-    const int targetFlags = target.key.flags();
-
-    const uint32_t numFrames = impl.numFrames_;
-    absl::Span<float> buffer(target.buffer.data(), numFrames);
+    const Impl::VoiceState& voice = impl.currentVoice();
+    const int regionNumber = voice.regionId.number();
+    Impl::Target &target = impl.targets_[targetId.number()];
 
     // only accept per-voice targets of the same region
-    if ((targetFlags & kModIsPerVoice) && regionId != target.key.region())
+    if ((target.key.flags() & kModIsPerVoice) && voice.regionId != target.key.region())
         return nullptr;
 
     // check if already processed
-    if (target.bufferReady)
-        return buffer.data();
+    if (!target.bufferReady) {
+        const unsigned lane = RenderWorkers::currentLane();
+        ASSERT(lane < impl.depthBuffers_.size());
+        absl::Span<float> depthBuffer(impl.depthBuffers_[lane].data(), impl.numFrames_);
+
+        // process the depth modulations first, then the target itself
+        for (uint32_t e = target.evaluationBegin; e < target.evaluationEnd; ++e) {
+            Impl::Target& current = impl.targets_[impl.evaluationOrder_[e]];
+            if (current.bufferReady)
+                continue;
+            if ((current.key.flags() & kModIsPerVoice) && current.key.region().number() != regionNumber)
+                continue;
+            impl.runConnections(current, voice, depthBuffer);
+            current.bufferReady = true;
+        }
+    }
 
-    // set the ready flag to prevent a cycle
-    // in case there is, be sure to initialize the buffer
-    target.bufferReady = true;
+    return target.buffer.data();
+}
 
-    auto sourcesPos = target.connectedSources.begin();
-    auto sourcesEnd = target.connectedSources.end();
+void ModMatrix::Impl::runConnections(Target& target, const VoiceState& voice, absl::Span<float> depthBuffer)
+{
+    const int regionNumber = voice.regionId.number();
+    const bool multiplicative = target.multiplicative;
+    absl::Span<float> buffer(target.buffer.data(), numFrames_);
     bool isFirstSource = true;
 
     // generate sources in their dedicated buffers
     // then add or multiply, depending on target flags
-    while (sourcesPos != sourcesEnd) {
-        Impl::Source &source = impl.sources_[sourcesPos->first];
-        const int sourceFlags = source.key.flags();
+    for (uint32_t c = target.connectionsBegin; c < target.connectionsEnd; ++c) {
+        const Connection& conn = connections_[c];
 
         // only accept per-voice sources of the same region
-        bool useThisSource = true;
-        if (sourceFlags & kModIsPerVoice)
-            useThisSource = (regionId == source.key.region());
+        if (conn.sourceRegion >= 0 && conn.sourceRegion != regionNumber)
+            continue;
 
-        if (useThisSource) {
-            absl::Span<float> sourceBuffer(source.buffer.data(), numFrames);
-
-            // unless source is already done, process it
-            if (!source.bufferReady) {
-                source.gen->generate(source.key, impl.currentVoiceId_, sourceBuffer);
-                source.bufferReady = true;
-            }
+        Source& source = sources_[conn.source];
+        absl::Span<float> sourceBuffer(source.buffer.data(), numFrames_);
 
-            float sourceDepth = sourcesPos->second.sourceDepth_;
-            if (sourceFlags & kModIsPerVoice) {
-                const float velToDepth = sourcesPos->second.velToDepth_;
-                sourceDepth += triggerValue * velToDepth;
-            }
+        // unless source is already done, process it
+        if (!source.bufferReady) {
+            source.gen->generate(source.key, voice.voiceId, sourceBuffer);
+            source.bufferReady = true;
+        }
 
-            const float* sourceDepthMod = getModulation(sourcesPos->second.sourceDepthModId_);
+        float sourceDepth = conn.sourceDepth;
+        if (conn.sourceRegion >= 0)
+            sourceDepth += voice.triggerValue * conn.velToDepth;
+
+        // the depth modulation was evaluated before, unless it is
+        // unreachable from this voice or in a cycle
+        const float* sourceDepthMod = nullptr;
+        if (conn.depthModTarget != noTarget) {
+            const Target& depthModTarget = targets_[conn.depthModTarget];
+            if ((conn.depthModRegion < 0 || conn.depthModRegion == regionNumber) && depthModTarget.bufferReady)
+                sourceDepthMod = depthModTarget.buffer.data();
+        }
 
+        if (!sourceDepthMod) {
             if (isFirstSource) {
-                if (sourceDepth == 1 && !sourceDepthMod)
-                    copy(absl::Span<const float>(sourceBuffer), buffer);
-                else if (!sourceDepthMod) {
-                    for (uint32_t i = 0; i < numFrames; ++i)
-                        buffer[i] = sourceDepth * sourceBuffer[i];
-                }
-                else if (targetFlags & kModIsMultiplicative) {
-                    for (uint32_t i = 0; i < numFrames; ++i)
-                        buffer[i] = (sourceDepth * sourceDepthMod[i]) * sourceBuffer[i];
-                }
-                else {
-                    ASSERT(targetFlags & kModIsAdditive);
-                    for (uint32_t i = 0; i < numFrames; ++i)
-                        buffer[i] = (sourceDepth + sourceDepthMod[i]) * sourceBuffer[i];
-                }
-                isFirstSource = false;
+                if (sourceDepth == 1)
+                    copy<float>(sourceBuffer, buffer);
+                else
+                    applyGain1<float>(sourceDepth, sourceBuffer, buffer);
             }
+            else if (multiplicative)
+                multiplyMul1<float>(sourceDepth, sourceBuffer, buffer);
+            else
+                multiplyAdd1<float>(sourceDepth, sourceBuffer, buffer);
+        }
+        else {
+            absl::Span<const float> depthMod(sourceDepthMod, numFrames_);
+            if (multiplicative)
+                applyGain1<float>(sourceDepth, depthMod, depthBuffer);
             else {
-                if (targetFlags & kModIsMultiplicative) {
-                    if (!sourceDepthMod)
-                        multiplyMul1<float>(sourceDepth, sourceBuffer, buffer);
-                    else {
-                        for (uint32_t i = 0; i < numFrames; ++i)
-                            buffer[i] *= (sourceDepth * sourceDepthMod[i]) * sourceBuffer[i];
-                    }
-                }
-                else {
-                    ASSERT(targetFlags & kModIsAdditive);
-                    if (!sourceDepthMod)
-                        multiplyAdd1<float>(sourceDepth, sourceBuffer, buffer);
-                    else {
-                        for (uint32_t i = 0; i < numFrames; ++i)
-                            buffer[i] += (sourceDepth + sourceDepthMod[i]) * sourceBuffer[i];
-                    }
-                }
+                copy<float>(depthMod, depthBuffer);
+                add1<float>(sourceDepth, depthBuffer);
             }
+
+            if (isFirstSource)
+                applyGain<float>(depthBuffer, sourceBuffer, buffer);
+            else if (multiplicative)
+                multiplyMul<float>(depthBuffer, sourceBuffer, buffer);
+            else
+                multiplyAdd<float>(depthBuffer, sourceBuffer, buffer);
         }
 
-        ++sourcesPos;
+        isFirstSource = false;
     }
 
     // if there were no source, fill output with the neutral element
-    if (isFirstSource) {
-        if (targetFlags & kModIsMultiplicative)
-            fill(buffer, 1.0f);
-        else {
-            ASSERT(targetFlags & kModIsAdditive);
-            fill(buffer, 0.0f);
-        }
-    }
-
-    return buffer.data();
+    if (isFirstSource)
+        fill(buffer, multiplicative ? 1.0f : 0.0f);
 }
 
 bool ModMatrix::validTarget(TargetId id) const
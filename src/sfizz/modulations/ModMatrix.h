@@ -53,6 +53,15 @@ public:
      */
     void setSamplesPerBlock(unsigned samplesPerBlock);
 
+    /**
+     * @brief Set the number of threads which process voices concurrently.
+     * Every render thread gets its own current voice state, which is
+     * selected according to `RenderWorkers::currentLane()`.
+     *
+     * @param numThreads
+     */
+    void setNumRenderThreads(unsigned numThreads);
+
     /**
      * @brief Register a modulation source inside the matrix.
      * If it is already present, it just returns the existing id.
@@ -135,6 +144,15 @@ public:
      */
     void endCycle();
 
+    /**
+     * @brief Generate all the per-cycle modulations in advance.
+     * This must be called after `beginCycle` when voices are processed
+     * concurrently, so the render threads only read the shared buffers.
+     * Per-voice modulations remain shared between the voices of a region,
+     * which must therefore be processed on the same thread.
+     */
+    void generatePerCycleModulations();
+
     /**
      * @brief Start modulation processing for a given voice.
      * This clears all the buffers which are per-voice.
@@ -6,6 +6,7 @@
 
 #include "Synth.h"
 #include "Messaging.h"
+#include "Telemetry.h"
 #include "sfizz.hpp"
 #include "sfizz_private.hpp"
 #include "absl/memory/memory.h"
@@ -55,6 +56,36 @@ bool sfz::Sfizz::loadSfzString(const std::string& path, const std::string& text)
     return synth->synth.loadSfzString(path, text);
 }
 
+bool sfz::Sfizz::reloadSfzFile(const std::string& path)
+{
+    return synth->synth.reloadSfzFile(path);
+}
+
+bool sfz::Sfizz::reloadSfzString(const std::string& path, const std::string& text)
+{
+    return synth->synth.reloadSfzString(path, text);
+}
+
+void sfz::Sfizz::setLoadProgressCallback(LoadProgressCallback callback)
+{
+    synth->synth.setLoadProgressCallback(std::move(callback));
+}
+
+bool sfz::Sfizz::loadSfzFileInBackground(const std::string& path)
+{
+    return synth->synth.loadSfzFileInBackground(path);
+}
+
+bool sfz::Sfizz::loadSfzStringInBackground(const std::string& path, const std::string& text)
+{
+    return synth->synth.loadSfzStringInBackground(path, text);
+}
+
+bool sfz::Sfizz::isInstrumentSwapPending() const noexcept
+{
+    return synth->synth.isInstrumentSwapPending();
+}
+
 bool sfz::Sfizz::loadScalaFile(const std::string& path)
 {
     return synth->synth.loadScalaFile(path);
@@ -120,6 +151,16 @@ size_t sfz::Sfizz::getNumPreloadedSamples() const noexcept
     return synth->synth.getNumPreloadedSamples();
 }
 
+size_t sfz::Sfizz::getNumReusedPreloadedSamples() const noexcept
+{
+    return synth->synth.getNumReusedPreloadedSamples();
+}
+
+size_t sfz::Sfizz::getNumReadPreloadedSamples() const noexcept
+{
+    return synth->synth.getNumReadPreloadedSamples();
+}
+
 void sfz::Sfizz::setSamplesPerBlock(int samplesPerBlock) noexcept
 {
     synth->synth.setSamplesPerBlock(samplesPerBlock);
@@ -275,15 +316,75 @@ void sfz::Sfizz::setNumVoices(int numVoices) noexcept
     synth->synth.setNumVoices(numVoices);
 }
 
-bool sfz::Sfizz::setOversamplingFactor(int) noexcept
+int sfz::Sfizz::getNumRenderThreads() const noexcept
 {
-    return true;
+    return synth->synth.getNumRenderThreads();
+}
+
+void sfz::Sfizz::setNumRenderThreads(int numThreads) noexcept
+{
+    synth->synth.setNumRenderThreads(numThreads);
 }
 
+bool sfz::Sfizz::hasRealtimeRenderThreads() const noexcept
+{
+    return synth->synth.hasRealtimeRenderThreads();
+}
+
+bool sfz::Sfizz::setOversamplingFactor(int factor) noexcept
+{
+    switch (factor) {
+    case 1:
+    case 2:
+    case 4:
+    case 8:
+        break;
+    default:
+        return false;
+    }
+
+    synth->synth.setOversamplingFactor(static_cast<sfz::Oversampling>(factor));
+    return true;
+}
 
 int sfz::Sfizz::getOversamplingFactor() const noexcept
 {
-    return 1;
+    return static_cast<int>(synth->synth.getOversamplingFactor());
+}
+
+size_t sfz::Sfizz::getPreloadedMemory() const noexcept
+{
+    return synth->synth.getPreloadedMemory();
+}
+
+void sfz::Sfizz::setStreamRingSize(uint32_t numFrames) noexcept
+{
+    synth->synth.setStreamRingSize(numFrames);
+}
+
+uint32_t sfz::Sfizz::getStreamRingSize() const noexcept
+{
+    return synth->synth.getStreamRingSize();
+}
+
+size_t sfz::Sfizz::getNumStreamUnderruns() const noexcept
+{
+    return synth->synth.getNumStreamUnderruns();
+}
+
+bool sfz::Sfizz::setPreloadCacheDirectory(const std::string& directory) noexcept
+{
+    return synth->synth.setPreloadCacheDirectory(directory);
+}
+
+size_t sfz::Sfizz::getNumPreloadCacheHits() const noexcept
+{
+    return synth->synth.getNumPreloadCacheHits();
+}
+
+size_t sfz::Sfizz::getNumPreloadCacheMisses() const noexcept
+{
+    return synth->synth.getNumPreloadCacheMisses();
 }
 
 void sfz::Sfizz::setPreloadSize(uint32_t preloadSize) noexcept
@@ -306,6 +407,16 @@ int sfz::Sfizz::getAllocatedBytes() const noexcept
     return synth->synth.getAllocatedBytes();
 }
 
+size_t sfz::Sfizz::getMappedBytes() const noexcept
+{
+    return synth->synth.getMappedBytes();
+}
+
+size_t sfz::Sfizz::getResidentMappedBytes() const noexcept
+{
+    return synth->synth.getResidentMappedBytes();
+}
+
 void sfz::Sfizz::enableFreeWheeling() noexcept
 {
     synth->synth.enableFreeWheeling();
@@ -316,6 +427,16 @@ void sfz::Sfizz::disableFreeWheeling() noexcept
     synth->synth.disableFreeWheeling();
 }
 
+void sfz::Sfizz::enableMappedStreaming() noexcept
+{
+    synth->synth.enableMappedStreaming();
+}
+
+void sfz::Sfizz::disableMappedStreaming() noexcept
+{
+    synth->synth.disableMappedStreaming();
+}
+
 bool sfz::Sfizz::shouldReloadFile()
 {
     return synth->synth.shouldReloadFile();
@@ -346,6 +467,53 @@ void sfz::Sfizz::disableLogging() noexcept
     synth->synth.disableLogging();
 }
 
+sfz::Sfizz::Telemetry sfz::Sfizz::getTelemetry() const noexcept
+{
+    using Stage = sfz::Telemetry::Stage;
+    const sfz::Telemetry& source = synth->synth.getTelemetry();
+    const sfz::LatencyHistogram& callbackTimes = source.getCallbackTimes();
+    const sfz::LatencyHistogram& fileWaitTimes = source.getFileWaitTimes();
+    const sfz::LatencyHistogram& fileLoadTimes = source.getFileLoadTimes();
+    constexpr double nsToSeconds = 1e-9;
+
+    Telemetry telemetry;
+    telemetry.numBlocks = source.getNumBlocks();
+    telemetry.numFrames = source.getNumFrames();
+    telemetry.dispatchTime = source.getStageTime(Stage::Dispatch).count();
+    telemetry.renderTime = source.getStageTime(Stage::RenderMethod).count();
+    telemetry.dataTime = source.getStageTime(Stage::Data).count();
+    telemetry.amplitudeTime = source.getStageTime(Stage::Amplitude).count();
+    telemetry.filterTime = source.getStageTime(Stage::Filters).count();
+    telemetry.panningTime = source.getStageTime(Stage::Panning).count();
+    telemetry.effectsTime = source.getStageTime(Stage::Effects).count();
+    telemetry.activeVoices = source.getActiveVoices();
+    telemetry.maxActiveVoices = source.getMaxActiveVoices();
+    telemetry.stolenVoices = source.getStolenVoices();
+    telemetry.fileQueueDepth = source.getFileQueueDepth();
+    telemetry.maxFileQueueDepth = source.getMaxFileQueueDepth();
+    telemetry.bufferPoolExhaustions = source.getBufferPoolExhaustions();
+    telemetry.streamUnderruns = source.getStreamUnderruns();
+    telemetry.effectBusBlocks = source.getEffectBusBlocks();
+    telemetry.skippedEffectBusBlocks = source.getSkippedEffectBusBlocks();
+    telemetry.callbackTimeMean = callbackTimes.mean() * nsToSeconds;
+    telemetry.callbackTimeP50 = callbackTimes.percentile(0.5) * nsToSeconds;
+    telemetry.callbackTimeP99 = callbackTimes.percentile(0.99) * nsToSeconds;
+    telemetry.callbackTimeP999 = callbackTimes.percentile(0.999) * nsToSeconds;
+    telemetry.callbackTimeMax = callbackTimes.max() * nsToSeconds;
+    telemetry.fileWaitTimeP50 = fileWaitTimes.percentile(0.5) * nsToSeconds;
+    telemetry.fileWaitTimeP99 = fileWaitTimes.percentile(0.99) * nsToSeconds;
+    telemetry.fileWaitTimeMax = fileWaitTimes.max() * nsToSeconds;
+    telemetry.fileLoadTimeP50 = fileLoadTimes.percentile(0.5) * nsToSeconds;
+    telemetry.fileLoadTimeP99 = fileLoadTimes.percentile(0.99) * nsToSeconds;
+    telemetry.fileLoadTimeMax = fileLoadTimes.max() * nsToSeconds;
+    return telemetry;
+}
+
+void sfz::Sfizz::resetTelemetry() noexcept
+{
+    synth->synth.resetTelemetry();
+}
+
 void sfz::Sfizz::allSoundOff() noexcept
 {
     synth->synth.allSoundOff();
@@ -7,6 +7,7 @@
 #include "Config.h"
 #include "Synth.h"
 #include "Messaging.h"
+#include "Telemetry.h"
 #include "utility/Macros.h"
 #include "sfizz.h"
 #include "sfizz_private.hpp"
@@ -31,6 +32,43 @@ bool sfizz_load_string(sfizz_synth_t* synth, const char* path, const char* text)
     return synth->synth.loadSfzString(path, text);
 }
 
+bool sfizz_reload_file(sfizz_synth_t* synth, const char* path)
+{
+    return synth->synth.reloadSfzFile(path);
+}
+
+bool sfizz_reload_string(sfizz_synth_t* synth, const char* path, const char* text)
+{
+    return synth->synth.reloadSfzString(path, text);
+}
+
+void sfizz_set_load_progress_callback(sfizz_synth_t* synth, sfizz_load_progress_t* callback, void* data)
+{
+    if (!callback) {
+        synth->synth.setLoadProgressCallback(nullptr);
+        return;
+    }
+
+    synth->synth.setLoadProgressCallback([callback, data](size_t numLoaded, size_t numTotal) {
+        return callback(data, static_cast<unsigned>(numLoaded), static_cast<unsigned>(numTotal));
+    });
+}
+
+bool sfizz_load_file_in_background(sfizz_synth_t* synth, const char* path)
+{
+    return synth->synth.loadSfzFileInBackground(path);
+}
+
+bool sfizz_load_string_in_background(sfizz_synth_t* synth, const char* path, const char* text)
+{
+    return synth->synth.loadSfzStringInBackground(path, text);
+}
+
+bool sfizz_is_instrument_swap_pending(sfizz_synth_t* synth)
+{
+    return synth->synth.isInstrumentSwapPending();
+}
+
 bool sfizz_load_scala_file(sfizz_synth_t* synth, const char* path)
 {
     return synth->synth.loadScalaFile(path);
@@ -100,6 +138,14 @@ size_t sfizz_get_num_preloaded_samples(sfizz_synth_t* synth)
 {
     return synth->synth.getNumPreloadedSamples();
 }
+size_t sfizz_get_num_reused_preloaded_samples(sfizz_synth_t* synth)
+{
+    return synth->synth.getNumReusedPreloadedSamples();
+}
+size_t sfizz_get_num_read_preloaded_samples(sfizz_synth_t* synth)
+{
+    return synth->synth.getNumReadPreloadedSamples();
+}
 int sfizz_get_num_active_voices(sfizz_synth_t* synth)
 {
     return synth->synth.getNumActiveVoices();
@@ -208,16 +254,62 @@ void sfizz_set_preload_size(sfizz_synth_t* synth, unsigned int preload_size)
     synth->synth.setPreloadSize(preload_size);
 }
 
-sfizz_oversampling_factor_t sfizz_get_oversampling_factor(sfizz_synth_t*)
+unsigned int sfizz_get_stream_ring_size(sfizz_synth_t* synth)
+{
+    return synth->synth.getStreamRingSize();
+}
+
+void sfizz_set_stream_ring_size(sfizz_synth_t* synth, unsigned int num_frames)
+{
+    synth->synth.setStreamRingSize(num_frames);
+}
+
+size_t sfizz_get_num_stream_underruns(sfizz_synth_t* synth)
+{
+    return synth->synth.getNumStreamUnderruns();
+}
+
+bool sfizz_set_preload_cache_directory(sfizz_synth_t* synth, const char* path)
+{
+    return synth->synth.setPreloadCacheDirectory(path ? path : "");
+}
+
+size_t sfizz_get_num_preload_cache_hits(sfizz_synth_t* synth)
 {
-    return SFIZZ_OVERSAMPLING_X1;
+    return synth->synth.getNumPreloadCacheHits();
 }
 
-bool sfizz_set_oversampling_factor(sfizz_synth_t*, sfizz_oversampling_factor_t)
+size_t sfizz_get_num_preload_cache_misses(sfizz_synth_t* synth)
 {
+    return synth->synth.getNumPreloadCacheMisses();
+}
+
+sfizz_oversampling_factor_t sfizz_get_oversampling_factor(sfizz_synth_t* synth)
+{
+    return static_cast<sfizz_oversampling_factor_t>(synth->synth.getOversamplingFactor());
+}
+
+bool sfizz_set_oversampling_factor(sfizz_synth_t* synth, sfizz_oversampling_factor_t oversampling)
+{
+    switch (oversampling) {
+    case SFIZZ_OVERSAMPLING_X1:
+    case SFIZZ_OVERSAMPLING_X2:
+    case SFIZZ_OVERSAMPLING_X4:
+    case SFIZZ_OVERSAMPLING_X8:
+        break;
+    default:
+        return false;
+    }
+
+    synth->synth.setOversamplingFactor(static_cast<sfz::Oversampling>(oversampling));
     return true;
 }
 
+size_t sfizz_get_preloaded_memory(sfizz_synth_t* synth)
+{
+    return synth->synth.getPreloadedMemory();
+}
+
 int sfizz_get_sample_quality(sfizz_synth_t* synth, sfizz_process_mode_t mode)
 {
     return synth->synth.getSampleQuality(static_cast<sfz::Synth::ProcessMode>(mode));
@@ -258,6 +350,21 @@ int sfizz_get_num_voices(sfizz_synth_t* synth)
     return synth->synth.getNumVoices();
 }
 
+void sfizz_set_num_render_threads(sfizz_synth_t* synth, int num_threads)
+{
+    synth->synth.setNumRenderThreads(num_threads);
+}
+
+int sfizz_get_num_render_threads(sfizz_synth_t* synth)
+{
+    return synth->synth.getNumRenderThreads();
+}
+
+bool sfizz_has_realtime_render_threads(sfizz_synth_t* synth)
+{
+    return synth->synth.hasRealtimeRenderThreads();
+}
+
 int sfizz_get_num_buffers(sfizz_synth_t* synth)
 {
     return synth->synth.getAllocatedBuffers();
@@ -268,6 +375,16 @@ int sfizz_get_num_bytes(sfizz_synth_t* synth)
     return synth->synth.getAllocatedBytes();
 }
 
+size_t sfizz_get_num_mapped_bytes(sfizz_synth_t* synth)
+{
+    return synth->synth.getMappedBytes();
+}
+
+size_t sfizz_get_num_resident_mapped_bytes(sfizz_synth_t* synth)
+{
+    return synth->synth.getResidentMappedBytes();
+}
+
 void sfizz_enable_freewheeling(sfizz_synth_t* synth)
 {
     synth->synth.enableFreeWheeling();
@@ -278,6 +395,16 @@ void sfizz_disable_freewheeling(sfizz_synth_t* synth)
     synth->synth.disableFreeWheeling();
 }
 
+void sfizz_enable_mapped_streaming(sfizz_synth_t* synth)
+{
+    synth->synth.enableMappedStreaming();
+}
+
+void sfizz_disable_mapped_streaming(sfizz_synth_t* synth)
+{
+    synth->synth.disableMappedStreaming();
+}
+
 char* sfizz_get_unknown_opcodes(sfizz_synth_t* synth)
 {
     const auto unknownOpcodes = synth->synth.getUnknownOpcodes();
@@ -328,6 +455,51 @@ void sfizz_disable_logging(sfizz_synth_t* synth)
     synth->synth.disableLogging();
 }
 
+void sfizz_get_telemetry(sfizz_synth_t* synth, sfizz_telemetry_t* telemetry)
+{
+    using Stage = sfz::Telemetry::Stage;
+    const sfz::Telemetry& source = synth->synth.getTelemetry();
+    const sfz::LatencyHistogram& callbackTimes = source.getCallbackTimes();
+    const sfz::LatencyHistogram& fileWaitTimes = source.getFileWaitTimes();
+    const sfz::LatencyHistogram& fileLoadTimes = source.getFileLoadTimes();
+    constexpr double nsToSeconds = 1e-9;
+
+    telemetry->num_blocks = source.getNumBlocks();
+    telemetry->num_frames = source.getNumFrames();
+    telemetry->dispatch_time = source.getStageTime(Stage::Dispatch).count();
+    telemetry->render_time = source.getStageTime(Stage::RenderMethod).count();
+    telemetry->data_time = source.getStageTime(Stage::Data).count();
+    telemetry->amplitude_time = source.getStageTime(Stage::Amplitude).count();
+    telemetry->filter_time = source.getStageTime(Stage::Filters).count();
+    telemetry->panning_time = source.getStageTime(Stage::Panning).count();
+    telemetry->effects_time = source.getStageTime(Stage::Effects).count();
+    telemetry->active_voices = source.getActiveVoices();
+    telemetry->max_active_voices = source.getMaxActiveVoices();
+    telemetry->stolen_voices = source.getStolenVoices();
+    telemetry->file_queue_depth = source.getFileQueueDepth();
+    telemetry->max_file_queue_depth = source.getMaxFileQueueDepth();
+    telemetry->buffer_pool_exhaustions = source.getBufferPoolExhaustions();
+    telemetry->stream_underruns = source.getStreamUnderruns();
+    telemetry->effect_bus_blocks = source.getEffectBusBlocks();
+    telemetry->skipped_effect_bus_blocks = source.getSkippedEffectBusBlocks();
+    telemetry->callback_time_mean = callbackTimes.mean() * nsToSeconds;
+    telemetry->callback_time_p50 = callbackTimes.percentile(0.5) * nsToSeconds;
+    telemetry->callback_time_p99 = callbackTimes.percentile(0.99) * nsToSeconds;
+    telemetry->callback_time_p999 = callbackTimes.percentile(0.999) * nsToSeconds;
+    telemetry->callback_time_max = callbackTimes.max() * nsToSeconds;
+    telemetry->file_wait_time_p50 = fileWaitTimes.percentile(0.5) * nsToSeconds;
+    telemetry->file_wait_time_p99 = fileWaitTimes.percentile(0.99) * nsToSeconds;
+    telemetry->file_wait_time_max = fileWaitTimes.max() * nsToSeconds;
+    telemetry->file_load_time_p50 = fileLoadTimes.percentile(0.5) * nsToSeconds;
+    telemetry->file_load_time_p99 = fileLoadTimes.percentile(0.99) * nsToSeconds;
+    telemetry->file_load_time_max = fileLoadTimes.max() * nsToSeconds;
+}
+
+void sfizz_reset_telemetry(sfizz_synth_t* synth)
+{
+    synth->synth.resetTelemetry();
+}
+
 void sfizz_all_sound_off(sfizz_synth_t* synth)
 {
     return synth->synth.allSoundOff();
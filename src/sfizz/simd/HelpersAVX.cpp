@@ -8,6 +8,7 @@
 #include "../SIMDConfig.h"
 #include "../MathHelpers.h"
 #include "Common.h"
+#include "HelpersScalar.h"
 
 #if SFIZZ_HAVE_AVX
 #include <immintrin.h>
@@ -54,3 +55,305 @@ void gainAVX(const float* gain, const float* input, float* output, unsigned size
     while (output < sentinel)
         *output++ = (*gain++) * (*input++);
 }
+
+#if SFIZZ_HAVE_AVX
+/**
+ * @brief Interpolate 8 points of a windowed-sinc table, which are at the
+ * table positions `ix`.
+ */
+static inline __m256 sincTableLookupAVX(const float* table, __m256 ix) noexcept
+{
+    alignas(32) int j[8];
+    const __m256i i0 = _mm256_cvttps_epi32(ix);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(j), i0);
+    const __m256 mu = _mm256_sub_ps(ix, _mm256_cvtepi32_ps(i0));
+
+    // reference: Interpolated table lookups using SSE2 [2/2]
+    // https://rawstudio.org/blog/?p=482
+    const auto load = [table](int a, int b) {
+        const __m128 pa = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&table[a])));
+        return _mm_loadh_pi(pa, reinterpret_cast<const __m64*>(&table[b]));
+    };
+    const __m256 p0p1 = _mm256_insertf128_ps(_mm256_castps128_ps256(load(j[0], j[1])), load(j[4], j[5]), 1);
+    const __m256 p2p3 = _mm256_insertf128_ps(_mm256_castps128_ps256(load(j[2], j[3])), load(j[6], j[7]), 1);
+    const __m256 y0 = _mm256_shuffle_ps(p0p1, p2p3, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m256 y1 = _mm256_shuffle_ps(p0p1, p2p3, _MM_SHUFFLE(3, 1, 3, 1));
+
+    return _mm256_add_ps(y0, _mm256_mul_ps(mu, _mm256_sub_ps(y1, y0)));
+}
+
+static inline __m256 loadTwoAVX(const float* low, const float* high) noexcept
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+}
+
+static inline float horizontalSumAVX(__m128 x) noexcept
+{
+    const __m128 high = _mm_movehl_ps(x, x);
+    const __m128 sum = _mm_add_ps(x, high);
+    return _mm_cvtss_f32(_mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1)));
+}
+#endif
+
+void sincInterpolationAVX(const float* table, unsigned tableSize, unsigned points,
+    const float* inputLeft, const float* inputRight, float* outputLeft, float* outputRight,
+    const int* indices, const float* coeffs, const float* addingGains, unsigned size) noexcept
+{
+#if SFIZZ_HAVE_AVX
+    if (points % 4 != 0) {
+        sincInterpolationScalar(table, tableSize, points, inputLeft, inputRight,
+            outputLeft, outputRight, indices, coeffs, addingGains, size);
+        return;
+    }
+
+    const int j0 = 1 - static_cast<int>(points) / 2;
+    const __m256 mmHalfPoints = _mm256_set1_ps(points / 2.0f);
+    const __m256 mmScale = _mm256_set1_ps(static_cast<float>((tableSize - 1) / points));
+    const __m256 mmSteps = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 0.0f, 1.0f, 2.0f, 3.0f);
+    const __m256 mmFour = _mm256_set1_ps(4.0f);
+
+    // Two output frames are computed at once, one in each 128-bit half,
+    // with a kernel shared by both channels
+    unsigned n = 0;
+    for (; n + 1 < size; n += 2) {
+        const float* left0 = inputLeft + indices[n] + j0;
+        const float* left1 = inputLeft + indices[n + 1] + j0;
+        const float* right0 = inputRight ? inputRight + indices[n] + j0 : nullptr;
+        const float* right1 = inputRight ? inputRight + indices[n + 1] + j0 : nullptr;
+
+        __m256 x = _mm256_add_ps(
+            _mm256_setr_ps(
+                j0 - coeffs[n], j0 - coeffs[n], j0 - coeffs[n], j0 - coeffs[n],
+                j0 - coeffs[n + 1], j0 - coeffs[n + 1], j0 - coeffs[n + 1], j0 - coeffs[n + 1]),
+            mmSteps);
+        __m256 yLeft = _mm256_setzero_ps();
+        __m256 yRight = _mm256_setzero_ps();
+        for (unsigned i = 0; i < points; i += 4) {
+            const __m256 h = sincTableLookupAVX(table, _mm256_mul_ps(_mm256_add_ps(x, mmHalfPoints), mmScale));
+            yLeft = _mm256_add_ps(yLeft, _mm256_mul_ps(h, loadTwoAVX(left0 + i, left1 + i)));
+            if (inputRight)
+                yRight = _mm256_add_ps(yRight, _mm256_mul_ps(h, loadTwoAVX(right0 + i, right1 + i)));
+            x = _mm256_add_ps(x, mmFour);
+        }
+
+        const float left[2] = {
+            horizontalSumAVX(_mm256_castps256_ps128(yLeft)),
+            horizontalSumAVX(_mm256_extractf128_ps(yLeft, 1)),
+        };
+        const float right[2] = {
+            horizontalSumAVX(_mm256_castps256_ps128(yRight)),
+            horizontalSumAVX(_mm256_extractf128_ps(yRight, 1)),
+        };
+
+        for (unsigned k = 0; k < 2; ++k) {
+            if (addingGains) {
+                const float g = addingGains[n + k];
+                outputLeft[n + k] += g * left[k];
+                if (outputRight)
+                    outputRight[n + k] += g * right[k];
+            } else {
+                outputLeft[n + k] = left[k];
+                if (outputRight)
+                    outputRight[n + k] = right[k];
+            }
+        }
+    }
+
+    // Odd frame at the end
+    if (n < size) {
+        sincInterpolationScalar(table, tableSize, points, inputLeft, inputRight,
+            outputLeft + n, outputRight ? outputRight + n : nullptr, indices + n, coeffs + n,
+            addingGains ? addingGains + n : nullptr, size - n);
+    }
+#else
+    sincInterpolationScalar(table, tableSize, points, inputLeft, inputRight,
+        outputLeft, outputRight, indices, coeffs, addingGains, size);
+#endif
+}
+
+void linearVoiceBatchAVX(const float* const* sources, const float* positions, const float* increments,
+    const float* const* gains, const float* panLeft, const float* panRight,
+    float* outputLeft, float* outputRight, unsigned numVoices, unsigned size) noexcept
+{
+#if SFIZZ_HAVE_AVX
+    // The voices are spread over the lanes, 8 at a time; the remaining
+    // voices go through the scalar path. AVX has no integer conversion of
+    // 256-bit vectors without AVX2, so the indices are stored as floats.
+    const unsigned numVectorVoices = numVoices - numVoices % TypeAlignment;
+    alignas(ByteAlignment) float indices[TypeAlignment];
+
+    for (unsigned t = 0; t < size; ++t) {
+        const __m256 mmFrame = _mm256_set1_ps(static_cast<float>(t));
+        __m256 mmLeft = _mm256_setzero_ps();
+        __m256 mmRight = _mm256_setzero_ps();
+
+        for (unsigned v = 0; v < numVectorVoices; v += TypeAlignment) {
+            const __m256 mmPosition = _mm256_add_ps(_mm256_loadu_ps(&positions[v]),
+                _mm256_mul_ps(_mm256_loadu_ps(&increments[v]), mmFrame));
+            const __m256 mmIndex = _mm256_round_ps(mmPosition, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+            const __m256 mmCoeff = _mm256_sub_ps(mmPosition, mmIndex);
+            _mm256_store_ps(indices, mmIndex);
+
+            alignas(ByteAlignment) float y0[TypeAlignment];
+            alignas(ByteAlignment) float y1[TypeAlignment];
+            alignas(ByteAlignment) float g[TypeAlignment];
+            for (unsigned k = 0; k < TypeAlignment; ++k) {
+                const float* source = sources[v + k] + static_cast<int>(indices[k]);
+                y0[k] = source[0];
+                y1[k] = source[1];
+                g[k] = gains[v + k][t];
+            }
+
+            __m256 mmY = _mm256_add_ps(
+                _mm256_mul_ps(_mm256_load_ps(y0), _mm256_sub_ps(_mm256_set1_ps(1.0f), mmCoeff)),
+                _mm256_mul_ps(_mm256_load_ps(y1), mmCoeff));
+            mmY = _mm256_mul_ps(mmY, _mm256_load_ps(g));
+            mmLeft = _mm256_add_ps(mmLeft, _mm256_mul_ps(mmY, _mm256_loadu_ps(&panLeft[v])));
+            mmRight = _mm256_add_ps(mmRight, _mm256_mul_ps(mmY, _mm256_loadu_ps(&panRight[v])));
+        }
+
+        float left = horizontalSumAVX(_mm_add_ps(_mm256_castps256_ps128(mmLeft), _mm256_extractf128_ps(mmLeft, 1)));
+        float right = horizontalSumAVX(_mm_add_ps(_mm256_castps256_ps128(mmRight), _mm256_extractf128_ps(mmRight, 1)));
+        for (unsigned v = numVectorVoices; v < numVoices; ++v) {
+            const float position = positions[v] + increments[v] * static_cast<float>(t);
+            const int index = static_cast<int>(position);
+            const float coeff = position - static_cast<float>(index);
+            const float* source = sources[v] + index;
+            const float y = (source[0] * (1.0f - coeff) + source[1] * coeff) * gains[v][t];
+            left += y * panLeft[v];
+            right += y * panRight[v];
+        }
+
+        outputLeft[t] += left;
+        outputRight[t] += right;
+    }
+#else
+    linearVoiceBatchScalar(sources, positions, increments, gains, panLeft, panRight,
+        outputLeft, outputRight, numVoices, size);
+#endif
+}
+
+#if SFIZZ_HAVE_AVX
+/**
+ * @brief Compute the sine and the cosine of 8 angles within [0, pi/2], with
+ * Taylor polynomials accurate to the float precision on this range.
+ */
+static inline void sinCosQuarterAVX(__m256 x, __m256& sine, __m256& cosine) noexcept
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 x2 = _mm256_mul_ps(x, x);
+    const auto term = [&x2, &one](__m256 y, float divisor) {
+        return _mm256_sub_ps(one, _mm256_mul_ps(_mm256_mul_ps(x2, _mm256_set1_ps(1.0f / divisor)), y));
+    };
+
+    __m256 s = term(one, 110.0f);
+    s = term(s, 72.0f);
+    s = term(s, 42.0f);
+    s = term(s, 20.0f);
+    s = term(s, 6.0f);
+    sine = _mm256_mul_ps(x, s);
+
+    __m256 c = term(one, 132.0f);
+    c = term(c, 90.0f);
+    c = term(c, 56.0f);
+    c = term(c, 30.0f);
+    c = term(c, 12.0f);
+    cosine = term(c, 2.0f);
+}
+#endif
+
+void biquadVoiceBatchAVX(const float* const* inputs, float* const* outputs,
+    const float* halfOmegas, const float* alphaScales, const float* poles, const float* shapes,
+    float* coeffs, float* memory, unsigned stride, unsigned numVoices, unsigned size) noexcept
+{
+#if SFIZZ_HAVE_AVX
+    // The voices are spread over the lanes, 8 at a time; the remaining
+    // voices go through the scalar path
+    const unsigned numVectorVoices = numVoices - numVoices % TypeAlignment;
+    alignas(ByteAlignment) float x[TypeAlignment];
+    alignas(ByteAlignment) float y[TypeAlignment];
+
+    for (unsigned v = 0; v < numVectorVoices; v += TypeAlignment) {
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 two = _mm256_set1_ps(2.0f);
+
+        // Target coefficients, computed for the 8 voices at once
+        __m256 sh;
+        __m256 ch;
+        sinCosQuarterAVX(_mm256_loadu_ps(&halfOmegas[v]), sh, ch);
+        const __m256 s2 = _mm256_mul_ps(sh, sh);
+        const __m256 c2 = _mm256_mul_ps(ch, ch);
+        const __m256 cosine = _mm256_sub_ps(c2, s2);
+        const __m256 alpha = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_mul_ps(sh, ch)), _mm256_loadu_ps(&alphaScales[v]));
+        const __m256 norm = _mm256_div_ps(one, _mm256_add_ps(one, alpha));
+        const float* shape = shapes + v;
+        const __m256 p3 = _mm256_loadu_ps(&shape[3 * stride]);
+        const __m256 tb0 = _mm256_mul_ps(norm, _mm256_add_ps(
+            _mm256_add_ps(_mm256_loadu_ps(&shape[0]), _mm256_mul_ps(_mm256_loadu_ps(&shape[stride]), s2)),
+            _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(&shape[2 * stride]), c2), _mm256_mul_ps(p3, alpha))));
+        const __m256 tb1 = _mm256_mul_ps(norm, _mm256_add_ps(
+            _mm256_mul_ps(_mm256_loadu_ps(&shape[4 * stride]), s2), _mm256_mul_ps(_mm256_loadu_ps(&shape[5 * stride]), c2)));
+        const __m256 tb2 = _mm256_sub_ps(tb0, _mm256_mul_ps(_mm256_mul_ps(two, p3), _mm256_mul_ps(alpha, norm)));
+        const __m256 ta1 = _mm256_mul_ps(_mm256_set1_ps(-2.0f), _mm256_mul_ps(cosine, norm));
+        const __m256 ta2 = _mm256_mul_ps(_mm256_sub_ps(one, alpha), norm);
+
+        float* coeff = coeffs + v;
+        __m256 b0 = _mm256_loadu_ps(&coeff[0]);
+        __m256 b1 = _mm256_loadu_ps(&coeff[stride]);
+        __m256 b2 = _mm256_loadu_ps(&coeff[2 * stride]);
+        __m256 a1 = _mm256_loadu_ps(&coeff[3 * stride]);
+        __m256 a2 = _mm256_loadu_ps(&coeff[4 * stride]);
+        float* mem = memory + v;
+        __m256 u1 = _mm256_loadu_ps(&mem[0]);
+        __m256 w1 = _mm256_loadu_ps(&mem[stride]);
+        __m256 w2 = _mm256_loadu_ps(&mem[2 * stride]);
+        __m256 y1 = _mm256_loadu_ps(&mem[3 * stride]);
+
+        const __m256 pole = _mm256_loadu_ps(&poles[v]);
+        const float* const* in = inputs + v;
+        float* const* out = outputs + v;
+
+        for (unsigned t = 0; t < size; ++t) {
+            b0 = _mm256_add_ps(tb0, _mm256_mul_ps(pole, _mm256_sub_ps(b0, tb0)));
+            b1 = _mm256_add_ps(tb1, _mm256_mul_ps(pole, _mm256_sub_ps(b1, tb1)));
+            b2 = _mm256_add_ps(tb2, _mm256_mul_ps(pole, _mm256_sub_ps(b2, tb2)));
+            a1 = _mm256_add_ps(ta1, _mm256_mul_ps(pole, _mm256_sub_ps(a1, ta1)));
+            a2 = _mm256_add_ps(ta2, _mm256_mul_ps(pole, _mm256_sub_ps(a2, ta2)));
+
+            for (unsigned k = 0; k < TypeAlignment; ++k)
+                x[k] = in[k][t];
+
+            const __m256 input = _mm256_load_ps(x);
+            const __m256 output = _mm256_sub_ps(
+                _mm256_add_ps(_mm256_mul_ps(b0, input), _mm256_add_ps(u1, w2)), _mm256_mul_ps(a1, y1));
+            w2 = _mm256_sub_ps(w1, _mm256_mul_ps(a2, y1));
+            u1 = _mm256_mul_ps(b1, input);
+            w1 = _mm256_mul_ps(b2, input);
+            y1 = output;
+
+            _mm256_store_ps(y, output);
+            for (unsigned k = 0; k < TypeAlignment; ++k)
+                out[k][t] = y[k];
+        }
+
+        _mm256_storeu_ps(&coeff[0], b0);
+        _mm256_storeu_ps(&coeff[stride], b1);
+        _mm256_storeu_ps(&coeff[2 * stride], b2);
+        _mm256_storeu_ps(&coeff[3 * stride], a1);
+        _mm256_storeu_ps(&coeff[4 * stride], a2);
+        _mm256_storeu_ps(&mem[0], u1);
+        _mm256_storeu_ps(&mem[stride], w1);
+        _mm256_storeu_ps(&mem[2 * stride], w2);
+        _mm256_storeu_ps(&mem[3 * stride], y1);
+    }
+
+    if (numVectorVoices < numVoices) {
+        const unsigned v = numVectorVoices;
+        biquadVoiceBatchScalar(inputs + v, outputs + v, halfOmegas + v, alphaScales + v,
+            poles + v, shapes + v, coeffs + v, memory + v, stride, numVoices - v, size);
+    }
+#else
+    biquadVoiceBatchScalar(inputs, outputs, halfOmegas, alphaScales, poles, shapes,
+        coeffs, memory, stride, numVoices, size);
+#endif
+}
@@ -8,3 +8,12 @@
 
 void gain1AVX(float gain, const float* input, float* output, unsigned size) noexcept;
 void gainAVX(const float* gain, const float* input, float* output, unsigned size) noexcept;
+void sincInterpolationAVX(const float* table, unsigned tableSize, unsigned points,
+    const float* inputLeft, const float* inputRight, float* outputLeft, float* outputRight,
+    const int* indices, const float* coeffs, const float* addingGains, unsigned size) noexcept;
+void linearVoiceBatchAVX(const float* const* sources, const float* positions, const float* increments,
+    const float* const* gains, const float* panLeft, const float* panRight,
+    float* outputLeft, float* outputRight, unsigned numVoices, unsigned size) noexcept;
+void biquadVoiceBatchAVX(const float* const* inputs, float* const* outputs,
+    const float* halfOmegas, const float* alphaScales, const float* poles, const float* shapes,
+    float* coeffs, float* memory, unsigned stride, unsigned numVoices, unsigned size) noexcept;
@@ -5,6 +5,8 @@
 // If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
 
 #include "HelpersNEON.h"
+#include "HelpersScalar.h"
+#include "../SIMDConfig.h"
 #include "Common.h"
 
 #if SFIZZ_HAVE_NEON
@@ -14,3 +16,85 @@
 using Type = float;
 constexpr unsigned TypeAlignment = 4;
 constexpr unsigned ByteAlignment = TypeAlignment * sizeof(Type);
+
+#if SFIZZ_HAVE_NEON
+/**
+ * @brief Interpolate 4 points of a windowed-sinc table, which are at the
+ * table positions `ix`.
+ */
+static inline float32x4_t sincTableLookupNEON(const float* table, float32x4_t ix) noexcept
+{
+    const int32x4_t i0 = vcvtq_s32_f32(ix);
+    const float32x4_t mu = vsubq_f32(ix, vcvtq_f32_s32(i0));
+
+    const float32x4_t p0p1 = vcombine_f32(
+        vld1_f32(&table[vgetq_lane_s32(i0, 0)]), vld1_f32(&table[vgetq_lane_s32(i0, 1)]));
+    const float32x4_t p2p3 = vcombine_f32(
+        vld1_f32(&table[vgetq_lane_s32(i0, 2)]), vld1_f32(&table[vgetq_lane_s32(i0, 3)]));
+    const float32x4x2_t y = vuzpq_f32(p0p1, p2p3);
+
+    return vmlaq_f32(y.val[0], mu, vsubq_f32(y.val[1], y.val[0]));
+}
+
+static inline float horizontalSumNEON(float32x4_t x) noexcept
+{
+    float32x2_t sum = vadd_f32(vget_low_f32(x), vget_high_f32(x));
+    sum = vpadd_f32(sum, sum);
+    return vget_lane_f32(sum, 0);
+}
+#endif
+
+void sincInterpolationNEON(const float* table, unsigned tableSize, unsigned points,
+    const float* inputLeft, const float* inputRight, float* outputLeft, float* outputRight,
+    const int* indices, const float* coeffs, const float* addingGains, unsigned size) noexcept
+{
+#if SFIZZ_HAVE_NEON
+    if (points % TypeAlignment != 0) {
+        sincInterpolationScalar(table, tableSize, points, inputLeft, inputRight,
+            outputLeft, outputRight, indices, coeffs, addingGains, size);
+        return;
+    }
+
+    const int j0 = 1 - static_cast<int>(points) / 2;
+    const float32x4_t mmHalfPoints = vdupq_n_f32(points / 2.0f);
+    const float32x4_t mmScale = vdupq_n_f32(static_cast<float>((tableSize - 1) / points));
+    const float steps[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+    const float32x4_t mmSteps = vld1q_f32(steps);
+    const float32x4_t mmFour = vdupq_n_f32(4.0f);
+
+    const auto* sentinel = indices + size;
+    while (indices < sentinel) {
+        const float* left = inputLeft + *indices + j0;
+        const float* right = inputRight ? inputRight + *indices + j0 : nullptr;
+
+        // The kernel is computed once for both channels
+        float32x4_t x = vaddq_f32(vdupq_n_f32(j0 - *coeffs), mmSteps);
+        float32x4_t yLeft = vdupq_n_f32(0.0f);
+        float32x4_t yRight = vdupq_n_f32(0.0f);
+        for (unsigned i = 0; i < points; i += TypeAlignment) {
+            const float32x4_t h = sincTableLookupNEON(table, vmulq_f32(vaddq_f32(x, mmHalfPoints), mmScale));
+            yLeft = vmlaq_f32(yLeft, h, vld1q_f32(left + i));
+            if (right)
+                yRight = vmlaq_f32(yRight, h, vld1q_f32(right + i));
+            x = vaddq_f32(x, mmFour);
+        }
+
+        if (addingGains) {
+            const float g = *addingGains++;
+            *outputLeft++ += g * horizontalSumNEON(yLeft);
+            if (outputRight)
+                *outputRight++ += g * horizontalSumNEON(yRight);
+        } else {
+            *outputLeft++ = horizontalSumNEON(yLeft);
+            if (outputRight)
+                *outputRight++ = horizontalSumNEON(yRight);
+        }
+
+        ++indices;
+        ++coeffs;
+    }
+#else
+    sincInterpolationScalar(table, tableSize, points, inputLeft, inputRight,
+        outputLeft, outputRight, indices, coeffs, addingGains, size);
+#endif
+}
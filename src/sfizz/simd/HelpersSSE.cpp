@@ -8,6 +8,7 @@
 #include "../SIMDConfig.h"
 #include "../MathHelpers.h"
 #include "Common.h"
+#include "HelpersScalar.h"
 #include <array>
 
 #if SFIZZ_HAVE_SSE2
@@ -587,3 +588,275 @@ bool allWithinSSE(const float* input, float low, float high, unsigned size) noex
 
     return true;
 }
+
+#if SFIZZ_HAVE_SSE2
+/**
+ * @brief Interpolate 4 points of a windowed-sinc table, which are at the
+ * table positions `ix`.
+ */
+static inline __m128 sincTableLookupSSE(const float* table, __m128 ix) noexcept
+{
+    alignas(16) int j[4];
+    const __m128i i0 = _mm_cvttps_epi32(ix);
+    _mm_store_si128(reinterpret_cast<__m128i*>(j), i0);
+    const __m128 mu = _mm_sub_ps(ix, _mm_cvtepi32_ps(i0));
+
+    __m128 p0p1 = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&table[j[0]])));
+    __m128 p2p3 = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&table[j[2]])));
+    p0p1 = _mm_loadh_pi(p0p1, reinterpret_cast<const __m64*>(&table[j[1]]));
+    p2p3 = _mm_loadh_pi(p2p3, reinterpret_cast<const __m64*>(&table[j[3]]));
+    const __m128 y0 = _mm_shuffle_ps(p0p1, p2p3, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 y1 = _mm_shuffle_ps(p0p1, p2p3, _MM_SHUFFLE(3, 1, 3, 1));
+
+    return _mm_add_ps(y0, _mm_mul_ps(mu, _mm_sub_ps(y1, y0)));
+}
+
+static inline float horizontalSumSSE(__m128 x) noexcept
+{
+    const __m128 high = _mm_movehl_ps(x, x);
+    const __m128 sum = _mm_add_ps(x, high);
+    return _mm_cvtss_f32(_mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1)));
+}
+#endif
+
+void sincInterpolationSSE(const float* table, unsigned tableSize, unsigned points,
+    const float* inputLeft, const float* inputRight, float* outputLeft, float* outputRight,
+    const int* indices, const float* coeffs, const float* addingGains, unsigned size) noexcept
+{
+#if SFIZZ_HAVE_SSE2
+    if (points % TypeAlignment != 0) {
+        sincInterpolationScalar(table, tableSize, points, inputLeft, inputRight,
+            outputLeft, outputRight, indices, coeffs, addingGains, size);
+        return;
+    }
+
+    const int j0 = 1 - static_cast<int>(points) / 2;
+    const __m128 mmHalfPoints = _mm_set1_ps(points / 2.0f);
+    const __m128 mmScale = _mm_set1_ps(static_cast<float>((tableSize - 1) / points));
+    const __m128 mmSteps = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 mmFour = _mm_set1_ps(4.0f);
+
+    const auto* sentinel = indices + size;
+    while (indices < sentinel) {
+        const float* left = inputLeft + *indices + j0;
+        const float* right = inputRight ? inputRight + *indices + j0 : nullptr;
+
+        // The kernel is computed once for both channels
+        __m128 x = _mm_add_ps(_mm_set1_ps(j0 - *coeffs), mmSteps);
+        __m128 yLeft = _mm_setzero_ps();
+        __m128 yRight = _mm_setzero_ps();
+        for (unsigned i = 0; i < points; i += TypeAlignment) {
+            const __m128 h = sincTableLookupSSE(table, _mm_mul_ps(_mm_add_ps(x, mmHalfPoints), mmScale));
+            yLeft = _mm_add_ps(yLeft, _mm_mul_ps(h, _mm_loadu_ps(left + i)));
+            if (right)
+                yRight = _mm_add_ps(yRight, _mm_mul_ps(h, _mm_loadu_ps(right + i)));
+            x = _mm_add_ps(x, mmFour);
+        }
+
+        if (addingGains) {
+            const float g = *addingGains++;
+            *outputLeft++ += g * horizontalSumSSE(yLeft);
+            if (outputRight)
+                *outputRight++ += g * horizontalSumSSE(yRight);
+        } else {
+            *outputLeft++ = horizontalSumSSE(yLeft);
+            if (outputRight)
+                *outputRight++ = horizontalSumSSE(yRight);
+        }
+
+        ++indices;
+        ++coeffs;
+    }
+#else
+    sincInterpolationScalar(table, tableSize, points, inputLeft, inputRight,
+        outputLeft, outputRight, indices, coeffs, addingGains, size);
+#endif
+}
+
+void linearVoiceBatchSSE(const float* const* sources, const float* positions, const float* increments,
+    const float* const* gains, const float* panLeft, const float* panRight,
+    float* outputLeft, float* outputRight, unsigned numVoices, unsigned size) noexcept
+{
+#if SFIZZ_HAVE_SSE2
+    // The voices are spread over the lanes, 4 at a time; the remaining
+    // voices go through the scalar path
+    const unsigned numVectorVoices = numVoices - numVoices % TypeAlignment;
+    alignas(ByteAlignment) int indices[TypeAlignment];
+
+    for (unsigned t = 0; t < size; ++t) {
+        const __m128 mmFrame = _mm_set1_ps(static_cast<float>(t));
+        __m128 mmLeft = _mm_setzero_ps();
+        __m128 mmRight = _mm_setzero_ps();
+
+        for (unsigned v = 0; v < numVectorVoices; v += TypeAlignment) {
+            const __m128 mmPosition = _mm_add_ps(_mm_loadu_ps(&positions[v]),
+                _mm_mul_ps(_mm_loadu_ps(&increments[v]), mmFrame));
+            const __m128i mmIndex = _mm_cvttps_epi32(mmPosition);
+            const __m128 mmCoeff = _mm_sub_ps(mmPosition, _mm_cvtepi32_ps(mmIndex));
+            _mm_store_si128(reinterpret_cast<__m128i*>(indices), mmIndex);
+
+            const float* s0 = sources[v] + indices[0];
+            const float* s1 = sources[v + 1] + indices[1];
+            const float* s2 = sources[v + 2] + indices[2];
+            const float* s3 = sources[v + 3] + indices[3];
+            const __m128 mmY0 = _mm_setr_ps(s0[0], s1[0], s2[0], s3[0]);
+            const __m128 mmY1 = _mm_setr_ps(s0[1], s1[1], s2[1], s3[1]);
+            const __m128 mmGain = _mm_setr_ps(gains[v][t], gains[v + 1][t], gains[v + 2][t], gains[v + 3][t]);
+
+            __m128 mmY = _mm_add_ps(
+                _mm_mul_ps(mmY0, _mm_sub_ps(_mm_set1_ps(1.0f), mmCoeff)),
+                _mm_mul_ps(mmY1, mmCoeff));
+            mmY = _mm_mul_ps(mmY, mmGain);
+            mmLeft = _mm_add_ps(mmLeft, _mm_mul_ps(mmY, _mm_loadu_ps(&panLeft[v])));
+            mmRight = _mm_add_ps(mmRight, _mm_mul_ps(mmY, _mm_loadu_ps(&panRight[v])));
+        }
+
+        float left = horizontalSumSSE(mmLeft);
+        float right = horizontalSumSSE(mmRight);
+        for (unsigned v = numVectorVoices; v < numVoices; ++v) {
+            const float position = positions[v] + increments[v] * static_cast<float>(t);
+            const int index = static_cast<int>(position);
+            const float coeff = position - static_cast<float>(index);
+            const float* source = sources[v] + index;
+            const float y = (source[0] * (1.0f - coeff) + source[1] * coeff) * gains[v][t];
+            left += y * panLeft[v];
+            right += y * panRight[v];
+        }
+
+        outputLeft[t] += left;
+        outputRight[t] += right;
+    }
+#else
+    linearVoiceBatchScalar(sources, positions, increments, gains, panLeft, panRight,
+        outputLeft, outputRight, numVoices, size);
+#endif
+}
+
+#if SFIZZ_HAVE_SSE2
+/**
+ * @brief Compute the sine and the cosine of 4 angles within [0, pi/2], with
+ * Taylor polynomials accurate to the float precision on this range.
+ */
+static inline void sinCosQuarterSSE(__m128 x, __m128& sine, __m128& cosine) noexcept
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 x2 = _mm_mul_ps(x, x);
+    const auto term = [&x2, &one](__m128 y, float divisor) {
+        return _mm_sub_ps(one, _mm_mul_ps(_mm_mul_ps(x2, _mm_set1_ps(1.0f / divisor)), y));
+    };
+
+    __m128 s = term(one, 110.0f);
+    s = term(s, 72.0f);
+    s = term(s, 42.0f);
+    s = term(s, 20.0f);
+    s = term(s, 6.0f);
+    sine = _mm_mul_ps(x, s);
+
+    __m128 c = term(one, 132.0f);
+    c = term(c, 90.0f);
+    c = term(c, 56.0f);
+    c = term(c, 30.0f);
+    c = term(c, 12.0f);
+    cosine = term(c, 2.0f);
+}
+#endif
+
+void biquadVoiceBatchSSE(const float* const* inputs, float* const* outputs,
+    const float* halfOmegas, const float* alphaScales, const float* poles, const float* shapes,
+    float* coeffs, float* memory, unsigned stride, unsigned numVoices, unsigned size) noexcept
+{
+#if SFIZZ_HAVE_SSE2
+    // The voices are spread over the lanes, 4 at a time; the remaining
+    // voices go through the scalar path
+    const unsigned numVectorVoices = numVoices - numVoices % TypeAlignment;
+    alignas(ByteAlignment) float y[TypeAlignment];
+
+    for (unsigned v = 0; v < numVectorVoices; v += TypeAlignment) {
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+
+        // Target coefficients, computed for the 4 voices at once
+        __m128 sh;
+        __m128 ch;
+        sinCosQuarterSSE(_mm_loadu_ps(&halfOmegas[v]), sh, ch);
+        const __m128 s2 = _mm_mul_ps(sh, sh);
+        const __m128 c2 = _mm_mul_ps(ch, ch);
+        const __m128 cosine = _mm_sub_ps(c2, s2);
+        const __m128 alpha = _mm_mul_ps(_mm_mul_ps(two, _mm_mul_ps(sh, ch)), _mm_loadu_ps(&alphaScales[v]));
+        const __m128 norm = _mm_div_ps(one, _mm_add_ps(one, alpha));
+        const float* shape = shapes + v;
+        const __m128 p3 = _mm_loadu_ps(&shape[3 * stride]);
+        const __m128 tb0 = _mm_mul_ps(norm, _mm_add_ps(
+            _mm_add_ps(_mm_loadu_ps(&shape[0]), _mm_mul_ps(_mm_loadu_ps(&shape[stride]), s2)),
+            _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&shape[2 * stride]), c2), _mm_mul_ps(p3, alpha))));
+        const __m128 tb1 = _mm_mul_ps(norm, _mm_add_ps(
+            _mm_mul_ps(_mm_loadu_ps(&shape[4 * stride]), s2), _mm_mul_ps(_mm_loadu_ps(&shape[5 * stride]), c2)));
+        const __m128 tb2 = _mm_sub_ps(tb0, _mm_mul_ps(_mm_mul_ps(two, p3), _mm_mul_ps(alpha, norm)));
+        const __m128 ta1 = _mm_mul_ps(_mm_set1_ps(-2.0f), _mm_mul_ps(cosine, norm));
+        const __m128 ta2 = _mm_mul_ps(_mm_sub_ps(one, alpha), norm);
+
+        float* coeff = coeffs + v;
+        __m128 b0 = _mm_loadu_ps(&coeff[0]);
+        __m128 b1 = _mm_loadu_ps(&coeff[stride]);
+        __m128 b2 = _mm_loadu_ps(&coeff[2 * stride]);
+        __m128 a1 = _mm_loadu_ps(&coeff[3 * stride]);
+        __m128 a2 = _mm_loadu_ps(&coeff[4 * stride]);
+        float* mem = memory + v;
+        __m128 u1 = _mm_loadu_ps(&mem[0]);
+        __m128 w1 = _mm_loadu_ps(&mem[stride]);
+        __m128 w2 = _mm_loadu_ps(&mem[2 * stride]);
+        __m128 y1 = _mm_loadu_ps(&mem[3 * stride]);
+
+        const __m128 pole = _mm_loadu_ps(&poles[v]);
+        const float* in0 = inputs[v];
+        const float* in1 = inputs[v + 1];
+        const float* in2 = inputs[v + 2];
+        const float* in3 = inputs[v + 3];
+        float* out0 = outputs[v];
+        float* out1 = outputs[v + 1];
+        float* out2 = outputs[v + 2];
+        float* out3 = outputs[v + 3];
+
+        for (unsigned t = 0; t < size; ++t) {
+            b0 = _mm_add_ps(tb0, _mm_mul_ps(pole, _mm_sub_ps(b0, tb0)));
+            b1 = _mm_add_ps(tb1, _mm_mul_ps(pole, _mm_sub_ps(b1, tb1)));
+            b2 = _mm_add_ps(tb2, _mm_mul_ps(pole, _mm_sub_ps(b2, tb2)));
+            a1 = _mm_add_ps(ta1, _mm_mul_ps(pole, _mm_sub_ps(a1, ta1)));
+            a2 = _mm_add_ps(ta2, _mm_mul_ps(pole, _mm_sub_ps(a2, ta2)));
+
+            const __m128 x = _mm_setr_ps(in0[t], in1[t], in2[t], in3[t]);
+            const __m128 output = _mm_sub_ps(
+                _mm_add_ps(_mm_mul_ps(b0, x), _mm_add_ps(u1, w2)), _mm_mul_ps(a1, y1));
+            w2 = _mm_sub_ps(w1, _mm_mul_ps(a2, y1));
+            u1 = _mm_mul_ps(b1, x);
+            w1 = _mm_mul_ps(b2, x);
+            y1 = output;
+
+            _mm_store_ps(y, output);
+            out0[t] = y[0];
+            out1[t] = y[1];
+            out2[t] = y[2];
+            out3[t] = y[3];
+        }
+
+        _mm_storeu_ps(&coeff[0], b0);
+        _mm_storeu_ps(&coeff[stride], b1);
+        _mm_storeu_ps(&coeff[2 * stride], b2);
+        _mm_storeu_ps(&coeff[3 * stride], a1);
+        _mm_storeu_ps(&coeff[4 * stride], a2);
+        _mm_storeu_ps(&mem[0], u1);
+        _mm_storeu_ps(&mem[stride], w1);
+        _mm_storeu_ps(&mem[2 * stride], w2);
+        _mm_storeu_ps(&mem[3 * stride], y1);
+    }
+
+    if (numVectorVoices < numVoices) {
+        const unsigned v = numVectorVoices;
+        biquadVoiceBatchScalar(inputs + v, outputs + v, halfOmegas + v, alphaScales + v,
+            poles + v, shapes + v, coeffs + v, memory + v, stride, numVoices - v, size);
+    }
+#else
+    biquadVoiceBatchScalar(inputs, outputs, halfOmegas, alphaScales, poles, shapes,
+        coeffs, memory, stride, numVoices, size);
+#endif
+}
@@ -6,6 +6,7 @@
 
 #pragma once
 #include <algorithm>
+#include <cmath>
 
 template<class T>
 inline void readInterleavedScalar(const T* input, T* outputLeft, T* outputRight, unsigned inputSize) noexcept
@@ -236,3 +237,132 @@ bool allWithinScalar(const T* input, T low, T high, unsigned size ) noexcept
 
     return true;
 }
+
+template <class T>
+void sincInterpolationScalar(const float* table, unsigned tableSize, unsigned points,
+    const T* inputLeft, const T* inputRight, T* outputLeft, T* outputRight,
+    const int* indices, const T* coeffs, const T* addingGains, unsigned size) noexcept
+{
+    const int j0 = 1 - static_cast<int>(points) / 2;
+    const float halfPoints = points / 2.0f;
+    const float scale = static_cast<float>((tableSize - 1) / points);
+
+    const auto* sentinel = indices + size;
+    while (indices < sentinel) {
+        const T* left = inputLeft + *indices + j0;
+        const T* right = inputRight ? inputRight + *indices + j0 : nullptr;
+        const T x0 = j0 - *coeffs;
+
+        T yLeft { 0 };
+        T yRight { 0 };
+        for (unsigned i = 0; i < points; ++i) {
+            const float ix = (static_cast<float>(x0 + i) + halfPoints) * scale;
+            const int i0 = static_cast<int>(ix);
+            const float mu = ix - i0;
+            const T h = static_cast<T>(table[i0] + mu * (table[i0 + 1] - table[i0]));
+            yLeft += h * left[i];
+            if (right)
+                yRight += h * right[i];
+        }
+
+        if (addingGains) {
+            const T g = *addingGains++;
+            *outputLeft++ += g * yLeft;
+            if (outputRight)
+                *outputRight++ += g * yRight;
+        } else {
+            *outputLeft++ = yLeft;
+            if (outputRight)
+                *outputRight++ = yRight;
+        }
+
+        ++indices;
+        ++coeffs;
+    }
+}
+
+template <class T>
+void linearVoiceBatchScalar(const T* const* sources, const T* positions, const T* increments,
+    const T* const* gains, const T* panLeft, const T* panRight,
+    T* outputLeft, T* outputRight, unsigned numVoices, unsigned size) noexcept
+{
+    for (unsigned t = 0; t < size; ++t) {
+        T left { 0 };
+        T right { 0 };
+        for (unsigned v = 0; v < numVoices; ++v) {
+            const T position = positions[v] + increments[v] * static_cast<T>(t);
+            const int index = static_cast<int>(position);
+            const T coeff = position - static_cast<T>(index);
+            const T* source = sources[v] + index;
+            const T y = (source[0] * (static_cast<T>(1.0) - coeff) + source[1] * coeff) * gains[v][t];
+            left += y * panLeft[v];
+            right += y * panRight[v];
+        }
+        outputLeft[t] += left;
+        outputRight[t] += right;
+    }
+}
+
+template <class T>
+void biquadVoiceBatchScalar(const T* const* inputs, T* const* outputs,
+    const T* halfOmegas, const T* alphaScales, const T* poles, const T* shapes,
+    T* coeffs, T* memory, unsigned stride, unsigned numVoices, unsigned size) noexcept
+{
+    for (unsigned v = 0; v < numVoices; ++v) {
+        // Target coefficients, from the half angle to keep the precision
+        // of 1 - cos(w) and 1 + cos(w) at both ends of the spectrum
+        const T sh = std::sin(halfOmegas[v]);
+        const T ch = std::cos(halfOmegas[v]);
+        const T s2 = sh * sh;
+        const T c2 = ch * ch;
+        const T cosine = c2 - s2;
+        const T alpha = static_cast<T>(2.0) * sh * ch * alphaScales[v];
+        const T norm = static_cast<T>(1.0) / (static_cast<T>(1.0) + alpha);
+        const T* shape = shapes + v;
+        const T tb0 = (shape[0] + shape[stride] * s2 + shape[2 * stride] * c2 + shape[3 * stride] * alpha) * norm;
+        const T tb1 = (shape[4 * stride] * s2 + shape[5 * stride] * c2) * norm;
+        const T tb2 = tb0 - static_cast<T>(2.0) * shape[3 * stride] * alpha * norm;
+        const T ta1 = static_cast<T>(-2.0) * cosine * norm;
+        const T ta2 = (static_cast<T>(1.0) - alpha) * norm;
+
+        T* coeff = coeffs + v;
+        T b0 = coeff[0];
+        T b1 = coeff[stride];
+        T b2 = coeff[2 * stride];
+        T a1 = coeff[3 * stride];
+        T a2 = coeff[4 * stride];
+        T* mem = memory + v;
+        T u1 = mem[0];
+        T w1 = mem[stride];
+        T w2 = mem[2 * stride];
+        T y1 = mem[3 * stride];
+
+        const T pole = poles[v];
+        const T* input = inputs[v];
+        T* output = outputs[v];
+        for (unsigned t = 0; t < size; ++t) {
+            b0 = tb0 + pole * (b0 - tb0);
+            b1 = tb1 + pole * (b1 - tb1);
+            b2 = tb2 + pole * (b2 - tb2);
+            a1 = ta1 + pole * (a1 - ta1);
+            a2 = ta2 + pole * (a2 - ta2);
+            const T x = input[t];
+            const T y = b0 * x + u1 + w2 - a1 * y1;
+            w2 = w1 - a2 * y1;
+            u1 = b1 * x;
+            w1 = b2 * x;
+            y1 = y;
+            output[t] = y;
+        }
+
+        coeff[0] = b0;
+        coeff[stride] = b1;
+        coeff[2 * stride] = b2;
+        coeff[3 * stride] = a1;
+        coeff[4 * stride] = a2;
+        mem[0] = u1;
+        mem[stride] = w1;
+        mem[2 * stride] = w2;
+        mem[3 * stride] = y1;
+    }
+}
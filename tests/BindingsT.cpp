@@ -36,3 +36,27 @@ TEST_CASE("[Bindings] Midnam C")
     sfizz_free_memory(midnamChar);
     sfizz_free(synth);
 }
+
+TEST_CASE("[Bindings] Reload C++")
+{
+    sfz::Sfizz synth;
+    const auto path = fs::current_path() / "tests/TestFiles/incremental_reload.sfz";
+    REQUIRE(synth.loadSfzString(path.string(), "<region> key=60 sample=kick.wav"));
+    REQUIRE(synth.getNumReadPreloadedSamples() == 1);
+    REQUIRE(synth.reloadSfzString(path.string(), "<region> key=60 sample=kick.wav <region> key=61 sample=snare.wav"));
+    REQUIRE(synth.getNumReusedPreloadedSamples() == 1);
+    REQUIRE(synth.getNumReadPreloadedSamples() == 1);
+}
+
+TEST_CASE("[Bindings] Reload C")
+{
+    sfizz_synth_t* synth = sfizz_create_synth();
+    const auto path = fs::current_path() / "tests/TestFiles/incremental_reload.sfz";
+    const auto strPath = path.string();
+    REQUIRE(sfizz_load_string(synth, strPath.c_str(), "<region> key=60 sample=kick.wav"));
+    REQUIRE(sfizz_get_num_read_preloaded_samples(synth) == 1);
+    REQUIRE(sfizz_reload_string(synth, strPath.c_str(), "<region> key=60 sample=kick.wav <region> key=61 sample=snare.wav"));
+    REQUIRE(sfizz_get_num_reused_preloaded_samples(synth) == 1);
+    REQUIRE(sfizz_get_num_read_preloaded_samples(synth) == 1);
+    sfizz_free(synth);
+}
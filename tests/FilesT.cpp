@@ -7,6 +7,9 @@
 #include "TestHelpers.h"
 #include "sfizz/Synth.h"
 #include "sfizz/Voice.h"
+#include "sfizz/FilePool.h"
+#include "sfizz/SampleStore.h"
+#include "sfizz/Resources.h"
 #include "sfizz/SfzHelpers.h"
 #include "sfizz/parser/Parser.h"
 #include "sfizz/modulations/ModId.h"
@@ -686,3 +689,696 @@ TEST_CASE("[Files] Key center from audio file")
     REQUIRE(synth.getRegionView(4)->pitchKeycenter == 10);
     REQUIRE(synth.getRegionView(5)->pitchKeycenter == 62);
 }
+
+TEST_CASE("[Files] Memory-mapped streaming")
+{
+    Synth mappedSynth;
+    Synth decodedSynth;
+    constexpr unsigned blockSize = 256;
+    AudioBuffer<float> mappedBuffer { 2, blockSize };
+    AudioBuffer<float> decodedBuffer { 2, blockSize };
+
+    const std::string sfzString = R"(<region> sample=kick_float_mono.wav)";
+    for (Synth* synth : { &mappedSynth, &decodedSynth }) {
+        synth->setSamplesPerBlock(blockSize);
+        synth->enableFreeWheeling();
+        synth->loadSfzString(fs::current_path() / "tests/TestFiles/mapped.sfz", sfzString);
+        REQUIRE( synth->getNumRegions() == 1 );
+    }
+    mappedSynth.enableMappedStreaming();
+
+    const size_t mappedBytesBefore = mappedSynth.getMappedBytes();
+    mappedSynth.noteOn(0, 60, 127);
+    decodedSynth.noteOn(0, 60, 127);
+
+    // play past the preloaded part
+    for (unsigned i = 0; i < 64; ++i) {
+        mappedSynth.renderBlock(mappedBuffer);
+        decodedSynth.renderBlock(decodedBuffer);
+        REQUIRE( approxEqual(mappedBuffer.getConstSpan(0), decodedBuffer.getConstSpan(0)) );
+        REQUIRE( approxEqual(mappedBuffer.getConstSpan(1), decodedBuffer.getConstSpan(1)) );
+    }
+
+    REQUIRE( mappedSynth.getMappedBytes() > mappedBytesBefore );
+    REQUIRE( mappedSynth.getMappedBytes() >= 44012 * sizeof(float) );
+}
+
+TEST_CASE("[Files] Memory-mapped streaming of stereo files")
+{
+    Synth mappedSynth;
+    Synth decodedSynth;
+    constexpr unsigned blockSize = 256;
+    AudioBuffer<float> mappedBuffer { 2, blockSize };
+    AudioBuffer<float> decodedBuffer { 2, blockSize };
+
+    const std::string sfzString = R"(
+        <region> key=60 sample=tone_float_stereo.wav
+        <region> key=62 sample=tone_float_stereo.wav pitch_keycenter=55
+    )";
+    for (Synth* synth : { &mappedSynth, &decodedSynth }) {
+        synth->setSamplesPerBlock(blockSize);
+        synth->enableFreeWheeling();
+        synth->loadSfzString(fs::current_path() / "tests/TestFiles/mapped.sfz", sfzString);
+        REQUIRE( synth->getNumRegions() == 2 );
+    }
+    mappedSynth.enableMappedStreaming();
+
+    const size_t mappedBytesBefore = mappedSynth.getMappedBytes();
+    for (Synth* synth : { &mappedSynth, &decodedSynth }) {
+        synth->noteOn(0, 60, 127);
+        synth->noteOn(0, 62, 127);
+    }
+
+    // play past the preloaded part, at the original pitch and pitched up
+    for (unsigned i = 0; i < 64; ++i) {
+        mappedSynth.renderBlock(mappedBuffer);
+        decodedSynth.renderBlock(decodedBuffer);
+        REQUIRE( approxEqual(mappedBuffer.getConstSpan(0), decodedBuffer.getConstSpan(0)) );
+        REQUIRE( approxEqual(mappedBuffer.getConstSpan(1), decodedBuffer.getConstSpan(1)) );
+    }
+
+    REQUIRE( mappedSynth.getMappedBytes() > mappedBytesBefore );
+    REQUIRE( mappedSynth.getMappedBytes() >= 40000 * 2 * sizeof(float) );
+}
+
+TEST_CASE("[Files] Streaming rings")
+{
+    const std::string sfzString = R"(
+        <region> key=60 sample=kick.wav
+        <region> key=61 sample=kick.wav direction=reverse
+        <region> key=62 sample=kick.wav loop_mode=loop_continuous loop_start=20000 loop_end=24000
+    )";
+
+    for (int key : { 60, 61, 62 }) {
+        Synth streamedSynth;
+        Synth loadedSynth;
+        constexpr unsigned blockSize = 256;
+        AudioBuffer<float> streamedBuffer { 2, blockSize };
+        AudioBuffer<float> loadedBuffer { 2, blockSize };
+
+        for (Synth* synth : { &streamedSynth, &loadedSynth }) {
+            synth->setSamplesPerBlock(blockSize);
+            synth->setPreloadSize(1024);
+            synth->enableFreeWheeling();
+            synth->loadSfzString(fs::current_path() / "tests/TestFiles/streaming.sfz", sfzString);
+            REQUIRE( synth->getNumRegions() == 3 );
+            REQUIRE( synth->getStreamRingSize() == 0 );
+        }
+        streamedSynth.setStreamRingSize(8192);
+        REQUIRE( streamedSynth.getStreamRingSize() == 8192 );
+        REQUIRE( loadedSynth.getStreamRingSize() == 0 );
+
+        streamedSynth.noteOn(0, key, 127);
+        loadedSynth.noteOn(0, key, 127);
+
+        // render past the sample end, or through a few loops
+        for (unsigned i = 0; i < 240; ++i) {
+            streamedSynth.renderBlock(streamedBuffer);
+            loadedSynth.renderBlock(loadedBuffer);
+            REQUIRE( approxEqual(streamedBuffer.getConstSpan(0), loadedBuffer.getConstSpan(0)) );
+            REQUIRE( approxEqual(streamedBuffer.getConstSpan(1), loadedBuffer.getConstSpan(1)) );
+        }
+
+        REQUIRE( streamedSynth.getNumStreamUnderruns() == 0 );
+    }
+}
+
+TEST_CASE("[Files] Streaming rings seek to their start")
+{
+    // The rings start past the preloaded frames, which the readers seek to
+    const std::string sfzString = R"(
+        <region> key=60 sample=kick.wav
+        <region> key=61 sample=kick.wav direction=reverse
+        <region> key=62 sample=kick.wav pitch_keycenter=50
+    )";
+
+    for (int key : { 60, 61, 62 }) {
+        Synth streamedSynth;
+        Synth loadedSynth;
+        constexpr unsigned blockSize = 256;
+        AudioBuffer<float> streamedBuffer { 2, blockSize };
+        AudioBuffer<float> loadedBuffer { 2, blockSize };
+
+        for (Synth* synth : { &streamedSynth, &loadedSynth }) {
+            synth->setSamplesPerBlock(blockSize);
+            synth->setPreloadSize(16384);
+            synth->enableFreeWheeling();
+            synth->loadSfzString(fs::current_path() / "tests/TestFiles/streaming.sfz", sfzString);
+            REQUIRE( synth->getNumRegions() == 3 );
+        }
+        streamedSynth.setStreamRingSize(8192);
+
+        streamedSynth.noteOn(0, key, 127);
+        loadedSynth.noteOn(0, key, 127);
+
+        for (unsigned i = 0; i < 200; ++i) {
+            streamedSynth.renderBlock(streamedBuffer);
+            loadedSynth.renderBlock(loadedBuffer);
+            REQUIRE( approxEqual(streamedBuffer.getConstSpan(0), loadedBuffer.getConstSpan(0)) );
+            REQUIRE( approxEqual(streamedBuffer.getConstSpan(1), loadedBuffer.getConstSpan(1)) );
+        }
+
+        REQUIRE( streamedSynth.getNumStreamUnderruns() == 0 );
+    }
+}
+
+TEST_CASE("[Files] Persistent preload cache")
+{
+    const fs::path cacheDirectory = fs::temp_directory_path() / "sfizz_preload_cache_test";
+    std::error_code ec;
+    fs::remove_all(cacheDirectory, ec);
+
+    const std::string sfzString = R"(
+        <region> key=60 sample=kick.wav
+        <region> key=61 sample=kick.wav direction=reverse
+        <region> key=62 sample=looped_flute.wav
+        <region> key=63 sample=root_key_38.wav pitch_keycenter=sample
+    )";
+
+    Synth uncachedSynth;
+    Synth cachedSynth;
+    constexpr unsigned blockSize = 256;
+    AudioBuffer<float> uncachedBuffer { 2, blockSize };
+    AudioBuffer<float> cachedBuffer { 2, blockSize };
+
+    for (Synth* synth : { &uncachedSynth, &cachedSynth }) {
+        REQUIRE( synth->setPreloadCacheDirectory(cacheDirectory.string()) );
+        synth->setSamplesPerBlock(blockSize);
+        synth->loadSfzString(fs::current_path() / "tests/TestFiles/preload_cache.sfz", sfzString);
+        REQUIRE( synth->getNumRegions() == 4 );
+    }
+
+    REQUIRE( uncachedSynth.getNumPreloadCacheHits() == 0 );
+    REQUIRE( uncachedSynth.getNumPreloadCacheMisses() == 4 );
+    REQUIRE( cachedSynth.getNumPreloadCacheHits() == 4 );
+    REQUIRE( cachedSynth.getNumPreloadCacheMisses() == 0 );
+
+    for (int i = 0; i < 4; ++i) {
+        const Region* uncached = uncachedSynth.getRegionView(i);
+        const Region* cached = cachedSynth.getRegionView(i);
+        REQUIRE( cached->sampleEnd == uncached->sampleEnd );
+        REQUIRE( cached->loopRange == uncached->loopRange );
+        REQUIRE( cached->loopMode == uncached->loopMode );
+        REQUIRE( cached->pitchKeycenter == uncached->pitchKeycenter );
+    }
+    REQUIRE( cachedSynth.getRegionView(2)->loopMode == LoopMode::loop_continuous );
+    REQUIRE( cachedSynth.getRegionView(3)->pitchKeycenter == 38 );
+
+    for (int key : { 60, 61, 62, 63 }) {
+        uncachedSynth.noteOn(0, key, 127);
+        cachedSynth.noteOn(0, key, 127);
+    }
+    for (unsigned i = 0; i < 16; ++i) {
+        uncachedSynth.renderBlock(uncachedBuffer);
+        cachedSynth.renderBlock(cachedBuffer);
+        REQUIRE( approxEqual(cachedBuffer.getConstSpan(0), uncachedBuffer.getConstSpan(0)) );
+        REQUIRE( approxEqual(cachedBuffer.getConstSpan(1), uncachedBuffer.getConstSpan(1)) );
+    }
+
+    fs::remove_all(cacheDirectory, ec);
+}
+
+TEST_CASE("[Files] Parallel preloading with progress")
+{
+    const std::string sfzString = R"(
+        <region> key=60 sample=kick.wav
+        <region> key=61 sample=snare.wav
+        <region> key=62 sample=closedhat.wav
+        <region> key=63 sample=looped_flute.wav
+        <region> key=64 sample=36-CajonCenter-1.wav
+        <region> key=65 sample=36-CajonCenter-2.wav
+        <region> key=66 sample=36-CajonCenter-3.wav
+        <region> key=67 sample=36-CajonCenter-4.wav
+        <region> key=68 sample=36-CajonCenter-5.wav
+        <region> key=69 sample=kick.wav offset=1000
+    )";
+
+    SECTION("Progress")
+    {
+        Synth synth;
+        std::vector<std::pair<size_t, size_t>> progress;
+        synth.setLoadProgressCallback([&progress](size_t numLoaded, size_t numTotal) {
+            progress.emplace_back(numLoaded, numTotal);
+            return true;
+        });
+        REQUIRE( synth.loadSfzString(fs::current_path() / "tests/TestFiles/preloading.sfz", sfzString) );
+        REQUIRE( synth.getNumRegions() == 10 );
+        REQUIRE( synth.getNumPreloadedSamples() == 9 );
+
+        REQUIRE( !progress.empty() );
+        for (size_t i = 0; i < progress.size(); ++i) {
+            REQUIRE( progress[i].second == 9 );
+            if (i > 0)
+                REQUIRE( progress[i].first > progress[i - 1].first );
+        }
+        REQUIRE( progress.back().first == 9 );
+    }
+
+    SECTION("Cancellation")
+    {
+        Synth synth;
+        size_t numCalls = 0;
+        synth.setLoadProgressCallback([&numCalls](size_t, size_t) {
+            return ++numCalls < 3;
+        });
+        REQUIRE( !synth.loadSfzString(fs::current_path() / "tests/TestFiles/preloading.sfz", sfzString) );
+        REQUIRE( numCalls == 3 );
+        REQUIRE( synth.getNumRegions() == 0 );
+
+        synth.setLoadProgressCallback(nullptr);
+        REQUIRE( synth.loadSfzString(fs::current_path() / "tests/TestFiles/preloading.sfz", sfzString) );
+        REQUIRE( synth.getNumRegions() == 10 );
+    }
+}
+
+TEST_CASE("[Files] Shared preloading between synths")
+{
+    const std::string sfzString = R"(
+        <region> key=60 sample=kick.wav
+        <region> key=61 sample=snare.wav
+    )";
+
+    Synth first;
+    Synth second;
+    Synth separate;
+    first.setSharedPreloading(true);
+    second.setSharedPreloading(true);
+    REQUIRE( !separate.getSharedPreloading() );
+
+    for (Synth* synth : { &first, &second, &separate }) {
+        REQUIRE( synth->loadSfzString(fs::current_path() / "tests/TestFiles/shared_preloading.sfz", sfzString) );
+        REQUIRE( synth->getNumRegions() == 2 );
+    }
+
+    const auto preloadedData = [](Synth& synth, int regionIndex) {
+        const Region* region = synth.getRegionView(regionIndex);
+        auto file = synth.getResources().getFilePool().getPreloadedFile(region->sampleId);
+        REQUIRE( file );
+        return file->preloadedData;
+    };
+
+    for (int i = 0; i < 2; ++i) {
+        const FileAudioBufferPtr shared = preloadedData(first, i);
+        REQUIRE( shared );
+        REQUIRE( preloadedData(second, i) == shared );
+        REQUIRE( preloadedData(separate, i) != shared );
+        REQUIRE( preloadedData(separate, i)->getNumFrames() == shared->getNumFrames() );
+    }
+}
+
+TEST_CASE("[Files] Shared loaded data between synths")
+{
+    const std::string sfzString = R"(
+        <region> key=60 sample=kick.wav
+    )";
+
+    Synth first;
+    Synth second;
+    Synth separate;
+    constexpr unsigned blockSize = 256;
+    AudioBuffer<float> secondBuffer { 2, blockSize };
+    AudioBuffer<float> separateBuffer { 2, blockSize };
+
+    for (Synth* synth : { &first, &second, &separate }) {
+        synth->setSharedPreloading(synth != &separate);
+        synth->setSamplesPerBlock(blockSize);
+        synth->setPreloadSize(1024);
+        synth->enableFreeWheeling();
+        REQUIRE( synth->loadSfzString(fs::current_path() / "tests/TestFiles/shared_loading.sfz", sfzString) );
+        synth->setStreamRingSize(0);
+    }
+
+    const auto loadedFile = [](Synth& synth) {
+        const Region* region = synth.getRegionView(0);
+        auto file = synth.getResources().getFilePool().getPreloadedFile(region->sampleId);
+        REQUIRE( file );
+        return file;
+    };
+
+    // The first synth loads the file, and the second one reuses it
+    first.noteOn(0, 60, 127);
+    first.renderBlock(secondBuffer);
+    REQUIRE( loadedFile(first)->status == FileData::Status::Done );
+    REQUIRE( loadedFile(first)->sharedFileData );
+    REQUIRE( SampleStore::instance().getNumEntries() >= 1 );
+
+    second.noteOn(0, 60, 127);
+    separate.noteOn(0, 60, 127);
+    for (unsigned i = 0; i < 64; ++i) {
+        second.renderBlock(secondBuffer);
+        separate.renderBlock(separateBuffer);
+        REQUIRE( approxEqual(secondBuffer.getConstSpan(0), separateBuffer.getConstSpan(0)) );
+        REQUIRE( approxEqual(secondBuffer.getConstSpan(1), separateBuffer.getConstSpan(1)) );
+    }
+
+    REQUIRE( loadedFile(second)->sharedFileData == loadedFile(first)->sharedFileData );
+    REQUIRE( !loadedFile(separate)->sharedFileData );
+}
+
+TEST_CASE("[Files] Predictive loading")
+{
+    const auto isPredicted = [](Synth& synth, int regionIndex) {
+        const Region* region = synth.getRegionView(regionIndex);
+        auto file = synth.getResources().getFilePool().getPreloadedFile(region->sampleId);
+        REQUIRE( file );
+        return file->predicted.load();
+    };
+
+    SECTION("Round-robins")
+    {
+        const std::string sfzString = R"(
+            <group> key=60 seq_length=2
+            <region> seq_position=1 sample=kick.wav
+            <region> seq_position=2 sample=snare.wav
+        )";
+
+        Synth predictiveSynth;
+        Synth synth;
+        constexpr unsigned blockSize = 256;
+        AudioBuffer<float> predictiveBuffer { 2, blockSize };
+        AudioBuffer<float> buffer { 2, blockSize };
+
+        for (Synth* s : { &predictiveSynth, &synth }) {
+            s->setSamplesPerBlock(blockSize);
+            s->setPreloadSize(1024);
+            s->enableFreeWheeling();
+            REQUIRE( s->loadSfzString(fs::current_path() / "tests/TestFiles/predictive_loading.sfz", sfzString) );
+        }
+        predictiveSynth.setPredictiveLoading(true);
+        REQUIRE( predictiveSynth.getPredictiveLoading() );
+        REQUIRE( !synth.getPredictiveLoading() );
+
+        // The first note plays the kick, and predicts the snare
+        for (Synth* s : { &predictiveSynth, &synth })
+            s->noteOn(0, 60, 100);
+        REQUIRE( predictiveSynth.getNumPredictedLoads() == 1 );
+        REQUIRE( !isPredicted(predictiveSynth, 0) );
+        REQUIRE( isPredicted(predictiveSynth, 1) );
+        REQUIRE( predictiveSynth.getPredictedMemory() > 0 );
+        REQUIRE( synth.getNumPredictedLoads() == 0 );
+
+        for (unsigned note = 0; note < 2; ++note) {
+            for (unsigned i = 0; i < 32; ++i) {
+                predictiveSynth.renderBlock(predictiveBuffer);
+                synth.renderBlock(buffer);
+                REQUIRE( approxEqual(predictiveBuffer.getConstSpan(0), buffer.getConstSpan(0)) );
+                REQUIRE( approxEqual(predictiveBuffer.getConstSpan(1), buffer.getConstSpan(1)) );
+            }
+
+            // The second note plays the snare which was predicted
+            for (Synth* s : { &predictiveSynth, &synth }) {
+                s->noteOff(0, 60, 0);
+                s->noteOn(0, 60, 100);
+            }
+        }
+
+        REQUIRE( predictiveSynth.getNumPredictionHits() >= 1 );
+        REQUIRE( predictiveSynth.getNumPredictedLoads() >= 2 );
+        REQUIRE( predictiveSynth.getNumPredictionMisses() == 0 );
+    }
+
+    SECTION("Keyswitches")
+    {
+        Synth synth;
+        synth.setPreloadSize(1024);
+        synth.setPredictiveLoading(true);
+        REQUIRE( synth.loadSfzString(fs::current_path() / "tests/TestFiles/predictive_loading.sfz", R"(
+            <global> sw_lokey=36 sw_hikey=37 sw_default=36
+            <region> key=60 sw_last=36 sample=kick.wav
+            <region> key=60 sw_last=37 sample=snare.wav
+        )") );
+
+        synth.noteOn(0, 60, 100);
+        synth.noteOff(0, 60, 0);
+        REQUIRE( !isPredicted(synth, 1) );
+
+        // The new articulation of the last note is loaded ahead
+        synth.noteOn(0, 37, 100);
+        REQUIRE( isPredicted(synth, 1) );
+    }
+
+    SECTION("Memory budget")
+    {
+        Synth synth;
+        synth.setPreloadSize(1024);
+        synth.setPredictiveLoading(true);
+        synth.setPredictiveLoadingBudget(0);
+        REQUIRE( synth.getPredictiveLoadingBudget() == 0 );
+        REQUIRE( synth.loadSfzString(fs::current_path() / "tests/TestFiles/predictive_loading.sfz", R"(
+            <group> key=60 seq_length=2
+            <region> seq_position=1 sample=kick.wav
+            <region> seq_position=2 sample=snare.wav
+        )") );
+
+        synth.noteOn(0, 60, 100);
+        REQUIRE( synth.getNumPredictedLoads() == 0 );
+        REQUIRE( !isPredicted(synth, 1) );
+    }
+}
+
+TEST_CASE("[Files] Loaded memory budget")
+{
+    Synth synth;
+    constexpr unsigned blockSize = 256;
+    AudioBuffer<float> buffer { 2, blockSize };
+    synth.setSamplesPerBlock(blockSize);
+    synth.setPreloadSize(1024);
+    synth.enableFreeWheeling();
+    REQUIRE( synth.loadSfzString(fs::current_path() / "tests/TestFiles/memory_budget.sfz", R"(
+        <region> key=60 sample=kick.wav
+        <region> key=61 sample=snare.wav
+    )") );
+    synth.setStreamRingSize(0);
+
+    // Room for one of the files
+    constexpr size_t budget = 200000;
+    synth.setLoadedMemoryBudget(budget);
+    REQUIRE( synth.getLoadedMemoryBudget() == budget );
+
+    const auto playNote = [&](int key) {
+        synth.noteOn(0, key, 100);
+        for (unsigned i = 0; i < 200; ++i)
+            synth.renderBlock(buffer);
+    };
+
+    // The idle file stays in memory while it fits
+    playNote(60);
+    const size_t fileMemory = synth.getLoadedMemory();
+    REQUIRE( fileMemory > 0 );
+    REQUIRE( fileMemory <= budget );
+    REQUIRE( synth.getNumEvictions() == 0 );
+
+    // The least recently used file makes room for the next one
+    playNote(61);
+    REQUIRE( synth.getLoadedMemory() <= budget );
+    REQUIRE( synth.getNumEvictions() == 1 );
+    REQUIRE( synth.getNumReloads() == 0 );
+
+    playNote(60);
+    REQUIRE( synth.getLoadedMemory() <= budget );
+    REQUIRE( synth.getNumEvictions() == 2 );
+    REQUIRE( synth.getNumReloads() == 1 );
+}
+
+TEST_CASE("[Files] Memory budget evicts the least recently released file")
+{
+    Synth synth;
+    constexpr unsigned blockSize = 256;
+    AudioBuffer<float> buffer { 2, blockSize };
+    synth.setSamplesPerBlock(blockSize);
+    synth.setPreloadSize(1024);
+    synth.enableFreeWheeling();
+    REQUIRE( synth.loadSfzString(fs::current_path() / "tests/TestFiles/memory_budget.sfz", R"(
+        <region> key=60 sample=kick.wav
+        <region> key=61 sample=snare.wav
+        <region> key=62 sample=closedhat.wav
+    )") );
+    synth.setStreamRingSize(0);
+
+    // Room for two of the files
+    constexpr size_t budget = 400000;
+    synth.setLoadedMemoryBudget(budget);
+
+    const auto playNote = [&](int key) {
+        synth.noteOn(0, key, 100);
+        for (unsigned i = 0; i < 200; ++i)
+            synth.renderBlock(buffer);
+    };
+
+    playNote(60);
+    playNote(61);
+    playNote(60);
+    REQUIRE( synth.getNumEvictions() == 0 );
+
+    // The snare was released before the kick played again
+    playNote(62);
+    REQUIRE( synth.getLoadedMemory() <= budget );
+    REQUIRE( synth.getNumEvictions() == 1 );
+
+    playNote(60);
+    REQUIRE( synth.getNumEvictions() == 1 );
+    REQUIRE( synth.getNumReloads() == 0 );
+
+    playNote(61);
+    REQUIRE( synth.getLoadedMemory() <= budget );
+    REQUIRE( synth.getNumEvictions() == 2 );
+    REQUIRE( synth.getNumReloads() == 1 );
+}
+
+TEST_CASE("[Files] Scheduled loads")
+{
+    Synth synth;
+    constexpr unsigned blockSize = 256;
+    AudioBuffer<float> buffer { 2, blockSize };
+    synth.setSamplesPerBlock(blockSize);
+    synth.setPreloadSize(1024);
+    synth.enableFreeWheeling();
+    REQUIRE( synth.loadSfzString(fs::current_path() / "tests/TestFiles/scheduled_loads.sfz", R"(
+        <region> key=60 sample=kick.wav
+        <region> key=61 sample=snare.wav offset=500
+    )") );
+    synth.setStreamRingSize(0);
+
+    FilePool& filePool = synth.getResources().getFilePool();
+    synth.noteOn(0, 60, 100);
+    synth.noteOn(0, 61, 100);
+    REQUIRE( filePool.getMaxPendingLoads() >= 1 );
+
+    // Freewheeling waits for every queued load, not only the started ones
+    synth.renderBlock(buffer);
+    REQUIRE( filePool.getNumPendingLoads() == 0 );
+    for (int i = 0; i < 2; ++i) {
+        const Region* region = synth.getRegionView(i);
+        auto file = filePool.getPreloadedFile(region->sampleId);
+        REQUIRE( file );
+        REQUIRE( file->status == FileData::Status::Done );
+    }
+}
+
+TEST_CASE("[Files] Incremental reload")
+{
+    const fs::path sfzPath = fs::current_path() / "tests/TestFiles/incremental_reload.sfz";
+    Synth synth;
+    REQUIRE( synth.loadSfzString(sfzPath, R"(
+        <region> key=60 sample=kick.wav
+        <region> key=61 sample=snare.wav
+    )") );
+    REQUIRE( synth.getNumPreloadedSamples() == 2 );
+    REQUIRE( synth.getNumReusedPreloadedSamples() == 0 );
+    REQUIRE( synth.getNumReadPreloadedSamples() == 2 );
+
+    const auto preloadedData = [&synth](int regionIndex) {
+        const Region* region = synth.getRegionView(regionIndex);
+        auto file = synth.getResources().getFilePool().getPreloadedFile(region->sampleId);
+        REQUIRE( file );
+        return file->preloadedData;
+    };
+    const FileAudioBufferPtr kick = preloadedData(0);
+
+    REQUIRE( synth.reloadSfzString(sfzPath, R"(
+        <region> key=60 sample=kick.wav volume=-6
+        <region> key=62 sample=closedhat.wav
+    )") );
+    REQUIRE( synth.getNumRegions() == 2 );
+    REQUIRE( synth.getNumPreloadedSamples() == 2 );
+    REQUIRE( synth.getNumReusedPreloadedSamples() == 1 );
+    REQUIRE( synth.getNumReadPreloadedSamples() == 1 );
+    REQUIRE( preloadedData(0) == kick );
+
+    // A full load reads everything again
+    REQUIRE( synth.loadSfzString(sfzPath, R"(
+        <region> key=60 sample=kick.wav
+    )") );
+    REQUIRE( synth.getNumPreloadedSamples() == 1 );
+    REQUIRE( synth.getNumReusedPreloadedSamples() == 0 );
+    REQUIRE( synth.getNumReadPreloadedSamples() == 1 );
+}
+
+TEST_CASE("[Files] Background loads share the preloads of the replaced instrument")
+{
+    const fs::path sfzPath = fs::current_path() / "tests/TestFiles/incremental_reload.sfz";
+    Synth synth;
+    REQUIRE( synth.loadSfzString(sfzPath, R"(
+        <region> key=60 sample=kick.wav
+        <region> key=61 sample=snare.wav
+    )") );
+
+    const auto preloadedData = [&synth](int regionIndex) {
+        const Region* region = synth.getRegionView(regionIndex);
+        auto file = synth.getResources().getFilePool().getPreloadedFile(region->sampleId);
+        REQUIRE( file );
+        return file->preloadedData;
+    };
+    const FileAudioBufferPtr kick = preloadedData(0);
+
+    REQUIRE( synth.loadSfzStringInBackground(sfzPath, R"(
+        <region> key=60 sample=kick.wav volume=-6
+        <region> key=62 sample=closedhat.wav
+    )") );
+    REQUIRE( synth.getNumRegions() == 2 );
+    REQUIRE( synth.getNumPreloadedSamples() == 2 );
+    REQUIRE( synth.getNumReusedPreloadedSamples() == 1 );
+    REQUIRE( synth.getNumReadPreloadedSamples() == 1 );
+    REQUIRE( preloadedData(0) == kick );
+}
+
+TEST_CASE("[Files] Oversampled preloading")
+{
+    const std::string sfzString = R"(
+        <region> key=60 sample=kick.wav
+        <region> key=61 sample=snare.wav
+    )";
+    const fs::path sfzPath = fs::current_path() / "tests/TestFiles/oversampling.sfz";
+
+    Synth reference;
+    REQUIRE( reference.loadSfzString(sfzPath, sfzString) );
+
+    Synth synth;
+    synth.setOversamplingFactor(Oversampling::x2);
+    REQUIRE( synth.getOversamplingFactor() == Oversampling::x2 );
+    REQUIRE( synth.loadSfzString(sfzPath, sfzString) );
+
+    const auto preloadedFile = [](Synth& synth, int regionIndex) {
+        const Region* region = synth.getRegionView(regionIndex);
+        auto file = synth.getResources().getFilePool().getPreloadedFile(region->sampleId);
+        REQUIRE( file );
+        return file;
+    };
+
+    for (int i = 0; i < 2; ++i) {
+        auto file = preloadedFile(synth, i);
+        auto referenceFile = preloadedFile(reference, i);
+        REQUIRE( file->information.oversamplingFactor == 2 );
+        REQUIRE( file->information.end == referenceFile->information.end );
+        REQUIRE( file->getNumPreloadedFrames() == 2 * referenceFile->getNumPreloadedFrames() );
+    }
+    REQUIRE( synth.getPreloadedMemory() == 2 * reference.getPreloadedMemory() );
+
+    // Changing the factor upsamples the preloaded data again
+    synth.setOversamplingFactor(Oversampling::x4);
+    for (int i = 0; i < 2; ++i) {
+        auto file = preloadedFile(synth, i);
+        REQUIRE( file->information.oversamplingFactor == 4 );
+        REQUIRE( file->getNumPreloadedFrames() == 4 * preloadedFile(reference, i)->getNumPreloadedFrames() );
+    }
+
+    // Oversampled voices play
+    synth.noteOn(0, 60, 100);
+    AudioBuffer<float> buffer { 2, static_cast<size_t>(synth.getSamplesPerBlock()) };
+    synth.renderBlock(buffer);
+    REQUIRE( synth.getNumActiveVoices() == 1 );
+
+    // The data upsampled again is shared between the pools, like when loading
+    Synth first;
+    Synth second;
+    for (Synth* shared : { &first, &second }) {
+        shared->setSharedPreloading(true);
+        REQUIRE( shared->loadSfzString(sfzPath, sfzString) );
+        shared->setOversamplingFactor(Oversampling::x2);
+    }
+    for (int i = 0; i < 2; ++i) {
+        auto file = preloadedFile(first, i);
+        REQUIRE( file->information.oversamplingFactor == 2 );
+        REQUIRE( file->preloadedData == preloadedFile(second, i)->preloadedData );
+    }
+}
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "sfizz/FilterBank.h"
+#include "sfizz/SfzFilter.h"
+#include "sfizz/SIMDHelpers.h"
+#include "sfizz/ScopedFTZ.h"
+#include "catch2/catch.hpp"
+#include <absl/memory/memory.h>
+#include <memory>
+#include <random>
+#include <vector>
+using namespace Catch::literals;
+using namespace sfz;
+
+TEST_CASE("[FilterBank] Supported types")
+{
+    REQUIRE(FilterBank::supports(kFilterLpf2p));
+    REQUIRE(FilterBank::supports(kFilterHpf2p));
+    REQUIRE(FilterBank::supports(kFilterBpf2p));
+    REQUIRE(FilterBank::supports(kFilterBrf2p));
+    REQUIRE(!FilterBank::supports(kFilterLpf1p));
+    REQUIRE(!FilterBank::supports(kFilterLpf2pSv));
+    REQUIRE(!FilterBank::supports(kFilterPeq));
+}
+
+TEST_CASE("[FilterBank] Matches the Faust filters")
+{
+    ScopedFTZ ftz;
+    // A group of SIMD lanes and a remainder
+    constexpr unsigned numVoices = 11;
+    constexpr unsigned blockSize = 128;
+    constexpr unsigned numBlocks = 4;
+    constexpr float sampleRate = 48000.0f;
+    const std::vector<FilterType> types { kFilterLpf2p, kFilterHpf2p, kFilterBpf2p, kFilterBrf2p };
+
+    std::mt19937 gen { 42 };
+    std::uniform_real_distribution<float> noise { -0.5f, 0.5f };
+
+    for (bool simd : { false, true }) {
+        setSIMDOpStatus<float>(SIMDOps::biquadVoiceBatch, simd);
+
+        FilterBank bank { numVoices };
+        bank.setSampleRate(sampleRate);
+        std::vector<FilterBank::Channel> channels(numVoices);
+        std::vector<std::unique_ptr<Filter>> filters;
+        for (unsigned v = 0; v < numVoices; ++v) {
+            const FilterType type = types[v % types.size()];
+            FilterBank::setupChannel(channels[v], type);
+            filters.push_back(absl::make_unique<Filter>());
+            filters[v]->init(sampleRate);
+            filters[v]->setType(type);
+            filters[v]->setChannels(1);
+        }
+
+        std::vector<float> expected(blockSize);
+        std::vector<std::vector<float>> outputs(numVoices, std::vector<float>(blockSize));
+        std::vector<std::vector<float>> inputs(numVoices, std::vector<float>(blockSize));
+        std::vector<std::vector<float>> cutoffs(numVoices, std::vector<float>(blockSize));
+        std::vector<std::vector<float>> resonances(numVoices, std::vector<float>(blockSize));
+        const std::vector<float> gains(blockSize, 0.0f);
+
+        for (unsigned block = 0; block < numBlocks; ++block) {
+            bank.clear();
+            for (unsigned v = 0; v < numVoices; ++v) {
+                for (unsigned i = 0; i < blockSize; ++i) {
+                    const float t = static_cast<float>(block * blockSize + i) / (numBlocks * blockSize);
+                    inputs[v][i] = noise(gen);
+                    // Sweep the cutoffs over the spectrum, and vary the resonances
+                    cutoffs[v][i] = 100.0f * (v + 1) * (1.0f + 20.0f * t);
+                    resonances[v][i] = static_cast<float>(v % 5) * 3.0f - 3.0f + (t > 0.5f ? 2.0f : 0.0f);
+                }
+                bank.add(channels[v], inputs[v].data(), outputs[v].data(),
+                    cutoffs[v].data(), resonances[v].data());
+            }
+            bank.process(blockSize);
+
+            for (unsigned v = 0; v < numVoices; ++v) {
+                const float* in[1] { inputs[v].data() };
+                float* out[1] { expected.data() };
+                if (block == 0)
+                    filters[v]->prepare(cutoffs[v][0], resonances[v][0], 0.0f);
+                filters[v]->processModulated(in, out, cutoffs[v].data(),
+                    resonances[v].data(), gains.data(), blockSize);
+
+                for (unsigned i = 0; i < blockSize; ++i)
+                    REQUIRE(outputs[v][i] == Approx(expected[i]).margin(1e-4));
+            }
+        }
+    }
+
+    resetSIMDOpStatus<float>();
+}
+
+TEST_CASE("[FilterBank] A voice keeps its state between banks")
+{
+    constexpr unsigned blockSize = 64;
+    std::vector<float> input(blockSize, 1.0f);
+    std::vector<float> cutoffs(blockSize, 500.0f);
+    std::vector<float> resonances(blockSize, 0.0f);
+    std::vector<float> together(2 * blockSize);
+    std::vector<float> apart(2 * blockSize);
+
+    FilterBank::Channel channel;
+    FilterBank::setupChannel(channel, kFilterLpf2p);
+    FilterBank bank { 1 };
+    bank.add(channel, input.data(), together.data(), cutoffs.data(), resonances.data());
+    bank.process(blockSize);
+    bank.clear();
+    bank.add(channel, input.data(), together.data() + blockSize, cutoffs.data(), resonances.data());
+    bank.process(blockSize);
+
+    // The same filter, moved to another bank with another voice in between
+    FilterBank::Channel other;
+    FilterBank::setupChannel(channel, kFilterLpf2p);
+    FilterBank::setupChannel(other, kFilterHpf2p);
+    FilterBank first { 4 };
+    FilterBank second { 4 };
+    std::vector<float> otherOutput(blockSize);
+    first.add(channel, input.data(), apart.data(), cutoffs.data(), resonances.data());
+    first.process(blockSize);
+    second.add(other, input.data(), otherOutput.data(), cutoffs.data(), resonances.data());
+    second.add(channel, input.data(), apart.data() + blockSize, cutoffs.data(), resonances.data());
+    second.process(blockSize);
+
+    for (unsigned i = 0; i < 2 * blockSize; ++i)
+        REQUIRE(apart[i] == Approx(together[i]).margin(1e-6));
+}
@@ -5,9 +5,13 @@
 // If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
 
 #include "sfizz/Interpolators.h"
+#include "sfizz/SIMDHelpers.h"
 #include "catch2/catch.hpp"
+#include <algorithm>
 #include <array>
 #include <numeric>
+#include <random>
+#include <vector>
 using namespace Catch::literals;
 
 TEST_CASE("[Interpolators] Sample at points")
@@ -127,3 +131,67 @@ TEST_CASE("[Interpolators] Windowed sinc precision")
     Check(windowedSincError(*sfz::SincInterpolatorTraits<60>::windowedSinc));
     Check(windowedSincError(*sfz::SincInterpolatorTraits<72>::windowedSinc));
 }
+
+template <sfz::InterpolatorModel M>
+static void checkSincBlock(bool simd)
+{
+    sfz::setSIMDOpStatus<float>(sfz::SIMDOps::sincInterpolation, simd);
+
+    constexpr int padding = 40;
+    constexpr unsigned numFrames = 61;
+    std::minstd_rand generator { 42 };
+    std::uniform_real_distribution<float> dist { -1.0f, 1.0f };
+
+    std::vector<float> left(2 * padding + numFrames);
+    std::vector<float> right(2 * padding + numFrames);
+    std::generate(left.begin(), left.end(), [&]() { return dist(generator); });
+    std::generate(right.begin(), right.end(), [&]() { return dist(generator); });
+
+    std::vector<int> indices(numFrames);
+    std::vector<float> coeffs(numFrames);
+    std::vector<float> gains(numFrames);
+    for (unsigned i = 0; i < numFrames; ++i) {
+        const float position = padding + i * 0.77f;
+        indices[i] = static_cast<int>(position);
+        coeffs[i] = position - indices[i];
+        gains[i] = dist(generator);
+    }
+
+    std::vector<float> outputLeft(numFrames);
+    std::vector<float> outputRight(numFrames);
+    REQUIRE( sfz::interpolateSincBlock<M>(left.data(), right.data(), outputLeft.data(), outputRight.data(),
+        indices.data(), coeffs.data(), nullptr, numFrames) );
+
+    for (unsigned i = 0; i < numFrames; ++i) {
+        REQUIRE( outputLeft[i] == Approx(sfz::interpolate<M>(&left[indices[i]], coeffs[i])).margin(1e-4) );
+        REQUIRE( outputRight[i] == Approx(sfz::interpolate<M>(&right[indices[i]], coeffs[i])).margin(1e-4) );
+    }
+
+    std::vector<float> added(outputLeft);
+    REQUIRE( sfz::interpolateSincBlock<M>(left.data(), nullptr, added.data(), nullptr,
+        indices.data(), coeffs.data(), gains.data(), numFrames) );
+    for (unsigned i = 0; i < numFrames; ++i)
+        REQUIRE( added[i] == Approx(outputLeft[i] * (1.0f + gains[i])).margin(1e-4) );
+}
+
+TEST_CASE("[Interpolators] Windowed sinc blocks")
+{
+    sfz::initializeInterpolators();
+    sfz::initializeSIMDDispatchers();
+
+    for (bool simd : { false, true }) {
+        checkSincBlock<sfz::kInterpolatorSinc8>(simd);
+        checkSincBlock<sfz::kInterpolatorSinc12>(simd);
+        checkSincBlock<sfz::kInterpolatorSinc16>(simd);
+        checkSincBlock<sfz::kInterpolatorSinc24>(simd);
+        checkSincBlock<sfz::kInterpolatorSinc36>(simd);
+        checkSincBlock<sfz::kInterpolatorSinc48>(simd);
+        checkSincBlock<sfz::kInterpolatorSinc60>(simd);
+        checkSincBlock<sfz::kInterpolatorSinc72>(simd);
+    }
+
+    sfz::resetSIMDOpStatus<float>();
+    float dummy = 0.0f;
+    int index = 0;
+    REQUIRE( !sfz::interpolateSincBlock<sfz::kInterpolatorLinear>(&dummy, nullptr, &dummy, nullptr, &index, &dummy, nullptr, 1) );
+}
@@ -8,6 +8,8 @@
 #include "sfizz/modulations/ModId.h"
 #include "sfizz/modulations/ModKey.h"
 #include "sfizz/Synth.h"
+#include "sfizz/Voice.h"
+#include "sfizz/Region.h"
 #include "TestHelpers.h"
 #include "catch2/catch.hpp"
 
@@ -558,3 +560,39 @@ TEST_CASE("[Modulations] Extended CCs connections")
         R"("Controller 1 {curve=1, smooth=10, step=0.1}" -> "LFOPhase {0, N=3}")",
     }, 1));
 }
+
+TEST_CASE("[Modulations] Depth modulations are evaluated before their targets")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(256);
+    synth.loadSfzString("/modulation.sfz", R"(
+        <control> set_cc2=127
+        <region> sample=*sine pitcheg_sustain=100 pitcheg_depth_oncc2=1200
+    )");
+    synth.noteOn(0, 60, 100);
+
+    const sfz::Voice* voice = nullptr;
+    for (int i = 0; i < synth.getNumVoices() && !voice; ++i) {
+        if (!synth.getVoiceView(i)->isFree())
+            voice = synth.getVoiceView(i);
+    }
+    REQUIRE(voice);
+
+    const NumericId<sfz::Region> regionId = voice->getRegion()->getId();
+    sfz::ModMatrix& mm = synth.getResources().getModMatrix();
+    mm.beginCycle(256);
+    mm.beginVoice(voice->getId(), regionId, 1.0f);
+
+    // the pitch target is requested first, its depth target is computed
+    // on the way
+    const float* pitch = mm.getModulationByKey(sfz::ModKey::createNXYZ(sfz::ModId::Pitch, regionId));
+    REQUIRE(pitch);
+    REQUIRE(pitch[255] == Approx(1200.0f).margin(1.0f));
+
+    const float* depth = mm.getModulationByKey(sfz::ModKey::createNXYZ(sfz::ModId::PitchEGDepth, regionId));
+    REQUIRE(depth);
+    REQUIRE(depth[255] == Approx(1200.0f).margin(1.0f));
+
+    mm.endVoice();
+    mm.endCycle();
+}
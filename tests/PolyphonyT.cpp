@@ -570,3 +570,45 @@ TEST_CASE("[Polyphony] Choke long release tails with note_polyphony")
     REQUIRE( numPlayingVoices(synth) == 1 ); // Not released, attack phase
     REQUIRE( numActiveVoices(synth) == 1 );
 }
+
+TEST_CASE("[Polyphony] Off-by groups only visit the voices they choke")
+{
+    sfz::Synth synth;
+    sfz::AudioBuffer<float> buffer { 2, static_cast<unsigned>(synth.getSamplesPerBlock()) };
+    synth.loadSfzString(fs::current_path() / "tests/TestFiles/polyphony.sfz", R"(
+        <group> group=1 off_by=2 <region> key=46 sample=*saw
+        <group> group=1 off_by=2 <region> key=47 sample=*saw
+        <group> group=2 off_by=3 <region> key=42 sample=*sine
+        <group> group=3 <region> key=44 sample=*triangle
+        <group> group=4 <region> key=60 sample=*square
+    )");
+    synth.noteOn(0, 46, 63);
+    synth.noteOn(0, 47, 63);
+    synth.noteOn(0, 60, 63);
+    synth.renderBlock(buffer);
+    REQUIRE( numPlayingVoices(synth) == 3 );
+    REQUIRE( synth.getPolyphonyGroupView(2)->getOffByVoices().size() == 2 );
+    REQUIRE( synth.getPolyphonyGroupView(3)->getOffByVoices().empty() );
+
+    // An unrelated group does not choke anything
+    synth.noteOn(0, 44, 63);
+    synth.renderBlock(buffer);
+    REQUIRE( numPlayingVoices(synth) == 4 );
+
+    // The closed hat chokes both open hats, and is registered to be choked in turn
+    synth.noteOn(0, 42, 63);
+    synth.renderBlock(buffer);
+    REQUIRE( numPlayingVoices(synth) == 3 );
+    REQUIRE( synth.getPolyphonyGroupView(3)->getOffByVoices().size() == 1 );
+
+    for (unsigned i = 0; i < 100; ++i)
+        synth.renderBlock(buffer);
+    REQUIRE( synth.getPolyphonyGroupView(2)->getOffByVoices().empty() );
+    REQUIRE( numActiveVoices(synth) == 3 );
+
+    synth.noteOn(0, 44, 63);
+    synth.renderBlock(buffer);
+    std::vector<std::string> samples = playingSamples(synth);
+    absl::c_sort(samples);
+    REQUIRE( samples == std::vector<std::string> { "*square", "*triangle", "*triangle" } );
+}
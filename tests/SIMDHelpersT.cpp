@@ -12,6 +12,7 @@
 #include <absl/types/span.h>
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <iostream>
 #include <jsl/allocator>
 using namespace Catch::literals;
@@ -980,3 +981,50 @@ TEST_CASE("[Helpers] allWithin")
     REQUIRE( !sfz::allWithin<float>(input, 0.0f, 5.0f) );
     REQUIRE( !sfz::allWithin<float>(input, -1.0f, 7.0f) );
 }
+
+TEST_CASE("[Helpers] linearVoiceBatch (SIMD vs scalar)")
+{
+    // An odd number of voices, to exercise the remainder of the vector lanes
+    constexpr unsigned numVoices { 13 };
+    constexpr unsigned numFrames { medBufferSize };
+    constexpr unsigned sourceSize { 4 * medBufferSize };
+
+    std::vector<std::vector<float>> sources(numVoices, std::vector<float>(sourceSize));
+    std::vector<std::vector<float>> gainRows(numVoices, std::vector<float>(numFrames));
+    std::array<const float*, numVoices> sourcePointers;
+    std::array<const float*, numVoices> gainPointers;
+    std::array<float, numVoices> positions;
+    std::array<float, numVoices> increments;
+    std::array<float, numVoices> panLeft;
+    std::array<float, numVoices> panRight;
+
+    for (unsigned v = 0; v < numVoices; ++v) {
+        for (unsigned i = 0; i < sourceSize; ++i)
+            sources[v][i] = std::sin(0.05f * static_cast<float>((v + 1) * i));
+        for (unsigned i = 0; i < numFrames; ++i)
+            gainRows[v][i] = 1.0f - static_cast<float>(i) / numFrames;
+        sourcePointers[v] = sources[v].data();
+        gainPointers[v] = gainRows[v].data();
+        positions[v] = 0.1f * static_cast<float>(v);
+        increments[v] = 0.5f + 0.125f * static_cast<float>(v);
+        panLeft[v] = 0.25f + 0.05f * static_cast<float>(v);
+        panRight[v] = 1.0f - panLeft[v];
+    }
+
+    std::vector<float> leftScalar(numFrames, 0.5f);
+    std::vector<float> rightScalar(numFrames, 0.5f);
+    std::vector<float> leftSIMD(numFrames, 0.5f);
+    std::vector<float> rightSIMD(numFrames, 0.5f);
+
+    sfz::setSIMDOpStatus<float>(sfz::SIMDOps::linearVoiceBatch, false);
+    sfz::linearVoiceBatch<float>(sourcePointers.data(), positions.data(), increments.data(),
+        gainPointers.data(), panLeft.data(), panRight.data(),
+        leftScalar.data(), rightScalar.data(), numVoices, numFrames);
+    sfz::setSIMDOpStatus<float>(sfz::SIMDOps::linearVoiceBatch, true);
+    sfz::linearVoiceBatch<float>(sourcePointers.data(), positions.data(), increments.data(),
+        gainPointers.data(), panLeft.data(), panRight.data(),
+        leftSIMD.data(), rightSIMD.data(), numVoices, numFrames);
+
+    REQUIRE( approxEqualMargin<float>(leftScalar, leftSIMD) );
+    REQUIRE( approxEqualMargin<float>(rightScalar, rightSIMD) );
+}
@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "sfizz/SfzFilter.h"
+#include "sfizz/MathHelpers.h"
+#include "sfizz/ScopedFTZ.h"
+#include "catch2/catch.hpp"
+#include <cmath>
+#include <random>
+#include <vector>
+using namespace Catch::literals;
+using namespace sfz;
+
+namespace {
+
+constexpr double sampleRate { 48000.0 };
+constexpr unsigned blockSize { 256 };
+constexpr unsigned numBlocks { 4 };
+
+struct Parameters {
+    std::vector<float> input;
+    std::vector<float> cutoff;
+    std::vector<float> q;
+    std::vector<float> pksh;
+};
+
+// Sweep the parameters over the blocks, and hold them on the last block
+Parameters makeParameters(float minQ, float maxQ)
+{
+    const unsigned numFrames = blockSize * numBlocks;
+    std::mt19937 gen { 42 };
+    std::uniform_real_distribution<float> noise { -0.5f, 0.5f };
+    Parameters p;
+    p.input.resize(numFrames);
+    p.cutoff.resize(numFrames);
+    p.q.resize(numFrames);
+    p.pksh.resize(numFrames);
+    for (unsigned i = 0; i < numFrames; ++i) {
+        const float t = std::min(1.0f, static_cast<float>(i) / (numFrames - blockSize));
+        p.input[i] = noise(gen);
+        p.cutoff[i] = 50.0f * std::pow(300.0f, t);
+        p.q[i] = minQ + t * (maxQ - minQ);
+        // Step over 0 dB, where the exact shelf equalizers divide by zero
+        p.pksh[i] = -11.9f + 24.0f * t;
+    }
+    return p;
+}
+
+template <class F, class T>
+void checkTablesMatchExact(T type, const Parameters& p, unsigned channels, const FilterTables& tables)
+{
+    F exact;
+    F tabled;
+    for (F* filter : { &exact, &tabled }) {
+        filter->init(sampleRate);
+        filter->setType(type);
+        filter->setChannels(channels);
+    }
+    tabled.setCoefficientTables(&tables);
+    exact.prepare(p.cutoff[0], p.q[0], p.pksh[0]);
+    tabled.prepare(p.cutoff[0], p.q[0], p.pksh[0]);
+
+    std::vector<float> expected(blockSize);
+    std::vector<float> output(blockSize);
+    for (unsigned block = 0; block < numBlocks; ++block) {
+        const unsigned offset = block * blockSize;
+        const float* in[2] = { &p.input[offset], &p.input[offset] };
+        float* exactOut[2] = { expected.data(), expected.data() };
+        float* tabledOut[2] = { output.data(), output.data() };
+        exact.processModulated(in, exactOut, &p.cutoff[offset], &p.q[offset], &p.pksh[offset], blockSize);
+        tabled.processModulated(in, tabledOut, &p.cutoff[offset], &p.q[offset], &p.pksh[offset], blockSize);
+        for (unsigned i = 0; i < blockSize; ++i)
+            REQUIRE(output[i] == Approx(expected[i]).margin(1e-3));
+    }
+}
+
+} // namespace
+
+TEST_CASE("[FilterTables] Lookups")
+{
+    FilterTables tables;
+    tables.setSampleRate(sampleRate);
+    REQUIRE(tables.sampleRate() == sampleRate);
+
+    for (float cutoff : { 1.0f, 30.0f, 440.0f, 1234.5f, 9000.0f, 20000.0f }) {
+        double c, s;
+        tables.cosSin(cutoff, c, s);
+        const double w0 = 2 * pi<double>() * cutoff / sampleRate;
+        REQUIRE(c == Approx(std::cos(w0)).margin(1e-4));
+        REQUIRE(s == Approx(std::sin(w0)).margin(1e-4));
+    }
+
+    for (float q : { -60.0f, -3.3f, 0.0f, 7.1f, 60.0f })
+        REQUIRE(tables.resonanceQ(q) == Approx(std::pow(10.0, q / 20.0)).epsilon(1e-4));
+
+    for (float pksh : { -120.0f, -10.05f, 0.0f, 5.5f, 60.0f })
+        REQUIRE(tables.peakShelfAmplitude(pksh) == Approx(std::pow(10.0, pksh / 40.0)).epsilon(1e-4));
+}
+
+TEST_CASE("[FilterTables] The filters match the exact coefficients")
+{
+    ScopedFTZ ftz;
+    FilterTables tables;
+    tables.setSampleRate(sampleRate);
+    const Parameters p = makeParameters(-3.0f, 12.0f);
+
+    for (FilterType type : { kFilterLpf2p, kFilterLpf4p, kFilterLpf6p, kFilterHpf2p, kFilterHpf4p,
+             kFilterHpf6p, kFilterBpf2p, kFilterBpf4p, kFilterBpf6p, kFilterBrf2p,
+             kFilterPeq, kFilterLsh, kFilterHsh, kFilterLpf2pSv, kFilterLpf1p }) {
+        for (unsigned channels : { 1, 2 })
+            checkTablesMatchExact<Filter>(type, p, channels, tables);
+    }
+}
+
+TEST_CASE("[FilterTables] The equalizers match the exact coefficients")
+{
+    ScopedFTZ ftz;
+    FilterTables tables;
+    tables.setSampleRate(sampleRate);
+    const Parameters p = makeParameters(0.5f, 2.0f);
+
+    for (EqType type : { kEqPeak, kEqLshelf, kEqHshelf }) {
+        for (unsigned channels : { 1, 2 })
+            checkTablesMatchExact<FilterEq>(type, p, channels, tables);
+    }
+}
+
+TEST_CASE("[Filter] Constant modulations give the same output as unmodulated processing")
+{
+    const std::vector<float> input(blockSize, 1.0f);
+    const std::vector<float> cutoff(blockSize, 800.0f);
+    const std::vector<float> q(blockSize, 6.0f);
+    const std::vector<float> pksh(blockSize, 0.0f);
+    std::vector<float> modulated(blockSize);
+    std::vector<float> unmodulated(blockSize);
+
+    Filter first;
+    Filter second;
+    for (Filter* filter : { &first, &second }) {
+        filter->init(sampleRate);
+        filter->setType(kFilterLpf2p);
+        filter->setChannels(1);
+    }
+
+    const float* in[1] = { input.data() };
+    float* out[1] = { modulated.data() };
+    first.processModulated(in, out, cutoff.data(), q.data(), pksh.data(), blockSize);
+    for (unsigned i = 0; i < blockSize; i += 16) {
+        const float* chunkIn[1] = { input.data() + i };
+        float* chunkOut[1] = { unmodulated.data() + i };
+        second.process(chunkIn, chunkOut, cutoff[i], q[i], pksh[i], 16);
+    }
+
+    for (unsigned i = 0; i < blockSize; ++i)
+        REQUIRE(modulated[i] == unmodulated[i]);
+}
@@ -6,14 +6,25 @@
 
 #include "sfizz/Synth.h"
 #include "sfizz/Region.h"
+#include "sfizz/Resources.h"
+#include "sfizz/SynthConfig.h"
+#include "sfizz/Config.h"
+#include "sfizz/Telemetry.h"
 #include "sfizz/Layer.h"
 #include "sfizz/SisterVoiceRing.h"
 #include "sfizz/SfzHelpers.h"
+#include "sfizz/SIMDHelpers.h"
 #include "sfizz/utility/NumericId.h"
 #include "BitArray.h"
 #include "TestHelpers.h"
 #include "catch2/catch.hpp"
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <sched.h>
+#endif
 using namespace Catch::literals;
 using namespace sfz::literals;
 
@@ -1917,3 +1928,542 @@ TEST_CASE("[Synth] Sequences also work on cc triggers")
     synth.renderBlock(buffer);
     REQUIRE( playingSamples(synth) == std::vector<std::string> { "*sine", "*saw", "*sine" } );
 }
+
+TEST_CASE("[Synth] Number of render threads")
+{
+    sfz::Synth synth;
+    REQUIRE( synth.getNumRenderThreads() == 1 );
+    synth.setNumRenderThreads(4);
+    REQUIRE( synth.getNumRenderThreads() == 4 );
+    synth.setNumRenderThreads(0);
+    REQUIRE( synth.getNumRenderThreads() == 1 );
+    synth.setNumRenderThreads(1000);
+    REQUIRE( synth.getNumRenderThreads() == 16 );
+    synth.setNumRenderThreads(1);
+    REQUIRE( synth.getNumRenderThreads() == 1 );
+}
+
+#if !defined(_WIN32)
+TEST_CASE("[Synth] Render threads report their realtime priority")
+{
+    // The system may refuse SCHED_FIFO, e.g. in a container or without the
+    // rtprio limit; probe it on a scratch thread to know what to expect
+    bool canUseFifo = false;
+    std::thread probe([&canUseFifo]() {
+        sched_param param {};
+        const int minprio = sched_get_priority_min(SCHED_FIFO);
+        const int maxprio = sched_get_priority_max(SCHED_FIFO);
+        param.sched_priority = minprio + sfz::config::renderWorkerPthreadPriority * (maxprio - minprio) / 100;
+        canUseFifo = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+    });
+    probe.join();
+
+    sfz::Synth synth;
+    synth.setNumRenderThreads(2);
+    REQUIRE( synth.getNumRenderThreads() == 2 );
+    REQUIRE( synth.hasRealtimeRenderThreads() == canUseFifo );
+    synth.setNumRenderThreads(4);
+    REQUIRE( synth.hasRealtimeRenderThreads() == canUseFifo );
+}
+#endif
+
+TEST_CASE("[Synth] Parallel rendering matches the serial rendering")
+{
+    const std::string sfzString = R"(
+        <region> key=60 sample=*sine amplitude_oncc20=50 lfo1_freq=3 lfo1_amplitude=20
+        <region> key=62 sample=*saw effect1=50 cutoff=800 fil_type=lpf_2p cutoff_oncc21=1200
+        <region> key=64 sample=*square pan=-30 effect1=100
+        <region> key=65 sample=*triangle pitch_oncc22=100
+        <effect> bus=fx1 type=lofi bitred=20
+    )";
+
+    sfz::Synth serial;
+    sfz::Synth parallel;
+    sfz::Synth parallelAgain;
+    serial.loadSfzString(fs::current_path() / "tests/TestFiles/parallel_render.sfz", sfzString);
+    for (sfz::Synth* synth : { &parallel, &parallelAgain }) {
+        synth->loadSfzString(fs::current_path() / "tests/TestFiles/parallel_render.sfz", sfzString);
+        synth->setNumRenderThreads(3);
+        REQUIRE( synth->getNumRenderThreads() == 3 );
+    }
+
+    sfz::AudioBuffer<float> serialBuffer { 2, static_cast<unsigned>(serial.getSamplesPerBlock()) };
+    sfz::AudioBuffer<float> parallelBuffer { 2, static_cast<unsigned>(parallel.getSamplesPerBlock()) };
+    sfz::AudioBuffer<float> parallelAgainBuffer { 2, static_cast<unsigned>(parallelAgain.getSamplesPerBlock()) };
+
+    for (sfz::Synth* synth : { &serial, &parallel, &parallelAgain }) {
+        synth->cc(0, 20, 64);
+        synth->cc(0, 21, 100);
+        synth->cc(0, 22, 32);
+        synth->noteOn(0, 60, 100);
+        synth->noteOn(10, 62, 90);
+        synth->noteOn(20, 64, 80);
+        synth->noteOn(30, 65, 70);
+    }
+
+    // The parallel rendering is reproducible to the bit
+    const auto bitEqual = [](absl::Span<const float> lhs, absl::Span<const float> rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    };
+
+    for (int i = 0; i < 10; ++i) {
+        serial.renderBlock(serialBuffer);
+        parallel.renderBlock(parallelBuffer);
+        parallelAgain.renderBlock(parallelAgainBuffer);
+        REQUIRE( approxEqual(serialBuffer.getConstSpan(0), parallelBuffer.getConstSpan(0)) );
+        REQUIRE( approxEqual(serialBuffer.getConstSpan(1), parallelBuffer.getConstSpan(1)) );
+        REQUIRE( bitEqual(parallelBuffer.getConstSpan(0), parallelAgainBuffer.getConstSpan(0)) );
+        REQUIRE( bitEqual(parallelBuffer.getConstSpan(1), parallelAgainBuffer.getConstSpan(1)) );
+    }
+
+    REQUIRE( parallel.getNumActiveVoices() == 4 );
+}
+
+TEST_CASE("[Synth] Parallel effect buses match the sequential processing")
+{
+    const std::string sfzString = R"(
+        <region> key=60 sample=*sine effect1=100 effect2=50
+        <region> key=62 sample=*saw effect2=100 effect3=80
+        <region> key=64 sample=*square effect3=100
+        <effect> bus=fx1 type=fverb reverb_type=mid_hall reverb_wet=100
+        <effect> bus=fx2 type=comp comp_threshold=-20 comp_ratio=4
+        <effect> bus=fx3 type=strings strings_number=24 strings_wet=100
+        <effect> bus=fx3 type=lofi bitred=20
+    )";
+
+    sfz::Synth sequential;
+    sfz::Synth parallel;
+    sequential.getResources().getSynthConfig().parallelEffectBuses = false;
+    parallel.getResources().getSynthConfig().parallelEffectBuses = true;
+
+    sfz::AudioBuffer<float> sequentialBuffer { 2, static_cast<unsigned>(sequential.getSamplesPerBlock()) };
+    sfz::AudioBuffer<float> parallelBuffer { 2, static_cast<unsigned>(parallel.getSamplesPerBlock()) };
+
+    for (sfz::Synth* synth : { &sequential, &parallel }) {
+        synth->loadSfzString(fs::current_path() / "tests/TestFiles/parallel_effects.sfz", sfzString);
+        synth->setNumRenderThreads(3);
+        synth->noteOn(0, 60, 100);
+        synth->noteOn(10, 62, 90);
+        synth->noteOn(20, 64, 80);
+    }
+
+    for (int i = 0; i < 10; ++i) {
+        sequential.renderBlock(sequentialBuffer);
+        parallel.renderBlock(parallelBuffer);
+        REQUIRE( approxEqual(sequentialBuffer.getConstSpan(0), parallelBuffer.getConstSpan(0)) );
+        REQUIRE( approxEqual(sequentialBuffer.getConstSpan(1), parallelBuffer.getConstSpan(1)) );
+    }
+}
+
+TEST_CASE("[Synth] Effect buses without input become idle")
+{
+    sfz::Synth synth;
+    sfz::AudioBuffer<float> buffer { 2, static_cast<unsigned>(synth.getSamplesPerBlock()) };
+    synth.loadSfzString(fs::current_path() / "tests/TestFiles/idle_effects.sfz", R"(
+        <region> key=60 sample=*sine effect1=100
+        <region> key=62 sample=*sine
+        <effect> bus=fx1 type=lofi bitred=20
+    )");
+
+    const auto renderSeconds = [&](float seconds) {
+        const int numBlocks = static_cast<int>(seconds * sfz::config::defaultSampleRate / synth.getSamplesPerBlock()) + 1;
+        for (int i = 0; i < numBlocks; ++i)
+            synth.renderBlock(buffer);
+    };
+
+    const sfz::EffectBus* bus = synth.getEffectBusView(1);
+    REQUIRE( bus != nullptr );
+    REQUIRE( !bus->isIdle() );
+    renderSeconds(sfz::config::effectBusIdleTime);
+    REQUIRE( bus->isIdle() );
+
+    // A voice which does not send to the bus keeps it idle
+    synth.noteOn(0, 62, 100);
+    synth.renderBlock(buffer);
+    REQUIRE( !bus->hasInputs() );
+    REQUIRE( bus->isIdle() );
+
+    synth.noteOn(0, 60, 100);
+    synth.renderBlock(buffer);
+    REQUIRE( bus->hasInputs() );
+    REQUIRE( !bus->isIdle() );
+
+    // The bus sleeps once the downsampler of the lofi has rung out
+    REQUIRE( bus->getTailTime() > 0.0 );
+    REQUIRE( bus->getTailTime() < 0.1 );
+    synth.allSoundOff();
+    renderSeconds(bus->getTailTime());
+    REQUIRE( bus->isIdle() );
+}
+
+TEST_CASE("[Synth] Effect buses run until their tails decay")
+{
+    sfz::Synth synth;
+    sfz::AudioBuffer<float> buffer { 2, static_cast<unsigned>(synth.getSamplesPerBlock()) };
+    synth.loadSfzString(fs::current_path() / "tests/TestFiles/effect_tails.sfz", R"(
+        <region> key=60 sample=*sine effect1=100 effect2=100
+        <effect> bus=fx1 type=fverb reverb_type=small_room reverb_wet=100
+        <effect> bus=fx2 type=gain gain=-6
+    )");
+
+    const sfz::EffectBus* reverbBus = synth.getEffectBusView(1);
+    const sfz::EffectBus* gainBus = synth.getEffectBusView(2);
+    REQUIRE( reverbBus != nullptr );
+    REQUIRE( gainBus != nullptr );
+    REQUIRE( reverbBus->getTailTime() > 0.0 );
+    REQUIRE( gainBus->getTailTime() == 0.0 );
+
+    synth.noteOn(0, 60, 100);
+    for (int i = 0; i < 10; ++i)
+        synth.renderBlock(buffer);
+
+    synth.allSoundOff();
+    synth.renderBlock(buffer);
+    REQUIRE( gainBus->isIdle() );
+    REQUIRE( !reverbBus->isIdle() );
+
+    // The reverb sleeps at last, and its cycles get counted as skipped
+    const int maxBlocks = static_cast<int>(10 * sfz::config::defaultSampleRate / synth.getSamplesPerBlock());
+    for (int i = 0; i < maxBlocks && !reverbBus->isIdle(); ++i)
+        synth.renderBlock(buffer);
+    REQUIRE( reverbBus->isIdle() );
+
+    synth.resetTelemetry();
+    synth.renderBlock(buffer);
+    REQUIRE( synth.getTelemetry().getEffectBusBlocks() == 0 );
+    REQUIRE( synth.getTelemetry().getSkippedEffectBusBlocks() == 3 );
+    for (int c = 0; c < 2; ++c)
+        REQUIRE( std::all_of(buffer.getConstSpan(c).begin(), buffer.getConstSpan(c).end(),
+            [](float x) { return x == 0.0f; }) );
+
+    synth.noteOn(0, 60, 100);
+    synth.renderBlock(buffer);
+    REQUIRE( !reverbBus->isIdle() );
+    REQUIRE( !gainBus->isIdle() );
+}
+
+TEST_CASE("[Synth] Effect sends are compacted and shared")
+{
+    sfz::Synth synth;
+    synth.loadSfzString(fs::current_path() / "tests/TestFiles/effect_sends.sfz", R"(
+        <region> key=60 sample=*sine effect1=0 effect3=50
+        <region> key=61 sample=*sine effect3=50
+        <region> key=62 sample=*sine effect1=20 effect2=40
+        <region> key=63 sample=*sine volume=-6 effect3=50
+        <effect> bus=fx1 type=gain gain=-6
+        <effect> bus=fx3 type=gain gain=-6
+    )");
+
+    REQUIRE( synth.getNumRegions() == 4 );
+    const sfz::Region* region = synth.getRegionView(0);
+    REQUIRE( region->effectSends.size() == 2 );
+    REQUIRE( region->effectSends[0].bus == 0 );
+    REQUIRE( region->effectSends[0].gain == 1.0f );
+    REQUIRE( region->effectSends[1].bus == 3 );
+    REQUIRE( region->effectSends[1].gain == 0.5_a );
+
+    // No send to fx2, which has no effect
+    const sfz::Region* other = synth.getRegionView(2);
+    REQUIRE( other->effectSends.size() == 2 );
+    REQUIRE( other->effectSends[1].bus == 1 );
+    REQUIRE( other->effectSends[1].gain == 0.2_a );
+
+    REQUIRE( synth.getRegionView(1)->effectSendsId == region->effectSendsId );
+    REQUIRE( synth.getRegionView(3)->effectSendsId == region->effectSendsId );
+    REQUIRE( other->effectSendsId != region->effectSendsId );
+}
+
+TEST_CASE("[Synth] Shared effect sends match the separate sends")
+{
+    const std::string sfzString = R"(
+        <region> key=60 sample=*sine effect1=100 effect2=50
+        <region> key=62 sample=*saw effect1=100 effect2=50
+        <region> key=64 sample=*square effect2=80
+        <effect> bus=fx1 type=width width=50
+        <effect> bus=fx2 type=gain gain=-6
+    )";
+
+    sfz::Synth synth;
+    sfz::AudioBuffer<float> buffer { 2, static_cast<unsigned>(synth.getSamplesPerBlock()) };
+    synth.loadSfzString(fs::current_path() / "tests/TestFiles/shared_sends.sfz", sfzString);
+
+    // The same voices rendered one at a time, with the sends of their regions
+    std::vector<sfz::AudioBuffer<float>> separate;
+    const std::array<int, 3> keys { 60, 62, 64 };
+    for (int key : keys) {
+        sfz::Synth single;
+        single.loadSfzString(fs::current_path() / "tests/TestFiles/shared_sends.sfz", sfzString);
+        single.noteOn(0, key, 100);
+        separate.emplace_back(2, static_cast<unsigned>(single.getSamplesPerBlock()));
+        single.renderBlock(separate.back());
+    }
+
+    for (int key : keys)
+        synth.noteOn(0, key, 100);
+    synth.renderBlock(buffer);
+
+    for (unsigned c = 0; c < 2; ++c) {
+        std::vector<float> expected(buffer.getNumFrames(), 0.0f);
+        for (const auto& single : separate) {
+            for (size_t i = 0; i < expected.size(); ++i)
+                expected[i] += single.getConstSpan(c)[i];
+        }
+        REQUIRE( approxEqual<float>(buffer.getConstSpan(c), absl::MakeConstSpan(expected)) );
+    }
+}
+
+TEST_CASE("[Synth] Note activation index keeps velocity layers and sequences")
+{
+    sfz::Synth synth;
+    sfz::AudioBuffer<float> buffer { 2, static_cast<unsigned>(synth.getSamplesPerBlock()) };
+    synth.loadSfzString(fs::current_path() / "tests/TestFiles/note_activation_index.sfz", R"(
+        <region> key=60 hivel=63 seq_length=2 seq_position=1 sample=*sine
+        <region> key=60 hivel=63 seq_length=2 seq_position=2 sample=*saw
+        <region> key=60 lovel=64 sample=*triangle
+        <region> lokey=60 hikey=61 lovel=100 hivel=100 sample=*square
+    )");
+
+    const auto playNote = [&](int key, int velocity) {
+        synth.allSoundOff();
+        synth.renderBlock(buffer);
+        synth.noteOn(0, key, velocity);
+        synth.renderBlock(buffer);
+        return playingSamples(synth);
+    };
+
+    REQUIRE( playNote(60, 30) == std::vector<std::string> { "*sine" } );
+    // The sequence advances on the notes which do not match the velocity
+    REQUIRE( playNote(60, 90) == std::vector<std::string> { "*triangle" } );
+    REQUIRE( playNote(60, 30) == std::vector<std::string> { "*sine" } );
+    REQUIRE( playNote(60, 30) == std::vector<std::string> { "*saw" } );
+    REQUIRE( playNote(60, 63) == std::vector<std::string> { "*sine" } );
+    REQUIRE( playNote(60, 64) == std::vector<std::string> { "*triangle" } );
+    std::vector<std::string> layered = playNote(60, 100);
+    std::sort(layered.begin(), layered.end());
+    REQUIRE( layered == std::vector<std::string> { "*square", "*triangle" } );
+    REQUIRE( playNote(61, 100) == std::vector<std::string> { "*square" } );
+    REQUIRE( playNote(61, 99).empty() );
+    REQUIRE( playNote(62, 100).empty() );
+}
+
+TEST_CASE("[Synth] Specialized render pipelines match the generic one")
+{
+    const std::string sfz = R"(
+        <region> key=60 sample=kick.wav
+        <region> key=61 sample=closedhat.wav cutoff=1500 fil_type=lpf_2p
+        <region> key=62 sample=kick.wav xfin_locc1=0 xfin_hicc1=127
+        <region> key=63 sample=*sine
+        <region> key=64 sample=*saw cutoff=800 fil_type=hpf_1p eq1_freq=500 eq1_gain=6
+        <region> key=65 sample=*triangle pan=-50
+    )";
+
+    sfz::Synth generic;
+    sfz::Synth specialized;
+    generic.getResources().getSynthConfig().specializedRenderPipelines = false;
+    specialized.getResources().getSynthConfig().specializedRenderPipelines = true;
+
+    sfz::AudioBuffer<float> genericBuffer { 2, static_cast<unsigned>(generic.getSamplesPerBlock()) };
+    sfz::AudioBuffer<float> specializedBuffer { 2, static_cast<unsigned>(specialized.getSamplesPerBlock()) };
+
+    for (sfz::Synth* synth : { &generic, &specialized }) {
+        synth->loadSfzString(fs::current_path() / "tests/TestFiles/render_pipelines.sfz", sfz);
+        synth->cc(0, 1, 64);
+        for (int key = 60; key <= 65; ++key)
+            synth->noteOn(0, key, 100);
+    }
+
+    for (int block = 0; block < 8; ++block) {
+        generic.renderBlock(genericBuffer);
+        specialized.renderBlock(specializedBuffer);
+        REQUIRE( approxEqual(genericBuffer.getConstSpan(0), specializedBuffer.getConstSpan(0)) );
+        REQUIRE( approxEqual(genericBuffer.getConstSpan(1), specializedBuffer.getConstSpan(1)) );
+    }
+}
+
+TEST_CASE("[Synth] Batched voice rendering matches the per-voice rendering")
+{
+    // Batchable voices at various pitches, mixed with voices that are not
+    const std::string sfz = R"(
+        <global> sample_quality=1
+        <region> key=60 sample=kick.wav
+        <region> key=61 sample=kick.wav pan=-40
+        <region> key=62 sample=closedhat.wav pan=70 volume=-6
+        <region> key=63 sample=kick.wav cutoff=1500 fil_type=lpf_2p
+        <region> key=64 sample=*sine
+        <region> lokey=48 hikey=59 pitch_keycenter=55 sample=kick.wav pan=20
+    )";
+
+    sfz::Synth perVoice;
+    sfz::Synth batched;
+    perVoice.getResources().getSynthConfig().batchedVoiceRendering = false;
+    batched.getResources().getSynthConfig().batchedVoiceRendering = true;
+
+    sfz::AudioBuffer<float> perVoiceBuffer { 2, static_cast<unsigned>(perVoice.getSamplesPerBlock()) };
+    sfz::AudioBuffer<float> batchedBuffer { 2, static_cast<unsigned>(batched.getSamplesPerBlock()) };
+
+    for (sfz::Synth* synth : { &perVoice, &batched }) {
+        synth->loadSfzString(fs::current_path() / "tests/TestFiles/batched_voices.sfz", sfz);
+        for (int key = 60; key <= 64; ++key)
+            synth->noteOn(0, key, 100);
+        // Transposed notes, which read the sample at other rates
+        synth->noteOn(0, 50, 80);
+        synth->noteOn(0, 57, 60);
+    }
+
+    const auto approxEqualMargin = [](absl::Span<const float> lhs, absl::Span<const float> rhs) {
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            if (lhs[i] != Approx(rhs[i]).margin(1e-4)) {
+                std::cerr << lhs[i] << " != " << rhs[i] << " at index " << i << '\n';
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (int block = 0; block < 16; ++block) {
+        perVoice.renderBlock(perVoiceBuffer);
+        batched.renderBlock(batchedBuffer);
+        REQUIRE( approxEqualMargin(perVoiceBuffer.getConstSpan(0), batchedBuffer.getConstSpan(0)) );
+        REQUIRE( approxEqualMargin(perVoiceBuffer.getConstSpan(1), batchedBuffer.getConstSpan(1)) );
+    }
+
+    REQUIRE( perVoice.getNumActiveVoices() == batched.getNumActiveVoices() );
+}
+
+TEST_CASE("[Synth] Background loads swap the instrument at a block boundary")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(256);
+    sfz::AudioBuffer<float> buffer { 2, 256 };
+    const auto isSilent = [&buffer]() {
+        return sfz::allWithin(buffer.getConstSpan(0), -1e-6f, 1e-6f)
+            && sfz::allWithin(buffer.getConstSpan(1), -1e-6f, 1e-6f);
+    };
+
+    synth.loadSfzString(fs::current_path() / "tests/TestFiles/swap_old.sfz", R"(
+        <region> key=60 sample=*sine
+    )");
+    synth.noteOn(0, 60, 100);
+    synth.renderBlock(buffer);
+    REQUIRE( !isSilent() );
+
+    REQUIRE( synth.loadSfzStringInBackground(fs::current_path() / "tests/TestFiles/swap_new.sfz", R"(
+        <region> key=62 sample=*saw
+        <region> key=64 sample=*triangle
+    )") );
+    REQUIRE( synth.isInstrumentSwapPending() );
+    REQUIRE( synth.getNumRegions() == 2 );
+    REQUIRE( synth.getNumActiveVoices() == 0 );
+
+    // The audio thread takes over the old instrument, which still plays the old note
+    synth.renderBlock(buffer);
+    REQUIRE( !synth.isInstrumentSwapPending() );
+    REQUIRE( synth.getNumActiveVoices() == 0 );
+    REQUIRE( !isSilent() );
+
+    // The old note rings out while fading, then the old instrument is retired
+    synth.renderBlock(buffer);
+    REQUIRE( !isSilent() );
+    const int ringOutBlocks = static_cast<int>(
+        sfz::config::instrumentSwapRingOutTime * sfz::config::defaultSampleRate / 256) + 2;
+    for (int i = 0; i < ringOutBlocks; ++i)
+        synth.renderBlock(buffer);
+    REQUIRE( isSilent() );
+
+    synth.noteOn(0, 62, 100);
+    synth.renderBlock(buffer);
+    REQUIRE( synth.getNumActiveVoices() == 1 );
+    REQUIRE( !isSilent() );
+}
+
+TEST_CASE("[Synth] Failed background loads keep the current instrument")
+{
+    sfz::Synth synth;
+    synth.loadSfzString(fs::current_path() / "tests/TestFiles/swap_old.sfz", R"(
+        <region> key=60 sample=*sine
+    )");
+
+    REQUIRE( !synth.loadSfzStringInBackground(fs::current_path() / "tests/TestFiles/swap_new.sfz", "") );
+    REQUIRE( !synth.loadSfzFileInBackground(fs::current_path() / "tests/TestFiles/does_not_exist.sfz") );
+    REQUIRE( !synth.isInstrumentSwapPending() );
+    REQUIRE( synth.getNumRegions() == 1 );
+}
+
+TEST_CASE("[Synth] Background loads keep the settings of the synth")
+{
+    sfz::Synth synth;
+    synth.setSamplesPerBlock(128);
+    synth.setSampleRate(44100);
+    synth.setNumVoices(16);
+    synth.setVolume(-6.0f);
+    synth.setSampleQuality(sfz::Synth::ProcessMode::ProcessLive, 3);
+    synth.setTuningFrequency(432.0f);
+
+    REQUIRE( synth.loadSfzStringInBackground(fs::current_path() / "tests/TestFiles/swap_new.sfz", R"(
+        <region> key=60 sample=*sine
+    )") );
+    sfz::AudioBuffer<float> buffer { 2, 128 };
+    synth.renderBlock(buffer);
+
+    REQUIRE( synth.getNumRegions() == 1 );
+    REQUIRE( synth.getSamplesPerBlock() == 128 );
+    REQUIRE( synth.getNumVoices() == 16 );
+    REQUIRE( synth.getVolume() == -6.0f );
+    REQUIRE( synth.getSampleQuality(sfz::Synth::ProcessMode::ProcessLive) == 3 );
+    REQUIRE( synth.getTuningFrequency() == 432.0f );
+}
+
+TEST_CASE("[Synth] Background loads apply the settings changed during the load")
+{
+    sfz::Synth synth;
+    synth.setVolume(-6.0f);
+    synth.setNumVoices(16);
+    synth.setLoadProgressCallback([&synth](size_t, size_t) {
+        synth.setVolume(-12.0f);
+        synth.setNumVoices(24);
+        return true;
+    });
+
+    REQUIRE( synth.loadSfzStringInBackground(fs::current_path() / "tests/TestFiles/swap_new.sfz", R"(
+        <region> key=60 sample=kick.wav
+    )") );
+    REQUIRE( synth.getNumRegions() == 1 );
+    REQUIRE( synth.getVolume() == -12.0f );
+    REQUIRE( synth.getNumVoices() == 24 );
+}
+
+TEST_CASE("[Synth] Background loads do not lose the settings changed on the audio thread")
+{
+    sfz::Synth synth;
+    std::atomic<bool> loading { true };
+    float lastVolume = 0.0f;
+    float lastFrequency = 440.0f;
+    std::thread audioThread([&]() {
+        for (int i = 0; loading.load(); ++i) {
+            lastVolume = -static_cast<float>(i % 40);
+            lastFrequency = 400.0f + static_cast<float>(i % 80);
+            synth.setVolume(lastVolume);
+            synth.setTuningFrequency(lastFrequency);
+        }
+    });
+
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE( synth.loadSfzStringInBackground(fs::current_path() / "tests/TestFiles/swap_new.sfz", R"(
+            <region> key=60 sample=*sine
+        )") );
+    }
+    loading = false;
+    audioThread.join();
+    REQUIRE( synth.getVolume() == lastVolume );
+    REQUIRE( synth.getTuningFrequency() == lastFrequency );
+}
+
+TEST_CASE("[Synth] Background loads keep the control hints of the new instrument")
+{
+    sfz::Synth synth;
+    REQUIRE( synth.loadSfzStringInBackground(fs::current_path() / "tests/TestFiles/swap_new.sfz", R"(
+        <control> hint_sustain_cancels_release=1
+        <region> key=60 sample=*sine
+    )") );
+    REQUIRE( synth.getResources().getSynthConfig().sustainCancelsRelease );
+}
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+// This code is part of the sfizz library and is licensed under a BSD 2-clause
+// license. You should have receive a LICENSE.md file along with the code.
+// If not, contact the sfizz maintainers at https://github.com/sfztools/sfizz
+
+#include "TestHelpers.h"
+#include "sfizz/Synth.h"
+#include "sfizz/Telemetry.h"
+#include "catch2/catch.hpp"
+#include <ghc/fs_std.hpp>
+using namespace Catch::literals;
+using namespace sfz;
+
+TEST_CASE("[Telemetry] Histogram buckets")
+{
+    for (uint64_t value : { 0ull, 1ull, 15ull, 16ull, 17ull, 31ull, 32ull, 1000ull, 123456789ull }) {
+        const unsigned index = LatencyHistogram::bucketIndex(value);
+        REQUIRE(value <= LatencyHistogram::bucketUpperBound(index));
+        if (index > 0)
+            REQUIRE(value > LatencyHistogram::bucketUpperBound(index - 1));
+    }
+    REQUIRE(LatencyHistogram::bucketIndex(uint64_t(1) << 50) == LatencyHistogram::numBuckets - 1);
+}
+
+TEST_CASE("[Telemetry] Histogram percentiles")
+{
+    LatencyHistogram histogram;
+    REQUIRE(histogram.percentile(0.5) == 0);
+
+    for (uint64_t i = 1; i <= 1000; ++i)
+        histogram.record(i * 1000);
+
+    REQUIRE(histogram.count() == 1000);
+    REQUIRE(histogram.max() == 1000000);
+    REQUIRE(histogram.mean() == Approx(500500.0));
+
+    // Upper bounds within the precision of the buckets
+    const auto p50 = static_cast<double>(histogram.percentile(0.5));
+    const auto p99 = static_cast<double>(histogram.percentile(0.99));
+    REQUIRE(p50 >= 500000.0);
+    REQUIRE(p50 <= 500000.0 * 1.07);
+    REQUIRE(p99 >= 990000.0);
+    REQUIRE(p99 <= 990000.0 * 1.07);
+    REQUIRE(histogram.percentile(1.0) >= histogram.max());
+
+    histogram.reset();
+    REQUIRE(histogram.count() == 0);
+    REQUIRE(histogram.percentile(0.99) == 0);
+}
+
+TEST_CASE("[Telemetry] Counters are collected while rendering")
+{
+    sfz::Synth synth;
+    sfz::AudioBuffer<float> buffer { 2, static_cast<unsigned>(synth.getSamplesPerBlock()) };
+    std::vector<std::string> messageList;
+    Client client(&messageList);
+    client.setReceiveCallback(&simpleMessageReceiver);
+    synth.loadSfzString(fs::current_path() / "tests/TestFiles/telemetry.sfz", R"(
+        <region> key=60 sample=*sine polyphony=1
+    )");
+    synth.resetTelemetry();
+    synth.noteOn(0, 60, 100);
+    synth.renderBlock(buffer);
+    synth.noteOn(0, 60, 100);
+    synth.renderBlock(buffer);
+    synth.renderBlock(buffer);
+
+    const Telemetry& telemetry = synth.getTelemetry();
+    REQUIRE(telemetry.getNumBlocks() == 3);
+    REQUIRE(telemetry.getNumFrames() == 3 * buffer.getNumFrames());
+    REQUIRE(telemetry.getStolenVoices() == 1);
+    REQUIRE(telemetry.getMaxActiveVoices() >= 1);
+    REQUIRE(telemetry.getCallbackTimes().count() == 3);
+
+    synth.dispatchMessage(client, 0, "/telemetry/blocks", "", nullptr);
+    synth.dispatchMessage(client, 0, "/telemetry/stolen_voices", "", nullptr);
+    synth.dispatchMessage(client, 0, "/telemetry/buffer_pool_exhaustions", "", nullptr);
+    std::vector<std::string> expected {
+        "/telemetry/blocks,h : { 3 }",
+        "/telemetry/stolen_voices,h : { 1 }",
+        "/telemetry/buffer_pool_exhaustions,h : { 0 }",
+    };
+    REQUIRE(messageList == expected);
+
+    synth.resetTelemetry();
+    REQUIRE(telemetry.getNumBlocks() == 0);
+    REQUIRE(telemetry.getStolenVoices() == 0);
+    REQUIRE(telemetry.getCallbackTimes().count() == 0);
+}